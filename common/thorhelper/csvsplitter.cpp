@@ -27,6 +27,13 @@
 #include "unicode/uchar.h"
 #endif
 
+#include "jset.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CSV_SCAN_SSE2
+#endif
+
 #include "csvsplitter.hpp"
 #include "eclrtl.hpp"
 #include "roxiemem.hpp"
@@ -36,6 +43,90 @@ using roxiemem::OwnedRoxieString;
 #define DEFAULT_CSV_LINE_LENGTH 2048
 #define MAX_SENSIBLE_CSV_LINE_LENGTH 0x200000
 
+//=====================================================================================================
+
+void CSVStructuralScanner::init(const StringMatcher & matcher)
+{
+    clear();
+    for (unsigned c=0; c < 256; c++)
+    {
+        structural[c] = matcher.isLeadingChar((byte)c);
+        if (structural[c])
+        {
+            //Too many different characters to compare against - the byte-at-a-time matcher will be quicker
+            if (numChars == MaxStructuralChars)
+                return;
+            chars[numChars++] = (byte)c;
+        }
+    }
+    enabled = true;
+}
+
+const byte * CSVStructuralScanner::skipPlain(const byte * cur, const byte * end) const
+{
+#ifdef CSV_SCAN_SSE2
+    if (end - cur >= 32)
+    {
+        __m128i search[MaxStructuralChars];
+        for (unsigned i=0; i < numChars; i++)
+            search[i] = _mm_set1_epi8((char)chars[i]);
+
+        do
+        {
+            __m128i low = _mm_loadu_si128((const __m128i *)cur);
+            __m128i high = _mm_loadu_si128((const __m128i *)(cur + 16));
+            __m128i matchLow = _mm_setzero_si128();
+            __m128i matchHigh = _mm_setzero_si128();
+            for (unsigned i=0; i < numChars; i++)
+            {
+                matchLow = _mm_or_si128(matchLow, _mm_cmpeq_epi8(low, search[i]));
+                matchHigh = _mm_or_si128(matchHigh, _mm_cmpeq_epi8(high, search[i]));
+            }
+            unsigned mask = (unsigned)_mm_movemask_epi8(matchLow) | ((unsigned)_mm_movemask_epi8(matchHigh) << 16);
+            if (mask)
+                return cur + countTrailingUnsetBits(mask);
+            cur += 32;
+        } while (end - cur >= 32);
+    }
+#else
+    if (end - cur >= 8)
+    {
+        const unsigned __int64 lowBits = 0x7F7F7F7F7F7F7F7FULL;
+        unsigned __int64 search[MaxStructuralChars];
+        for (unsigned i=0; i < numChars; i++)
+            search[i] = chars[i] * 0x0101010101010101ULL;
+
+        do
+        {
+            unsigned __int64 value;
+            memcpy(&value, cur, sizeof(value));
+            unsigned __int64 mask = 0;
+            for (unsigned i=0; i < numChars; i++)
+            {
+                //Exact test for zero bytes - sets the top bit of each byte that matched
+                unsigned __int64 diff = value ^ search[i];
+                mask |= ~(((diff & lowBits) + lowBits) | diff | lowBits);
+            }
+            if (mask)
+            {
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+                return cur + countTrailingUnsetBits(mask) / 8;
+#else
+                break;
+#endif
+            }
+            cur += 8;
+        } while (end - cur >= 8);
+    }
+#endif
+
+    while ((cur != end) && !structural[*cur])
+        cur++;
+    return cur;
+}
+
+//=====================================================================================================
+
 CSVSplitter::CSVSplitter()
 {
     lengths = NULL;
@@ -55,6 +146,7 @@ CSVSplitter::~CSVSplitter()
 
 void CSVSplitter::addQuote(const char * text)
 {
+    scannerPrepared = false;
     //Allow '' to remove quoting.
     if (text && *text)
         matcher.addEntry(text, QUOTE+(numQuotes++<<8));
@@ -62,28 +154,33 @@ void CSVSplitter::addQuote(const char * text)
 
 void CSVSplitter::addSeparator(const char * text)
 {
+    scannerPrepared = false;
     if (text && *text)
         matcher.addEntry(text, SEPARATOR);
 }
 
 void CSVSplitter::addTerminator(const char * text)
 {
+    scannerPrepared = false;
     matcher.addEntry(text, TERMINATOR);
 }
 
 void CSVSplitter::addItem(MatchItem item, const char * text)
 {
+    scannerPrepared = false;
     if (text)
         matcher.addEntry(text, item);
 }
 
 void CSVSplitter::addEscape(const char * text)
 {
+    scannerPrepared = false;
     matcher.queryAddEntry((size32_t)strlen(text), text, ESCAPE);
 }
 
 void CSVSplitter::addWhitespace()
 {
+    scannerPrepared = false;
     matcher.queryAddEntry(1, " ", WHITESPACE);
     matcher.queryAddEntry(1, "\t", WHITESPACE);
 }
@@ -91,6 +188,8 @@ void CSVSplitter::addWhitespace()
 void CSVSplitter::reset()
 {
     matcher.reset();
+    scanner.clear();
+    scannerPrepared = false;
     delete [] lengths;
     delete [] data;
     free(internalBuffer);
@@ -253,7 +352,10 @@ void CSVSplitter::setFieldRange(const byte * start, const byte * end, unsigned c
         switch (match & 255)
         {
         case NONE:
-            matchLen = 1;
+            if (scanner.isEnabled())
+                matchLen = (unsigned)(scanner.skipPlain(cur+1, end) - cur);
+            else
+                matchLen = 1;
             break;
         case WHITESPACE:
         case SEPARATOR:
@@ -342,6 +444,8 @@ size32_t CSVSplitter::splitLine(size32_t maxLength, const byte * start)
     bool lastEscape = false;
     internalOffset = 0;
 
+    prepareScanner();
+    const bool scanPlain = scanner.isEnabled();
     while (cur != end)
     {
         unsigned matchLen;
@@ -350,6 +454,9 @@ size32_t CSVSplitter::splitLine(size32_t maxLength, const byte * start)
         {
         case NONE:
             cur++;          // matchLen == 0;
+            //Skip the rest of a run of characters that cannot start a match
+            if (scanPlain)
+                cur = scanner.skipPlain(cur, end);
             lastGood = cur;
             break;
         case WHITESPACE:
@@ -633,3 +740,170 @@ void CSVOutputStream::writeHeaderLn(size32_t len, const char * data)
     }
 }
 
+
+//=====================================================================================================
+
+#ifdef _USE_CPPUNIT
+#include "unittests.hpp"
+
+namespace csvsplittertests {
+
+static void generateCsv(StringBuffer & out, unsigned numLines, unsigned numFields, unsigned seed)
+{
+    static const char * const fragments[] = { "abc", "a much longer piece of plain text", "12345", " padded ", "\"quoted, with separator\"", "\"double \"\"quoted\"\"\"", "x\\,y", "" };
+    unsigned numFragments = (unsigned)(sizeof(fragments)/sizeof(fragments[0]));
+    for (unsigned line=0; line < numLines; line++)
+    {
+        for (unsigned field=0; field < numFields; field++)
+        {
+            if (field)
+                out.append(',');
+            seed = seed * 1103515245 + 12345;
+            out.append(fragments[(seed >> 16) % numFragments]);
+            if ((seed >> 8) & 1)
+                out.append(fragments[1]);
+        }
+        out.append((line & 1) ? "\r\n" : "\n");
+    }
+}
+
+static unsigned splitAll(CSVSplitter & splitter, const StringBuffer & text, unsigned numFields, StringBuffer * fields)
+{
+    unsigned numLines = 0;
+    const byte * cur = (const byte *)text.str();
+    size32_t remaining = text.length();
+    while (remaining)
+    {
+        size32_t len = splitter.splitLine(remaining, cur);
+        if (fields)
+        {
+            for (unsigned i=0; i < numFields; i++)
+                fields->append(splitter.queryLengths()[i], (const char *)splitter.queryData()[i]).append('|');
+            fields->newline();
+        }
+        cur += len;
+        remaining -= len;
+        numLines++;
+    }
+    return numLines;
+}
+
+class CSVSplitterTests : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( CSVSplitterTests );
+        CPPUNIT_TEST(testScanner);
+        CPPUNIT_TEST(testSplitMatches);
+        CPPUNIT_TEST(testMultiByte);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    void checkSplit(const char * quotes, const char * separators, const char * terminators, const char * escapes, const StringBuffer & text, unsigned numFields)
+    {
+        CSVSplitter scalar;
+        CSVSplitter vector;
+        scalar.init(numFields, 0, quotes, separators, terminators, escapes, false);
+        vector.init(numFields, 0, quotes, separators, terminators, escapes, false);
+        scalar.setUseScanner(false);
+
+        StringBuffer expected, actual;
+        unsigned expectedLines = splitAll(scalar, text, numFields, &expected);
+        unsigned actualLines = splitAll(vector, text, numFields, &actual);
+        CPPUNIT_ASSERT_EQUAL(expectedLines, actualLines);
+        CPPUNIT_ASSERT_EQUAL(std::string(expected.str()), std::string(actual.str()));
+    }
+
+public:
+    void testScanner()
+    {
+        StringMatcher matcher;
+        addActionList(matcher, ",", CSVSplitter::SEPARATOR);
+        addActionList(matcher, "\n", CSVSplitter::TERMINATOR);
+
+        CSVStructuralScanner scanner;
+        scanner.init(matcher);
+        CPPUNIT_ASSERT(scanner.isEnabled());
+
+        //Check every position relative to the block boundaries
+        for (unsigned len=0; len < 100; len++)
+        {
+            StringBuffer text;
+            text.appendN(len, 'x').append(',').appendN(40, 'y');
+            const byte * start = (const byte *)text.str();
+            CPPUNIT_ASSERT_EQUAL((size_t)len, (size_t)(scanner.skipPlain(start, start + text.length()) - start));
+            CPPUNIT_ASSERT_EQUAL((size_t)len, (size_t)(scanner.skipPlain(start, start + len) - start));
+        }
+
+        //Too many distinct characters to scan efficiently
+        addActionList(matcher, "a,b,c,d,e,f,g", CSVSplitter::QUOTE);
+        scanner.init(matcher);
+        CPPUNIT_ASSERT(!scanner.isEnabled());
+    }
+
+    void testSplitMatches()
+    {
+        StringBuffer text;
+        generateCsv(text, 500, 7, 1);
+        checkSplit("\"", ",", "\n,\r\n", "\\", text, 7);
+        //Fewer columns than fields in the file
+        checkSplit("\"", ",", "\n,\r\n", "\\", text, 3);
+        //A trailing line without a terminator
+        text.append("last,line");
+        checkSplit("\"", ",", "\n,\r\n", nullptr, text, 7);
+    }
+
+    void testMultiByte()
+    {
+        StringBuffer text;
+        generateCsv(text, 200, 5, 7);
+        text.replaceString(",", "<>");
+        checkSplit("\"", "<>", "\n,\r\n", "\\", text, 5);
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( CSVSplitterTests );
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( CSVSplitterTests, "CSVSplitterTests" );
+
+class CSVSplitterTiming : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( CSVSplitterTiming );
+        CPPUNIT_TEST(testThroughput);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    void timeSplit(const char * title, const StringBuffer & text, unsigned numFields, bool useScanner)
+    {
+        CSVSplitter splitter;
+        splitter.init(numFields, 0, "\"", ",", "\n,\r\n", "\\", false);
+        splitter.setUseScanner(useScanner);
+
+        const unsigned numIter = 20;
+        unsigned numLines = 0;
+        cycle_t start = get_cycles_now();
+        for (unsigned pass=0; pass < numIter; pass++)
+            numLines += splitAll(splitter, text, numFields, nullptr);
+        cycle_t elapsed = get_cycles_now() - start;
+        double seconds = (double)cycle_to_nanosec(elapsed) / 1000000000.0;
+        DBGLOG("%s(%s): %u lines in %.3fs = %.1f MB/s", title, useScanner ? "scanner" : "bytewise", numLines, seconds, ((double)text.length() * numIter) / (seconds * 1024 * 1024));
+    }
+
+public:
+    void testThroughput()
+    {
+        StringBuffer text;
+        generateCsv(text, 100000, 12, 99);
+        timeSplit("Mixed", text, 12, false);
+        timeSplit("Mixed", text, 12, true);
+
+        StringBuffer numeric;
+        for (unsigned line=0; line < 200000; line++)
+            numeric.append(line).append(',').append(line * 7919ULL).append(',').append("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklm").append('\n');
+        timeSplit("Unquoted", numeric, 3, false);
+        timeSplit("Unquoted", numeric, 3, true);
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( CSVSplitterTiming );
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( CSVSplitterTiming, "CSVSplitterTiming" );
+
+} // namespace csvsplittertests
+#endif
@@ -57,6 +57,34 @@
  * char, while the RFC mentions re-using quotes (""). We implement both.
  */
 
+/**
+ * CSVStructuralScanner - skips runs of bytes that cannot start a quote, separator, terminator,
+ * escape or whitespace sequence.
+ *
+ * The set of possible leading bytes is compared against a block of input at a time (32 bytes
+ * with SSE2, otherwise 8 bytes using 64bit word operations), giving a bitmask of the structural
+ * positions within the block.  It is only enabled when the number of distinct leading bytes is
+ * small - otherwise the splitter falls back to matching each byte individually.
+ */
+class THORHELPER_API CSVStructuralScanner
+{
+public:
+    static constexpr unsigned MaxStructuralChars = 8;
+
+    void init(const StringMatcher & matcher);
+    void clear() { numChars = 0; enabled = false; }
+    inline bool isEnabled() const { return enabled; }
+
+    //Returns the first position in [cur, end) that could start a match, or end if there are none
+    const byte * skipPlain(const byte * cur, const byte * end) const;
+
+protected:
+    byte chars[MaxStructuralChars];
+    bool structural[256];
+    unsigned numChars = 0;
+    bool enabled = false;
+};
+
 interface ISerialStream;
 class THORHELPER_API CSVSplitter
 {
@@ -82,12 +110,29 @@ public:
     inline unsigned * queryLengths() const { return lengths; }
     inline const byte * * queryData() const { return data; }
 
+    //Allows the vectorised structural scanning to be disabled (e.g., to compare against the byte-at-a-time path)
+    inline void setUseScanner(bool value) { useScanner = value; scannerPrepared = false; }
+
 protected:
     void setFieldRange(const byte * start, const byte * end, unsigned curColumn, unsigned quoteToStrip, bool unescape);
+    inline void prepareScanner()
+    {
+        if (!scannerPrepared)
+        {
+            if (useScanner)
+                scanner.init(matcher);
+            else
+                scanner.clear();
+            scannerPrepared = true;
+        }
+    }
 
 protected:
     unsigned            maxColumns;
     StringMatcher       matcher;
+    CSVStructuralScanner scanner;
+    bool                scannerPrepared = false;
+    bool                useScanner = true;
     unsigned            numQuotes;
     unsigned *          lengths;
     const byte * *      data;
@@ -1224,6 +1224,27 @@ private:
         virtual size32_t getRecordSize() const override { throwUnexpected(); }
     };
 
+    // Used when the fields are extracted directly from the parse events rather than from a property tree for each row
+    class CStreamFieldFetcher : public CSimpleInterfaceOf<IDynamicFieldValueFetcher>
+    {
+        Linked<IXmlFieldParse> parser;
+    public:
+        CStreamFieldFetcher(IXmlFieldParse *_parser) : parser(_parser)
+        {
+        }
+    // IDynamicFieldValueFetcher impl.
+        virtual const byte *queryValue(unsigned fieldNum, size_t &sz) const override
+        {
+            size32_t rawSz;
+            const char *ret = parser->queryValue(fieldNum, rawSz);
+            sz = rawSz;
+            return (const byte *)ret;
+        }
+        virtual IDynamicRowIterator *getNestedIterator(unsigned fieldNum) const override { throwUnexpected(); }
+        virtual size_t getSize(unsigned fieldNum) const override { throwUnexpected(); }
+        virtual size32_t getRecordSize() const override { throwUnexpected(); }
+    };
+
 public:
     IMPLEMENT_IINTERFACE_USING(ExternalFormatDiskRowReader);
     MarkupDiskRowReader(IDiskReadMapping * _mapping, ThorActivityKind _kind);
@@ -1242,6 +1263,8 @@ public:
 
 protected:
     virtual bool setInputFile(IFile * inputFile, const char * _logicalFilename, unsigned _partNumber, offset_t _baseOffset, offset_t startOffset, offset_t length, const IPropertyTree * inputOptions, const FieldFilterArray & expectedFilter) override;
+    bool getStreamedFieldXPaths(std::vector<const char *> & fieldXPaths) const;
+    bool nextMatch();
 
 protected:
     StringBuffer xpath;
@@ -1251,9 +1274,11 @@ protected:
     IXmlToRowTransformer *xmlTransformer = nullptr;
     Linked<IColumnProvider> lastMatch;
     Owned<IXMLParse> xmlParser;
+    Owned<IXmlFieldParse> fieldParser;
 
     bool noRoot = false;
     bool useXmlContents = false;
+    bool streamFields = true;
 
     const RtlRecord *record = nullptr;
     bool opened = false;
@@ -1267,6 +1292,7 @@ MarkupDiskRowReader::MarkupDiskRowReader(IDiskReadMapping * _mapping, ThorActivi
 
     markupOptions.getProp("ActivityOptions/rowTag", rowTag);
     noRoot = markupOptions.getPropBool("noRoot");
+    streamFields = markupOptions.getPropBool("streamFields", streamFields);
 
     record = &actualDiskMeta->queryRecordAccessor(true);
 }
@@ -1276,25 +1302,53 @@ bool MarkupDiskRowReader::setInputFile(IFile * inputFile, const char * _logicalF
     return ExternalFormatDiskRowReader::setInputFile(inputFile, _logicalFilename, _partNumber, _baseOffset, startOffset, length, inputOptions, _expectedFilter);
 }
 
-//Implementation of IAllocRowStream
-const void *MarkupDiskRowReader::nextRow()
+//Returns true if the fields can be extracted directly from the parse events, without building a property tree for each row
+bool MarkupDiskRowReader::getStreamedFieldXPaths(std::vector<const char *> & fieldXPaths) const
 {
-    checkOpen();
+    unsigned numFields = record->getNumFields();
+    fieldXPaths.resize(numFields);
+    for (unsigned fieldNum=0; fieldNum<numFields; fieldNum++)
+    {
+        //Nested records, datasets and sets require the child iterators provided by the property tree
+        if (record->queryNested(fieldNum) || record->queryType(fieldNum)->queryChildType())
+            return false;
+        fieldXPaths[fieldNum] = record->queryXPath(fieldNum);
+    }
+    return canStreamXmlFields(xpath, numFields, fieldXPaths.data());
+}
+
+//Position on the next matching row, and associate the field fetcher with it
+bool MarkupDiskRowReader::nextMatch()
+{
+    if (fieldParser)
+        return fieldParser->nextRow();
+
     while (xmlParser->next())
     {
         if (lastMatch)
         {
-            RtlDynamicRowBuilder builder(outputAllocator);
             ((CFieldFetcher *)fieldFetcher.get())->setCurrentMatch(lastMatch);
-            size32_t sizeRead = translator->translate(builder, *this, *fieldFetcher);
-            dbgassertex(sizeRead);
             lastMatch.clear();
-            roxiemem::OwnedConstRoxieRow next = builder.finalizeRowClear(sizeRead);
-
-            if (fieldFilterMatchProjected(next))
-                return next.getClear();
+            return true;
         }
     }
+    return false;
+}
+
+//Implementation of IAllocRowStream
+const void *MarkupDiskRowReader::nextRow()
+{
+    checkOpen();
+    while (nextMatch())
+    {
+        RtlDynamicRowBuilder builder(outputAllocator);
+        size32_t sizeRead = translator->translate(builder, *this, *fieldFetcher);
+        dbgassertex(sizeRead);
+        roxiemem::OwnedConstRoxieRow next = builder.finalizeRowClear(sizeRead);
+
+        if (fieldFilterMatchProjected(next))
+            return next.getClear();
+    }
     return eofRow;
 }
 
@@ -1310,24 +1364,19 @@ const void *MarkupDiskRowReader::nextRow(size32_t & resultSize)
 const void * MarkupDiskRowReader::nextRow(MemoryBufferBuilder & builder)
 {
     checkOpen();
-    while (xmlParser->next())
+    while (nextMatch())
     {
-        if (lastMatch)
-        {
-            ((CFieldFetcher *)fieldFetcher.get())->setCurrentMatch(lastMatch);
-            size32_t resultSize = translator->translate(builder, *this, *fieldFetcher);
-            dbgassertex(resultSize);
-            lastMatch.clear();
-            const void *ret = builder.getSelf();
+        size32_t resultSize = translator->translate(builder, *this, *fieldFetcher);
+        dbgassertex(resultSize);
+        const void *ret = builder.getSelf();
 
-            if (fieldFilterMatchProjected(ret))
-            {
-                builder.finishRow(resultSize);
-                return ret;
-            }
-            else
-                builder.removeBytes(resultSize);
+        if (fieldFilterMatchProjected(ret))
+        {
+            builder.finishRow(resultSize);
+            return ret;
         }
+        else
+            builder.removeBytes(resultSize);
     }
     return eofRow;
 }
@@ -1370,13 +1419,29 @@ bool MarkupDiskRowReader::checkOpen()
     if (!opened)
     {
         Owned<ISimpleReadStream> simpleStream = new CSimpleStream(inputStream);
-        if (kind==TAKjsonread)
-            xmlParser.setown(createJSONParse(*simpleStream, xpath, *this, noRoot?ptr_noRoot:ptr_none, useXmlContents));
+        PTreeReaderOptions readerOptions = noRoot ? ptr_noRoot : ptr_none;
+        std::vector<const char *> fieldXPaths;
+        if (streamFields && !useXmlContents && getStreamedFieldXPaths(fieldXPaths))
+        {
+            unsigned numFields = record->getNumFields();
+            if (kind==TAKjsonread)
+                fieldParser.setown(createJsonFieldParse(*simpleStream, xpath, numFields, fieldXPaths.data(), readerOptions));
+            else
+                fieldParser.setown(createXmlFieldParse(*simpleStream, xpath, numFields, fieldXPaths.data(), readerOptions));
+            xmlParser.clear();
+            fieldFetcher.setown(new CStreamFieldFetcher(fieldParser));
+        }
         else
-            xmlParser.setown(createXMLParse(*simpleStream, xpath, *this, noRoot?ptr_noRoot:ptr_none, useXmlContents));
+        {
+            if (kind==TAKjsonread)
+                xmlParser.setown(createJSONParse(*simpleStream, xpath, *this, readerOptions, useXmlContents));
+            else
+                xmlParser.setown(createXMLParse(*simpleStream, xpath, *this, readerOptions, useXmlContents));
+            fieldParser.clear();
 
-        if (!fieldFetcher)
-            fieldFetcher.setown(new CFieldFetcher(*record, nullptr));
+            if (!fieldFetcher)
+                fieldFetcher.setown(new CFieldFetcher(*record, nullptr));
+        }
 
         opened = true;
         return true;
@@ -17,6 +17,7 @@
 
 #include "platform.h"
 #include <algorithm>
+#include <vector>
 
 #include "jlib.hpp"
 #include "jexcept.hpp"
@@ -2195,3 +2196,484 @@ IXMLParse *createJSONParseString(const char *string, const char *xpath, IXMLSele
     return parser;
 }
 
+
+//=====================================================================================================
+
+static bool isSimpleRowXPath(const char *xpath)
+{
+    if (!xpath)
+        return true;
+    if ('/' == *xpath)
+        xpath++;
+    for (const char *cur = xpath; *cur; cur++)
+    {
+        switch (*cur)
+        {
+        case '[':
+        case ']':
+        case '@':
+            return false;
+        case '/':
+            if ('/' == cur[1] || '\0' == cur[1])
+                return false;
+            break;
+        }
+    }
+    return true;
+}
+
+static bool isSimpleFieldXPath(const char *xpath)
+{
+    if (!xpath || !*xpath || '/' == *xpath)
+        return false;
+    bool segmentStart = true;
+    for (const char *cur = xpath; *cur; cur++)
+    {
+        switch (*cur)
+        {
+        case '[':
+        case ']':
+        case '*':
+        case '<':
+        case '>':
+            return false;
+        case '@':
+            //Attributes are only supported as the final element of the path
+            if (!segmentStart || strchr(cur, '/'))
+                return false;
+            break;
+        case '/':
+            if (segmentStart)
+                return false;
+            segmentStart = true;
+            continue;
+        }
+        segmentStart = false;
+    }
+    return !segmentStart;
+}
+
+bool canStreamXmlFields(const char *rowXPath, unsigned numFields, const char * const *fieldXPaths)
+{
+    if (!isSimpleRowXPath(rowXPath))
+        return false;
+    for (unsigned field=0; field < numFields; field++)
+    {
+        if (!isSimpleFieldXPath(fieldXPaths[field]))
+            return false;
+    }
+    return true;
+}
+
+/*
+ * The field xpaths are compiled into a tree of element names (relative to the row element).  As the parse events
+ * for a row are processed, a stack of the current states within that tree is maintained.  Every occurrence of an
+ * element is followed, but only the first element or attribute (in document order) that matches the full xpath of a
+ * field is used - which matches the semantics of queryProp(), e.g. address/city is found in the second address if
+ * the first does not contain a city.
+ * Values are copied into a buffer that is reused for each row, so no allocations are required once it has grown.
+ */
+class CXmlFieldMatcher : implements IPTreeNotifyEvent, public CInterface
+{
+    static constexpr unsigned noState = (unsigned)-1;
+
+    struct FieldPathState
+    {
+        StringAttr tag;
+        std::vector<unsigned> valueFields;
+        std::vector<unsigned> children;
+        std::vector<std::pair<StringAttr, unsigned>> attributes;
+    };
+
+    struct FieldValue
+    {
+        size32_t offset = 0;
+        size32_t size = 0;
+        unsigned row = 0;                       // the row this value was set for
+        unsigned matchedRow = 0;                // the row in which the field was matched (possibly without a value)
+    };
+
+    CXPath rowXPath;
+    std::vector<FieldPathState> states;
+    std::vector<unsigned> stateStack;           // state for each open element within the current row
+    std::vector<FieldValue> values, completeValues;
+    MemoryBuffer valueBuffer, completeValueBuffer;
+    unsigned numFields;
+    unsigned rowLevel;                          // the nesting level of the row elements
+    unsigned level = 0;
+    unsigned matchedLevels = 0;                 // number of enclosing elements that match the row xpath
+    unsigned curRow = 0;
+    unsigned completeRow = 0;
+    bool inRow = false;
+    bool rowReady = false;
+    bool isJson;
+
+    unsigned queryChildState(unsigned parent, const char *tag, size32_t len)
+    {
+        for (unsigned child : states[parent].children)
+        {
+            const StringAttr &childTag = states[child].tag;
+            if ((childTag.length() == len) && (0 == memcmp(childTag.get(), tag, len)))
+                return child;
+        }
+        unsigned next = (unsigned)states.size();
+        states.emplace_back();
+        states[next].tag.set(tag, len);
+        states[parent].children.push_back(next);
+        return next;
+    }
+    void addField(unsigned field, const char *xpath)
+    {
+        unsigned state = 0;
+        for (;;)
+        {
+            const char *sep = strchr(xpath, '/');
+            if (!sep)
+                break;
+            state = queryChildState(state, xpath, (size32_t)(sep-xpath));
+            xpath = sep+1;
+        }
+        if ('@' == *xpath)
+            states[state].attributes.emplace_back(xpath, field);
+        else
+        {
+            state = queryChildState(state, xpath, (size32_t)strlen(xpath));
+            states[state].valueFields.push_back(field);
+        }
+    }
+    void setValue(unsigned field, size32_t length, const void *value)
+    {
+        FieldValue &cur = values[field];
+        if (cur.matchedRow == curRow)
+            return;
+        cur.matchedRow = curRow;
+        if (!value)
+            return;
+        cur.row = curRow;
+        cur.offset = valueBuffer.length();
+        cur.size = length;
+        valueBuffer.append(length, value).append('\0');
+    }
+    bool checkSkipJsonRoot(const char *tag)
+    {
+        //Mirrors the root array/object handling in CXMLParse::CJSONMaker
+        if (!isJson || level || inRow)
+            return false;
+        if (streq(tag, "__array__"))
+            return true;
+        return streq(tag, "__object__") && rowXPath.queryDepth();
+    }
+    bool matchesRowXPath(unsigned matchLevel, const char *tag)
+    {
+        if (0 == rowXPath.queryDepth())
+            return true;
+        return rowXPath.match(matchLevel, tag);
+    }
+
+public:
+    IMPLEMENT_IINTERFACE_USING(CInterface);
+
+    CXmlFieldMatcher(const char *_rowXPath, unsigned _numFields, const char * const *fieldXPaths, bool _isJson)
+    : rowXPath(_rowXPath, false), numFields(_numFields), isJson(_isJson)
+    {
+        rowLevel = rowXPath.queryDepth() ? rowXPath.queryDepth()-1 : 0;
+        states.emplace_back();
+        values.resize(numFields);
+        completeValues.resize(numFields);
+        for (unsigned field=0; field < numFields; field++)
+            addField(field, fieldXPaths[field]);
+    }
+
+    inline bool isRowReady() const { return rowReady; }
+    inline void clearRowReady() { rowReady = false; }
+    const char *queryValue(unsigned field, size32_t &sz) const
+    {
+        dbgassertex(field < numFields);
+        const FieldValue &value = completeValues[field];
+        if (value.row != completeRow)
+        {
+            sz = 0;
+            return nullptr;
+        }
+        sz = value.size;
+        return completeValueBuffer.toByteArray() + value.offset;
+    }
+
+// IPTreeNotifyEvent
+    virtual void beginNode(const char *tag, bool sequence, offset_t startOffset) override
+    {
+        if (checkSkipJsonRoot(tag))
+            return;
+        if (inRow)
+        {
+            unsigned parent = stateStack.back();
+            unsigned next = noState;
+            if (noState != parent)
+            {
+                for (unsigned child : states[parent].children)
+                {
+                    //Later siblings are also followed since they may contain a match for a field that the earlier
+                    //ones did not.  setValue() ignores any fields that have already been matched.
+                    if (streq(states[child].tag, tag))
+                    {
+                        next = child;
+                        break;
+                    }
+                }
+            }
+            stateStack.push_back(next);
+        }
+        else if ((level <= rowLevel) && (matchedLevels == level) && matchesRowXPath(level, tag))
+        {
+            matchedLevels++;
+            if (level == rowLevel)
+            {
+                inRow = true;
+                curRow++;
+                valueBuffer.clear();
+                stateStack.clear();
+                stateStack.push_back(0);
+            }
+        }
+    }
+    virtual void newAttribute(const char *name, const char *value) override
+    {
+        if (!inRow)
+            return;
+        unsigned state = stateStack.back();
+        if (noState == state)
+            return;
+        for (auto &attr : states[state].attributes)
+        {
+            if (streq(attr.first, name))
+                setValue(attr.second, (size32_t)strlen(value), value);
+        }
+    }
+    virtual void beginNodeContent(const char *tag) override
+    {
+        if (checkSkipJsonRoot(tag))
+            return;
+        level++;
+    }
+    virtual void endNode(const char *tag, unsigned length, const void *value, bool binary, offset_t endOffset) override
+    {
+        if (checkSkipJsonRoot(tag))
+            return;
+        --level;
+        if (inRow)
+        {
+            unsigned state = stateStack.back();
+            stateStack.pop_back();
+            //NB: An empty value is treated as missing, the same as a property tree, but later elements are still ignored
+            if (noState != state)
+            {
+                for (unsigned field : states[state].valueFields)
+                    setValue(field, length, length ? value : nullptr);
+            }
+            if (stateStack.empty())
+            {
+                //Keep the values of the completed row - the next row may start before they have been consumed
+                inRow = false;
+                rowReady = true;
+                values.swap(completeValues);
+                valueBuffer.swapWith(completeValueBuffer);
+                completeRow = curRow;
+            }
+        }
+        if (matchedLevels > level)
+            matchedLevels = level;
+    }
+};
+
+class CXmlFieldParse : implements IXmlFieldParse, public CInterface
+{
+    Owned<CXmlFieldMatcher> matcher;
+    Owned<IPullPTreeReader> reader;
+
+public:
+    IMPLEMENT_IINTERFACE;
+
+    CXmlFieldParse(ISimpleReadStream &stream, const char *rowXPath, unsigned numFields, const char * const *fieldXPaths, PTreeReaderOptions xmlOptions, bool isJson)
+    {
+        matcher.setown(new CXmlFieldMatcher(rowXPath, numFields, fieldXPaths, isJson));
+        if (isJson)
+            reader.setown(createPullJSONStreamReader(stream, *matcher, xmlOptions));
+        else
+            reader.setown(createPullXMLStreamReader(stream, *matcher, xmlOptions));
+    }
+
+// IXmlFieldParse
+    virtual bool nextRow() override
+    {
+        matcher->clearRowReady();
+        while (!matcher->isRowReady())
+        {
+            if (!reader->next())
+                return false;
+        }
+        return true;
+    }
+    virtual const char *queryValue(unsigned field, size32_t &sz) const override
+    {
+        return matcher->queryValue(field, sz);
+    }
+};
+
+IXmlFieldParse *createXmlFieldParse(ISimpleReadStream &stream, const char *rowXPath, unsigned numFields, const char * const *fieldXPaths, PTreeReaderOptions xmlOptions)
+{
+    dbgassertex(canStreamXmlFields(rowXPath, numFields, fieldXPaths));
+    return new CXmlFieldParse(stream, rowXPath, numFields, fieldXPaths, xmlOptions, false);
+}
+
+IXmlFieldParse *createJsonFieldParse(ISimpleReadStream &stream, const char *rowXPath, unsigned numFields, const char * const *fieldXPaths, PTreeReaderOptions xmlOptions)
+{
+    dbgassertex(canStreamXmlFields(rowXPath, numFields, fieldXPaths));
+    return new CXmlFieldParse(stream, rowXPath, numFields, fieldXPaths, xmlOptions, true);
+}
+
+//=====================================================================================================
+
+#ifdef _USE_CPPUNIT
+#include "unittests.hpp"
+
+class XmlFieldParseTests : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( XmlFieldParseTests );
+        CPPUNIT_TEST(testXPaths);
+        CPPUNIT_TEST(testXml);
+        CPPUNIT_TEST(testJson);
+        CPPUNIT_TEST(testRepeatedParent);
+    CPPUNIT_TEST_SUITE_END();
+
+    class CRowCollector : public CSimpleInterfaceOf<IXMLSelect>
+    {
+        StringBuffer &out;
+        unsigned numFields;
+        const char * const *fieldXPaths;
+    public:
+        CRowCollector(StringBuffer &_out, unsigned _numFields, const char * const *_fieldXPaths) : out(_out), numFields(_numFields), fieldXPaths(_fieldXPaths) {}
+        virtual void match(IColumnProvider &entry, offset_t startOffset, offset_t endOffset) override
+        {
+            for (unsigned field=0; field < numFields; field++)
+            {
+                size32_t sz;
+                const char *value = entry.readRaw(fieldXPaths[field], sz);
+                appendValue(out, value, sz);
+            }
+            out.newline();
+        }
+    };
+
+    static void appendValue(StringBuffer &out, const char *value, size32_t sz)
+    {
+        if (value)
+            out.append('[').append(sz, value).append(']');
+        else
+            out.append("<null>");
+    }
+
+    void checkParse(const char *text, const char *rowXPath, unsigned numFields, const char * const *fieldXPaths, bool isJson)
+    {
+        CPPUNIT_ASSERT(canStreamXmlFields(rowXPath, numFields, fieldXPaths));
+
+        StringBuffer expected;
+        {
+            Owned<CRowCollector> collector = new CRowCollector(expected, numFields, fieldXPaths);
+            Owned<IXMLParse> parser = isJson ? createJSONParseString(text, rowXPath, *collector, ptr_none, false) : createXMLParseString(text, rowXPath, *collector, ptr_none, false);
+            while (parser->next())
+            {
+            }
+        }
+
+        StringBuffer actual;
+        {
+            Owned<IFileIO> io = createIFileI((unsigned)strlen(text), text);
+            Owned<IFileIOStream> stream = createIOStream(io);
+            Owned<IXmlFieldParse> parser = isJson ? createJsonFieldParse(*stream, rowXPath, numFields, fieldXPaths) : createXmlFieldParse(*stream, rowXPath, numFields, fieldXPaths);
+            while (parser->nextRow())
+            {
+                for (unsigned field=0; field < numFields; field++)
+                {
+                    size32_t sz;
+                    const char *value = parser->queryValue(field, sz);
+                    appendValue(actual, value, sz);
+                }
+                actual.newline();
+            }
+        }
+        CPPUNIT_ASSERT_EQUAL(std::string(expected.str()), std::string(actual.str()));
+    }
+
+public:
+    void testXPaths()
+    {
+        const char *simple[] = { "name", "@id", "address/city", "address/@zip" };
+        CPPUNIT_ASSERT(canStreamXmlFields("/Dataset/Row", 4, simple));
+        CPPUNIT_ASSERT(canStreamXmlFields("", 4, simple));
+        CPPUNIT_ASSERT(!canStreamXmlFields("/Dataset/Row[@id]", 4, simple));
+        CPPUNIT_ASSERT(!canStreamXmlFields("//Row", 4, simple));
+
+        const char *qualified[] = { "name[1]" };
+        const char *content[] = { "<>" };
+        const char *absolute[] = { "/Dataset/name" };
+        const char *attrParent[] = { "@id/name" };
+        CPPUNIT_ASSERT(!canStreamXmlFields("/Dataset/Row", 1, qualified));
+        CPPUNIT_ASSERT(!canStreamXmlFields("/Dataset/Row", 1, content));
+        CPPUNIT_ASSERT(!canStreamXmlFields("/Dataset/Row", 1, absolute));
+        CPPUNIT_ASSERT(!canStreamXmlFields("/Dataset/Row", 1, attrParent));
+    }
+
+    void testXml()
+    {
+        const char *xml =
+            "<Dataset>"
+            "<Row id='1'><name>Fred</name><address zip='123'><city>Boca</city></address></Row>"
+            "<Other><Row id='x'><name>skipped</name></Row></Other>"
+            "<Row id='2'><name></name><name>second</name><address><city>A</city></address><address zip='9'><city>B</city></address></Row>"
+            "<Row><extra><name>nested</name></extra></Row>"
+            "</Dataset>";
+        const char *fields[] = { "name", "@id", "address/city", "address/@zip", "name" };
+        checkParse(xml, "/Dataset/Row", 5, fields, false);
+        checkParse(xml, "Dataset/Other/Row", 5, fields, false);
+        checkParse(xml, "/Dataset/*", 5, fields, false);
+    }
+
+    void testJson()
+    {
+        const char *json =
+            "{\"Row\": ["
+            "{\"name\": \"Fred\", \"@id\": \"1\", \"address\": {\"city\": \"Boca\", \"@zip\": \"123\"}},"
+            "{\"name\": \"\", \"address\": [{\"city\": \"A\"}, {\"city\": \"B\"}]},"
+            "{\"extra\": {\"name\": \"nested\"}}"
+            "]}";
+        const char *fields[] = { "name", "@id", "address/city", "address/@zip" };
+        checkParse(json, "Row", 4, fields, true);
+
+        const char *rootArray = "[{\"name\": \"a\"}, {\"name\": \"b\"}]";
+        checkParse(rootArray, "", 1, fields, true);
+    }
+
+    //A field is matched within a later element if an earlier one with the same name does not contain it
+    void testRepeatedParent()
+    {
+        const char *xml = "<Row><address zip='1'/><address><city>B</city></address></Row>";
+        const char *fields[] = { "address/city", "address/@zip" };
+        checkParse(xml, "/Row", 2, fields, false);
+
+        const char *rowFields[] = { "address/city" };
+        Owned<IFileIO> io = createIFileI((unsigned)strlen(xml), xml);
+        Owned<IFileIOStream> stream = createIOStream(io);
+        Owned<IXmlFieldParse> parser = createXmlFieldParse(*stream, "/Row", 1, rowFields);
+        CPPUNIT_ASSERT(parser->nextRow());
+        size32_t sz;
+        const char *value = parser->queryValue(0, sz);
+        CPPUNIT_ASSERT(value);
+        CPPUNIT_ASSERT_EQUAL(std::string("B"), std::string(value, sz));
+        CPPUNIT_ASSERT(!parser->nextRow());
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( XmlFieldParseTests );
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( XmlFieldParseTests, "XmlFieldParseTests" );
+
+#endif
@@ -230,4 +230,19 @@ thorhelper_decl IXMLParse *createJSONParseString(const char *str, const char *xp
 thorhelper_decl size32_t createRowFromJson(ARowBuilder & rowBuilder, size32_t size, const char * utf8, IXmlToRowTransformer * xmlTransformer, bool stripWhitespace);
 thorhelper_decl const void * createRowFromJson(IEngineRowAllocator * rowAllocator, size32_t len, const char * utf8, IXmlToRowTransformer * xmlTransformer, bool stripWhitespace);
 
+/*
+ * Streaming extraction of the fields of each matching row, evaluated directly over the pull parser events
+ * without building a property tree for each row.  The row xpath may not contain qualifiers, and each field
+ * xpath must be a simple relative path (optionally ending in an attribute) - use canStreamXmlFields() to check.
+ * Values are returned with the same first-match semantics as IPropertyTree::queryProp().
+ */
+interface IXmlFieldParse : extends IInterface
+{
+    virtual bool nextRow() = 0; // returns false once the input is exhausted
+    virtual const char *queryValue(unsigned field, size32_t &sz) const = 0; // nullptr if the field was not present
+};
+thorhelper_decl bool canStreamXmlFields(const char *rowXPath, unsigned numFields, const char * const *fieldXPaths);
+thorhelper_decl IXmlFieldParse *createXmlFieldParse(ISimpleReadStream &stream, const char *rowXPath, unsigned numFields, const char * const *fieldXPaths, PTreeReaderOptions xmlOptions=ptr_none);
+thorhelper_decl IXmlFieldParse *createJsonFieldParse(ISimpleReadStream &stream, const char *rowXPath, unsigned numFields, const char * const *fieldXPaths, PTreeReaderOptions xmlOptions=ptr_none);
+
 #endif // THORXMLREAD_HPP
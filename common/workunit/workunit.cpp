@@ -16,7 +16,10 @@
 ############################################################################## */
 
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
+#include <atomic>
+#include <vector>
 
 #include "jlib.hpp"
 #include "jcontainerized.hpp"
@@ -194,6 +197,251 @@ CWuGraphStats::CWuGraphStats(StatisticCreatorType _creatorType, const char * _cr
     collector->beginScope(graphScopeId);
 }
 
+/*
+ * Incremental graph progress.
+ *
+ * Progress for a running subgraph is republished every few seconds, and most of the statistics do not change
+ * between updates.  Rather than replacing the complete compressed stats blob each time, a writer remembers the
+ * values it last published and appends a small compressed "Delta" containing only the changed statistics.
+ * Readers fold the deltas into the base collection lazily, and the writer compacts everything back into a
+ * single blob once too many deltas (or too much delta data) have accumulated.  The @seq attribute on the
+ * subgraph identifies the base blob, so a writer never appends to a base that it did not write itself.
+ */
+
+static constexpr byte graphStatsDeltaVersion = 1;
+static constexpr unsigned defaultGraphStatsMaxDeltas = 16;
+static constexpr unsigned maxPublishedGraphStats = 4096;
+
+struct PublishedStatValue
+{
+    std::string scope;
+    StatisticKind kind;
+    unsigned __int64 value;
+};
+typedef std::vector<PublishedStatValue> PublishedStatValues;
+
+class PublishedGraphStats
+{
+public:
+    StringAttr seq;
+    std::unordered_map<std::string, unsigned __int64> values;
+    unsigned numDeltas = 0;
+    size32_t baseSize = 0;
+    size32_t deltaSize = 0;
+};
+
+// An update that has been written to the progress tree, but is only recorded as published once it has been committed
+class PendingGraphStats
+{
+public:
+    bool full = false;
+    StringAttr seq;
+    PublishedStatValues values; // all values if full, otherwise only those that changed
+    size32_t size = 0;
+};
+
+//Keys are <wuid>/<graph>/sg<subgraph>/<creator>, entries are removed when the subgraph or graph completes
+static CriticalSection publishedGraphStatsCrit;
+static std::unordered_map<std::string, PublishedGraphStats> publishedGraphStats;
+static std::atomic<unsigned> graphStatsSeq{0};
+
+static void forgetPublishedGraphStats(const char * prefix)
+{
+    size_t prefixLen = strlen(prefix);
+    CriticalBlock block(publishedGraphStatsCrit);
+    for (auto it = publishedGraphStats.begin(); it != publishedGraphStats.end();)
+    {
+        if (0 == it->first.compare(0, prefixLen, prefix))
+            it = publishedGraphStats.erase(it);
+        else
+            ++it;
+    }
+}
+
+static unsigned queryGraphStatsMaxDeltas()
+{
+    static unsigned maxDeltas = (unsigned)getExpertOptInt64("graphStatsMaxDeltas", defaultGraphStatsMaxDeltas);
+    return maxDeltas;
+}
+
+static void makeStatKey(std::string & key, const char * scope, StatisticKind kind)
+{
+    key.assign(scope);
+    key.push_back('|');
+    key.append(std::to_string((unsigned)kind));
+}
+
+static void notePublishedGraphStats(const char * key, PendingGraphStats & pending)
+{
+    std::string statKey;
+    CriticalBlock block(publishedGraphStatsCrit);
+    if (pending.full)
+    {
+        //Entries are pruned as subgraphs and graphs complete, this only bounds writers that never report completion.
+        //Forgetting what was published only means the next update is written in full.
+        if (publishedGraphStats.size() >= maxPublishedGraphStats)
+            publishedGraphStats.clear();
+        PublishedGraphStats & published = publishedGraphStats[key];
+        published.seq.set(pending.seq);
+        published.values.clear();
+        published.numDeltas = 0;
+        published.baseSize = pending.size;
+        published.deltaSize = 0;
+        for (const PublishedStatValue & cur : pending.values)
+        {
+            makeStatKey(statKey, cur.scope.c_str(), cur.kind);
+            published.values[statKey] = cur.value;
+        }
+    }
+    else
+    {
+        auto match = publishedGraphStats.find(key);
+        if ((match == publishedGraphStats.end()) || !streq(match->second.seq, pending.seq))
+            return;
+        PublishedGraphStats & published = match->second;
+        for (const PublishedStatValue & cur : pending.values)
+        {
+            makeStatKey(statKey, cur.scope.c_str(), cur.kind);
+            published.values[statKey] = cur.value;
+        }
+        published.numDeltas++;
+        published.deltaSize += pending.size;
+    }
+}
+
+static void gatherStatValues(PublishedStatValues & values, IStatisticCollection & collection, StringBuffer & scope)
+{
+    unsigned numStats = collection.getNumStatistics();
+    for (unsigned i=0; i < numStats; i++)
+    {
+        StatisticKind kind;
+        unsigned __int64 value;
+        collection.getStatistic(kind, value, i);
+        values.push_back({ scope.str(), kind, value });
+    }
+
+    size32_t prevLength = scope.length();
+    Owned<IStatisticCollectionIterator> iter = &collection.getScopes(nullptr, false);
+    ForEach(*iter)
+    {
+        IStatisticCollection & cur = iter->query();
+        if (prevLength)
+            scope.append(':');
+        cur.getScope(scope);
+        gatherStatValues(values, cur, scope);
+        scope.setLength(prevLength);
+    }
+}
+
+static void applyStatsDelta(IStatisticCollection & target, MemoryBuffer & serialized)
+{
+    byte version;
+    unsigned numValues;
+    serialized.read(version);
+    if (version != graphStatsDeltaVersion)
+        return;
+    serialized.read(numValues);
+    for (unsigned i=0; i < numValues; i++)
+    {
+        const char * scope;
+        unsigned kind;
+        unsigned __int64 value;
+        serialized.read(scope).read(kind).read(value);
+        target.setStatistic(scope, (StatisticKind)kind, value);
+    }
+}
+
+// Returns the statistics for a subgraph progress entry, including any incremental updates, or null if there are none.
+static IStatisticCollection * loadSubGraphStats(IPropertyTree & subgraph)
+{
+    MemoryBuffer compressed;
+    MemoryBuffer serialized;
+    subgraph.getPropBin("Stats", compressed);
+    //Protect against updates that delete the stats while we are iterating
+    if (!compressed.length())
+        return nullptr;
+
+    decompressToBuffer(serialized, compressed);
+    Owned<IStatisticCollection> collection = createStatisticCollection(serialized);
+    Owned<IPropertyTreeIterator> deltas = subgraph.getElements("Delta");
+    ForEach(*deltas)
+    {
+        deltas->query().getPropBin(nullptr, compressed.clear());
+        if (compressed.length())
+        {
+            decompressToBuffer(serialized.clear(), compressed);
+            applyStatsDelta(*collection, serialized);
+        }
+    }
+    return collection.getClear();
+}
+
+bool CWuGraphStats::publishIncremental(IPropertyTree & progress, const char * tag, const char * key, IStatisticCollection & stats, PendingGraphStats & pending)
+{
+    unsigned maxDeltas = queryGraphStatsMaxDeltas();
+    if (!maxDeltas)
+        return false;
+
+    IPropertyTree * subgraph = progress.queryPropTree(tag);
+    const char * seq = subgraph ? subgraph->queryProp("@seq") : nullptr;
+    if (!seq)
+        return false;
+
+    PublishedStatValues current;
+    StringBuffer scope;
+    gatherStatValues(current, stats, scope);
+
+    CriticalBlock block(publishedGraphStatsCrit);
+    auto match = publishedGraphStats.find(key);
+    if (match == publishedGraphStats.end())
+        return false;
+    PublishedGraphStats & published = match->second;
+    //If someone else has replaced the subgraph stats since they were published, or there are enough deltas, rewrite it
+    if (!streq(published.seq, seq) || (published.numDeltas >= maxDeltas))
+        return false;
+
+    MemoryBuffer serialized;
+    unsigned numChanged = 0;
+    serialized.append(graphStatsDeltaVersion);
+    size32_t countPos = serialized.length();
+    serialized.append(numChanged);
+    std::string statKey;
+    for (const PublishedStatValue & cur : current)
+    {
+        makeStatKey(statKey, cur.scope.c_str(), cur.kind);
+        auto prev = published.values.find(statKey);
+        if ((prev == published.values.end()) || (prev->second != cur.value))
+        {
+            serialized.append(cur.scope.c_str()).append((unsigned)cur.kind).append(cur.value);
+            pending.values.push_back(cur);
+            numChanged++;
+        }
+    }
+    //Nothing has changed - no need to send anything
+    if (numChanged == 0)
+        return true;
+    serialized.writeDirect(countPos, sizeof(numChanged), &numChanged);
+
+    MemoryBuffer compressed;
+    compressToBuffer(compressed, serialized.length(), serialized.toByteArray());
+    //Once the deltas are a significant fraction of the complete stats, it is cheaper to compact them
+    if ((published.deltaSize + compressed.length()) * 2 > published.baseSize)
+        return false;
+
+    subgraph->addPropBin("Delta", compressed.length(), compressed.toByteArray());
+    unsigned minActivity = 0;
+    unsigned maxActivity = 0;
+    stats.getMinMaxActivity(minActivity, maxActivity);
+    if ((unsigned)subgraph->getPropInt("@minActivity") != minActivity)
+        subgraph->setPropInt("@minActivity", minActivity);
+    if ((unsigned)subgraph->getPropInt("@maxActivity") != maxActivity)
+        subgraph->setPropInt("@maxActivity", maxActivity);
+
+    pending.seq.set(seq);
+    pending.size = compressed.length();
+    return true;
+}
+
 void CWuGraphStats::beforeDispose()
 {
     collector->endScope();
@@ -201,20 +449,35 @@ void CWuGraphStats::beforeDispose()
     tag.append("sg").append(id);
 
     IPropertyTree &progress = queryProgressTree();
-    if (merge && progress.hasProp(tag))
+    if (merge)
     {
-        VStringBuffer statsPath("%s/Stats", tag.str());
-        MemoryBuffer compressed;
-        progress.getPropBin(statsPath, compressed);
-        if (compressed.length())
+        IPropertyTree * prev = progress.queryPropTree(tag);
+        if (prev)
         {
-            MemoryBuffer serialized;
-            decompressToBuffer(serialized, compressed);
-            Owned<IStatisticCollection> prevCollection = createStatisticCollection(serialized);
-            prevCollection->mergeInto(*collector);
+            Owned<IStatisticCollection> prevCollection = loadSubGraphStats(*prev);
+            if (prevCollection)
+                prevCollection->mergeInto(*collector);
         }
     }
     Owned<IStatisticCollection> stats = collector->getResult();
+
+    //Merged updates combine with the existing values, so they are always written in full
+    StringBuffer key;
+    if (!merge && getIncrementalKey(key))
+    {
+        key.append('/').append(tag).append('/').append(creator);
+        PendingGraphStats pending;
+        if (publishIncremental(progress, tag, key, *stats, pending))
+        {
+            if (pending.size)
+            {
+                commitProgress();
+                notePublishedGraphStats(key, pending);
+            }
+            return;
+        }
+    }
+
     MemoryBuffer compressed;
     {
         MemoryBuffer serialized;
@@ -235,6 +498,24 @@ void CWuGraphStats::beforeDispose()
     subgraph->setPropBin("Stats", compressed.length(), compressed.toByteArray());
     if (!progress.getPropBool("@stats", false))
         progress.setPropBool("@stats", true);
+
+    if (key.length())
+    {
+        VStringBuffer seq("%x.%x.%u", (unsigned)GetCurrentProcessId(), (unsigned)getTimeStampNowValue(), ++graphStatsSeq);
+        subgraph->setProp("@seq", seq);
+
+        PendingGraphStats pending;
+        pending.full = true;
+        pending.seq.set(seq);
+        pending.size = compressed.length();
+        StringBuffer scope;
+        gatherStatValues(pending.values, *stats, scope);
+
+        //Only record what was published once dali has it - if the commit fails the next update is written in full
+        forgetPublishedGraphStats(key);
+        commitProgress();
+        notePublishedGraphStats(key, pending);
+    }
 }
 
 IStatisticGatherer & CWuGraphStats::queryStatsBuilder()
@@ -345,22 +626,13 @@ protected:
 
     IPropertyTree * createProcessTreeFromStats(bool doFormat)
     {
-        MemoryBuffer compressed;
-        MemoryBuffer serialized;
         Owned<IPropertyTree> progressTree = createPTree();
         Owned<IPropertyTreeIterator> iter = progress->getElements("sg*");
         ForEach(*iter)
         {
-            IPropertyTree & curSubGraph = iter->query();
-            curSubGraph.getPropBin("Stats", compressed.clear());
-            //Protect against updates that delete the stats while we are iterating
-            if (compressed.length())
-            {
-                decompressToBuffer(serialized.clear(), compressed);
-                Owned<IStatisticCollection> collection = createStatisticCollection(serialized);
-
+            Owned<IStatisticCollection> collection = loadSubGraphStats(iter->query());
+            if (collection)
                 expandProcessTreeFromStats(progressTree, progressTree, collection, doFormat);
-            }
         }
         return progressTree.getClear();
     }
@@ -755,14 +1027,11 @@ protected:
         if (!checkSubGraph())
             return false;
 
-        curSubGraph.getPropBin("Stats", compressed.clear());
+        Owned<IStatisticCollection> collection = loadSubGraphStats(curSubGraph);
         //Don't crash on old format progress...
-        if (compressed.length() == 0)
+        if (!collection)
             return false;
 
-        decompressToBuffer(serialized.clear(), compressed);
-
-        Owned<IStatisticCollection> collection = createStatisticCollection(serialized);
         statsIterator.timeStamp = collection->queryWhenCreated();
         if (!beginCollection(*collection))
             return false;
@@ -1051,8 +1320,6 @@ private:
     Owned<IPropertyTreeIterator> subgraphIter;
     IArrayOf<IStatisticCollection> collections;
     IArrayOf<IStatisticCollectionIterator> childIterators; // Iterator(n) through collections(n) - created once iterating children
-    MemoryBuffer compressed;
-    MemoryBuffer serialized;
     bool valid;
 };
 
@@ -3795,6 +4062,8 @@ public:
     }
 protected:
     virtual IPropertyTree &queryProgressTree() override;
+    virtual bool getIncrementalKey(StringBuffer & key) const override;
+    virtual void commitProgress() override;
     const CDaliWorkUnit *owner;
     Owned<IRemoteConnection> conn;
     StringAttr graphName;
@@ -3979,6 +4248,7 @@ public:
 
     virtual void clearGraphProgress() const
     {
+        forgetPublishedGraphStats(VStringBuffer("%s/", queryWuid()));
         CriticalBlock block(crit);
         progressConnection.clear();  // Make sure nothing is locking for read or we won't be able to lock for write
         StringBuffer path("/GraphProgress/");
@@ -4076,6 +4346,8 @@ public:
     {
         Owned<IRemoteConnection> conn = getWritableProgressConnection(graphName, wfid);
         conn->queryRoot()->setPropInt("@_state", state);
+        if (WUGraphRunning != state)
+            forgetPublishedGraphStats(VStringBuffer("%s/%s/", queryWuid(), graphName));
     }
     virtual void setNodeState(const char *graphName, WUGraphIDType nodeId, WUGraphState state) const
     {
@@ -4108,6 +4380,8 @@ public:
                 break;
             }
         }
+        if (WUGraphRunning != state)
+            forgetPublishedGraphStats(VStringBuffer("%s/%s/sg%" I64F "u/", queryWuid(), graphName, (unsigned __int64)nodeId));
     }
     virtual IWUGraphStats *updateStats(const char *graphName, StatisticCreatorType creatorType, const char * creator, unsigned _wfid, unsigned subgraph, bool merge) const override
     {
@@ -4627,6 +4901,19 @@ IPropertyTree &CDaliWuGraphStats::queryProgressTree()
     return *conn->queryRoot();
 }
 
+void CDaliWuGraphStats::commitProgress()
+{
+    if (conn)
+        conn->commit();
+}
+
+bool CDaliWuGraphStats::getIncrementalKey(StringBuffer & key) const
+{
+    //Only the changes are committed to dali, so appending a delta avoids resending the complete stats
+    key.append(owner->queryWuid()).append('/').append(graphName);
+    return true;
+}
+
 class CLocalWUAssociated : implements IConstWUAssociatedFile, public CInterface
 {
     Owned<IPropertyTree> p;
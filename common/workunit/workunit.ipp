@@ -669,6 +669,11 @@ public:
     virtual IStatisticGatherer & queryStatsBuilder();
 protected:
     virtual IPropertyTree &queryProgressTree() = 0;
+    // Return true (and a key unique to the graph) if the store can accept incremental updates for the graph
+    virtual bool getIncrementalKey(StringBuffer & key) const { return false; }
+    bool publishIncremental(IPropertyTree & progress, const char * tag, const char * key, IStatisticCollection & stats, class PendingGraphStats & pending);
+    // Commit the progress tree, so that what was written is known to have been published
+    virtual void commitProgress() {}
     Owned<IStatisticGatherer> collector;
     StringAttr creator;
     StatisticCreatorType creatorType;
@@ -39,8 +39,10 @@
 #include "eclhelper.hpp"
 #include "seclib.hpp"
 #include "dameta.hpp"
+#include "jmetrics.hpp"
 
 #include <string>
+#include <list>
 #include <vector>
 #include <unordered_map>
 #include <algorithm>
@@ -1131,12 +1133,287 @@ interface IDistributedFileTransactionExt : extends IDistributedFileTransaction
     virtual ICodeContext *queryCodeContext()=0;
 };
 
+static auto pDfsMetaCacheHits = hpccMetrics::registerCounterMetric("dfs.metacache.hits", "The total number of DFS file meta data lookups satisfied from the client cache", SMeasureCount);
+static auto pDfsMetaCacheMisses = hpccMetrics::registerCounterMetric("dfs.metacache.misses", "The total number of DFS file meta data lookups that were not in the client cache", SMeasureCount);
+static auto pDfsMetaCacheStale = hpccMetrics::registerCounterMetric("dfs.metacache.stale", "The total number of client cache DFS file meta data entries invalidated by Dali change notifications", SMeasureCount);
+static auto pDfsMetaCachePermissionChecks = hpccMetrics::registerCounterMetric("dfs.metacache.permissionchecks", "The total number of Dali scope permission checks made for DFS file meta data client cache hits", SMeasureCount);
+
+#define DEFAULT_DFS_META_CACHE_ENTRIES 0 // disabled unless configured, each entry holds two Dali subscriptions
+#define DEFAULT_DFS_META_CACHE_MB 64
+#define DEFAULT_DFS_META_CACHE_PERMISSION_SECS 60 // how long a scope permission checked for a cache hit is reused
+
+/*
+ * Process wide cache of getFileTree results for files held in the local Dali.
+ * Each entry subscribes to the File and SuperFile branches of its logical name before the tree is fetched,
+ * any change notified by Dali to either branch drops the entry (or prevents it being added if the change
+ * raced with the fetch). Entries are held serialized, which bounds the memory used and means every hit
+ * returns a private copy. Bounded by entry count and total size, least recently used entries are evicted first.
+ * The scope permissions of the user are checked again for a hit (see getFileTree). The permission is cached per user and
+ * scope for a short time (dfsMetaCachePermissionSecs), so a revoked permission takes at most that long to take effect.
+ * Only these unaudited checks are cached, the audited checks made by lookup() always go to Dali.
+ * lookup() itself is not served from the cache. The IDistributedFile it returns holds a read lock on the file's branch
+ * through a live Dali connection, which stops the file being altered or deleted while it is in use, and its later
+ * locking and attribute updates go through that connection. A cached copy of the tree can provide neither.
+ */
+class CDfsMetaCache : implements ISDSSubscription, public CInterface
+{
+    class CEntry : public CInterface
+    {
+    public:
+        CEntry(const char *_key) : key(_key) { }
+
+        std::string key;
+        MemoryBuffer tree;
+        SubscriptionId fileSubId = 0;
+        SubscriptionId superSubId = 0;
+        std::list<CEntry *>::iterator lruPos;
+        bool cached = false;
+        bool stale = false;
+    };
+
+    CriticalSection crit;
+    std::unordered_map<std::string, Owned<CEntry>> entries;
+    std::unordered_map<SubscriptionId, Linked<CEntry>> subscriptions;
+    std::list<CEntry *> lru; // most recently used at front
+    std::vector<CEntry *> fetching;
+    std::vector<SubscriptionId> pendingUnsubscribes;
+    std::unordered_map<std::string, std::pair<SecAccessFlags, unsigned>> permissions; // by user|scope, permission and when it was checked
+    unsigned maxEntries;
+    memsize_t maxSize;
+    memsize_t totalSize = 0;
+    unsigned permissionTimeoutMs;
+
+    void unlinkEntry(CEntry &entry)
+    {
+        // called in critical section
+        if (entry.cached)
+        {
+            lru.erase(entry.lruPos);
+            totalSize -= entry.tree.length();
+            entry.cached = false;
+        }
+        for (SubscriptionId id : { entry.fileSubId, entry.superSubId })
+        {
+            if (id)
+            {
+                subscriptions.erase(id);
+                pendingUnsubscribes.push_back(id);
+            }
+        }
+        entry.fileSubId = 0;
+        entry.superSubId = 0;
+        auto it = entries.find(entry.key);
+        if ((it != entries.end()) && (it->second.get() == &entry)) // NB: a later fetch of the same key may have replaced it
+            entries.erase(it); // NB: may release entry
+    }
+    void flushUnsubscribes()
+    {
+        // unsubscribing is a Dali round trip and must not happen within notify, so is deferred to here
+        std::vector<SubscriptionId> ids;
+        {
+            CriticalBlock block(crit);
+            if (pendingUnsubscribes.empty())
+                return;
+            ids.swap(pendingUnsubscribes);
+        }
+        for (SubscriptionId id : ids)
+        {
+            try
+            {
+                querySDS().unsubscribe(id);
+            }
+            catch (IException *e)
+            {
+                EXCLOG(e, "CDfsMetaCache: unsubscribe");
+                e->Release();
+            }
+        }
+    }
+public:
+    IMPLEMENT_IINTERFACE_USING(CInterface);
+
+    CDfsMetaCache(unsigned _maxEntries, memsize_t _maxSize, unsigned _permissionTimeoutMs)
+        : maxEntries(_maxEntries), maxSize(_maxSize), permissionTimeoutMs(_permissionTimeoutMs)
+    {
+    }
+    ~CDfsMetaCache()
+    {
+        {
+            CriticalBlock block(crit);
+            for (auto &it : subscriptions)
+                pendingUnsubscribes.push_back(it.first);
+            subscriptions.clear();
+            lru.clear();
+            entries.clear();
+        }
+        flushUnsubscribes();
+    }
+    IPropertyTree *lookup(const char *key)
+    {
+        flushUnsubscribes();
+        CriticalBlock block(crit);
+        auto it = entries.find(key);
+        if ((it == entries.end()) || !it->second->cached)
+        {
+            pDfsMetaCacheMisses->inc(1);
+            return nullptr;
+        }
+        CEntry &entry = *it->second;
+        lru.splice(lru.begin(), lru, entry.lruPos);
+        pDfsMetaCacheHits->inc(1);
+        MemoryBuffer mb;
+        mb.setBuffer(entry.tree.length(), (void *)entry.tree.toByteArray(), false);
+        return createPTree(mb);
+    }
+    void *beginFetch(const char *key, CDfsLogicalFileName &dlfn)
+    {
+        // Subscribe before the tree is fetched, so that a change that races with the fetch is not missed
+        StringBuffer fileQuery, superQuery;
+        dlfn.makeFullnameQuery(fileQuery, DXB_File);
+        dlfn.makeFullnameQuery(superQuery, DXB_SuperFile);
+        Owned<CEntry> entry = new CEntry(key);
+        {
+            CriticalBlock block(crit);
+            if (entries.find(key) != entries.end())
+                return nullptr; // another thread is fetching the same tree, let it populate the cache
+            entries[entry->key].set(entry);
+            fetching.push_back(entry);
+        }
+        try
+        {
+            entry->fileSubId = querySDS().subscribe(fileQuery, *this, true);
+            entry->superSubId = querySDS().subscribe(superQuery, *this, true);
+        }
+        catch (IException *e)
+        {
+            EXCLOG(e, "CDfsMetaCache: subscribe");
+            e->Release();
+            CriticalBlock block(crit);
+            entry->stale = true; // NB: any subscription made is removed in endFetch
+        }
+        CriticalBlock block(crit);
+        if (entry->fileSubId)
+            subscriptions[entry->fileSubId].set(entry);
+        if (entry->superSubId)
+            subscriptions[entry->superSubId].set(entry);
+        return entry.getClear();
+    }
+    void endFetch(void *handle, IPropertyTree *tree)
+    {
+        Owned<CEntry> entry = (CEntry *)handle;
+        {
+            CriticalBlock block(crit);
+            fetching.erase(std::find(fetching.begin(), fetching.end(), entry.get()));
+            if (!entry->stale && tree && entry->fileSubId && entry->superSubId)
+            {
+                tree->serialize(entry->tree);
+                if (entry->tree.length() <= maxSize)
+                {
+                    lru.push_front(entry.get());
+                    entry->lruPos = lru.begin();
+                    entry->cached = true;
+                    totalSize += entry->tree.length();
+                    // in-flight fetches are in entries but not in lru, so only cached entries are counted.
+                    // The new entry is at the front, so it is never the one evicted.
+                    while ((lru.size() > 1) && ((lru.size() > maxEntries) || (totalSize > maxSize)))
+                        unlinkEntry(*lru.back());
+                }
+            }
+            if (!entry->cached)
+            {
+                if (entry->stale)
+                    pDfsMetaCacheStale->inc(1);
+                unlinkEntry(*entry);
+            }
+        }
+        flushUnsubscribes();
+    }
+    bool lookupPermission(const char *key, SecAccessFlags &perms)
+    {
+        CriticalBlock block(crit);
+        auto it = permissions.find(key);
+        if (it == permissions.end())
+            return false;
+        if (msTick()-it->second.second >= permissionTimeoutMs)
+        {
+            permissions.erase(it);
+            return false;
+        }
+        perms = it->second.first;
+        return true;
+    }
+    void addPermission(const char *key, SecAccessFlags perms)
+    {
+        CriticalBlock block(crit);
+        if (permissions.size() >= maxEntries)
+        {
+            unsigned now = msTick();
+            for (auto it = permissions.begin(); it != permissions.end();)
+            {
+                if (now-it->second.second >= permissionTimeoutMs)
+                    it = permissions.erase(it);
+                else
+                    ++it;
+            }
+            if (permissions.size() >= maxEntries)
+                permissions.clear();
+        }
+        permissions[key] = { perms, msTick() };
+    }
+    void discard(const char *key)
+    {
+        {
+            CriticalBlock block(crit);
+            auto it = entries.find(key);
+            if ((it == entries.end()) || !it->second->cached)
+                return;
+            unlinkEntry(*it->second);
+        }
+        flushUnsubscribes();
+    }
+    void clear()
+    {
+        {
+            CriticalBlock block(crit);
+            while (!lru.empty())
+                unlinkEntry(*lru.back());
+        }
+        flushUnsubscribes();
+    }
+// ISDSSubscription
+    virtual void notify(SubscriptionId id, const char *xpath, SDSNotifyFlags flags, unsigned valueLen, const void *valueData) override
+    {
+        CriticalBlock block(crit);
+        auto it = subscriptions.find(id);
+        if (it == subscriptions.end())
+        {
+            // May be for a subscription whose id has not yet been recorded by beginFetch, so conservatively
+            // discard whatever is being fetched. Late notifications for removed entries also end up here.
+            for (CEntry *entry : fetching)
+                entry->stale = true;
+            return;
+        }
+        Linked<CEntry> entry = it->second.get();
+        if (entry->stale)
+            return;
+        entry->stale = true;
+        if (entry->cached)
+        {
+            pDfsMetaCacheStale->inc(1);
+            unlinkEntry(*entry);
+        }
+        // else fetch in progress, endFetch will discard the result
+    }
+};
+
 class CDistributedFileDirectory: implements IDistributedFileDirectory, public CInterface
 {
     Owned<IUserDescriptor> defaultudesc;
     Owned<IDFSredirection> redirection;
+    Owned<CDfsMetaCache> metaCache;
 
     void resolveForeignFiles(IPropertyTree *tree,const INode *foreigndali);
+    IPropertyTree *doGetFileTree(const char *lname,IUserDescriptor *user,const INode *foreigndali,unsigned foreigndalitimeout,GetFileTreeOpts opts);
 
 protected: friend class CDistributedFile;
     StringAttr defprefclusters;
@@ -1151,6 +1428,19 @@ public:
         defaultTimeout = INFINITE;
         defaultudesc.setown(createUserDescriptor());
         redirection.setown(createDFSredirection());
+        unsigned metaCacheEntries = (unsigned)getExpertOptInt64("dfsMetaCacheEntries", DEFAULT_DFS_META_CACHE_ENTRIES);
+        memsize_t metaCacheMB = (memsize_t)getExpertOptInt64("dfsMetaCacheMB", DEFAULT_DFS_META_CACHE_MB);
+        unsigned metaCachePermissionSecs = (unsigned)getExpertOptInt64("dfsMetaCachePermissionSecs", DEFAULT_DFS_META_CACHE_PERMISSION_SECS);
+        if (metaCacheEntries && metaCacheMB)
+            metaCache.setown(new CDfsMetaCache(metaCacheEntries, metaCacheMB*0x100000, metaCachePermissionSecs*1000));
+    }
+    void setMetaCacheLimits(unsigned maxEntries, memsize_t maxSize)
+    {
+        // NB: not thread safe, only used by the unit tests
+        if (maxEntries && maxSize)
+            metaCache.setown(new CDfsMetaCache(maxEntries, maxSize, DEFAULT_DFS_META_CACHE_PERMISSION_SECS*1000));
+        else
+            metaCache.clear();
     }
     unsigned queryDefaultTimeout() const { return defaultTimeout; }
 
@@ -11678,6 +11968,60 @@ void CDistributedFileDirectory::setFileProtect(CDfsLogicalFileName &dlfn,IUserDe
 }
 
 IPropertyTree *CDistributedFileDirectory::getFileTree(const char *lname, IUserDescriptor *user, const INode *foreigndali,unsigned foreigndalitimeout, GetFileTreeOpts opts)
+{
+    // Only plain logical files in the local Dali are cached, redirected names cannot be tracked by subscription
+    if (!metaCache || !isLocalDali(foreigndali) || redirection->numEntries())
+        return doGetFileTree(lname, user, foreigndali, foreigndalitimeout, opts);
+    CDfsLogicalFileName dlfn;
+    dlfn.set(lname);
+    if (dlfn.isForeign() || dlfn.isExternal() || dlfn.isMulti() || dlfn.isQuery())
+        return doGetFileTree(lname, user, foreigndali, foreigndalitimeout, opts);
+
+    // Permissions are checked by Dali, so the user is part of the key
+    StringBuffer key(dlfn.get());
+    key.append('@');
+    dlfn.getCluster(key);
+    key.append('|').append(static_cast<unsigned>(opts)).append('|');
+    if (user)
+        user->getUserName(key);
+    Owned<IPropertyTree> ret = metaCache->lookup(key);
+    if (ret)
+    {
+        // The cached tree was fetched with this user's permissions at the time, which may since have been revoked
+        StringBuffer scopes, permKey;
+        dlfn.getScopes(scopes);
+        if (user)
+            user->getUserName(permKey);
+        permKey.append('|').append(scopes);
+        SecAccessFlags perms;
+        if (!metaCache->lookupPermission(permKey, perms))
+        {
+            pDfsMetaCachePermissionChecks->inc(1);
+            perms = getScopePermissions(scopes, user, 0);
+            metaCache->addPermission(permKey, perms);
+        }
+        if (HASREADPERMISSION(perms))
+            return ret.getClear();
+        metaCache->discard(key); // let Dali report the failure
+        return doGetFileTree(lname, user, foreigndali, foreigndalitimeout, opts);
+    }
+    void *handle = metaCache->beginFetch(key, dlfn);
+    if (!handle)
+        return doGetFileTree(lname, user, foreigndali, foreigndalitimeout, opts);
+    try
+    {
+        ret.setown(doGetFileTree(lname, user, foreigndali, foreigndalitimeout, opts));
+    }
+    catch (IException *)
+    {
+        metaCache->endFetch(handle, nullptr);
+        throw;
+    }
+    metaCache->endFetch(handle, ret);
+    return ret.getClear();
+}
+
+IPropertyTree *CDistributedFileDirectory::doGetFileTree(const char *lname, IUserDescriptor *user, const INode *foreigndali,unsigned foreigndalitimeout, GetFileTreeOpts opts)
 {
     constexpr unsigned gftVersion = 2; // for future use (0 and 1 are reserved for legacy versions)
     bool expandnodes = hasMask(opts, GetFileTreeOpts::expandNodes);
@@ -13846,6 +14190,24 @@ void configurePreferredPlanes()
  * external use for logical-files only is this test-suite, so I'd rather hack the test
  * suite than expose the behaviour to more viewers.
  */
+extern da_decl void setDfsMetaCacheLimits(unsigned maxEntries, memsize_t maxSize)
+{
+    queryDistributedFileDirectory();
+    DFdir->setMetaCacheLimits(maxEntries, maxSize);
+}
+
+extern da_decl void getDfsMetaCacheCounts(__uint64 &hits, __uint64 &misses, __uint64 &stale)
+{
+    hits = pDfsMetaCacheHits->queryValue();
+    misses = pDfsMetaCacheMisses->queryValue();
+    stale = pDfsMetaCacheStale->queryValue();
+}
+
+extern da_decl __uint64 getDfsMetaCachePermissionChecks()
+{
+    return pDfsMetaCachePermissionChecks->queryValue();
+}
+
 extern da_decl void removeLogical(const char *fname, IUserDescriptor *user) {
     if (queryDistributedFileDirectory().exists(fname, user)) {
         Owned<IDistributedFile> file = queryDistributedFileDirectory().lookup(fname, user, AccessMode::tbdWrite, false, false, nullptr, defaultPrivilegedUser);
@@ -128,6 +128,9 @@ public:
                 else if (0 == stricmp(id, "connections")) { // Legacy - newer diag clients should use querySDS().getConnections() directly
                     mb.append(querySDS().getConnections(buf).str());
                 }
+                else if (0 == stricmp(id, "sdscontention")) {
+                    mb.append(querySDSServer().getContentionStats(buf).str());
+                }
                 else if (0 == stricmp(id, "sdssubscribers")) { // Legacy - newer diag clients should use querySDS().getSubscribers() directly
                     mb.append(querySDS().getSubscribers(buf).str());
                 }
@@ -15,14 +15,18 @@
     limitations under the License.
 ############################################################################## */
 
+#include <functional>
 #include <queue>
 #include <list>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "platform.h"
 #include "jhash.hpp"
 #include "jlib.hpp"
 #include "jfile.hpp"
+#include "jcrc.hpp"
 #include "jregexp.hpp"
 #include "jthread.hpp"
 #include "javahash.hpp"
@@ -88,6 +92,11 @@ static auto pSdsRequestsReceived = hpccMetrics::registerCounterMetric("dali.sds.
 static auto pSdsRequestsStarted = hpccMetrics::registerCounterMetric("dali.sds.requests.started", "The total number of Dali SDS requests started", SMeasureCount);
 static auto pSdsRequestsCompleted = hpccMetrics::registerCounterMetric("dali.sds.requests.completed", "The total number of Dali SDS requests completed", SMeasureCount);
 static auto pSdsRequestsPending = hpccMetrics::registerGaugeFromCountersMetric("dali.sds.requests.pending", "Current number of pending SDS requests", SMeasureCount, pSdsRequestsReceived, pSdsRequestsStarted);
+static auto pSdsDeltaCommitLatency = hpccMetrics::registerCyclesToNsScaledHistogramMetric("dali.sds.delta.commit.latency", "Time from a transaction being queued to its delta being written",
+    { 100000, 1000000, 5000000, 10000000, 50000000, 100000000, 500000000, 1000000000, 5000000000, 10000000000 }); // 100us .. 10s
+static auto pSdsDeltaCommitBatchSize = hpccMetrics::registerHistogramMetric("dali.sds.delta.commit.batchsize", "Number of transactions written by each delta commit", SMeasureCount,
+    { 1, 2, 5, 10, 50, 100, 500, 1000, 5000, 10000 });
+static auto pSdsDeltaThrottled = hpccMetrics::registerCounterMetric("dali.sds.delta.throttled", "The total number of transactions that waited for the delta writer because of the queue limits", SMeasureCount);
 
 // #define TEST_NOTIFY_HANDLER
 
@@ -307,6 +316,197 @@ void CLCLockBlock::changeToWrite(const char *msg)
 #define CHECKEDDALIWRITELOCKBLOCK(l,timeout)  WriteLockBlock glue(block,__LINE__)(l)
 #endif
 
+// Records how often a critical section was entered and how often, and for how long, callers had to wait for it
+struct CCritContentionStats
+{
+    RelaxedAtomic<unsigned __int64> acquired{0};
+    RelaxedAtomic<unsigned __int64> contended{0};
+    RelaxedAtomic<cycle_t> waitCycles{0};
+    RelaxedAtomic<cycle_t> maxWaitCycles{0};
+
+    void enter(CheckedCriticalSection &crit, const char *fname, unsigned lnum)
+    {
+        ++acquired;
+#ifdef USECHECKEDCRITICALSECTIONS
+        if (crit.lockWait(0))
+            return;
+        ++contended;
+        cycle_t start = get_cycles_now();
+        checkedCritEnter(crit, fakeCritTimeout, fname, lnum);
+        cycle_t waited = get_cycles_now() - start;
+        waitCycles.fetch_add(waited);
+        maxWaitCycles.store_max(waited);
+#else
+        crit.enter();
+#endif
+    }
+    void merge(const CCritContentionStats &other)
+    {
+        acquired.fetch_add(other.acquired);
+        contended.fetch_add(other.contended);
+        waitCycles.fetch_add(other.waitCycles);
+        maxWaitCycles.store_max(other.maxWaitCycles);
+    }
+    StringBuffer &toString(StringBuffer &out) const
+    {
+        return out.appendf("acquired=%" I64F "u, contended=%" I64F "u, waitMs=%" I64F "u, maxWaitMs=%" I64F "u",
+            acquired.load(), contended.load(), cycle_to_millisec(waitCycles), cycle_to_millisec(maxWaitCycles));
+    }
+};
+
+class CContendedCriticalBlock
+{
+    CheckedCriticalSection &crit;
+public:
+    CContendedCriticalBlock(CheckedCriticalSection &_crit, CCritContentionStats &stats, const char *fname, unsigned lnum) : crit(_crit)
+    {
+        stats.enter(crit, fname, lnum);
+    }
+    ~CContendedCriticalBlock()
+    {
+        CHECKEDCRITLEAVE(crit);
+    }
+};
+#define CONTENDEDCRITICALBLOCK(sect, stats) CContendedCriticalBlock glue(block,__LINE__)(sect, stats, __FILE__, __LINE__)
+
+/* Connection establishment is serialized per top-level branch of the store.
+ * Two xpaths that start with different top-level element names can never resolve to the same nodes,
+ * so e.g. connects to /WorkUnits and /Files do not need to wait for each other.
+ * xpaths that are not rooted in a single, plain, top-level name (the root itself, wildcards, qualifiers or '//')
+ * take every stripe, always in ascending order so that they cannot deadlock with each other.
+ */
+#define SDS_CONNECT_STRIPES 32
+class CConnectStripes
+{
+    CheckedCriticalSection crits[SDS_CONNECT_STRIPES];
+    CCritContentionStats stats[SDS_CONNECT_STRIPES];
+public:
+    static bool getStripe(const char *xpath, unsigned &stripe)
+    {
+        while ('/' == *xpath)
+        {
+            if ('/' == *(xpath+1)) // '//'
+                return false;
+            xpath++;
+        }
+        const char *end = xpath;
+        while (*end && '/' != *end)
+        {
+            if (strchr("*?[@.", *end))
+                return false;
+            end++;
+        }
+        if (end == xpath)
+            return false;
+        stripe = hashnc((const byte *)xpath, end-xpath, 0) % SDS_CONNECT_STRIPES;
+        return true;
+    }
+    void enter(unsigned stripe, const char *fname, unsigned lnum)
+    {
+        stats[stripe].enter(crits[stripe], fname, lnum);
+    }
+    void leave(unsigned stripe)
+    {
+        CHECKEDCRITLEAVE(crits[stripe]);
+    }
+    StringBuffer &getStats(StringBuffer &out) const
+    {
+        CCritContentionStats total;
+        for (unsigned s=0; s<SDS_CONNECT_STRIPES; s++)
+            total.merge(stats[s]);
+        total.toString(out.append("connect (all stripes): ")).newline();
+        for (unsigned s=0; s<SDS_CONNECT_STRIPES; s++)
+        {
+            if (stats[s].contended)
+                stats[s].toString(out.appendf("  connect stripe %u: ", s)).newline();
+        }
+        return out;
+    }
+};
+
+class CConnectCritBlock : public CInterface
+{
+    CConnectStripes &stripes;
+    unsigned first, last; // inclusive
+    const char *fname;
+    unsigned lnum;
+public:
+    CConnectCritBlock(CConnectStripes &_stripes, const char *xpath, const char *_fname, unsigned _lnum) : stripes(_stripes), fname(_fname), lnum(_lnum)
+    {
+        unsigned stripe;
+        if (CConnectStripes::getStripe(xpath, stripe))
+            first = last = stripe;
+        else
+        {
+            first = 0;
+            last = SDS_CONNECT_STRIPES-1;
+        }
+        enter();
+    }
+    ~CConnectCritBlock()
+    {
+        leave();
+    }
+    void enter()
+    {
+        for (unsigned s=first; s<=last; s++)
+            stripes.enter(s, fname, lnum);
+    }
+    void leave()
+    {
+        unsigned s = last+1;
+        while (s-- > first)
+            stripes.leave(s);
+    }
+};
+
+/* The server connection table is split into stripes by connection id, so that the per-request connection
+ * lookups do not all serialize on a single critical section. No code path holds more than one stripe at a time.
+ */
+#define SDS_CONNECTION_TABLE_STRIPES 64
+class CStripedConnectionTable
+{
+public:
+    struct Stripe
+    {
+        CheckedCriticalSection crit;
+        CConnectionHashTable table;
+        CCritContentionStats stats;
+    };
+private:
+    Stripe stripes[SDS_CONNECTION_TABLE_STRIPES];
+public:
+    inline Stripe &queryStripe(ConnectionId id)
+    {
+        return stripes[hashc((const byte *)&id, sizeof(id), 0) % SDS_CONNECTION_TABLE_STRIPES];
+    }
+    inline Stripe &queryStripeN(unsigned n) { return stripes[n]; }
+    inline unsigned numStripes() const { return SDS_CONNECTION_TABLE_STRIPES; }
+    void kill()
+    {
+        for (unsigned s=0; s<SDS_CONNECTION_TABLE_STRIPES; s++)
+            stripes[s].table.kill();
+    }
+    unsigned count()
+    {
+        unsigned total = 0;
+        for (unsigned s=0; s<SDS_CONNECTION_TABLE_STRIPES; s++)
+        {
+            CONTENDEDCRITICALBLOCK(stripes[s].crit, stripes[s].stats);
+            total += stripes[s].table.count();
+        }
+        return total;
+    }
+    StringBuffer &getStats(StringBuffer &out) const
+    {
+        CCritContentionStats total;
+        for (unsigned s=0; s<SDS_CONNECTION_TABLE_STRIPES; s++)
+            total.merge(stripes[s].stats);
+        return total.toString(out.append("connection table (all stripes): ")).newline();
+    }
+};
+#define STRIPECRITICALBLOCK(stripe) CONTENDEDCRITICALBLOCK((stripe).crit, (stripe).stats)
+
 #define OVERFLOWSIZE 50000
 class CFitArray
 {
@@ -412,8 +612,17 @@ StringBuffer &constructStoreName(const char *storeBase, unsigned e, StringBuffer
     return res;
 }
 
+StringBuffer &constructBinaryStoreName(const char *storeBase, unsigned e, StringBuffer &res)
+{
+    res.append(storeBase);
+    if (e)
+        res.append(e);
+    res.append(".bin");
+    return res;
+}
+
 ////////////////
-static CheckedCriticalSection loadStoreCrit, saveStoreCrit, saveIncCrit, nfyTableCrit, extCrit, blockedSaveCrit;
+static CheckedCriticalSection loadStoreCrit, saveStoreCrit, saveIncCrit, extCrit, blockedSaveCrit;
 class CCovenSDSManager;
 static CCovenSDSManager *SDSManager;
 
@@ -977,7 +1186,7 @@ bool filesMatch(IFile *file1, IFile *file2, bool compareTimes=true)
     return false;
 }
 
-void writeDelta(StringBuffer &xml, IFile &iFile, const char *msg="", unsigned retrySecs=0, unsigned retryAttempts=10)
+void writeDelta(StringBuffer &xml, IFile &iFile, const char *msg="", unsigned retrySecs=0, unsigned retryAttempts=10, bool sync=false)
 {
     Owned<IException> exception;
     OwnedIFileIO iFileIO;
@@ -992,7 +1201,7 @@ void writeDelta(StringBuffer &xml, IFile &iFile, const char *msg="", unsigned re
         header.append(deltaHeader);
         try
         {
-            iFileIO.setown(iFile.open(IFOreadwrite));
+            iFileIO.setown(iFile.open(IFOreadwrite, sync ? IFEsync : IFEnone));
             stream.setown(createIOStream(iFileIO));
             if (lastGood)
             {
@@ -1014,6 +1223,8 @@ void writeDelta(StringBuffer &xml, IFile &iFile, const char *msg="", unsigned re
             stream->write(xml.length(), xml.str());
             stream->flush();
             stream.clear();
+            if (sync) // data must be durable before the header that commits it
+                iFileIO->flush();
             offset_t fLen = lastGood + xml.length();
             unsigned crc = crc32(xml.str(), xml.length(), startCrc);
             char *headerPtr = (char *)header.bufferBase();
@@ -1022,6 +1233,8 @@ void writeDelta(StringBuffer &xml, IFile &iFile, const char *msg="", unsigned re
             sprintf(strNum, "%016" I64F "X", fLen);
             memcpy(headerPtr + deltaHeaderSizeOff, strNum, 16);
             iFileIO->write(0, strlen(deltaHeader), headerPtr);
+            if (sync)
+                iFileIO->flush();
         }
         catch (IException *e)
         {
@@ -1063,6 +1276,7 @@ class CTransactionItem : public CSimpleInterface
 public:
     enum flagt : byte { f_none, f_delta, f_addext, f_delext } type = f_none;
     char *name;
+    cycle_t queuedCycles = 0;
     union
     {
         IPropertyTree *deltaTree;
@@ -1136,6 +1350,14 @@ class CDeltaWriter : implements IThreaded
     std::atomic<bool> aborted = false;
     bool signalWhenAllWritten = false;
     Semaphore allWrittenSem;
+    // group commit - throttled callers wait for the writer thread to write the batch containing their transaction,
+    // instead of writing the whole queue themselves whilst holding pendingCrit
+    bool groupCommit = false;
+    bool syncCommits = false;           // fsync each delta commit
+    unsigned __int64 queuedSeq = 0;     // sequence of last transaction queued
+    unsigned __int64 writtenSeq = 0;    // sequence of last transaction written
+    unsigned groupCommitWaiters = 0;
+    Semaphore groupCommitSem;
 
     void validateDeltaBackup()
     {
@@ -1159,7 +1381,7 @@ class CDeltaWriter : implements IThreaded
             StringBuffer deltaFilename(dataPath);
             iStoreHelper->getCurrentDeltaFilename(deltaFilename);
             OwnedIFile iFile = createIFile(deltaFilename.str());
-            writeDelta(deltaXml, *iFile);
+            writeDelta(deltaXml, *iFile, "", 0, 10, syncCommits);
         }
         catch (IException *e)
         {
@@ -1186,7 +1408,7 @@ class CDeltaWriter : implements IThreaded
                     StringBuffer deltaFilename(backupPath);
                     constructStoreName(DELTANAME, iStoreHelper->queryCurrentEdition(), deltaFilename);
                     OwnedIFile iFile = createIFile(deltaFilename.str());
-                    ::writeDelta(deltaXml, *iFile, "backup - ", 60, 30);
+                    ::writeDelta(deltaXml, *iFile, "backup - ", 60, 30, syncCommits);
                 }
             }
             catch (IException *e)
@@ -1314,9 +1536,12 @@ class CDeltaWriter : implements IThreaded
         }
 
         std::vector<std::string> pendingExtDeletes;
+        std::vector<cycle_t> queuedTimes;
+        queuedTimes.reserve(todo.size());
         while (!todo.empty())
         {
             CTransactionItem *item = todo.front();
+            queuedTimes.push_back(item->queuedCycles);
             if (CTransactionItem::f_delta == item->type)
             {
                 Owned<IPropertyTree> changeTree = item->deltaTree;
@@ -1324,9 +1549,18 @@ class CDeltaWriter : implements IThreaded
                 cleanChangeTree(*changeTree);
 
                 // write out with header details (i.e. path)
-                deltaXml.appendf("<Header path=\"%s\">\n  <Delta>\n", item->name);
-                toXML(changeTree, deltaXml, 4);
-                deltaXml.append("  </Delta>\n</Header>");
+                if (groupCommit) // compact, unformatted
+                {
+                    deltaXml.appendf("<Header path=\"%s\"><Delta>", item->name);
+                    toXML(changeTree, deltaXml, 0, 0);
+                    deltaXml.append("</Delta></Header>");
+                }
+                else
+                {
+                    deltaXml.appendf("<Header path=\"%s\">\n  <Delta>\n", item->name);
+                    toXML(changeTree, deltaXml, 4);
+                    deltaXml.append("  </Delta>\n</Header>");
+                }
             }
             else
             {
@@ -1362,10 +1596,27 @@ class CDeltaWriter : implements IThreaded
             if (backupPath.length())
                 deleteExt(backupPath, ext.c_str(), 60, 30);
         }
+        cycle_t now = get_cycles_now();
         if (thresholdDuration)
-            lastSaveTime = get_cycles_now();
+            lastSaveTime = now;
+        if (queuedTimes.size())
+        {
+            pSdsDeltaCommitBatchSize->recordMeasurement(queuedTimes.size());
+            for (cycle_t queued : queuedTimes)
+                pSdsDeltaCommitLatency->recordMeasurement(now - queued);
+        }
         return true;
     }
+    void markWritten(unsigned __int64 seq)
+    {
+        // must be called whilst pendingCrit is held
+        writtenSeq = seq;
+        if (groupCommitWaiters)
+        {
+            groupCommitSem.signal(groupCommitWaiters);
+            groupCommitWaiters = 0;
+        }
+    }
     void requestAsyncWrite()
     {
         // must be called whilst pendingCrit is held + writeRequested == false
@@ -1391,6 +1642,8 @@ public:
         transactionQueueLimit = config.getPropInt("@deltaTransactionQueueLimit", defaultDeltaTransactionQueueLimit);
         unsigned deltaTransactionMaxMemMB = config.getPropInt("@deltaTransactionMaxMemMB", defaultDeltaMemMaxMB);
         transactionMaxMem = (memsize_t)deltaTransactionMaxMemMB * 0x100000;
+        groupCommit = config.getPropBool("@deltaGroupCommit", false);
+        syncCommits = config.getPropBool("@deltaSyncCommits", false);
         if (saveThresholdSecs)
         {
             thresholdDuration = queryOneSecCycles() * saveThresholdSecs;
@@ -1407,12 +1660,16 @@ public:
             msg.append("<DISABLED>");
         else
             msg.append(transactionQueueLimit);
+        msg.appendf(", deltaGroupCommit=%s, deltaSyncCommits=%s", boolToStr(groupCommit), boolToStr(syncCommits));
         PROGLOG("%s", msg.str());
 
         if ((transactionQueueLimit > 1) && (transactionMaxMem > 0))
             threaded.init(this, false);
         else
+        {
+            groupCommit = false; // needs the writer thread
             PROGLOG("All transactions will be committed synchronously");
+        }
     }
     void addDelta(char *path, IPropertyTree *delta)
     {
@@ -1467,6 +1724,12 @@ public:
             pendingTransactionsSem.signal();
             allWrittenSem.signal();
             threaded.join();
+            CriticalBlock b(pendingCrit);
+            if (groupCommitWaiters) // release any waiters, what remains pending is handled by the final store save
+            {
+                groupCommitSem.signal(groupCommitWaiters);
+                groupCommitWaiters = 0;
+            }
         }
     }
 // IThreaded
@@ -1487,6 +1750,7 @@ public:
             {
                 CLeavableCriticalBlock b(pendingCrit);
                 std::queue<Owned<CTransactionItem>> todo = std::move(pending);
+                unsigned __int64 batchSeq = queuedSeq;
                 if (0 == todo.size())
                 {
                     if (writeRequested)
@@ -1513,6 +1777,11 @@ public:
                 b.leave();
                 while (!save(todo)) // if temporarily blocked, wait a bit (blocking window is short)
                     MilliSleep(1000);
+                if (groupCommit)
+                {
+                    CriticalBlock b2(pendingCrit);
+                    markWritten(batchSeq);
+                }
             }
         }
     }
@@ -1752,6 +2021,35 @@ void buildNotifyData(MemoryBuffer &notifyData, PDState state, CPTStack *stack, M
 class CSubscriberNotifier;
 typedef SimpleHashTableOf<CSubscriberNotifier, SubscriptionId> CSubscriberNotifierTable;
 
+/* Pending notifications are queued per subscriber, so the notifier table is split into stripes by subscription id.
+ * A notifier only ever touches its own stripe, and no code path holds more than one stripe at a time.
+ */
+#define SDS_NOTIFY_STRIPES 16
+class CStripedNotifierTable
+{
+public:
+    struct Stripe
+    {
+        CheckedCriticalSection crit;
+        CSubscriberNotifierTable table;
+        CCritContentionStats stats;
+    };
+private:
+    Stripe stripes[SDS_NOTIFY_STRIPES];
+public:
+    inline Stripe &queryStripe(SubscriptionId id)
+    {
+        return stripes[hashc((const byte *)&id, sizeof(id), 0) % SDS_NOTIFY_STRIPES];
+    }
+    StringBuffer &getStats(StringBuffer &out) const
+    {
+        CCritContentionStats total;
+        for (unsigned s=0; s<SDS_NOTIFY_STRIPES; s++)
+            total.merge(stripes[s].stats);
+        return total.toString(out.append("notify table (all stripes): ")).newline();
+    }
+};
+
 class CSubscriberNotifier : public CInterface
 {
     DECL_NAMEDCOUNT;
@@ -1762,8 +2060,8 @@ class CSubscriberNotifier : public CInterface
         MemoryBuffer notifyData;
     };
 public:
-    CSubscriberNotifier(CSubscriberNotifierTable &_table, CSubscriberContainerBase &_subscriber, MemoryBuffer &notifyData)
-        : table(_table), subscriber(_subscriber) //NB: takes ownership of subscriber
+    CSubscriberNotifier(CStripedNotifierTable::Stripe &_stripe, CSubscriberContainerBase &_subscriber, MemoryBuffer &notifyData)
+        : stripe(_stripe), subscriber(_subscriber) //NB: takes ownership of subscriber
     {
         INIT_NAMEDCOUNT;
         change.setown(new CChange(notifyData));
@@ -1787,7 +2085,7 @@ public:
             else if (subscriber.isUnsubscribed())
                 break;
 
-            CHECKEDCRITICALBLOCK(nfyTableCrit, fakeCritTimeout);
+            STRIPECRITICALBLOCK(stripe);
             if (changeQueue.ordinality())
             {
                 change.set(&changeQueue.item(0));
@@ -1795,14 +2093,14 @@ public:
             }
             else
             {
-                table.removeExact(this);
+                stripe.table.removeExact(this);
                 break;
             }
         }
         if (subscriber.isUnsubscribed())
         {
-            { CHECKEDCRITICALBLOCK(nfyTableCrit, fakeCritTimeout);
-                table.removeExact(this);
+            { STRIPECRITICALBLOCK(stripe);
+                stripe.table.removeExact(this);
             }
             querySubscriptionManager(SDS_PUBLISHER)->remove(subscriber.queryId());
         }
@@ -1818,7 +2116,7 @@ private:
     CIArrayOf<CChange> changeQueue;
     CSubscriberContainerBase &subscriber;
     MemoryAttr notifyData;
-    CSubscriberNotifierTable &table;
+    CStripedNotifierTable::Stripe &stripe;
 };
 
 ////////////////
@@ -1991,6 +2289,388 @@ public:
 
 enum LockStatus { LockFailed, LockHeld, LockTimedOut, LockSucceeded };
 
+/* Secondary index of the direct children of a store branch (e.g. /WorkUnits), on a set of their attributes.
+ * Used to answer single level qualified getXPaths requests (e.g. "*[@state="completed"]") without evaluating
+ * the qualifiers against every child of the branch.
+ * The index only narrows the candidates, every qualifier is still evaluated against each candidate, so keys are
+ * normalized to lower case and serve both case sensitive and insensitive (=?) comparisons.
+ * Changes are noted from the deltas as they are committed: children named in a delta are re-indexed lazily
+ * on the next lookup, changes at or above the branch cause a full rebuild on the next lookup.
+ * Children are referenced by node id and resolved when used, so a child deleted before its delta is seen is
+ * simply skipped.
+ * Each child is given an ordinal when it is first indexed (branch order when the index is built, then the order
+ * children are added), and the matches are returned in ordinal order, so only the matches are sorted rather than
+ * the whole branch walked. Store branches keep their children in a hash table, so an unindexed query does not
+ * return them in any meaningful order either.
+ */
+class CSDSAttributeIndex : public CInterface
+{
+    struct CIndexedChild
+    {
+        __int64 id; // not a link, so that deleted children are not kept alive by the index
+        unsigned ordinal;
+        std::vector<std::string> keys; // per attribute, the key it was indexed under
+    };
+    struct CMatch
+    {
+        unsigned ordinal;
+        aindex_t pos;
+        IPropertyTree *tree;
+    };
+
+    StringAttr branchXPath;
+    StringArray branchSegments;
+    StringArray attributes;
+    Linked<IPropertyTree> branch;
+    bool valid = false;
+    unsigned nextOrdinal = 0;
+    std::unordered_map<std::string, std::vector<CIndexedChild>> children; // by child name
+    std::vector<std::unordered_map<std::string, std::unordered_map<__int64, unsigned>>> keyMaps; // per attribute, id -> ordinal
+    std::unordered_set<std::string> dirty; // child names to re-index
+    CriticalSection crit;
+
+    static std::string makeKey(const char *value)
+    {
+        std::string key(value ? value : "");
+        for (char &c : key)
+            c = tolower(c);
+        return key;
+    }
+    static const char *stripQualifier(StringBuffer &out, const char *segment, const char *end)
+    {
+        const char *q = segment;
+        while (q < end && '[' != *q)
+            q++;
+        out.clear().append(q-segment, segment);
+        return out.str();
+    }
+    void addChild(IPropertyTree &child, unsigned ordinal)
+    {
+        CIndexedChild entry;
+        entry.id = queryNodeId(child);
+        entry.ordinal = ordinal;
+        ForEachItemIn(a, attributes)
+        {
+            const char *value = child.queryProp(attributes.item(a));
+            entry.keys.push_back(value ? makeKey(value) : std::string());
+            if (value && *value)
+                keyMaps[a][entry.keys.back()][entry.id] = ordinal;
+        }
+        children[child.queryName()].push_back(std::move(entry));
+    }
+    void removeChildren(const char *name, std::unordered_map<__int64, unsigned> &ordinals)
+    {
+        auto it = children.find(name);
+        if (it == children.end())
+            return;
+        for (CIndexedChild &entry : it->second)
+        {
+            ordinals[entry.id] = entry.ordinal;
+            ForEachItemIn(a, attributes)
+            {
+                if (entry.keys[a].empty())
+                    continue;
+                auto keyIt = keyMaps[a].find(entry.keys[a]);
+                if (keyIt != keyMaps[a].end())
+                {
+                    keyIt->second.erase(entry.id);
+                    if (keyIt->second.empty())
+                        keyMaps[a].erase(keyIt);
+                }
+            }
+        }
+        children.erase(it);
+    }
+    void rebuild(IPropertyTree &root)
+    {
+        CCycleTimer timer;
+        children.clear();
+        keyMaps.clear();
+        keyMaps.resize(attributes.ordinality());
+        dirty.clear();
+        nextOrdinal = 0;
+        branch.set(root.queryPropTree(branchXPath));
+        if (branch)
+        {
+            Owned<IPropertyTreeIterator> iter = branch->getElements("*");
+            ForEach(*iter)
+                addChild(iter->query(), nextOrdinal++);
+        }
+        valid = true;
+        PROGLOG("SDS attribute index on /%s built, %u children indexed, took %u ms", branchXPath.get(), nextOrdinal, timer.elapsedMs());
+    }
+    void refresh(IPropertyTree &root)
+    {
+        if (!valid)
+        {
+            rebuild(root);
+            return;
+        }
+        for (const std::string &name : dirty)
+        {
+            // children that are re-indexed keep their ordinal, new children are added at the end
+            std::unordered_map<__int64, unsigned> ordinals;
+            removeChildren(name.c_str(), ordinals);
+            if (branch)
+            {
+                Owned<IPropertyTreeIterator> iter = branch->getElements(name.c_str());
+                ForEach(*iter)
+                {
+                    IPropertyTree &child = iter->query();
+                    auto it = ordinals.find(queryNodeId(child));
+                    addChild(child, (it != ordinals.end()) ? it->second : nextOrdinal++);
+                }
+            }
+        }
+        dirty.clear();
+    }
+protected:
+    virtual __int64 queryNodeId(IPropertyTree &node) = 0;
+    virtual IPropertyTree *queryNode(__int64 id) = 0; // NULL if the node no longer exists
+public:
+    CSDSAttributeIndex(const char *_branchXPath, const char *attributeList)
+    {
+        while ('/' == *_branchXPath)
+            _branchXPath++;
+        branchXPath.set(_branchXPath);
+        branchSegments.appendList(branchXPath, "/");
+        StringArray attrs;
+        attrs.appendList(attributeList, ",");
+        ForEachItemIn(a, attrs)
+        {
+            const char *attr = attrs.item(a);
+            if ('@' == *attr)
+                attributes.append(attr);
+            else
+                attributes.append(VStringBuffer("@%s", attr));
+        }
+    }
+    const char *queryBranchXPath() const { return branchXPath; }
+    void invalidate()
+    {
+        CriticalBlock b(crit);
+        valid = false;
+    }
+    void noteBranchChanges(IPropertyTree &branchChange)
+    {
+        Owned<IPropertyTreeIterator> iter = branchChange.getElements("*");
+        ForEach(*iter)
+        {
+            IPropertyTree &change = iter->query();
+            const char *tag = change.queryName();
+            if (streq(ATTRCHANGE_TAG, tag) || streq(ATTRDELETE_TAG, tag) || streq(APPEND_TAG, tag))
+                continue; // changes to the branch node itself
+            const char *childName = change.queryProp("@name");
+            if (!childName || !(streq(RESERVED_CHANGE_NODE, tag) || streq(DELETE_TAG, tag)))
+            {
+                valid = false;
+                return;
+            }
+            dirty.insert(childName);
+        }
+    }
+    // called for every delta, path is the absolute path of the node the change tree is relative to
+    void noteChange(const char *path, IPropertyTree &changeTree)
+    {
+        CriticalBlock b(crit);
+        if (!valid)
+            return; // will be rebuilt on next use
+        StringBuffer name;
+        const char *seg = path;
+        ForEachItemIn(s, branchSegments)
+        {
+            while ('/' == *seg)
+                seg++;
+            if (!*seg)
+            {
+                // change above the branch, follow the change tree down to it
+                IPropertyTree *change = &changeTree;
+                for (; s<branchSegments.ordinality(); s++)
+                {
+                    VStringBuffer childXPath("*[@name=\"%s\"]", branchSegments.item(s));
+                    Owned<IPropertyTreeIterator> iter = change->getElements(childXPath);
+                    if (!iter->first())
+                        return; // unrelated
+                    change = &iter->query();
+                    if (!streq(RESERVED_CHANGE_NODE, change->queryName()) || change->getPropBool("@new") || change->getPropBool("@replace"))
+                    {
+                        valid = false;
+                        return;
+                    }
+                }
+                noteBranchChanges(*change);
+                return;
+            }
+            const char *end = seg;
+            while (*end && '/' != *end)
+                end++;
+            if (!streq(branchSegments.item(s), stripQualifier(name, seg, end)))
+                return; // unrelated
+            seg = end;
+        }
+        while ('/' == *seg)
+            seg++;
+        if (!*seg) // the branch itself
+        {
+            noteBranchChanges(changeTree);
+            return;
+        }
+        const char *end = seg;
+        while (*end && '/' != *end)
+            end++;
+        dirty.insert(stripQualifier(name, seg, end));
+    }
+    /* If xpath is a single step below 'tree' (the indexed branch) with at least one equality qualifier on an indexed attribute,
+     * sets matchTree (in the getXPathMatchTree format, or NULL if nothing matches) and returns true.
+     * Returns false if the index cannot be used and the caller should evaluate the xpath.
+     */
+    bool getXPathMatchTree(IPropertyTree &root, IPropertyTree &tree, const char *xpath, IPropertyTree *&matchTree)
+    {
+        // parse step - <name pattern>[qualifier]...
+        const char *qualifiers = xpath;
+        while (*qualifiers && '[' != *qualifiers)
+        {
+            if ('/' == *qualifiers)
+                return false;
+            qualifiers++;
+        }
+        if (qualifiers == xpath || !*qualifiers)
+            return false;
+        StringAttr namePattern(xpath, qualifiers-xpath);
+        StringArray quals;
+        const char *q = qualifiers;
+        while (*q)
+        {
+            if ('[' != *q)
+                return false;
+            const char *start = q;
+            char quote = 0;
+            for (q++; *q; q++)
+            {
+                if (quote)
+                {
+                    if (*q == quote)
+                        quote = 0;
+                }
+                else if ('"' == *q || '\'' == *q)
+                    quote = *q;
+                else if (']' == *q)
+                    break;
+            }
+            if (!*q)
+                return false;
+            q++;
+            if (isdigit(*(start+1))) // positional
+                return false;
+            quals.append(StringBuffer(q-start, start));
+        }
+
+        CriticalBlock b(crit);
+        if (valid && (&tree != branch.get()))
+            return false;
+        refresh(root);
+        if (!branch || (&tree != branch.get()))
+            return false;
+        // pick the most selective indexed equality qualifier
+        const std::unordered_map<__int64, unsigned> *candidates = nullptr;
+        bool indexed = false;
+        ForEachItemIn(i, quals)
+        {
+            const char *qual = quals.item(i)+1;
+            const char *eq = strchr(qual, '=');
+            if (!eq || ('!' == *(eq-1)))
+                continue;
+            StringBuffer attr(eq-qual, qual);
+            attr.trim();
+            unsigned a = attributes.find(attr);
+            if (NotFound == a)
+                continue;
+            const char *v = eq+1;
+            if ('?' == *v)
+                v++;
+            if ('~' == *v)
+                v++;
+            while (' ' == *v)
+                v++;
+            char quote = *v;
+            if (('"' != quote) && ('\'' != quote))
+                continue;
+            const char *vEnd = strchr(v+1, quote);
+            if (!vEnd)
+                continue;
+            StringBuffer value(vEnd-(v+1), v+1);
+            // equality comparisons are always wildcard matches, with or without ~
+            if (0 == value.length() || strchr(value, '*') || strchr(value, '?'))
+                continue;
+            auto keyIt = keyMaps[a].find(makeKey(value));
+            if (keyIt == keyMaps[a].end())
+            {
+                matchTree = nullptr; // nothing can match
+                return true;
+            }
+            if (!indexed || (keyIt->second.size() < candidates->size()))
+                candidates = &keyIt->second;
+            indexed = true;
+        }
+        if (!indexed)
+            return false;
+        bool nocase = branch->isCaseInsensitive();
+        std::vector<CMatch> matches;
+        for (auto &candidateId : *candidates)
+        {
+            IPropertyTree *candidate = queryNode(candidateId.first);
+            if (!candidate) // deleted, but not yet seen in a delta
+                continue;
+            aindex_t pos = ((PTree *)branch.get())->findChild(candidate);
+            if (NotFound == pos) // removed, but not yet seen in a delta
+                continue;
+            if (!WildMatch(candidate->queryName(), namePattern, nocase))
+                continue;
+            bool match = true;
+            ForEachItemIn(i, quals)
+            {
+                Owned<IPropertyTreeIterator> iter = candidate->getElements(quals.item(i));
+                if (!iter->first())
+                {
+                    match = false;
+                    break;
+                }
+            }
+            if (!match)
+                continue;
+            matches.push_back({ candidateId.second, pos, candidate });
+        }
+        if (matches.empty())
+        {
+            matchTree = nullptr;
+            return true;
+        }
+        std::sort(matches.begin(), matches.end(), [](const CMatch &l, const CMatch &r) { return l.ordinal < r.ordinal; });
+        Owned<IPropertyTree> matchParent = createPTree(tree.queryName());
+        for (auto &m : matches)
+        {
+            IPropertyTree *childContainer = matchParent->addPropTree(m.tree->queryName(), createPTree());
+            childContainer->setPropInt("@pos", m.pos+1);
+        }
+        matchTree = matchParent.getClear();
+        return true;
+    }
+};
+
+// The attribute index of a branch of the server's store, the children are identified by their server ids
+class CSDSServerAttributeIndex final : public CSDSAttributeIndex
+{
+    CFitArray &allNodes;
+protected:
+    virtual __int64 queryNodeId(IPropertyTree &node) override { return ((CRemoteTreeBase &)node).queryServerId(); }
+    virtual IPropertyTree *queryNode(__int64 id) override { return allNodes.queryElem(id); }
+public:
+    CSDSServerAttributeIndex(CFitArray &_allNodes, const char *_branchXPath, const char *attributeList)
+        : CSDSAttributeIndex(_branchXPath, attributeList), allNodes(_allNodes)
+    {
+    }
+};
+
 class CCovenSDSManager : public CSDSManagerBase, implements ISDSManagerServer, implements ISubscriptionManager, implements IExceptionHandler
 {
 public:
@@ -2033,7 +2713,7 @@ public:
     inline CFitArray &queryAllNodes() { return allNodes; }
     unsigned __int64 getNextExternal() { return nextExternal++; }
     CServerConnection *createConnectionInstance(CRemoteTreeBase *root, SessionId sessionId, unsigned mode, unsigned timeout, const char *xpath, CRemoteTreeBase *&tree, ConnectionId connectionId, StringAttr *deltaPath, Owned<IPropertyTree> &deltaChange, Owned<CBranchChange> &branchChange, unsigned &additions);
-    void createConnection(SessionId sessionId, unsigned mode, unsigned timeout, const char *xpath, CServerRemoteTree *&tree, ConnectionId &connectionId, bool primary, Owned<LinkingCriticalBlock> &connectCritBlock);
+    void createConnection(SessionId sessionId, unsigned mode, unsigned timeout, const char *xpath, CServerRemoteTree *&tree, ConnectionId &connectionId, bool primary, Owned<CConnectCritBlock> &connectCritBlock);
     void disconnect(ConnectionId connectionId, bool deleteRoot=false, CLCLockBlock *lockBlock=nullptr);
     void registerTree(__int64 serverId, CServerRemoteTree &tree);
     void unregisterTree(__int64 uniqId);
@@ -2074,6 +2754,7 @@ public:
     virtual StringBuffer &getConnections(StringBuffer &out);
     virtual StringBuffer &getSubscribers(StringBuffer &out);
     virtual StringBuffer &getExternalReport(StringBuffer &out);
+    virtual StringBuffer &getContentionStats(StringBuffer &out);
     virtual void installNotifyHandler(const char *handlerKey, ISDSNotifyHandler *handler);
     virtual bool removeNotifyHandler(const char *handlerKey);
     virtual IPropertyTree *lockStoreRead() const;
@@ -2110,12 +2791,19 @@ public:
     virtual bool fireException(IException *e);
 
 public: // data
+    /* dataRWLock is deliberately not striped.  A commit applies changes relative to its connection root, which can
+     * delete or rename nodes, move externals and register/unregister server ids in allNodes, and it records the
+     * change in the delta transaction, whose order must match the order the changes were applied to the store.
+     * A store save or subscriber scan also needs a consistent view of the whole tree, so every commit serializes
+     * against them.  blockedSaveCrit and saveStoreCrit guard the single delta/store file and cannot be split either.
+     * Commit latency is instead reduced by the group commit in the delta writer.
+     */
     mutable ReadWriteLock dataRWLock;
-    CheckedCriticalSection connectCrit;
+    CConnectStripes connectStripes;
     CheckedCriticalSection connDestructCrit;
-    CheckedCriticalSection cTableCrit;
     CheckedCriticalSection sTableCrit;
     CheckedCriticalSection lockCrit;
+    CCritContentionStats lockCritStats;
     CheckedCriticalSection treeRegCrit;
     Owned<Thread> unhandledThread;
     unsigned writeTransactions;
@@ -2141,10 +2829,12 @@ private:
     unsigned __int64 nextExternal;
     unsigned externalSizeThreshold;
     CLockTable lockTable;
+    CStripedConnectionTable connectionTable;
+    CIArrayOf<CSDSAttributeIndex> attributeIndexes;
     CNotifyHandlerTable nodeNotifyHandlers;
     Owned<IThreadPool> scanNotifyPool, notifyPool;
     CExternalHandlerTable externalHandlers;
-    CSubscriberNotifierTable subscriberNotificationTable;
+    CStripedNotifierTable subscriberNotificationTable;
     Owned<CConnectionSubscriptionManager> connectionSubscriptionManager;
     Owned<INodeSubscriptionManager> nodeSubscriptionManager;
     bool restartOnError, externalEnvironment;
@@ -2270,7 +2960,9 @@ void CBinaryFileExternal::write(const char *name, IPropertyTree &tree)
 
 void CDeltaWriter::addToQueue(CTransactionItem *item)
 {
+    item->queuedCycles = get_cycles_now();
     pending.push(item);
+    unsigned __int64 seq = ++queuedSeq;
     // add actual size for externals, and nominal '100 byte' value for delta transactions
     // it will act. as a rough guide to appoaching size threshold. It is not worth
     // synchronously preparing and serializing here (which will be done asynchronously later)
@@ -2284,9 +2976,32 @@ void CDeltaWriter::addToQueue(CTransactionItem *item)
         if (!writeRequested)
             requestAsyncWrite();
     }
+    else if (groupCommit && !aborted) // wait for the writer thread to commit the batch including this transaction
+    {
+        ++totalQueueLimitHits;
+        pSdsDeltaThrottled->inc(1);
+        CCycleTimer timer;
+        if (!writeRequested)
+            requestAsyncWrite();
+        while ((writtenSeq < seq) && !aborted)
+        {
+            ++groupCommitWaiters;
+            CriticalUnblock ub(pendingCrit);
+            groupCommitSem.wait();
+        }
+        timeThrottled += timer.elapsedCycles();
+        ++throttleCounter;
+        if (timeThrottled >= queryOneSecCycles())
+        {
+            IWARNLOG("Transactions throttled (group commit) - since last message throttled-time/transactions = { %u ms, %u }, total hard limit hits = %u", (unsigned)cycle_to_millisec(timeThrottled), throttleCounter, totalQueueLimitHits);
+            timeThrottled = 0;
+            throttleCounter = 0;
+        }
+    }
     else // here if exceeded transationQueueLimit, transactionMaxMem or exceeded time threshold (deltaSaveThresholdSecs)
     {
         ++totalQueueLimitHits;
+        pSdsDeltaThrottled->inc(1);
         // force a synchronous save
         CCycleTimer timer;
         PROGLOG("Forcing synchronous save of %u transactions", (unsigned)pending.size());
@@ -2577,10 +3292,11 @@ static bool suppressedOrphanUnlock=false;
 class CServerRemoteTree : public CRemoteTreeBase
 {
     DECL_NAMEDCOUNT;
-    class COrphanHandler : public ChildMap
+    class COrphanHandler : public CCompactChildMap<ChildMap>
     {
+        typedef CCompactChildMap<ChildMap> PARENT;
     public:
-        COrphanHandler() : ChildMap() { }
+        COrphanHandler() : PARENT() { }
         ~COrphanHandler() { _releaseAll(); }
         static void setOrphans(CServerRemoteTree &tree, bool tf)
         {
@@ -2605,7 +3321,7 @@ class CServerRemoteTree : public CRemoteTreeBase
         }
         virtual void onAdd(void *e) // ensure memory of constructed multi value elements are no longer orphaned.
         {
-            ChildMap::onAdd(e);
+            PARENT::onAdd(e);
             CServerRemoteTree &tree = *((CServerRemoteTree *)(IPropertyTree *)e);
             setOrphans(tree, false);
         }
@@ -2622,24 +3338,22 @@ class CServerRemoteTree : public CRemoteTreeBase
                 setOrphans(tree, true);
                 SDSManager->unlockAll(tree.queryServerId());
             }
-            ChildMap::onRemove(e);
+            PARENT::onRemove(e);
         }
         virtual bool replace(const char *key, IPropertyTree *tree) // provides different semantics, used if element being replaced is not to be treated as deleted.
         {
             CHECKEDCRITICALBLOCK(suppressedOrphanUnlockCrit, fakeCritTimeout);
             BoolSetBlock bblock(suppressedOrphanUnlock);
-            bool ret = ChildMap::replace(key, tree);
+            bool ret = PARENT::replace(key, tree);
             return ret;
         }
         virtual bool set(const char *key, IPropertyTree *tree)
         {
             // NB: be careful if replacing, to remove element first, because may self-destruct if lastref in middle of SuperHashTable::replace, leaving tablecount wrong.
-            unsigned vs = getHashFromElement(tree);
-            const void *fp = getFindParam(tree);
-            IPropertyTree *et = (IPropertyTree *)SuperHashTable::find(vs, fp);
+            IPropertyTree *et = query(tree->queryName());
             if (et)
                 removeExact(et);
-            return ChildMap::set(key, tree);
+            return PARENT::set(key, tree);
         }
     };
 
@@ -4317,7 +5031,7 @@ void CSDSTransactionServer::processMessage(CMessageBuffer &mb)
                 mb.read(xpath);
                 if (queryTransactionLogging())
                     transactionLog.log("xpath='%s' mode=%d", xpath.get(), (unsigned)mode);
-                Owned<LinkingCriticalBlock> connectCritBlock = new LinkingCriticalBlock(manager.connectCrit, __FILE__, __LINE__);
+                Owned<CConnectCritBlock> connectCritBlock = new CConnectCritBlock(manager.connectStripes, xpath, __FILE__, __LINE__);
                 if (RTM_CREATE == (mode & RTM_CREATE_MASK) || RTM_CREATE_QUERY == (mode & RTM_CREATE_MASK))
                     lockBlock.setown(new CLCLockBlock(manager.dataRWLock, false, readWriteTimeout, __FILE__, __LINE__));
                 else
@@ -4382,7 +5096,7 @@ void CSDSTransactionServer::processMessage(CMessageBuffer &mb)
                         connectionId = 0;
                         CServerRemoteTree *_tree;
                         Owned<CServerRemoteTree> tree;
-                        Owned<LinkingCriticalBlock> connectCritBlock = new LinkingCriticalBlock(manager.connectCrit, __FILE__, __LINE__);
+                        Owned<CConnectCritBlock> connectCritBlock = new CConnectCritBlock(manager.connectStripes, xpath, __FILE__, __LINE__);
                         manager.createConnection(id, mode, timeout, xpath, _tree, connectionId, true, connectCritBlock);
                         if (connectionId)
                             tree.setown(_tree);
@@ -5007,7 +5721,36 @@ void initializeInternals(IPropertyTree *root)
     root->addPropTree("Status/Servers",createPTree());
 }
 
-IPropertyTree *loadStore(const char *storeFilename, unsigned edition, IPTreeMaker *iMaker, unsigned crcValidation, bool logErrorsOnly=false, const bool *abort=NULL)
+static constexpr offset_t maxParallelStoreLoadSize = 0x7fffffff;
+static constexpr size32_t parallelStoreReadChunk = 0x4000000; // 64MB
+
+// Read the whole store into memory and parse it in parallel.  Returns NULL if the store is not suitable.
+// The whole file is held in memory for the duration of the parse, which is why the parallel load is opt-in (@parallelLoad).
+static IPropertyTree *loadStoreParallel(IFileIO &iFileIOStore, offset_t fSize, std::function<IPTreeMaker *()> createMaker, unsigned &crc, const bool *abort)
+{
+    MemoryBuffer xml;
+    size32_t len = (size32_t)fSize;
+    char *buf = (char *)xml.reserveTruncate(len);
+    CRC32 crc32;
+    size32_t pos = 0;
+    while (pos < len)
+    {
+        if (abort && *abort)
+            throw MakeSDSException(SDSExcpt_LoadAborted, "%s", "reading xml store");
+        size32_t read = iFileIOStore.read(pos, std::min(len-pos, parallelStoreReadChunk), buf+pos);
+        if (!read)
+            return nullptr;
+        crc32.tally(read, buf+pos);
+        pos += read;
+        PROGLOG("Load progress: read %.2f MB of %.2f MB", ((double)pos) / 0x100000, ((double)len) / 0x100000);
+    }
+    crc = crc32.get();
+    return createPTreeFromXMLBufferParallel(len, buf, ipt_none, ptr_ignoreWhiteSpace, createMaker, abort);
+}
+
+// If createParallelMaker is supplied, the store is parsed on multiple threads, with a maker created for each independent piece.
+// iMaker is only used if the store could not be parsed in parallel.
+IPropertyTree *loadStore(const char *storeFilename, unsigned edition, IPTreeMaker *iMaker, unsigned crcValidation, bool logErrorsOnly=false, const bool *abort=NULL, std::function<IPTreeMaker *()> createParallelMaker=nullptr)
 {
     CHECKEDCRITICALBLOCK(loadStoreCrit, fakeCritTimeout);
     CHECKEDCRITICALBLOCK(saveStoreCrit, fakeCritTimeout);
@@ -5020,13 +5763,34 @@ IPropertyTree *loadStore(const char *storeFilename, unsigned edition, IPTreeMake
             throw MakeSDSException(SDSExcpt_OpenStoreFailed, "%s", storeFilename);
         offset_t fSize = iFileIOStore->size();
         PROGLOG("Loading store %u (size=%.2f MB, storedCrc=%x)", edition, ((double)fSize) / 0x100000, crcValidation);
-        Owned<IFileIOStream> fstream = createIOStream(iFileIOStore);
-        OwnedIFileIOStream progressedIFileIOStream = createProgressIFileIOStream(fstream, fSize, "Load progress", 60);
-        Owned<ICrcIOStream> crcPipeStream = createCrcPipeStream(progressedIFileIOStream);
-        Owned<IIOStream> ios = createBufferedIOStream(crcPipeStream);
-        root.setown((CServerRemoteTree *) createPTree(*ios, ipt_none, ptr_ignoreWhiteSpace, iMaker));
-        ios.clear();
-        unsigned crc = crcPipeStream->queryCrc();
+        unsigned crc = 0;
+        if (createParallelMaker && (fSize <= maxParallelStoreLoadSize) && (getAffinityCpus() > 1))
+        {
+            try
+            {
+                root.setown(loadStoreParallel(*iFileIOStore, fSize, createParallelMaker, crc, abort));
+                if (!root)
+                    PROGLOG("Store %u cannot be loaded in parallel, loading serially", edition);
+            }
+            catch (IException *e)
+            {
+                if (abort && *abort)
+                    throw;
+                // reload serially, which will report any genuine error in context
+                OWARNLOG(e, "Failed to load store in parallel, loading serially");
+                e->Release();
+            }
+        }
+        if (!root)
+        {
+            Owned<IFileIOStream> fstream = createIOStream(iFileIOStore);
+            OwnedIFileIOStream progressedIFileIOStream = createProgressIFileIOStream(fstream, fSize, "Load progress", 60);
+            Owned<ICrcIOStream> crcPipeStream = createCrcPipeStream(progressedIFileIOStream);
+            Owned<IIOStream> ios = createBufferedIOStream(crcPipeStream);
+            root.setown((CServerRemoteTree *) createPTree(*ios, ipt_none, ptr_ignoreWhiteSpace, iMaker));
+            ios.clear();
+            crc = crcPipeStream->queryCrc();
+        }
 
         if (crcValidation && crc != crcValidation)
             IWARNLOG("Error processing store %s - CRC ERROR (file size=%" I64F "d, validation crc=%x, calculated crc=%x)", storeFilename, iFileIOStore->size(), crcValidation, crc); // not fatal yet (maybe later)
@@ -5056,6 +5820,367 @@ IPropertyTree *loadStore(const char *storeFilename, unsigned edition, IPTreeMake
 }
 
 
+/////////////////
+// Binary store checkpoint (dalisds<N>.bin), written alongside the xml store when SH_BinaryStore is set.
+//
+// Layout: header | tree sections ... | atom section | directory | trailer
+// Atoms are the distinct tag and attribute names. The first tree section holds the root and each top level node
+// (without children), the remaining sections each hold a run of complete subtrees below one top level node, so
+// they can be crc checked and built in parallel. Each node is encoded as:
+//   packed tag atom, packed #attributes { packed name atom, packed length, text }, value kind, [packed length, value], packed #children
+// The trailer records the crc of the xml store it was written with, so a binary store is only used if it
+// matches the current xml store.
+
+static const char binaryStoreMagic[8] = { 'D','A','L','I','B','S','D','S' };
+static constexpr unsigned binaryStoreVersion = 1;
+static constexpr size32_t binaryStoreSectionSize = 0x4000000; // 64MB - approx. size at which a subtree section is closed
+enum BinaryStoreSection : unsigned { bss_atoms=1, bss_skeleton=2, bss_subtrees=3 };
+enum BinaryStoreValue : byte { bsv_none=0, bsv_string=1, bsv_binary=2 };
+
+struct BinaryStoreSectionInfo
+{
+    unsigned type = 0;
+    unsigned topIndex = 0;       // for bss_subtrees, index of the top level node they belong to
+    unsigned crc = 0;
+    offset_t offset = 0;
+    size32_t size = 0;
+};
+
+class CBinaryStoreWriter
+{
+    IFileIOStream &out;
+    MapStringTo<unsigned> atomMap;
+    MemoryBuffer atoms;
+    unsigned numAtoms = 0;
+    std::vector<BinaryStoreSectionInfo> sections;
+    offset_t pos = 0;
+
+    unsigned getAtom(const char *name)
+    {
+        unsigned *found = atomMap.getValue(name);
+        if (found)
+            return *found;
+        atomMap.setValue(name, numAtoms);
+        atoms.append(name);
+        return numAtoms++;
+    }
+    void writeBlock(const void *data, size32_t len)
+    {
+        out.write(len, data);
+        pos += len;
+    }
+    void writeSection(unsigned type, unsigned topIndex, MemoryBuffer &mb)
+    {
+        BinaryStoreSectionInfo info;
+        info.type = type;
+        info.topIndex = topIndex;
+        info.crc = crc32(mb.toByteArray(), mb.length(), 0);
+        info.offset = pos;
+        info.size = mb.length();
+        writeBlock(mb.toByteArray(), mb.length());
+        sections.push_back(info);
+        mb.clear();
+    }
+    void serializeSelf(IPropertyTree &node, MemoryBuffer &mb)
+    {
+        mb.appendPacked(getAtom(node.queryName()));
+        unsigned numAttrs = 0;
+        Owned<IAttributeIterator> attrs = node.getAttributes();
+        ForEach(*attrs)
+            numAttrs++;
+        mb.appendPacked(numAttrs);
+        ForEach(*attrs)
+        {
+            mb.appendPacked(getAtom(attrs->queryName()));
+            const char *value = attrs->queryValue();
+            size32_t len = value ? strlen(value) : 0;
+            mb.appendPacked(len).append(len, value);
+        }
+        if (node.isBinary(nullptr))
+        {
+            MemoryBuffer value;
+            node.getPropBin(nullptr, value);
+            mb.append((byte)bsv_binary).appendPacked(value.length()).append(value);
+        }
+        else
+        {
+            StringBuffer value;
+            if (node.getProp(nullptr, value))
+                mb.append((byte)bsv_string).appendPacked(value.length()).append(value.length(), value.str());
+            else
+                mb.append((byte)bsv_none);
+        }
+    }
+    void serializeTree(IPropertyTree &node, MemoryBuffer &mb)
+    {
+        serializeSelf(node, mb);
+        unsigned numChildren = node.numChildren();
+        mb.appendPacked(numChildren);
+        Owned<IPropertyTreeIterator> iter = node.getElements("*");
+        ForEach(*iter)
+            serializeTree(iter->query(), mb);
+    }
+public:
+    CBinaryStoreWriter(IFileIOStream &_out) : out(_out) { }
+
+    void write(IPropertyTree &root, unsigned xmlCrc)
+    {
+        unsigned version = binaryStoreVersion;
+        writeBlock(binaryStoreMagic, sizeof(binaryStoreMagic));
+        writeBlock(&version, sizeof(version));
+
+        MemoryBuffer mb;
+        serializeSelf(root, mb);
+        mb.appendPacked(root.numChildren());
+        unsigned topIndex = 0;
+        MemoryBuffer subtrees;
+        Owned<IPropertyTreeIterator> topIter = root.getElements("*");
+        ForEach(*topIter)
+        {
+            IPropertyTree &top = topIter->query();
+            serializeSelf(top, mb);
+            Owned<IPropertyTreeIterator> iter = top.getElements("*");
+            ForEach(*iter)
+            {
+                serializeTree(iter->query(), subtrees);
+                if (subtrees.length() >= binaryStoreSectionSize)
+                    writeSection(bss_subtrees, topIndex, subtrees);
+            }
+            if (subtrees.length())
+                writeSection(bss_subtrees, topIndex, subtrees);
+            topIndex++;
+        }
+        writeSection(bss_skeleton, 0, mb);
+        mb.appendPacked(numAtoms).append(atoms);
+        writeSection(bss_atoms, 0, mb);
+
+        offset_t directoryPos = pos;
+        unsigned numSections = (unsigned)sections.size();
+        for (auto &info: sections)
+            mb.append(info.type).append(info.topIndex).append(info.crc).append(info.offset).append(info.size);
+        writeBlock(mb.toByteArray(), mb.length());
+        unsigned directoryCrc = crc32(mb.toByteArray(), mb.length(), 0);
+        mb.clear().append(directoryPos).append(numSections).append(directoryCrc).append(xmlCrc).append(sizeof(binaryStoreMagic), binaryStoreMagic);
+        writeBlock(mb.toByteArray(), mb.length());
+    }
+};
+
+static void saveBinaryStore(IPropertyTree &root, const char *filename, unsigned xmlCrc)
+{
+    CCycleTimer timer;
+    OwnedIFile iFile = createIFile(filename);
+    OwnedIFileIO iFileIO = iFile->open(IFOcreate);
+    if (!iFileIO)
+        throw MakeSDSException(SDSExcpt_OpenStoreFailed, "%s", filename);
+    OwnedIFileIOStream stream = createBufferedIOStream(iFileIO);
+    CBinaryStoreWriter writer(*stream);
+    writer.write(root, xmlCrc);
+    stream->flush();
+    stream.clear();
+    iFileIO->close();
+    PROGLOG("Binary store saved: %s (%u ms)", filename, timer.elapsedMs());
+}
+
+class CBinaryStoreReader
+{
+    IPTreeNodeCreator &nodeCreator;
+    std::function<void(IPropertyTree &)> onNode;
+    std::vector<const char *> atoms;
+    MemoryBuffer atomData;
+    const bool *abort;
+
+    void checkAbort() const
+    {
+        if (abort && *abort)
+            throw MakeStringException(0, "Binary store: load aborted");
+    }
+
+    const char *readAtom(MemoryBuffer &mb)
+    {
+        unsigned atom;
+        mb.readPacked(atom);
+        if (atom >= atoms.size())
+            throw MakeStringException(0, "Binary store: invalid atom %u", atom);
+        return atoms[atom];
+    }
+    void readSelf(IPropertyTree &node, MemoryBuffer &mb)
+    {
+        unsigned numAttrs;
+        mb.readPacked(numAttrs);
+        StringBuffer value;
+        while (numAttrs--)
+        {
+            const char *name = readAtom(mb);
+            size32_t len;
+            mb.readPacked(len);
+            value.clear().append(len, (const char *)mb.readDirect(len));
+            node.setProp(name, value);
+        }
+        byte kind;
+        mb.read(kind);
+        size32_t len = 0;
+        if (bsv_none != kind)
+            mb.readPacked(len);
+        if (bsv_binary == kind)
+            node.setPropBin(nullptr, len, mb.readDirect(len));
+        else
+            node.setProp(nullptr, value.clear().append(len, (const char *)mb.readDirect(len)));
+        if (onNode)
+            onNode(node);
+    }
+    void readChildren(IPropertyTree &parent, MemoryBuffer &mb)
+    {
+        unsigned numChildren;
+        mb.readPacked(numChildren);
+        while (numChildren--)
+        {
+            const char *tag = readAtom(mb);
+            IPropertyTree *child = nodeCreator.create(nullptr);
+            child = parent.addPropTree(tag, child); // attach before filling, as the xml maker does
+            readSelf(*child, mb);
+            readChildren(*child, mb);
+        }
+    }
+public:
+    CBinaryStoreReader(IPTreeNodeCreator &_nodeCreator, std::function<void(IPropertyTree &)> _onNode, const bool *_abort) : nodeCreator(_nodeCreator), onNode(_onNode), abort(_abort) { }
+
+    IPropertyTree *read(IFileIO &io, unsigned xmlCrc)
+    {
+        offset_t fileSize = io.size();
+        MemoryBuffer mb;
+        size32_t trailerSize = sizeof(offset_t)+3*sizeof(unsigned)+sizeof(binaryStoreMagic);
+        if (fileSize < sizeof(binaryStoreMagic)+sizeof(unsigned)+trailerSize)
+            throw MakeStringException(0, "Binary store: truncated");
+        if (io.read(fileSize-trailerSize, trailerSize, mb.reserveTruncate(trailerSize)) != trailerSize)
+            throw MakeStringException(0, "Binary store: failed to read trailer");
+        offset_t directoryPos;
+        unsigned numSections, directoryCrc, storedXmlCrc;
+        mb.read(directoryPos).read(numSections).read(directoryCrc).read(storedXmlCrc);
+        if (0 != memcmp(mb.readDirect(sizeof(binaryStoreMagic)), binaryStoreMagic, sizeof(binaryStoreMagic)))
+            throw MakeStringException(0, "Binary store: bad trailer");
+        if (storedXmlCrc != xmlCrc)
+            throw MakeStringException(0, "Binary store: does not match xml store (crc=%x, expected=%x)", storedXmlCrc, xmlCrc);
+        if (directoryPos > fileSize-trailerSize)
+            throw MakeStringException(0, "Binary store: bad directory offset");
+        size32_t directorySize = (size32_t)(fileSize-trailerSize-directoryPos);
+        mb.clear();
+        if (io.read(directoryPos, directorySize, mb.reserveTruncate(directorySize)) != directorySize)
+            throw MakeStringException(0, "Binary store: failed to read directory");
+        if (crc32(mb.toByteArray(), mb.length(), 0) != directoryCrc)
+            throw MakeStringException(0, "Binary store: directory crc error");
+        std::vector<BinaryStoreSectionInfo> sections(numSections);
+        for (auto &info: sections)
+            mb.read(info.type).read(info.topIndex).read(info.crc).read(info.offset).read(info.size);
+
+        auto readSection = [&](const BinaryStoreSectionInfo &info, MemoryBuffer &data)
+        {
+            if ((info.offset > directoryPos) || (info.size > directoryPos-info.offset))
+                throw MakeStringException(0, "Binary store: bad section offset");
+            if (io.read(info.offset, info.size, data.clear().reserveTruncate(info.size)) != info.size)
+                throw MakeStringException(0, "Binary store: failed to read section");
+            if (crc32(data.toByteArray(), data.length(), 0) != info.crc)
+                throw MakeStringException(0, "Binary store: section crc error (offset=%" I64F "u)", info.offset);
+        };
+
+        // atoms and skeleton first, then subtree sections in parallel
+        const BinaryStoreSectionInfo *skeletonInfo = nullptr;
+        std::vector<const BinaryStoreSectionInfo *> subtreeInfo;
+        for (auto &info: sections)
+        {
+            switch (info.type)
+            {
+                case bss_atoms:
+                {
+                    readSection(info, atomData);
+                    unsigned numAtoms;
+                    atomData.readPacked(numAtoms);
+                    atoms.reserve(numAtoms);
+                    while (numAtoms--)
+                    {
+                        const char *atom = (const char *)atomData.readDirect(0);
+                        size32_t len = strlen(atom);
+                        atomData.skip(len+1);
+                        atoms.push_back(atom);
+                    }
+                    break;
+                }
+                case bss_skeleton:
+                    skeletonInfo = &info;
+                    break;
+                case bss_subtrees:
+                    subtreeInfo.push_back(&info);
+                    break;
+            }
+        }
+        if (!skeletonInfo)
+            throw MakeStringException(0, "Binary store: no root section");
+
+        MemoryBuffer skeleton;
+        readSection(*skeletonInfo, skeleton);
+        Owned<IPropertyTree> root = nodeCreator.create(readAtom(skeleton));
+        readSelf(*root, skeleton);
+        unsigned numTop;
+        skeleton.readPacked(numTop);
+        std::vector<IPropertyTree *> topNodes;
+        for (unsigned t=0; t<numTop; t++)
+        {
+            const char *tag = readAtom(skeleton);
+            IPropertyTree *top = root->addPropTree(tag, nodeCreator.create(nullptr));
+            readSelf(*top, skeleton);
+            topNodes.push_back(top);
+        }
+
+        // Each section is read, verified and built detached in a single pass (in parallel).  Nothing is attached
+        // until every section has been verified, so a damaged file (or an abort) discards all the built trees.
+        unsigned numSubtreeSections = (unsigned)subtreeInfo.size();
+        std::vector<std::vector<std::pair<const char *, Owned<IPropertyTree>>>> built(numSubtreeSections);
+        asyncFor(numSubtreeSections, getAffinityCpus(), true, [&](unsigned i)
+        {
+            checkAbort();
+            MemoryBuffer data;
+            readSection(*subtreeInfo[i], data);
+            auto &subtrees = built[i];
+            while (data.remaining())
+            {
+                const char *tag = readAtom(data);
+                Owned<IPropertyTree> child = nodeCreator.create(nullptr);
+                readSelf(*child, data);
+                readChildren(*child, data);
+                subtrees.emplace_back(tag, child.getClear());
+            }
+        });
+        checkAbort();
+        for (unsigned i=0; i<numSubtreeSections; i++)
+        {
+            unsigned topIndex = subtreeInfo[i]->topIndex;
+            if (topIndex >= topNodes.size())
+                throw MakeStringException(0, "Binary store: bad top level index %u", topIndex);
+            IPropertyTree *top = topNodes[topIndex];
+            for (auto &subtree: built[i])
+                top->addPropTree(subtree.first, subtree.second.getClear());
+            built[i].clear();
+        }
+        return root.getClear();
+    }
+};
+
+static IPropertyTree *loadBinaryStore(const char *filename, unsigned xmlCrc, IPTreeNodeCreator &nodeCreator, std::function<void(IPropertyTree &)> onNode, const bool *abort)
+{
+    CHECKEDCRITICALBLOCK(loadStoreCrit, fakeCritTimeout);
+    CHECKEDCRITICALBLOCK(saveStoreCrit, fakeCritTimeout);
+    OwnedIFile iFile = createIFile(filename);
+    OwnedIFileIO iFileIO = iFile->open(IFOread);
+    if (!iFileIO)
+        return nullptr;
+    CCycleTimer timer;
+    PROGLOG("Loading binary store %s (size=%.2f MB)", filename, ((double)iFileIO->size()) / 0x100000);
+    CBinaryStoreReader reader(nodeCreator, onNode, abort);
+    IPropertyTree *root = reader.read(*iFileIO, xmlCrc);
+    PROGLOG("Binary store loaded (%u ms)", timer.elapsedMs());
+    return root;
+}
+
+
 // Not really coalescing, blocking transations and saving store (which will delete pending transactions).
 class CLightCoalesceThread : implements ICoalesce, public CInterface
 {
@@ -5245,7 +6370,7 @@ public:
             CHECKEDWRITELOCKENTER(SDSManager->dataRWLock, readWriteTimeout);
         else
             CHECKEDREADLOCKENTER(SDSManager->dataRWLock, readWriteTimeout);
-        CHECKEDCRITENTER(SDSManager->lockCrit, fakeCritTimeout);
+        SDSManager->lockCritStats.enter(SDSManager->lockCrit, __FILE__, __LINE__);
         unlocked = false;
         unsigned e=msTick()-got;
         if (e>readWriteSlowTracing)
@@ -5782,6 +6907,24 @@ public:
                 return;
             }
 
+            if (0 != (SH_BinaryStore & configFlags))
+            {
+                // best effort, if missing or stale the xml store is loaded instead
+                StringBuffer binStoreNamePath(location);
+                constructBinaryStoreName(storeName, newEdition, binStoreNamePath);
+                try
+                {
+                    saveBinaryStore(*root, binStoreNamePath, crc);
+                }
+                catch (IException *e)
+                {
+                    OWARNLOG(e, "Failed to save binary store");
+                    e->Release();
+                    OwnedIFile binIFile = createIFile(binStoreNamePath);
+                    binIFile->remove();
+                }
+            }
+
             if (0 != (SH_CheckNewDelta & configFlags))
             {
                 CheckDeltaBlock cD(*this);
@@ -5856,6 +6999,11 @@ public:
             removeDaliFile(location, storeName, toDeleteEdition);
             removeDaliFile(location, DELTANAME, toDeleteEdition);
             removeDaliFile(location, DELTADETACHED, toDeleteEdition);
+            StringBuffer binFilename(location);
+            constructBinaryStoreName(storeName, toDeleteEdition, binFilename);
+            OwnedIFile binIFile = createIFile(binFilename);
+            if (binIFile->exists())
+                binIFile->remove();
             if (remoteBackupLocation)
             {
                 removeDaliFile(remoteBackupLocation, storeName, toDeleteEdition);
@@ -5983,6 +7131,23 @@ CCovenSDSManager::CCovenSDSManager(ICoven &_coven, IPropertyTree &_config, const
     unsigned initNodeTableSize = queryCoven().getInitSDSNodes();
     allNodes.ensure(initNodeTableSize?initNodeTableSize:INIT_NODETABLE_SIZE);
     externalSizeThreshold = config.getPropInt("@externalSizeThreshold", defaultExternalSizeThreshold);
+    if (config.getPropBool("@attributeIndexes", false))
+    {
+        Owned<IPropertyTreeIterator> indexIter = config.getElements("AttributeIndex");
+        if (indexIter->first())
+        {
+            ForEach(*indexIter)
+            {
+                IPropertyTree &index = indexIter->query();
+                const char *path = index.queryProp("@path");
+                const char *attributes = index.queryProp("@attributes");
+                if (!isEmptyString(path) && !isEmptyString(attributes))
+                    attributeIndexes.append(*new CSDSServerAttributeIndex(allNodes, path, attributes));
+            }
+        }
+        else
+            attributeIndexes.append(*new CSDSServerAttributeIndex(allNodes, "WorkUnits", "@state,@submitID,@clusterName,@jobName"));
+    }
     remoteBackupLocation.set(config.queryProp("@remoteBackupLocation"));
     nextExternal = 1;
     if (0 == coven.getServerRank())
@@ -6082,6 +7247,7 @@ CCovenSDSManager::CCovenSDSManager(ICoven &_coven, IPropertyTree &_config, const
 
     unsigned configFlags = config.getPropBool("@recoverFromIncErrors", true) ? SH_RecoverFromIncErrors : 0;
     configFlags |= config.getPropBool("@backupErrorFiles", true) ? SH_BackupErrorFiles : 0;
+    configFlags |= config.getPropBool("@binaryStore", false) ? SH_BinaryStore : 0;
     iStoreHelper = createStoreHelper(storeName, dataPath, remoteBackupLocation, configFlags, keepLastN, 100, &server.queryStopped());
     doTimeComparison = false;
     if (config.getPropBool("@lightweightCoalesce", true))
@@ -6108,7 +7274,7 @@ CCovenSDSManager::~CCovenSDSManager()
     if (coalesce) coalesce->stop();
     scanNotifyPool.clear();
     notifyPool.clear();
-    connections.kill();
+    connectionTable.kill();
     ::Release(iStoreHelper);
     if (!config.getPropBool("@leakStore", true)) // intentional default leak of time consuming deconstruction of tree
         ::Release(root);
@@ -6211,6 +7377,8 @@ void CCovenSDSManager::checkEnvironment(IPropertyTree *oldEnv, IPropertyTree *ne
 void CCovenSDSManager::loadStore(const char *storeName, const bool *abort)
 {
     if (root) root->Release();
+    ForEachItemIn(i, attributeIndexes)
+        attributeIndexes.item(i).invalidate();
 
     class CNodeCreate : implements IPTreeNodeCreator, public CInterface
     {
@@ -6243,7 +7411,62 @@ void CCovenSDSManager::loadStore(const char *storeName, const bool *abort)
         StringBuffer storeFilename(dataPath);
         iStoreHelper->getCurrentStoreFilename(storeFilename, &crc);
 
-        root = (CServerRemoteTree *)::loadStore(storeFilename.str(), iStoreHelper->queryCurrentEdition(), &treeMaker, crc, false, abort);
+        if (config.getPropBool("@binaryStore", false) && crc)
+        {
+            StringBuffer binStoreFilename(storeFilename);
+            binStoreFilename.setLength(binStoreFilename.length()-4); // strip .xml
+            binStoreFilename.append(".bin");
+            if (checkFileExists(binStoreFilename))
+            {
+                CriticalSection convertCrit;
+                auto onNode = [&](IPropertyTree &node)
+                {
+                    CServerRemoteTree &serverNode = (CServerRemoteTree &)node;
+                    if (serverNode.testExternalCandidate())
+                    {
+                        CriticalBlock block(convertCrit);
+                        treeMaker.convertQueue.append(serverNode);
+                    }
+                };
+                try
+                {
+                    root = (CServerRemoteTree *)loadBinaryStore(binStoreFilename, crc, nodeCreator, onNode, abort);
+                }
+                catch (IException *e)
+                {
+                    if (abort && *abort)
+                        throw;
+                    OWARNLOG(e, "Failed to load binary store, loading xml store");
+                    e->Release();
+                    treeMaker.convertQueue.kill();
+                }
+            }
+        }
+        if (!root)
+        {
+            // Each piece of a parallel load has its own maker, their external candidates are gathered once the load has succeeded
+            std::vector<Owned<CSDSTreeMaker>> parallelMakers;
+            CriticalSection parallelMakersCrit;
+            auto createParallelMaker = [&]() -> IPTreeMaker *
+            {
+                CSDSTreeMaker *maker = new CSDSTreeMaker(&nodeCreator);
+                CriticalBlock block(parallelMakersCrit);
+                parallelMakers.emplace_back(LINK(maker));
+                return maker;
+            };
+            std::function<IPTreeMaker *()> parallelMaker;
+            if (config.getPropBool("@parallelLoad", false))
+                parallelMaker = createParallelMaker;
+            root = (CServerRemoteTree *)::loadStore(storeFilename.str(), iStoreHelper->queryCurrentEdition(), &treeMaker, crc, false, abort, parallelMaker);
+            if (root && !treeMaker.queryRoot()) // i.e. loaded in parallel
+            {
+                for (auto &maker : parallelMakers)
+                {
+                    ForEachItemIn(c, maker->convertQueue)
+                        treeMaker.convertQueue.append(maker->convertQueue.item(c));
+                }
+            }
+        }
         if (!root)
         {
             StringBuffer s(storeName);
@@ -6686,6 +7909,8 @@ StringBuffer &transformToAbsolute(StringBuffer &result, const char *xpath, unsig
 void CCovenSDSManager::serializeDelta(const char *path, IPropertyTree *changeTree)
 {
     Owned<IPropertyTree> ownedChangeTree = changeTree;
+    ForEachItemIn(i, attributeIndexes)
+        attributeIndexes.item(i).noteChange(path, *changeTree);
     // translate changeTree to inc format (e.g. remove id's)
     if (externalEnvironment)
     {
@@ -6821,10 +8046,10 @@ IRemoteConnections *CCovenSDSManager::connect(IMultipleConnector *mConnect, Sess
 IRemoteConnection *CCovenSDSManager::connect(const char *xpath, SessionId id, unsigned mode, unsigned timeout)
 {
     Owned<CLCLockBlock> lockBlock;
-    Owned<LinkingCriticalBlock> connectCritBlock;
+    Owned<CConnectCritBlock> connectCritBlock;
     if (!RTM_MODE(mode, RTM_INTERNAL))
     {
-        connectCritBlock.setown(new LinkingCriticalBlock(connectCrit, __FILE__, __LINE__));
+        connectCritBlock.setown(new CConnectCritBlock(connectStripes, xpath, __FILE__, __LINE__));
         if (RTM_CREATE == (mode & RTM_CREATE_MASK) || RTM_CREATE_QUERY == (mode & RTM_CREATE_MASK))
             lockBlock.setown(new CLCLockBlock(dataRWLock, false, readWriteTimeout, __FILE__, __LINE__));
         else
@@ -7194,7 +8419,18 @@ IPropertyTree *CCovenSDSManager::getXPaths(__int64 serverId, const char *xpath,
     Owned<CServerRemoteTree> tree = getRegisteredTree(serverId);
     if (!tree)
         return NULL;
-    IPropertyTree *matchTree = getXPathMatchTree(*tree, xpath);
+    IPropertyTree *matchTree = nullptr;
+    bool indexed = false;
+    ForEachItemIn(i, attributeIndexes)
+    {
+        if (attributeIndexes.item(i).getXPathMatchTree(*root, *tree, xpath, matchTree))
+        {
+            indexed = true;
+            break;
+        }
+    }
+    if (!indexed)
+        matchTree = getXPathMatchTree(*tree, xpath);
     if (!matchTree)
         return NULL;
     if (getServerIds)
@@ -7287,7 +8523,7 @@ void CCovenSDSManager::restart(IException * e)
     msg.append("Unhandled exception, restarting: ").append(e->errorCode()).append(": ");
     e->errorMessage(msg);
     stop();
-    connections.kill();
+    connectionTable.kill();
     DBGLOG("-------: stopped");
     DBGLOG("-------: saving current store . . . . . .");
     saveStore();
@@ -7505,7 +8741,7 @@ CServerConnection *CCovenSDSManager::createConnectionInstance(CRemoteTreeBase *r
 
 void CCovenSDSManager::clearSDSLocks()
 {
-    CHECKEDCRITICALBLOCK(lockCrit, fakeCritTimeout);
+    CONTENDEDCRITICALBLOCK(lockCrit, lockCritStats);
     SuperHashIteratorOf<CLock> iter(lockTable.queryBaseTable());
     ICopyArrayOf<CLock> locks;
     ForEach(iter)
@@ -7523,7 +8759,7 @@ void CCovenSDSManager::changeLockMode(CServerConnection &connection, unsigned ne
     newMode |= connection.queryMode() & ~(RTM_LOCKBASIC_MASK|RTM_LOCK_SUB);
     CUnlockCallback callback(connection.queryXPath(), connectionId, *tree);
     {
-        CHECKEDCRITICALBLOCK(lockCrit, fakeCritTimeout);
+        CONTENDEDCRITICALBLOCK(lockCrit, lockCritStats);
         CLock *lock = queryLock(treeId);
         if (lock)
         {
@@ -7555,7 +8791,7 @@ bool CCovenSDSManager::unlock(__int64 connectionId, bool close, StringBuffer &co
     {
         PROGLOG("forcing unlock for connection : %s", connectionInfo.str());
         __int64 nodeId = ((CRemoteTreeBase *)connection->queryRoot())->queryServerId();
-        CHECKEDCRITICALBLOCK(lockCrit, fakeCritTimeout);
+        CONTENDEDCRITICALBLOCK(lockCrit, lockCritStats);
         CLock *lock = queryLock(nodeId);
         if (lock)
             lock->unlock(connectionId);
@@ -7565,7 +8801,7 @@ bool CCovenSDSManager::unlock(__int64 connectionId, bool close, StringBuffer &co
 
 bool CCovenSDSManager::unlock(__int64 treeId, ConnectionId connectionId, bool delayDelete)
 {
-    CHECKEDCRITICALBLOCK(lockCrit, fakeCritTimeout);
+    CONTENDEDCRITICALBLOCK(lockCrit, lockCritStats);
     CLock *lock = queryLock(treeId);
     if (lock)
         return lock->unlock(connectionId, delayDelete);
@@ -7574,7 +8810,7 @@ bool CCovenSDSManager::unlock(__int64 treeId, ConnectionId connectionId, bool de
 
 void CCovenSDSManager::unlockAll(__int64 treeId)
 {
-    CHECKEDCRITICALBLOCK(lockCrit, fakeCritTimeout);
+    CONTENDEDCRITICALBLOCK(lockCrit, lockCritStats);
     CLock *lock = queryLock(treeId);
     if (lock)
         lock->unlockAll();
@@ -7612,7 +8848,7 @@ void CCovenSDSManager::lock(CServerRemoteTree &tree, const char *xpath, Connecti
     }
 
     __int64 treeId = tree.queryServerId();
-    CHECKEDCRITICALBLOCK(lockCrit, fakeCritTimeout);
+    CONTENDEDCRITICALBLOCK(lockCrit, lockCritStats);
     lock = lockTable.find(&treeId);
 
     if (!lock)
@@ -7642,7 +8878,7 @@ void CCovenSDSManager::lock(CServerRemoteTree &tree, const char *xpath, Connecti
     }
 }
 
-void CCovenSDSManager::createConnection(SessionId sessionId, unsigned mode, unsigned timeout, const char *xpath, CServerRemoteTree *&tree, ConnectionId &connectionId, bool primary, Owned<LinkingCriticalBlock> &connectCritBlock)
+void CCovenSDSManager::createConnection(SessionId sessionId, unsigned mode, unsigned timeout, const char *xpath, CServerRemoteTree *&tree, ConnectionId &connectionId, bool primary, Owned<CConnectCritBlock> &connectCritBlock)
 {
     CRemoteTreeBase *_tree;
     Linked<CRemoteTreeBase> linkedTree;
@@ -7697,20 +8933,20 @@ void CCovenSDSManager::createConnection(SessionId sessionId, unsigned mode, unsi
         class CConnectExistingLockCallback : implements IUnlockCallback
         {
             CUnlockCallback lcb;
-            CheckedCriticalSection *connectCrit;
+            CConnectCritBlock *connectCritBlock;
         public:
-            CConnectExistingLockCallback(const char *xpath, ConnectionId connectionId, CServerRemoteTree &tree, CheckedCriticalSection *_connectCrit) : lcb(xpath, connectionId, tree), connectCrit(_connectCrit) { }
+            CConnectExistingLockCallback(const char *xpath, ConnectionId connectionId, CServerRemoteTree &tree, CConnectCritBlock *_connectCritBlock) : lcb(xpath, connectionId, tree), connectCritBlock(_connectCritBlock) { }
             virtual void block()
             {
-                if (connectCrit)
-                    CHECKEDCRITENTER(*connectCrit, fakeCritTimeout);
+                if (connectCritBlock)
+                    connectCritBlock->enter();
                 lcb.block();
             }
             virtual void unblock()
             {
                 lcb.unblock();
-                if (connectCrit)
-                    CHECKEDCRITLEAVE(*connectCrit);
+                if (connectCritBlock)
+                    connectCritBlock->leave();
             }
         };
 
@@ -7719,8 +8955,9 @@ void CCovenSDSManager::createConnection(SessionId sessionId, unsigned mode, unsi
             CTimeMon tm(timeout);
             connectionId = coven.getUniqueId();
             Owned<CServerConnection> tmpConn = new CServerConnection(*this, connectionId, xpath, sessionId, mode, timeout, NULL, (ConnInfoFlags)0);
-            { CHECKEDCRITICALBLOCK(cTableCrit, fakeCritTimeout);
-                connections.replace(*LINK(tmpConn));
+            { CStripedConnectionTable::Stripe &stripe = connectionTable.queryStripe(connectionId);
+                STRIPECRITICALBLOCK(stripe);
+                stripe.table.replace(*LINK(tmpConn));
             }
             if (sessionId)
             {
@@ -7762,7 +8999,7 @@ void CCovenSDSManager::createConnection(SessionId sessionId, unsigned mode, unsi
                                             {
                                                 CServerRemoteTree &e = freeExistingLocks.existingLockTrees.item(f);
                                                 {
-                                                    CHECKEDCRITICALBLOCK(lockCrit, fakeCritTimeout);
+                                                    CONTENDEDCRITICALBLOCK(lockCrit, lockCritStats);
                                                     CLock *_lock = queryLock(e.queryServerId());
                                                     if (_lock)
                                                     {
@@ -7780,7 +9017,7 @@ void CCovenSDSManager::createConnection(SessionId sessionId, unsigned mode, unsi
                                     }
                                     else
                                         remaining = 0; // a timeout of 0 means fail immediately if locked
-                                    CConnectExistingLockCallback connectLockCallback(xpath, connectionId, existing, &connectCrit);
+                                    CConnectExistingLockCallback connectLockCallback(xpath, connectionId, existing, connectCritBlock.get());
                                     lock(existing, xpath, connectionId, sessionId, mode, remaining, connectLockCallback);
                                 }
                                 if (!queryConnection(connectionId)) // aborted
@@ -7806,15 +9043,17 @@ void CCovenSDSManager::createConnection(SessionId sessionId, unsigned mode, unsi
             }
             catch (IException *)
             {
-                CHECKEDCRITICALBLOCK(cTableCrit, fakeCritTimeout);
+                CStripedConnectionTable::Stripe &stripe = connectionTable.queryStripe(tmpConn->queryConnectionId());
+                STRIPECRITICALBLOCK(stripe);
                 tmpConn->unsubscribeSession();
-                connections.removeExact(tmpConn);
+                stripe.table.removeExact(tmpConn);
                 connectionId = 0;
                 throw;
             }
-            { CHECKEDCRITICALBLOCK(cTableCrit, fakeCritTimeout);
+            { CStripedConnectionTable::Stripe &stripe = connectionTable.queryStripe(tmpConn->queryConnectionId());
+                STRIPECRITICALBLOCK(stripe);
                 tmpConn->unsubscribeSession();
-                connections.removeExact(tmpConn);
+                stripe.table.removeExact(tmpConn);
             }
         }
 
@@ -7864,28 +9103,31 @@ void CCovenSDSManager::createConnection(SessionId sessionId, unsigned mode, unsi
             connectCritBlock.clear();
         }
 
-        { CHECKEDCRITICALBLOCK(cTableCrit, fakeCritTimeout);
-            connections.replace(*LINK(connection));
+        { CStripedConnectionTable::Stripe &stripe = connectionTable.queryStripe(connectionId);
+            STRIPECRITICALBLOCK(stripe);
+            stripe.table.replace(*LINK(connection));
         }
         try
         {
             if (!locked)
             {
-                CConnectExistingLockCallback connectLockCallback(xpath, connectionId, *(CServerRemoteTree *)_tree, connectCritBlock.get()?&connectCrit:NULL);
+                CConnectExistingLockCallback connectLockCallback(xpath, connectionId, *(CServerRemoteTree *)_tree, connectCritBlock.get());
                 lock(*(CServerRemoteTree *)_tree, xpath, connectionId, sessionId, mode, timeout, connectLockCallback);
             }
         }
         catch (IException *)
         {
-            { CHECKEDCRITICALBLOCK(cTableCrit, fakeCritTimeout);
-                connections.removeExact(connection);
+            { CStripedConnectionTable::Stripe &stripe = connectionTable.queryStripe(connectionId);
+                STRIPECRITICALBLOCK(stripe);
+                stripe.table.removeExact(connection);
             }
             throw;
         }
         catch (DALI_CATCHALL)
         {
-            { CHECKEDCRITICALBLOCK(cTableCrit, fakeCritTimeout);
-                connections.removeExact(connection);
+            { CStripedConnectionTable::Stripe &stripe = connectionTable.queryStripe(connectionId);
+                STRIPECRITICALBLOCK(stripe);
+                stripe.table.removeExact(connection);
             }
             throw;
         }
@@ -7927,14 +9169,16 @@ void CCovenSDSManager::createConnection(SessionId sessionId, unsigned mode, unsi
 
 CServerConnection *CCovenSDSManager::queryConnection(ConnectionId id)
 {
-    CHECKEDCRITICALBLOCK(cTableCrit, fakeCritTimeout);
-    return (CServerConnection *)connections.find(&id);
+    CStripedConnectionTable::Stripe &stripe = connectionTable.queryStripe(id);
+    STRIPECRITICALBLOCK(stripe);
+    return (CServerConnection *)stripe.table.find(&id);
 }
 
 CServerConnection *CCovenSDSManager::getConnection(ConnectionId id)
 {
-    CHECKEDCRITICALBLOCK(cTableCrit, fakeCritTimeout);
-    CServerConnection *conn = (CServerConnection *)connections.find(&id);
+    CStripedConnectionTable::Stripe &stripe = connectionTable.queryStripe(id);
+    STRIPECRITICALBLOCK(stripe);
+    CServerConnection *conn = (CServerConnection *)stripe.table.find(&id);
     if (conn) conn->Link();
     return conn;
 }
@@ -7942,11 +9186,12 @@ CServerConnection *CCovenSDSManager::getConnection(ConnectionId id)
 void CCovenSDSManager::disconnect(ConnectionId id, bool deleteRoot, CLCLockBlock *lockBlock)
 {
     Linked<CServerConnection> connection;
-    { CHECKEDCRITICALBLOCK(cTableCrit, fakeCritTimeout);
+    { CStripedConnectionTable::Stripe &stripe = connectionTable.queryStripe(id);
+        STRIPECRITICALBLOCK(stripe);
         connection.set(queryConnection(id));
         if (!connection)
             return;
-        connections.removeExact(connection);
+        stripe.table.removeExact(connection);
     }
     Linked<CServerRemoteTree> tree = (CServerRemoteTree *)connection->queryRootUnvalidated();
     if (!tree) return;
@@ -7956,7 +9201,7 @@ void CCovenSDSManager::disconnect(ConnectionId id, bool deleteRoot, CLCLockBlock
     {
         if (deleteRoot || RTM_MODE(connection->queryMode(), RTM_DELETE_ON_DISCONNECT))
         {
-            CHECKEDCRITICALBLOCK(lockCrit, fakeCritTimeout);
+            CONTENDEDCRITICALBLOCK(lockCrit, lockCritStats);
             CLock *lock = queryLock(tree->queryServerId());
             if (lock)
             {
@@ -8140,14 +9385,13 @@ StringBuffer &formatSubscribers(MemoryBuffer &src, StringBuffer &out)
 
 unsigned CCovenSDSManager::countConnections()
 {
-    CHECKEDCRITICALBLOCK(cTableCrit, fakeCritTimeout);
-    return connections.count();
+    return connectionTable.count();
 }
 
 unsigned CCovenSDSManager::countActiveLocks()
 {
     unsigned activeLocks = 0;
-    CHECKEDCRITICALBLOCK(lockCrit, fakeCritTimeout);
+    CONTENDEDCRITICALBLOCK(lockCrit, lockCritStats);
     SuperHashIteratorOf<CLock> iter(lockTable.queryBaseTable());
     ForEach(iter) {
         CLock &lock = iter.query();
@@ -8164,7 +9408,7 @@ ILockInfoCollection *CCovenSDSManager::getLocks(const char *ipPattern, const cha
     bool filteredXPaths = !isEmptyString(xpathPattern);
     CLockInfoArray locks;
     {
-        CHECKEDCRITICALBLOCK(lockCrit, fakeCritTimeout);
+        CONTENDEDCRITICALBLOCK(lockCrit, lockCritStats);
         SuperHashIteratorOf<CLock> iter(lockTable.queryBaseTable());
         ForEach(iter)
         {
@@ -8191,11 +9435,9 @@ ILockInfoCollection *CCovenSDSManager::getLocks(const char *ipPattern, const cha
 
 MemoryBuffer &CCovenSDSManager::collectUsageStats(MemoryBuffer &out)
 {
-    { CHECKEDCRITICALBLOCK(cTableCrit, fakeCritTimeout);
-        out.append(connections.count());
-    }
+    out.append(connectionTable.count());
     unsigned activeLocks = 0;
-    { CHECKEDCRITICALBLOCK(lockCrit, fakeCritTimeout);
+    { CONTENDEDCRITICALBLOCK(lockCrit, lockCritStats);
         SuperHashIteratorOf<CLock> iter(lockTable.queryBaseTable());
         ForEach(iter)
         {
@@ -8211,11 +9453,18 @@ MemoryBuffer &CCovenSDSManager::collectUsageStats(MemoryBuffer &out)
 
 MemoryBuffer &CCovenSDSManager::collectConnections(MemoryBuffer &out)
 {
-    CHECKEDCRITICALBLOCK(cTableCrit, fakeCritTimeout);
-    out.append(connections.count());
-    SuperHashIteratorOf<CServerConnection> iter(connections.queryBaseTable());
-    ForEach(iter)
-        iter.query().getInfo(out);
+    IArrayOf<CServerConnection> conns;
+    for (unsigned s=0; s<connectionTable.numStripes(); s++)
+    {
+        CStripedConnectionTable::Stripe &stripe = connectionTable.queryStripeN(s);
+        STRIPECRITICALBLOCK(stripe);
+        SuperHashIteratorOf<CServerConnection> iter(stripe.table.queryBaseTable());
+        ForEach(iter)
+            conns.append(*LINK(&iter.query()));
+    }
+    out.append(conns.ordinality());
+    ForEachItemIn(c, conns)
+        conns.item(c).getInfo(out);
     return out;
 }
 
@@ -8269,6 +9518,15 @@ StringBuffer &CCovenSDSManager::getExternalReport(StringBuffer &out)
     return out;
 }
 
+StringBuffer &CCovenSDSManager::getContentionStats(StringBuffer &out)
+{
+    connectStripes.getStats(out);
+    connectionTable.getStats(out);
+    subscriberNotificationTable.getStats(out);
+    lockCritStats.toString(out.append("lock table: ")).newline();
+    return out;
+}
+
 StringBuffer &CCovenSDSManager::getConnections(StringBuffer &out)
 {
     MemoryBuffer mb;
@@ -8371,9 +9629,10 @@ void CCovenSDSManager::handleNotify(CSubscriberContainerBase *_subscriber, Memor
         factory->Release();
     }
 
-    CHECKEDCRITICALBLOCK(nfyTableCrit, fakeCritTimeout);
     SubscriptionId id = subscriber->queryId();
-    CSubscriberNotifier *notifier = subscriberNotificationTable.find(id);
+    CStripedNotifierTable::Stripe &stripe = subscriberNotificationTable.queryStripe(id);
+    STRIPECRITICALBLOCK(stripe);
+    CSubscriberNotifier *notifier = stripe.table.find(id);
 
     /* Must clear 'subscriber' before leaving ntyTableCrit block, so that the notifier thread owns and destroys it
      * It cannot be destroyed here, because this method may have been called inside the SDS lock during a node
@@ -8387,8 +9646,8 @@ void CCovenSDSManager::handleNotify(CSubscriberContainerBase *_subscriber, Memor
     }
     else
     {
-        Owned<CSubscriberNotifier> _notifier = new CSubscriberNotifier(subscriberNotificationTable, *subscriber.getClear(), notifyData);
-        subscriberNotificationTable.replace(*_notifier);
+        Owned<CSubscriberNotifier> _notifier = new CSubscriberNotifier(stripe, *subscriber.getClear(), notifyData);
+        stripe.table.replace(*_notifier);
         notifyPool->start(_notifier.getClear()); // NB: takes ownership (during init())
     }
 }
@@ -9248,6 +10507,64 @@ void LogRemoteConn(IRemoteConnection *conn)
 }
 
 
+#ifdef _USE_CPPUNIT
+/*
+ * The attribute index, on a plain tree rather than the server's store, for the unit tests.
+ * Nodes are identified by a table that links them, so a deleted node is still resolved but no longer found in the branch.
+ */
+class CSDSTestAttributeIndex final : public CSDSAttributeIndex
+{
+    std::unordered_map<IPropertyTree *, __int64> ids;
+    std::vector<Linked<IPropertyTree>> nodes; // by id-1
+protected:
+    virtual __int64 queryNodeId(IPropertyTree &node) override
+    {
+        auto it = ids.find(&node);
+        if (it != ids.end())
+            return it->second;
+        nodes.emplace_back(&node);
+        __int64 id = nodes.size();
+        ids[&node] = id;
+        return id;
+    }
+    virtual IPropertyTree *queryNode(__int64 id) override { return nodes[id-1]; }
+public:
+    CSDSTestAttributeIndex(const char *_branchXPath, const char *attributeList) : CSDSAttributeIndex(_branchXPath, attributeList) { }
+};
+
+static Owned<IPropertyTree> testIndexStore;
+static Owned<CSDSTestAttributeIndex> testAttributeIndex;
+
+extern da_decl void setTestAttributeIndex(IPropertyTree *store, const char *branchXPath, const char *attributes)
+{
+    testIndexStore.set(store);
+    testAttributeIndex.setown(store ? new CSDSTestAttributeIndex(branchXPath, attributes) : nullptr);
+}
+
+// Returns the getXPaths match tree for xpath, relative to the indexed branch, and whether the index answered it
+extern da_decl IPropertyTree *getTestAttributeIndexXPaths(const char *xpath, bool &indexed)
+{
+    IPropertyTree *branch = testIndexStore->queryPropTree(testAttributeIndex->queryBranchXPath());
+    assertex(branch);
+    IPropertyTree *matchTree = nullptr;
+    indexed = testAttributeIndex->getXPathMatchTree(*testIndexStore, *branch, xpath, matchTree);
+    if (!indexed)
+        matchTree = getXPathMatchTree(*branch, xpath);
+    return matchTree;
+}
+
+// Applies a delta, in the <Header path="..."><Delta><T>...</T></Delta></Header> format of the delta files, to the store and notes it with the index
+extern da_decl void applyTestAttributeIndexDelta(const char *deltaXml)
+{
+    Owned<IPropertyTree> header = createPTreeFromXMLString(deltaXml);
+    testAttributeIndex->noteChange(header->queryProp("@path"), *header->queryPropTree("Delta/T"));
+    StringBuffer xml(deltaXml);
+    Owned<IFileIO> io = createIFileIO(xml);
+    Owned<IFileIOStream> stream = createIOStream(io);
+    verifyex(applyXmlDeltas(*testIndexStore, *stream, true));
+}
+#endif
+
 #ifdef _POOLED_SERVER_REMOTE_TREE
 
 MODULE_INIT(INIT_PRIORITY_STANDARD)
@@ -173,6 +173,7 @@ interface ISDSManagerServer : extends ISDSManager
     virtual unsigned queryCommitMeanSize() const = 0;
     virtual void saveRequest() = 0;
     virtual bool unlock(__int64 connectionId, bool closeConn, StringBuffer &connectionInfo) = 0;
+    virtual StringBuffer &getContentionStats(StringBuffer &out) = 0; // connect, connection table and lock table contention
 };
 
 
@@ -269,6 +270,7 @@ enum
     SH_RecoverFromIncErrors = 0x0002,
     SH_BackupErrorFiles     = 0x0004,
     SH_CheckNewDelta        = 0x0008,
+    SH_BinaryStore          = 0x0010,   // also save a binary checkpoint of the store, for faster loading
 };
 extern da_decl IStoreHelper *createStoreHelper(const char *storeName, const char *location, const char *remoteBackupLocation, unsigned configFlags, unsigned keepStores=0, unsigned delay=5000, const bool *abort=NULL);
 extern da_decl bool applyXmlDeltas(IPropertyTree &root, IIOStream &stream, bool stopOnError=false);
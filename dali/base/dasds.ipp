@@ -528,9 +528,6 @@ public:
     virtual IPropertyTree *getXPaths(__int64 serverId, const char *xpath, bool getServerIds=false) = 0;
     virtual IPropertyTreeIterator *getXPathsSortLimit(const char *baseXPath, const char *matchXPath, const char *sortby, bool caseinsensitive, bool ascending, unsigned from, unsigned limit) = 0;
     virtual void getExternalValueFromServerId(__int64 serverId, MemoryBuffer &mb) = 0;
-
-protected:
-    CConnectionHashTable connections;
 };
 
 class DaliPTArrayIterator : public CArrayIteratorOf<IPropertyTree, IPropertyTreeIterator>
@@ -32,7 +32,7 @@
 
 #include "environment.hpp"
 
-static const char *cmds[] = { "locks", "sdsstats", "sdssubscribers", "connections", "threads", "mpqueue", "clients", "mpverify", "timeq", "cleanq",  "timesds", "build", "sdsfetch", "dirparts", "sdssize", "nodeinfo", "slavenode", "backuplist", "save", NULL };
+static const char *cmds[] = { "locks", "sdsstats", "sdscontention", "sdssubscribers", "connections", "threads", "mpqueue", "clients", "mpverify", "timeq", "cleanq",  "timesds", "build", "sdsfetch", "dirparts", "sdssize", "nodeinfo", "slavenode", "backuplist", "save", NULL };
 
 void usage(const char *exe)
 {
@@ -40,6 +40,7 @@ void usage(const char *exe)
     printf("Commands:\n");
     printf("-locks              -- list active SDS locks\n");
     printf("-sdsstats           -- SDS statistics\n");
+    printf("-sdscontention      -- SDS connect/connection/lock table contention statistics\n");
     printf("-sdssubscribers     -- list active SDS subscribers\n");
     printf("-connections        -- list SDS connections\n");
     printf("-allowlist          -- list entries in allowlist\n");
@@ -827,6 +827,7 @@ public:
     CICopyArrayOf<EclGraphElement> dependentOnActivity;
     IntArray dependentControlId;
     IProbeManager * probeManager;
+    IArrayOf<IHThorInput> readAheads;
 
     Owned<EclBoundLoopGraph> loopGraph;
 };
@@ -1005,6 +1006,7 @@ public:
 
 protected:
     void doExecute(const byte * parentExtract, bool checkDependencies);
+    bool canExecuteSinksInParallel() const;
     void cleanupActivities();
     bool prepare(const byte * parentExtract, bool checkDependencies);
 
@@ -1084,6 +1086,11 @@ public:
         graphAgentContext.set(&_agent);
         agent = &graphAgentContext;
         aborted = false;
+        if (wu)
+        {
+            readAheadRows = wu->getDebugValueInt("hthorReadAhead", 0);
+            parallelSinks = wu->getDebugValueBool("hthorParallelSinks", false);
+        }
     }
 
     void createFromXGMML(ILoadedDllEntry * dll, IPropertyTree * xgmml);
@@ -1106,6 +1113,8 @@ public:
 
     inline bool queryLibrary() const { return isLibrary; }
     inline unsigned queryWfid() const { return wfid; }
+    inline unsigned queryReadAheadRows() const { return readAheadRows; }
+    inline bool queryParallelSinks() const { return parallelSinks; }
 
 protected:
     IAgentContext * agent;
@@ -1118,6 +1127,8 @@ protected:
     CHThorDebugContext * debugContext;
     IProbeManager * probeManager;
     unsigned wfid;
+    unsigned readAheadRows = 0;     // Number of rows read ahead on a separate thread for cpu intensive activities (0 = disabled)
+    bool parallelSinks = false;     // Execute the independent sinks of a subgraph concurrently
     bool aborted;
 };
 
@@ -22,6 +22,7 @@
 #include "jprop.hpp"
 #include "jfile.hpp"
 #include "jsocket.hpp"
+#include "jthread.hpp"
 #include "jregexp.hpp"
 #include "mplog.hpp"
 #include "eclagent.ipp"
@@ -46,6 +47,45 @@ using roxiemem::OwnedRoxieString;
 
 //---------------------------------------------------------------------------
 
+//Activities which perform a (potentially expensive) transform of each input row, and never step their input.  If
+//read ahead is enabled the input of these activities is read on a separate thread.
+static bool isReadAheadConsumer(ThorActivityKind kind)
+{
+    switch (kind)
+    {
+    case TAKproject:
+    case TAKfilterproject:
+    case TAKcountproject:
+    case TAKnormalize:
+    case TAKparse:
+    case TAKxmlparse:
+        return true;
+    default:
+        return false;
+    }
+}
+
+//Sinks whose only side effect is to write a result or a file, so independent instances can be executed concurrently
+static bool canExecuteSinkInParallel(ThorActivityKind kind)
+{
+    switch (kind)
+    {
+    case TAKdiskwrite:
+    case TAKspillwrite:
+    case TAKcsvwrite:
+    case TAKxmlwrite:
+    case TAKjsonwrite:
+    case TAKindexwrite:
+    case TAKworkunitwrite:
+    case TAKdictionaryworkunitwrite:
+    case TAKlocalresultwrite:
+    case TAKdictionaryresultwrite:
+        return true;
+    default:
+        return false;
+    }
+}
+
 static IHThorActivity * createActivity(IAgentContext & agent, unsigned activityId, unsigned subgraphId, unsigned graphId, ThorActivityKind kind, bool isLocal, bool isGrouped, IHThorArg & arg, IPropertyTree * node, EclGraphElement * graphElement)
 {
     EclGraph & graph = graphElement->subgraph->parent;
@@ -518,6 +558,14 @@ void EclGraphElement::createActivity(IAgentContext & agent, EclSubGraph * owner)
                 else
                 {
                     useInput = input.queryOutput(branchIndexes.item(i2));
+                    //Only used within top level subgraphs - child queries are executed too many times to benefit
+                    unsigned readAheadRows = subgraph->parent.queryReadAheadRows();
+                    if (readAheadRows && useInput && isReadAheadConsumer(kind) && !subgraph->owner && !subgraph->debugContext)
+                    {
+                        IHThorInput * readAhead = createReadAheadInput(useInput, readAheadRows);
+                        readAheads.append(*readAhead);
+                        useInput = readAhead;
+                    }
                 }
                 activity->setInput(i2, useInput);
             }
@@ -945,6 +993,21 @@ bool EclSubGraph::prepare(const byte * parentExtract, bool checkDependencies)
 }
 
 
+bool EclSubGraph::canExecuteSinksInParallel() const
+{
+    //Only top level subgraphs, and not when debugging since the debugger assumes a single thread of execution
+    if ((sinks.ordinality() < 2) || !parent.queryParallelSinks() || owner || debugContext)
+        return false;
+    //The sinks within a subgraph are independent (hthor graphs do not contain splitters), but only execute them in
+    //parallel if they do not have any other side effects.
+    ForEachItemIn(i, sinks)
+    {
+        if (!canExecuteSinkInParallel(sinks.item(i).kind))
+            return false;
+    }
+    return true;
+}
+
 void EclSubGraph::doExecute(const byte * parentExtract, bool checkDependencies)
 {
     if (executed)
@@ -982,8 +1045,13 @@ void EclSubGraph::doExecute(const byte * parentExtract, bool checkDependencies)
     IException *e = nullptr;
     try
     {
-        ForEachItemIn(ie, sinks)
-           sinks.item(ie).execute();
+        if (canExecuteSinksInParallel())
+            asyncFor(sinks.ordinality(), [&](unsigned i) { sinks.item(i).execute(); });
+        else
+        {
+            ForEachItemIn(ie, sinks)
+               sinks.item(ie).execute();
+        }
     }
     catch (IException * _e)
     {
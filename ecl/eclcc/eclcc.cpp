@@ -385,6 +385,8 @@ protected:
     StringArray allowSignedPermissions;
     StringArray deniedPermissions;
     StringAttr optMetaLocation;
+    StringAttr optObjectCacheLocation;
+    unsigned optObjectCacheMaxSizeMB = DEFAULT_OBJECT_CACHE_MAX_MB;
     StringBuffer neverSimplifyRegEx;
     StringAttr optDefaultGitPrefix;
     StringAttr optGitUser;
@@ -794,6 +796,7 @@ ICppCompiler * EclCC::createCompiler(const char * coreName, const char * sourceD
     Owned<ICppCompiler> compiler = ::createCompiler(coreName, sourceDir, targetDir, optTargetCompiler, logVerbose, compileBatchOut);
     compiler->setOnlyCompile(optOnlyCompile);
     compiler->setCCLogPath(cclogFilename);
+    compiler->setObjectCacheDir(optObjectCacheLocation, optObjectCacheMaxSizeMB);
 
     ForEachItemIn(iComp, compileOptions)
         compiler->addCompileOption(compileOptions.item(iComp));
@@ -1479,6 +1482,9 @@ void EclCC::processSingleQuery(const EclRepositoryManager & localRepositoryManag
             {
                 updateWorkunitStat(instance.wu, SSToperation, ">compile:>parse", StNumAttribsProcessed, NULL, parseCtx.numAttribsProcessed);
             }
+            //Definitions with a valid cache entry are still parsed - only the rewrite of the entry is avoided
+            if (cache && logVerbose)
+                DBGLOG("%u of %u definitions had a valid cache entry", parseCtx.numCacheEntriesValid, parseCtx.numAttribsProcessed);
 
             if (exportDependencies)
             {
@@ -2952,6 +2958,16 @@ int EclCC::parseCommandLineOptions(int argc, const char* argv[])
             else
                 optMetaLocation.clear();
         }
+        else if (iter.matchOption(tempArg, "--objcache"))
+        {
+            if (!tempArg.isEmpty())
+                optObjectCacheLocation.set(tempArg);
+            else
+                optObjectCacheLocation.clear();
+        }
+        else if (iter.matchOption(optObjectCacheMaxSizeMB, "--objcachesize"))
+        {
+        }
         else if (iter.matchOption(tempArg, "--neversimplify"))
         {
             appendNeverSimplifyList(tempArg);
@@ -2977,6 +2993,13 @@ int EclCC::parseCommandLineOptions(int argc, const char* argv[])
         else if (iter.matchFlag(optGenerateHeader, "-pch"))
         {
         }
+        else if (iter.matchOption(tempArg, "--profile"))
+        {
+            //Equivalent to -fprofileWorkunit=x
+            StringBuffer option;
+            option.append("profileWorkunit=").append(tempArg);
+            debugOptions.append(option);
+        }
         else if (iter.matchFlag(optPruneArchive, "--prunearchive"))
         {
         }
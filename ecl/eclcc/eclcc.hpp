@@ -121,10 +121,13 @@ const char * const helpText[] = {
     "!   --nogpg       Do not run gpg to check signatures on signed code",
     "    --nosourcepath Compile as if the source came from stdin",
     "?!  --nostdinc    Do not include the current directory in -I",
+    "!   --objcache=x  Reuse object files from directory x for generated c++ files that are unchanged",
+    "!   --objcachesize=n Prune the object cache to below n MB (default 2048, 0 = unlimited)",
 #ifndef _WIN32
     "!   -pch          Generate precompiled header for eclinclude4.hpp",
 #endif
     "!   -P <path>     Specify the path of the output files (only with -b option)",
+    "!   --profile=x   Use the activity statistics from workunit x (a wuid or file) to guide code generation",
     "!   --prunearchive Do not include plugins and standard library in the archive (defaults on)",
     "?   -R<repo>[#version]=path Resolve repository references in directory 'path'",
     "!   --regeneratecache Force regeneration of cache (overwrite existing cache)",
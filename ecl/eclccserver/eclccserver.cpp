@@ -133,6 +133,8 @@ private:
 //------------------------------------------------------------------------------------------------------------------
 
 static bool useChildProcesses = false;      // Use k8s jobs for compile tasks
+static unsigned maxCompileJobs = 0;         // Limit on the number of c++ compiler processes across all compile threads (0 = no limit)
+static Semaphore compileJobSlots;
 static unsigned childProcessTimeLimit = 0;  // If using k8s jobs to compile, try a child process first but abort if it takes longer than this time (seconds)
 
 class AbortWaiter : public Thread
@@ -243,6 +245,7 @@ class EclccCompileThread : implements IPooledThread, implements IErrorReporter,
     StringArray filesSeen;
     StringBuffer repoRootPath;
     unsigned defaultMaxCompileThreads = 1;
+    RelaxedAtomic<unsigned> objectCacheHits = { 0 };
     bool saveTemps = false;
 
     virtual void reportError(IException *e)
@@ -444,20 +447,63 @@ class EclccCompileThread : implements IPooledThread, implements IErrorReporter,
             remove(line + 3);
             return 0;
         }
-        else if (!alreadyFailed)
+        else if (startsWith(line, "cached "))
         {
-            DBGLOG("Executing %s", line);
-            unsigned retcode = doRunCompileCommand(abortWaiter, output, line);
-            if (retcode)
-                DBGLOG("Error: retcode=%u executing %s", retcode, line);
+            // cached <cache-file>\t<object-file>\t<compile-command>
+            StringArray parts;
+            parts.appendList(line+7, "\t", false);
+            if (parts.ordinality() != 3)
+            {
+                DBGLOG("Invalid cached compile line %s", line);
+                return 1;
+            }
+            const char * cacheName = parts.item(0);
+            const char * objectName = parts.item(1);
+            if (copyFromObjectCache(cacheName, objectName))
+            {
+                DBGLOG("Reusing cached object %s for %s", cacheName, objectName);
+                objectCacheHits++;
+                return 0;
+            }
+            if (alreadyFailed)
+                return 0;
+            unsigned retcode = runCompileCommand(abortWaiter, output, parts.item(2));
+            if (retcode == 0)
+                addToObjectCache(cacheName, objectName, getComponentConfigSP()->getPropInt("@objectCacheMaxSize", DEFAULT_OBJECT_CACHE_MAX_MB));
             return retcode;
         }
+        else if (!alreadyFailed)
+            return runCompileCommand(abortWaiter, output, line);
         return 0;
     }
 
+    unsigned runCompileCommand(AbortWaiter &abortWaiter, StringBuffer &output, const char *cmd)
+    {
+        DBGLOG("Executing %s", cmd);
+        if (maxCompileJobs)
+            compileJobSlots.wait();
+        unsigned retcode;
+        try
+        {
+            retcode = doRunCompileCommand(abortWaiter, output, cmd);
+        }
+        catch (...)
+        {
+            if (maxCompileJobs)
+                compileJobSlots.signal();
+            throw;
+        }
+        if (maxCompileJobs)
+            compileJobSlots.signal();
+        if (retcode)
+            DBGLOG("Error: retcode=%u executing %s", retcode, cmd);
+        return retcode;
+    }
+
     unsigned doCompileCpp(AbortWaiter &abortWaiter, const char *wuid, unsigned maxThreads)
     {
         RelaxedAtomic<unsigned> numFailed = { 0 };
+        objectCacheHits = 0;
         if (!maxThreads)
             maxThreads = 1;
         VStringBuffer ccfileName("%s.cc", wuid);
@@ -502,6 +548,8 @@ class EclccCompileThread : implements IPooledThread, implements IErrorReporter,
                     throw;
                 }
             });
+            if (objectCacheHits)
+                DBGLOG("Reused %u of %u objects from the object cache", (unsigned)objectCacheHits, lineIdx-firstCompile);
         }
         while (lines.isItem(lineIdx))
         {
@@ -608,7 +656,22 @@ class EclccCompileThread : implements IPooledThread, implements IErrorReporter,
             eclccCmd.append(" -main \"").append(mainDefinition).append("\"");
         eclccCmd.append(" --timings");
         eclccCmd.append(" --nostdinc");
-        eclccCmd.append(" --metacache=");
+        //A shared definition cache avoids regenerating the cache entries for unchanged definitions on every compile.
+        //The entries are validated using the hash of the source, so they remain valid for fresh clones of a repository.
+        Owned<IPropertyTree> config = getComponentConfig();
+        const char * metaCacheDir = config->queryProp("@metaCacheDirectory");
+        if (!isEmptyString(metaCacheDir))
+            eclccCmd.appendf(" \"--metacache=%s\"", metaCacheDir);
+        else
+            eclccCmd.append(" --metacache=");
+        //Objects for generated files that are unchanged since a previous compile (e.g. republishing a query after a
+        //change to a single attribute) are copied from the shared object cache rather than recompiled.
+        const char * objectCacheDir = config->queryProp("@objectCacheDirectory");
+        if (!isEmptyString(objectCacheDir))
+        {
+            eclccCmd.appendf(" \"--objcache=%s\"", objectCacheDir);
+            eclccCmd.appendf(" --objcachesize=%u", config->getPropInt("@objectCacheMaxSize", DEFAULT_OBJECT_CACHE_MAX_MB));
+        }
 
 #ifdef _CONTAINERIZED
         /* stderr is reserved for actual errors, and is consumed by this (parent) process
@@ -622,7 +685,6 @@ class EclccCompileThread : implements IPooledThread, implements IErrorReporter,
         if (syntaxCheck)
             eclccCmd.appendf(" -syntax");
 
-        Owned<IPropertyTree> config = getComponentConfig();
         if (config->getPropBool("@enableEclccDali", true))
         {
             const char *daliServers = config->queryProp("@daliServers");
@@ -721,6 +783,8 @@ class EclccCompileThread : implements IPooledThread, implements IErrorReporter,
                 retcode = doCompileCpp(abortWaiter, wuid, workunit->getDebugValueInt("maxCompileThreads", defaultMaxCompileThreads));
                 unsigned __int64 elapsed_compilecpp = cycle_to_nanosec(get_cycles_now() - startCompileCpp);
                 workunit->setStatistic(queryStatisticsComponentType(), queryStatisticsComponentName(), SSToperation, ">compile:>compile c++", StTimeElapsed, NULL, elapsed_compilecpp, 1, 0, StatsMergeReplace);
+                if (objectCacheHits)
+                    workunit->setStatistic(queryStatisticsComponentType(), queryStatisticsComponentName(), SSToperation, ">compile:>compile c++", StNumObjectsFromCache, NULL, objectCacheHits, 1, 0, StatsMergeReplace);
             }
             if (compileCppSeparately)
             {
@@ -1453,6 +1517,9 @@ int main(int argc, const char *argv[])
             // still accept the old name if the new one is not present.
             unsigned maxThreads = globals->getPropInt("@maxEclccProcesses", globals->getPropInt("@maxCompileThreads", 4));
 #endif
+            maxCompileJobs = globals->getPropInt("@maxCompileJobs", 0);
+            if (maxCompileJobs)
+                compileJobSlots.signal(maxCompileJobs);
             EclccServer server(queueNames.str(), maxThreads);
             // if we got here, eclserver is successfully started and all options are good, so create the "sentinel file" for re-runs from the script
             // put in its own "scope" to force the flush
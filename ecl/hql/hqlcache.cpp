@@ -24,6 +24,7 @@
 #include "hqlerrors.hpp"
 #include "junicode.hpp"
 #include "hqlplugins.hpp"
+#include "eclrtl.hpp"
 
 //---------------------------------------------------------------------------------------------------------------------
 
@@ -33,6 +34,15 @@ void setTraceCache(bool value)
     traceCache = value;
 }
 
+//The cache may be shared by multiple compile threads.  A single lock is used to check if entries are up to date, since
+//the check recurses through the dependencies, and the dependencies may form a cycle.
+static CriticalSection cacheCrit;
+
+hash64_t getEclSourceHash(IFileContents * contents)
+{
+    return rtlHash64Data(contents->length(), contents->getText(), HASH64_INIT);
+}
+
 /*
  * Base class for implementing a cache entry for a single source file.
  */
@@ -47,6 +57,7 @@ public:
 
 protected:
     virtual bool calcUpToDate(hash64_t optionHash) const;
+    virtual hash64_t getSourceHash() const { return 0; } // 0 if not known
 
 protected:
     mutable bool cachedUpToDate = false;
@@ -57,7 +68,7 @@ protected:
 
 bool EclCachedDefinition::isUpToDate(hash64_t optionHash) const
 {
-    //MORE: Improve thread safety if this object is shared between multiple threads.
+    CriticalBlock block(cacheCrit);
     if (!cachedUpToDate)
     {
         cachedUpToDate = true;
@@ -87,10 +98,20 @@ bool EclCachedDefinition::calcUpToDate(hash64_t optionHash) const
     if (!contents)
         return false;
 
-    //If the cached information is younger than the original ecl then not valid
-    timestamp_type originalTs = contents->getTimeStamp();
-    if ((originalTs == 0) || (getTimeStamp() < originalTs))
-        return false;
+    //If the hash of the source was recorded then it determines whether the entry is valid, otherwise if the cached
+    //information is younger than the original ecl then not valid
+    hash64_t sourceHash = getSourceHash();
+    if (sourceHash)
+    {
+        if (sourceHash != getEclSourceHash(contents))
+            return false;
+    }
+    else
+    {
+        timestamp_type originalTs = contents->getTimeStamp();
+        if ((originalTs == 0) || (getTimeStamp() < originalTs))
+            return false;
+    }
 
     StringArray dependencies;
     queryDependencies(dependencies);
@@ -131,6 +152,10 @@ protected:
             return false;
         return EclCachedDefinition::calcUpToDate(optionHash);
     }
+    virtual hash64_t getSourceHash() const override
+    {
+        return cacheTree ? (hash64_t)cacheTree->getPropInt64("@srcHash") : 0;
+    }
 
     const char * queryName() const { return cacheTree ? cacheTree->queryProp("@name") : nullptr; }
 
@@ -211,6 +236,7 @@ protected:
 protected:
     Linked<IEclRepository> repository;
     MapStringToMyClass<IEclCachedDefinition> map;
+    CriticalSection mapCrit;
 };
 
 
@@ -218,6 +244,7 @@ IEclCachedDefinition * EclCachedDefinitionCollection::getDefinition(const char *
 {
     StringBuffer lowerPath;
     lowerPath.append(eclpath).toLowerCase();
+    CriticalBlock block(mapCrit);
     IEclCachedDefinition * match = map.getValue(lowerPath);
     if (match)
         return LINK(match);
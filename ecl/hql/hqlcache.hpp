@@ -98,6 +98,14 @@ extern HQL_API void updateArchiveFromCache(IPropertyTree * archive, IEclCachedDe
  */
 extern HQL_API void expandArchive(const char * path, IPropertyTree * archive, bool includePlugins);
 
+/*
+ * Calculate the hash of the source of a definition.  It is stored in the cache entry so the entry remains valid if the
+ * source is unchanged, even if the timestamp of the source file has changed (e.g. a fresh checkout of a repository).
+ *
+ * @param contents      The source of the definition.
+ */
+extern HQL_API hash64_t getEclSourceHash(IFileContents * contents);
+
 //Shared functions
 void setDefinitionText(IPropertyTree * target, const char * prop, IFileContents * contents, bool checkDirty);
 
@@ -329,7 +329,13 @@ PURE(expression) - treat an expression as pure - probably superseded with WITHIN
 
 //---------------------------------------------------------------------------------------------------------------------
 
-const unsigned InitialExprCacheSize = 0x1000U; // Allocating larger than default has a very minor benefit
+//The table of commoned up expressions is split into shards, each with its own lock, so that threads creating expressions
+//in parallel rarely contend.  The shard is selected from the top bits of the hash since the table uses the bottom bits.
+const unsigned NumExprCacheShards = 16;         // must be a power of 2
+const unsigned ExprCacheShardShift = 28;
+const unsigned InitialExprCacheSize = 0x400U;   // Per shard.  Allocating larger than default has a very minor benefit
+static_assert((1U << (32 - ExprCacheShardShift)) == NumExprCacheShards, "Shard shift does not match the number of shards");
+
 class HqlExprCache : public JavaHashTableOf<CHqlExpression>
 {
 public:
@@ -357,7 +363,8 @@ protected:
 static Mutex * transformMutex;
 static CriticalSection * transformCS;
 static Semaphore * transformSemaphore;
-static HqlExprCache *exprCache;
+static HqlExprCache * exprCache[NumExprCacheShards];
+static inline unsigned getExprCacheShard(unsigned hash) { return hash >> ExprCacheShardShift; }
 static CriticalSection * nullIntCS;
 static CriticalSection * unadornedCS;
 static CriticalSection * sourcePathCS;
@@ -390,7 +397,7 @@ static IHqlExpression * processingMarker;
 static IHqlExpression * mergePendingMarker;
 static IHqlExpression * mergeNoMatchMarker;
 static IHqlExpression * nullIntValue[9][2];
-static CriticalSection * exprCacheCS;
+static CriticalSection * exprCacheCS;       // one per shard
 static CriticalSection * crcCS;
 static KeptAtomTable * sourcePaths;
 
@@ -436,9 +443,10 @@ MODULE_INIT(INIT_PRIORITY_HQLINTERNAL)
     transformMutex = new Mutex;
     transformCS = new CriticalSection;
     transformSemaphore = new Semaphore(NUM_PARALLEL_TRANSFORMS);
-    exprCacheCS = new CriticalSection;
+    exprCacheCS = new CriticalSection[NumExprCacheShards];
     crcCS = new CriticalSection;
-    exprCache = new HqlExprCache;
+    for (unsigned shard=0; shard < NumExprCacheShards; shard++)
+        exprCache[shard] = new HqlExprCache;
     nullIntCS = new CriticalSection;
     unadornedCS = new CriticalSection;
     sourcePathCS = new CriticalSection;
@@ -477,7 +485,8 @@ MODULE_INIT(INIT_PRIORITY_HQLINTERNAL)
 MODULE_EXIT()
 {
 #ifdef TRACE_HASH
-    exprCache->dumpStats();
+    for (unsigned shard=0; shard < NumExprCacheShards; shard++)
+        exprCache[shard]->dumpStats();
 #endif
     for (unsigned i=0; i<=8; i++)
     {
@@ -513,25 +522,29 @@ MODULE_EXIT()
     nullType->Release();
 
 #ifdef _REPORT_EXPRESSION_LEAKS
-    if (exprCache->count())
+    unsigned numLeaked = 0;
+    for (unsigned shard=0; shard < NumExprCacheShards; shard++)
     {
 #if 0 // Place debugging code inside here
-        JavaHashIteratorOf<IHqlExpression> iter(*exprCache, false);
+        JavaHashIteratorOf<IHqlExpression> iter(*exprCache[shard], false);
         ForEach(iter)
         {
             IHqlExpression & ret = iter.query();
         }
 #endif
-        fprintf(stderr, "%s Hash table contains %d entries\n", activeSource.str(), exprCache->count());
+        numLeaked += exprCache[shard]->count();
     }
+    if (numLeaked)
+        fprintf(stderr, "%s Hash table contains %d entries\n", activeSource.str(), numLeaked);
 #endif
 
     ::Release(sourcePaths);
     delete sourcePathCS;
     delete unadornedCS;
     delete nullIntCS;
-    exprCache->Release();
-    delete exprCacheCS;
+    for (unsigned shard=0; shard < NumExprCacheShards; shard++)
+        exprCache[shard]->Release();
+    delete [] exprCacheCS;
     delete crcCS;
     delete transformMutex;
     delete transformCS;
@@ -546,13 +559,16 @@ MODULE_INIT(INIT_PRIORITY_STANDARD)
 }
 MODULE_EXIT()
 {
-    for (auto & cur  : *exprCache)
+    for (unsigned shard=0; shard < NumExprCacheShards; shard++)
     {
-        if (cur.getOperator() == no_constant)
+        for (auto & cur  : *exprCache[shard])
         {
-            StringBuffer text;
-            toECL(cur.queryBody(), text, false);
-            printf("CONST:%" I64F "u:%s", querySeqId(&cur), text.str());
+            if (cur.getOperator() == no_constant)
+            {
+                StringBuffer text;
+                toECL(cur.queryBody(), text, false);
+                printf("CONST:%" I64F "u:%s", querySeqId(&cur), text.str());
+            }
         }
     }
 
@@ -952,6 +968,9 @@ void HqlParseContext::noteBeginAttribute(const char * package, IHqlScope * scope
         setDefinitionText(attr, "", contents, checkDirty);
     }
 
+    if (hasCacheLocation())
+        curMeta().sourceHash = getEclSourceHash(contents);
+
     ISourcePath * sourcePath = contents->querySourcePath();
 
     if (checkBeginMeta())
@@ -1011,6 +1030,9 @@ void HqlParseContext::noteBeginModule(const char * package, IHqlScope * scope, I
         }
     }
 
+    if (hasCacheLocation())
+        curMeta().sourceHash = getEclSourceHash(contents);
+
     if (checkBeginMeta())
     {
         IPropertyTree * attr = beginMetaSource(contents);
@@ -1113,6 +1135,8 @@ bool HqlParseContext::createCache(bool isMacro)
         stream.setown(createBufferedIOStream(stream));
         writeStringToStream(*stream, "<Cache");
         VStringBuffer extraText(" hash=\"%" I64F "d\"", (__int64) optionHash);
+        if (curMeta().sourceHash)
+            extraText.appendf(" srcHash=\"%" I64F "d\"", (__int64) curMeta().sourceHash);
         if (isMacro)
             extraText.append(" isMacro=\"1\"");
         writeStringToStream(*stream, extraText);
@@ -3992,9 +4016,10 @@ void CHqlExpression::beforeDispose()
 #endif
     if (observed)
     {
-        HqlCriticalBlock block(*exprCacheCS);
+        unsigned shard = getExprCacheShard(hashcode);
+        HqlCriticalBlock block(exprCacheCS[shard]);
         if (observed)
-            exprCache->removeExact(this);
+            exprCache[shard]->removeExact(this);
     }
     assertex(!(observed));
 }
@@ -4009,14 +4034,14 @@ unsigned CHqlExpression::getHash() const
 void CHqlExpression::addObserver(IObserver & observer)
 {
     assertex(!(observed));
-    assert(&observer == exprCache);
+    assert(&observer == exprCache[getExprCacheShard(hashcode)]);
     observed = true;
 }
 
 void CHqlExpression::removeObserver(IObserver & observer)
 {
     assertex(observed);
-    assert(&observer == exprCache);
+    assert(&observer == exprCache[getExprCacheShard(hashcode)]);
     observed = false;
 }
 
@@ -4043,15 +4068,16 @@ IHqlExpression * CHqlExpression::commonUpExpression()
 
     IHqlExpression * match;
     {
-        HqlCriticalBlock block(*exprCacheCS);
-        match = exprCache->addOrFind(*this);
+        unsigned shard = getExprCacheShard(hashcode);
+        HqlCriticalBlock block(exprCacheCS[shard]);
+        match = exprCache[shard]->addOrFind(*this);
 #ifndef GATHER_COMMON_STATS
         if (match == this)
             return this;
 #endif
         if (!static_cast<CHqlExpression *>(match)->isAliveAndLink())
         {
-            exprCache->replace(*this);
+            exprCache[shard]->replace(*this);
 #ifdef GATHER_COMMON_STATS
             Link();
             match = this;
@@ -4105,23 +4131,24 @@ void displayHqlCacheStats()
 {
 #if 0
     static HqlExprCopyArray prev;
-    DBGLOG("CachedItems = %d", exprCache->count());
-    exprCache->dumpStats();
-    for (CHqlExpression & ret : *exprCache)
+    HqlExprCopyArray next;
+    for (unsigned shard=0; shard < NumExprCacheShards; shard++)
     {
-        if (!prev.contains(ret))
+        DBGLOG("Shard %u CachedItems = %d", shard, exprCache[shard]->count());
+        exprCache[shard]->dumpStats();
+        for (CHqlExpression & ret : *exprCache[shard])
         {
-            StringBuffer s;
-            processedTreeToECL(&ret, s);
-            DBGLOG("%p: %s", &ret, s.str());
+            if (!prev.contains(ret))
+            {
+                StringBuffer s;
+                processedTreeToECL(&ret, s);
+                DBGLOG("%p: %s", &ret, s.str());
+            }
+            next.append(ret);
         }
     }
 
-    prev.kill();
-    for (auto & iter2 : *exprCache)
-    {
-        prev.append(iter2);
-    }
+    prev.swapWith(next);
 #endif
 }
 
@@ -852,6 +852,7 @@ public:
     IPropertyTree * dependencies = nullptr;
     HqlExprCopyArray dependents;
     Owned<IPropertyTree> meta;
+    hash64_t sourceHash = 0;
 };
 
 interface IEclCachedDefinitionCollection;
@@ -949,6 +950,7 @@ public:
     IEclCachedDefinitionCollection * cache = nullptr;
     hash64_t optionHash = 0;
     unsigned numAttribsProcessed = 0;
+    unsigned numCacheEntriesValid = 0;      // Number of definitions with an up to date cache entry (which are still parsed)
 
 private:
     void createDependencyEntry(IHqlScope * scope, IIdAtom * name);
@@ -1030,6 +1032,7 @@ public:
     inline bool createCache(bool isMacro) { return parseCtx.createCache(isMacro); }
     void reportTiming(const char * name);
     inline void incrementAttribsProcessed() { ++parseCtx.numAttribsProcessed; }
+    inline void incrementCacheEntriesValid() { ++parseCtx.numCacheEntriesValid; }
     inline bool neverSimplify(const char *fullname) { return parseCtx.neverSimplify(fullname); }
 protected:
 
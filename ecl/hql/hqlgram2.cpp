@@ -12855,6 +12855,8 @@ void parseAttribute(IHqlScope * scope, IFileContents * contents, HqlLookupContex
         HqlParseContext & parseContext = ctx.queryParseContext();
         Owned<IEclCachedDefinition> cached = parseContext.cache->getDefinition(fullName);
         cacheUptoDate = cached->isUpToDate(parseContext.optionHash);
+        if (cacheUptoDate)
+            ctx.incrementCacheEntriesValid();
     }
 
     //The attribute will be added to the current scope as a side-effect of parsing the attribute.
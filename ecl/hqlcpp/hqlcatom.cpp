@@ -161,6 +161,7 @@ IIdAtom * columnReadUnicodeXId;
 IIdAtom * columnReadUtf8XId;
 IIdAtom * compareDataDataId;
 IIdAtom * compareEStrEStrId;
+IIdAtom * compareFixedDataId;
 IIdAtom * compareQStrQStrId;
 IIdAtom * compareStrBlankId;
 IIdAtom * compareStrStrId;
@@ -398,6 +399,7 @@ IIdAtom * hash32Data5Id;
 IIdAtom * hash32Data6Id;
 IIdAtom * hash32Data7Id;
 IIdAtom * hash32Data8Id;
+IIdAtom * hash32FixedDataId;
 IIdAtom * hash32UnicodeId;
 IIdAtom * hash32Utf8Id;
 IIdAtom * hash32VStrId;
@@ -828,6 +830,7 @@ MODULE_INIT(INIT_PRIORITY_HQLATOM-1)
     MAKEID(columnReadUtf8X);
     MAKEID(compareDataData);
     MAKEID(compareEStrEStr);
+    MAKEID(compareFixedData);
     MAKEID(compareQStrQStr);
     MAKEID(compareStrBlank);
     MAKEID(compareStrStr);
@@ -1064,6 +1067,7 @@ MODULE_INIT(INIT_PRIORITY_HQLATOM-1)
     MAKEID(hash32Data6);
     MAKEID(hash32Data7);
     MAKEID(hash32Data8);
+    MAKEID(hash32FixedData);
     MAKEID(hash32VStr);
     MAKEID(hash32Unicode);
     MAKEID(hash32Utf8);
@@ -159,6 +159,7 @@ extern IIdAtom * columnReadUnicodeXId;
 extern IIdAtom * columnReadUtf8XId;
 extern IIdAtom * compareDataDataId;
 extern IIdAtom * compareEStrEStrId;
+extern IIdAtom * compareFixedDataId;
 extern IIdAtom * compareQStrQStrId;
 extern IIdAtom * compareStrBlankId;
 extern IIdAtom * compareStrStrId;
@@ -396,6 +397,7 @@ extern IIdAtom * hash32Data5Id;
 extern IIdAtom * hash32Data6Id;
 extern IIdAtom * hash32Data7Id;
 extern IIdAtom * hash32Data8Id;
+extern IIdAtom * hash32FixedDataId;
 extern IIdAtom * hash32UnicodeId;
 extern IIdAtom * hash32Utf8Id;
 extern IIdAtom * hash32VStrId;
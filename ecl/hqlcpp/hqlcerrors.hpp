@@ -281,6 +281,7 @@
 #define HQLWRN_NestedSequentialUseOrdered       4214
 #define HQLWRN_ExpressionsDuplicated            4549
 #define HQLWRN_DistributionNotMatchLocalJoin    4550
+#define HQLWRN_ProfileNotLoaded                 4551
 
 //Temporary errors
 #define HQLERR_OrderOnVarlengthStrings          4601
@@ -583,6 +584,7 @@
 #define HQLWRN_GlobalDatasetFromChildQuery_Text "Global dataset expression (%s) is used in a child query"
 #define HQLWRN_NestedSequentialUseOrdered_Text  "Using ORDERED instead of SEQUENTIAL for child actions"
 #define HQLWRN_DistributionNotMatchLocalJoin_Text "Input distributions do not appear to match the local join condition in activity %u"
+#define HQLWRN_ProfileNotLoaded_Text            "Could not load any activity statistics from profile workunit '%s'"
 
 #define HQLERR_DistributionVariableLengthX_Text "DISTRIBUTION does not support variable length field '%s'"
 #define HQLERR_DistributionUnsupportedTypeXX_Text "DISTRIBUTION does not support field '%s' with type %s"
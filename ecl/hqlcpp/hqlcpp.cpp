@@ -1797,6 +1797,7 @@ void HqlCppTranslator::cacheOptions()
         DebugOption(options.globalFoldOptions, "globalFoldOptions", (unsigned)-1),
         DebugOption(options.allowScopeMigrate,"allowScopeMigrate", true),
         DebugOption(options.supportFilterProject,"supportFilterProject", true),
+        DebugOption(options.generateBlockHelpers,"generateBlockHelpers", true),
         DebugOption(options.normalizeExplicitCasts,"normalizeExplicitCasts", true),
         DebugOption(options.optimizeInlineSource,"optimizeInlineSource", false),
         DebugOption(options.optimizeDiskSource,"optimizeDiskSource", true),
@@ -1919,6 +1920,12 @@ void HqlCppTranslator::cacheOptions()
         DebugOption(options.allowStaticRegex, "allowStaticRegex", true),
         DebugOption(options.defaultStaticRegex, "defaultStaticRegex", targetRoxie()),   // Roxie queries are loaded once, and shared.  It makes sense to only compile once.
         DebugOption(options.traceAll, "traceAll", false),
+        DebugOption(options.profileHotPercent, "profileHotPercent", 5),         // activities taking at least this % of the profiled time are hot
+        DebugOption(options.profileColdPermille, "profileColdPermille", 1),     // activities taking less than this fraction (per mille) of the profiled time are cold
+        DebugOption(options.profileOptimize, "profileOptimize", true),          // optimize the helpers of hot activities, and not the helpers of cold activities
+        DebugOption(options.profileStrands, "profileStrands", false),           // use strands for hot projects and filters
+        DebugOption(options.maxFixedCompareSize, "maxFixedCompareSize", 32),    // fixed size keys up to this size are ordered a word at a time instead of using memcmp
+        DebugOption(options.fastInternalHash, "fastInternalHash", true),        // use a word at a time hash for fixed size keys in hashes private to an activity
     };
 
     //get options values from workunit
@@ -1996,9 +2003,110 @@ void HqlCppTranslator::cacheOptions()
         ForEachItemIn(i, activities)
             options.traceActivityIds.append(atoi(activities.item(i)));
     }
+
+    SCMStringBuffer profileWorkunit;
+    if (wu()->getDebugValue("profileWorkunit", profileWorkunit).length())
+        loadActivityProfile(profileWorkunit.str());
     postProcessOptions();
 }
 
+void HqlCppTranslator::loadActivityProfile(const char * source)
+{
+    Owned<IConstWorkUnit> profileWu;
+    try
+    {
+        if (looksLikeAWuid(source, 'W'))
+            profileWu.setown(getWorkUnitFactory()->openWorkUnit(source));
+        else
+            profileWu.setown(createLocalWorkUnitFromFile(source));
+    }
+    catch (IException * e)
+    {
+        EXCLOG(e, "Loading activity profile");
+        e->Release();
+    }
+
+    Owned<ActivityProfile> profile = new ActivityProfile;
+    if (profileWu)
+        profile->loadFromWorkunit(profileWu);
+    if (profile->isEmpty())
+    {
+        WARNING1(CategoryEfficiency, HQLWRN_ProfileNotLoaded, source);
+        return;
+    }
+
+    profile->classify(options.profileHotPercent, options.profileColdPermille);
+    DBGLOG("Using statistics for %u activities from %s to guide code generation", profile->numActivities(), source);
+    activityProfile.setown(profile.getClear());
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+void ActivityProfile::loadFromWorkunit(IConstWorkUnit * wu)
+{
+    WuScopeFilter filter;
+    filter.addScopeType(SSTactivity);
+    filter.addOutputStatistic(StTimeLocalExecute);
+    filter.addOutputAttribute(WaKind);
+    filter.addOutputAttribute(WaEclText);
+    filter.finishedFilter();
+
+    Owned<IConstWUScopeIterator> it = &wu->getScopeIterator(filter);
+    ForEach(*it)
+    {
+        const char * id = queryScopeTail(it->queryScope());
+        if (!startsWith(id, ActivityScopePrefix))
+            continue;
+
+        StringBuffer kindText;
+        StringBuffer eclText;
+        unsigned activityId = atoi(id + strlen(ActivityScopePrefix));
+        stat_type localTime = it->queryStat(StTimeLocalExecute);
+        const char * kind = it->queryAttribute(WaKind, kindText);
+        const char * ecl = it->queryAttribute(WaEclText, eclText);
+
+        ActivityStats & stats = activities[activityId];
+        if (kind)
+            stats.kind = atoi(kind);
+        if (!isEmptyString(ecl))
+            stats.eclHash = hashc((const byte *)ecl, strlen(ecl), 0);
+        stats.localTime += localTime;
+        totalTime += localTime;
+    }
+}
+
+void ActivityProfile::classify(unsigned hotPercent, unsigned coldPermille)
+{
+    if (totalTime == 0)
+        return;
+
+    for (auto & cur : activities)
+    {
+        ActivityStats & stats = cur.second;
+        if (hotPercent && (stats.localTime * 100 >= totalTime * hotPercent))
+            stats.hint = ProfileHot;
+        else if (stats.localTime * 1000 < totalTime * coldPermille)
+            stats.hint = ProfileCold;
+    }
+}
+
+ProfileHint ActivityProfile::queryHint(unsigned activityId, unsigned kind, const char * eclText) const
+{
+    auto match = activities.find(activityId);
+    if (match == activities.end())
+        return ProfileUnknown;
+
+    //Activity ids are allocated sequentially, so after an edit the same id (and even the same kind) can refer to a
+    //different activity.  Only use the statistics if the kind and the ecl for the activity are both unchanged.
+    //Profiles without the ecl in the graph (e.g. obfuscated queries) are never matched.
+    const ActivityStats & stats = match->second;
+    if (stats.kind != kind)
+        return ProfileUnknown;
+    if (!stats.eclHash || (stats.eclHash != hashc((const byte *)eclText, strlen(eclText), 0)))
+        return ProfileUnknown;
+    return stats.hint;
+}
+
 void HqlCppTranslator::postProcessOptions()
 {
     if (options.optimizeMax)
@@ -8721,6 +8829,15 @@ IHqlExpression * HqlCppTranslator::querySimpleOrderSelector(IHqlExpression * exp
     return querySelectorDataset(expr, isNew);
 }
 
+//Ordering a small fixed size block a word at a time is significantly quicker than calling memcmp().  Compilers already
+//inline memcmp() when it is only used for equality, so that case is left alone.
+IIdAtom * HqlCppTranslator::queryFixedCompareFunc(const EvaluateCompareInfo & info, unsigned size) const
+{
+    if (!info.isEqualityCompare() && (size <= options.maxFixedCompareSize))
+        return compareFixedDataId;
+    return memcmpId;
+}
+
 static unsigned getMemcmpSize(IHqlExpression * left, IHqlExpression * right, bool isEqualityCompare)
 {
     ITypeInfo * leftType = left->queryType();
@@ -8950,7 +9067,7 @@ void HqlCppTranslator::doBuildAssignCompareElement(BuildCtx & ctx, EvaluateCompa
                 }
                 else
                 {
-                    func = memcmpId;
+                    func = queryFixedCompareFunc(info, realType->getSize());
                     args.append(*getElementPointer(lhs.expr));
                     args.append(*getElementPointer(rhs.expr));
                     args.append(*getSizetConstant(realType->getSize()));
@@ -9109,7 +9226,7 @@ void HqlCppTranslator::doBuildAssignCompareElement(BuildCtx & ctx, EvaluateCompa
                 args.append(*lhs.expr.getLink());
                 args.append(*rhs.expr.getLink());
                 args.append(*getSizetConstant(leftType->getSize()));
-                op = bindTranslatedFunctionCall(memcmpId, args);
+                op = bindTranslatedFunctionCall(queryFixedCompareFunc(info, leftType->getSize()), args);
             }
             else
             {
@@ -9266,8 +9383,8 @@ void HqlCppTranslator::doBuildReturnCompare(BuildCtx & ctx, IHqlExpression * exp
 class HashCodeCreator
 {
 public:
-    HashCodeCreator(HqlCppTranslator & _translator, const CHqlBoundTarget & _target, node_operator _hashKind, bool _optimizeInternal) 
-        : translator(_translator), target(_target), hashKind(_hashKind), optimizeInternal(_optimizeInternal)
+    HashCodeCreator(HqlCppTranslator & _translator, const CHqlBoundTarget & _target, node_operator _hashKind, bool _optimizeInternal, bool _fastFixedHash)
+        : translator(_translator), target(_target), hashKind(_hashKind), optimizeInternal(_optimizeInternal), fastFixedHash(_fastFixedHash)
     {
         prevFunc = NULL;
     }
@@ -9276,6 +9393,15 @@ public:
     //and the generated code size.
     void buildHash(BuildCtx & ctx, IIdAtom * func, IHqlExpression * length, IHqlExpression * ptr)
     {
+        //If the hash value is private to the activity, fixed size fields can be hashed a word at a time.  Each field is
+        //hashed separately so the value does not depend on the record layout - e.g., Hash and KeyHash for a dedup must match.
+        if ((func == hash32DataId) && fastFixedHash && length->queryValue())
+        {
+            flush(ctx);
+            buildCall(ctx, hash32FixedDataId, length, ptr);
+            return;
+        }
+
         if ((func == hash32DataId) || (func == hash64DataId))
         {
             ptr = stripTranslatedCasts(ptr);
@@ -9385,6 +9511,7 @@ protected:
     LinkedHqlExpr initialValue;
     node_operator hashKind;
     bool optimizeInternal;
+    bool fastFixedHash;
     IIdAtom * prevFunc;
     OwnedHqlExpr prevLength;
     OwnedHqlExpr prevPtr;
@@ -9401,7 +9528,7 @@ void HqlCppTranslator::doBuildAssignHashCrc(BuildCtx & ctx, const CHqlBoundTarge
     else if (op == no_hash64)
         initialValue.setown(createConstant(createIntValue(HASH64_INIT, 8, false)));
 
-    HashCodeCreator creator(*this, target, op, expr->hasAttribute(internalAtom));
+    HashCodeCreator creator(*this, target, op, expr->hasAttribute(internalAtom), expr->hasAttribute(fastAtom));
     creator.setInitialValue(initialValue);
     if (child->getOperator() != no_sortlist)
         doBuildAssignHashElement(ctx, creator, child);
@@ -594,6 +594,33 @@ class HqlMapTransformer;
 
 class TransformBuilder;
 
+enum ProfileHint { ProfileUnknown, ProfileCold, ProfileHot };
+
+//The execution statistics of the activities from a previous run of the same query, used to guide code generation.
+//Activities are matched by id, and only if the activity kind and the ecl recorded in the graph are unchanged.
+class ActivityProfile : public CInterface
+{
+    struct ActivityStats
+    {
+        unsigned kind = 0;
+        unsigned eclHash = 0;
+        stat_type localTime = 0;
+        ProfileHint hint = ProfileUnknown;
+    };
+
+public:
+    void loadFromWorkunit(IConstWorkUnit * wu);
+    void classify(unsigned hotPercent, unsigned coldPermille);
+    ProfileHint queryHint(unsigned activityId, unsigned kind, const char * eclText) const;
+
+    inline bool isEmpty() const { return activities.empty(); }
+    inline unsigned numActivities() const { return (unsigned)activities.size(); }
+
+protected:
+    std::unordered_map<unsigned, ActivityStats> activities;
+    stat_type totalTime = 0;
+};
+
 struct HqlCppOptions
 {
     unsigned            defaultImplicitKeyedJoinLimit = 0;
@@ -639,6 +666,9 @@ struct HqlCppOptions
     unsigned            maxOptimizeSize = 0;
     unsigned            minNoOptimizeSize = 0;
     unsigned            irOptions = 0;
+    unsigned            profileHotPercent = 0;
+    unsigned            profileColdPermille = 0;
+    unsigned            maxFixedCompareSize = 0;
     UnsignedArray       traceActivityIds;
     bool                peephole = false;
     bool                foldConstantCast = false;
@@ -735,6 +765,7 @@ struct HqlCppOptions
     bool                allowStoredDuplicate = false;
     bool                allowScopeMigrate = false;
     bool                supportFilterProject = false;
+    bool                generateBlockHelpers = false;
     bool                normalizeExplicitCasts = false;
     bool                optimizeInlineSource = false;
     bool                optimizeDiskSource = false;
@@ -848,6 +879,9 @@ struct HqlCppOptions
     bool                allowStaticRegex = true;
     bool                defaultStaticRegex = false;
     bool                traceAll = false;
+    bool                profileOptimize = false;
+    bool                profileStrands = false;
+    bool                fastInternalHash = false;
     std::unordered_map<std::string, bool> traceOptions;
 
 public:
@@ -1172,6 +1206,11 @@ public:
 
     HqlCppOptions const & queryOptions() const { return options; }
     bool queryTrace(const char * option) const { return options.queryTrace(option); }
+    bool hasActivityProfile() const { return activityProfile != nullptr; }
+    ProfileHint queryProfileHint(unsigned activityId, unsigned kind, const char * eclText) const
+    {
+        return activityProfile ? activityProfile->queryHint(activityId, kind, eclText) : ProfileUnknown;
+    }
 
     bool needToSerializeToSlave(IHqlExpression * expr) const;
     void noteFinishedTiming(const char * name, cycle_t startCycles)
@@ -1688,6 +1727,7 @@ public:
     void doStringTranslation(BuildCtx & ctx, ICharsetInfo * tgtset, ICharsetInfo * srcset, unsigned tgtlen, IHqlExpression * srclen, IHqlExpression * target, IHqlExpression * src);
 
     void cacheOptions();
+    void loadActivityProfile(const char * source);
     void overrideOptionsForLibrary();
     void overrideOptionsForQuery();
 
@@ -1932,6 +1972,7 @@ protected:
     void expandSimpleOrder(IHqlExpression * left, IHqlExpression * right, HqlExprArray & leftValues, HqlExprArray & rightValues);
     void expandOrder(IHqlExpression * expr, HqlExprArray & leftValues, HqlExprArray & rightValues, SharedHqlExpr & defaultValue);
     void optimizeOrderValues(HqlExprArray & leftValues, HqlExprArray & rightValues, bool isEqualityCompare);
+    IIdAtom * queryFixedCompareFunc(const EvaluateCompareInfo & info, unsigned size) const;
     IHqlExpression * querySimpleOrderSelector(IHqlExpression * expr, bool & isNew);
 
     unsigned doBuildThorChildSubGraph(BuildCtx & ctx, IHqlExpression * expr, SubGraphType kind, unsigned thisId=0, IHqlExpression * represents=NULL);
@@ -2138,6 +2179,7 @@ protected:
     HqlExprArray activityExprStack;             //only used for improving the error reporting
     PointerArray recordIndexCache;
     Owned<ITimeReporter> timeReporter;
+    Owned<ActivityProfile> activityProfile;
     CIArrayOf<SourceFieldUsage> trackedSources;
     HqlExprArray tracedActivities;
 };
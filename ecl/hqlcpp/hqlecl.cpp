@@ -736,6 +736,12 @@ bool HqlDllGenerator::doCompile(ICppCompiler * compiler)
 
         unsigned __int64 elapsed = cycle_to_nanosec(get_cycles_now() - startCycles);
         updateWorkunitStat(wu, SSToperation, ">compile:>compile c++", StTimeElapsed, NULL, elapsed);
+        unsigned objectCacheHits = compiler->queryObjectCacheHits();
+        if (objectCacheHits)
+        {
+            LOG(MCuserInfo, "%u of %u c++ files reused objects from the object cache", objectCacheHits, sourceFiles.ordinality());
+            updateWorkunitStat(wu, SSToperation, ">compile:>compile c++", StNumObjectsFromCache, NULL, objectCacheHits);
+        }
     }
     //Keep the files if there was a compile error.
     if (ok && deleteGenerated)
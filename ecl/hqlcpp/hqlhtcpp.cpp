@@ -285,6 +285,15 @@ MemberFunction::~MemberFunction() noexcept(false)
             stmt->setForceOptimize(false);
     }
 
+    //Statistics from a previous run take precedence over the size heuristics - optimize the helpers of the activities
+    //where the time was spent, and save compile time on the activities that barely ran.
+    if (stmt && translator.hasActivityProfile() && translator.queryOptions().profileOptimize)
+    {
+        ActivityInstance * activity = translator.queryCurrentActivity(ctx);
+        if (activity && (activity->profileHint != ProfileUnknown))
+            stmt->setForceOptimize(activity->profileHint == ProfileHot);
+    }
+
     //Do not process the aliases if we are aborting from an error
 #if __cplusplus >= 201703
     if (!std::uncaught_exceptions())
@@ -1779,6 +1788,7 @@ ActivityInstance::ActivityInstance(HqlCppTranslator & _translator, BuildCtx & ct
     meta.setMeta(translator, record, ::isGrouped(outputDataset));
 
     activityId = translator.nextActivityId();
+    profileHint = queryProfileHint();
 
     StringBuffer s;
     className.set(s.clear().append("cAc").append(activityId).str());
@@ -2067,6 +2077,7 @@ void ActivityInstance::processHints(IHqlExpression * hintAttr)
 void ActivityInstance::changeActivityKind(ThorActivityKind newKind)
 {
     kind = newKind;
+    profileHint = queryProfileHint();
     if (graphNode)
     {
         addAttributeInt(WaKind, kind);
@@ -2076,6 +2087,18 @@ void ActivityInstance::changeActivityKind(ThorActivityKind newKind)
         table->updateActivityKind(kind);
 }
 
+ProfileHint ActivityInstance::queryProfileHint() const
+{
+    if (!translator.hasActivityProfile())
+        return ProfileUnknown;
+
+    //The ecl is generated in the same way as the text that createGraphNode() adds to the graph
+    StringBuffer eclText;
+    toECL(activityExpr->queryBody(), eclText, false, true);
+    elideString(eclText, MAX_GRAPH_ECL_LENGTH);
+    return translator.queryProfileHint(activityId, kind, eclText);
+}
+
 
 void ActivityInstance::setInternalSink(bool value)
 {
@@ -2103,6 +2126,19 @@ static void getRecordSizeText(StringBuffer & out, IHqlExpression * record)
         out.append(minSize);
 }
 
+//Only projects and filters whose transforms are pure can be switched to strands without any other hints.  Counters
+//(count projects), skips and side effects could all change the results.
+static bool supportsProfileStrands(IHqlExpression * expr, ThorActivityKind kind)
+{
+    switch (kind)
+    {
+    case TAKproject:
+    case TAKfilter:
+        return isPureActivity(expr);
+    }
+    return false;
+}
+
 void ActivityInstance::createGraphNode(IPropertyTree * defaultSubGraph, bool alwaysExecuted)
 {
     IPropertyTree * parentGraphNode = subgraph ? subgraph->tree.get() : defaultSubGraph;
@@ -2168,6 +2204,11 @@ void ActivityInstance::createGraphNode(IPropertyTree * defaultSubGraph, bool alw
         addAttributeBool(WaIsNoAccess, true);
     if (activityExpr->hasAttribute(parallelAtom))
         addAttributeInt(WaNumParallel, getIntValue(queryAttributeChild(activityExpr, parallelAtom, 0), -1));
+    else if ((profileHint == ProfileHot) && options.profileStrands && supportsProfileStrands(activityExpr, kind))
+        addAttributeInt(WaNumParallel, -1);
+    //Record which activities had code generation guided by a previous run
+    if (profileHint != ProfileUnknown)
+        addAttribute("profile", (profileHint == ProfileHot) ? "hot" : "cold");
     if (hasOrderedAttribute(activityExpr))
         addAttributeBool(WaIsOrdered, isOrdered(activityExpr), true);
     if (activityExpr->hasAttribute(algorithmAtom))
@@ -5843,7 +5884,10 @@ void HqlCppTranslator::buildCompareClass(BuildCtx & ctx, const char * name, IHql
 void HqlCppTranslator::buildHashOfExprsClass(BuildCtx & ctx, const char * name, IHqlExpression * cond, const DatasetReference & dataset, bool compareToSelf)
 {
     IHqlExpression * attr = compareToSelf ? createAttribute(internalAtom) : NULL;
-    OwnedHqlExpr hash = createValue(no_hash32, LINK(unsignedType), LINK(cond), attr);
+    //If the hash is only compared with other hashes from the same class the values are never visible outside the
+    //activity, so a faster hash function can be used for fixed size fields.
+    IHqlExpression * fastAttr = (compareToSelf && options.fastInternalHash) ? createAttribute(fastAtom) : NULL;
+    OwnedHqlExpr hash = createValue(no_hash32, LINK(unsignedType), LINK(cond), attr, fastAttr);
 
     buildHashClass(ctx, name, hash, dataset);
 }
@@ -15679,6 +15723,11 @@ ABoundActivity * HqlCppTranslator::doBuildActivityProject(BuildCtx & ctx, IHqlEx
             instance->graphLabel.set("Filtered Project");
     }
 
+    //For simple fixed size records, a block entry point calls the transform directly so it can be inlined
+    bool generateBlock = options.generateBlockHelpers && !isFilterProject && !containsCounter && isFixedRecordSize(dataset->queryRecord()) && isFixedRecordSize(expr->queryRecord());
+    if (generateBlock)
+        instance->addBaseClass("IHThorProjectBlockExtra", false);
+
     buildActivityFramework(instance);
 
     buildInstancePrefix(instance);
@@ -15731,6 +15780,15 @@ ABoundActivity * HqlCppTranslator::doBuildActivityProject(BuildCtx & ctx, IHqlEx
             buildTransformBody(func.ctx, transform, dataset, NULL, instance->activityExpr, selSeq);
     }
 
+    if (generateBlock)
+    {
+        MemberFunction func(*this, instance->startctx, "virtual void transformBlock(unsigned numRows, ARowBuilder * * builders, const void * * rows, size32_t * sizes) override");
+        BuildCtx loopctx(func.ctx);
+        loopctx.addQuotedCompoundLiteral("for (unsigned i=0; i < numRows; i++)");
+        StringBuffer s;
+        loopctx.addQuoted(s.append("sizes[i] = ").append(instance->className).append("::transform(*builders[i], rows[i]);"));
+    }
+
     if (filterConditions.ordinality() || transformContainsSkip(transform))
         doBuildBoolFunction(instance->classctx, "canFilter", true);
 
@@ -15917,12 +15975,17 @@ ABoundActivity * HqlCppTranslator::doBuildActivityFilter(BuildCtx & ctx, IHqlExp
 
     Owned<ActivityInstance> instance = new ActivityInstance(*this, ctx, TAKfilter, expr,"Filter");
 
-    buildActivityFramework(instance);
-    buildInstancePrefix(instance);
-
     HqlExprAttr invariant;
     OwnedHqlExpr cond = extractFilterConditions(invariant, expr, dataset, options.spotCSE, queryOptions().spotCseInIfDatasetConditions);
 
+    //For simple fixed size records, a block entry point calls isValid directly so it can be inlined into a branch free loop
+    bool generateBlock = cond && options.generateBlockHelpers && isFixedRecordSize(dataset->queryRecord());
+    if (generateBlock)
+        instance->addBaseClass("IHThorFilterBlockExtra", false);
+
+    buildActivityFramework(instance);
+    buildInstancePrefix(instance);
+
     //Base class returns true, so only generate if no non-invariant conditions
     if (cond)
     {
@@ -15945,6 +16008,18 @@ ABoundActivity * HqlCppTranslator::doBuildActivityFilter(BuildCtx & ctx, IHqlExp
         }
     }
 
+    if (generateBlock)
+    {
+        MemberFunction func(*this, instance->startctx, "virtual unsigned selectValid(unsigned numRows, const void * * rows, unsigned * selected) override");
+        func.ctx.addQuotedLiteral("unsigned numValid = 0;");
+        BuildCtx loopctx(func.ctx);
+        loopctx.addQuotedCompoundLiteral("for (unsigned i=0; i < numRows; i++)");
+        loopctx.addQuotedLiteral("selected[numValid] = i;");
+        StringBuffer s;
+        loopctx.addQuoted(s.append("numValid += ").append(instance->className).append("::isValid(rows[i]) ? 1 : 0;"));
+        func.ctx.addQuotedLiteral("return numValid;");
+    }
+
     if (invariant)
         doBuildBoolFunction(instance->startctx, "canMatchAny", invariant);
 
@@ -180,6 +180,7 @@ public:
     void setInternalSink(bool value);
 
     void changeActivityKind(ThorActivityKind newKind);
+    ProfileHint queryProfileHint() const;
 
 protected:
     void noteChildActivityLocation(IHqlExpression * pass);
@@ -215,6 +216,7 @@ public:
     bool         hasChildActivity;
     bool         generateMetaFromInput = false;
     GraphLocalisation activityLocalisation;
+    ProfileHint  profileHint = ProfileUnknown;
     ActivityInstance * containerActivity;
     Owned<ParentExtract> parentExtract;
     Owned<EvalContext> parentEvalContext;
@@ -2249,7 +2249,9 @@ void SourceBuilder::buildGroupAggregateHashHelper(ParentExtract * extractBuilder
         MemberFunction func(translator, classctx, "virtual unsigned hash(const void * _self) override");
         assignLocalExtract(func.ctx, extractBuilder, dataset, "_self");
 
-        OwnedHqlExpr hash = createValue(no_hash32, LINK(unsignedType), LINK(fields), createAttribute(internalAtom));
+        //Must match the hash generated for HashElement by buildHashOfExprsClass()
+        IHqlExpression * fastAttr = translator.queryOptions().fastInternalHash ? createAttribute(fastAtom) : NULL;
+        OwnedHqlExpr hash = createValue(no_hash32, LINK(unsignedType), LINK(fields), createAttribute(internalAtom), fastAttr);
         translator.buildReturn(func.ctx, hash);
     }
 
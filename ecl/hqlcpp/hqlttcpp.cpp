@@ -14224,11 +14224,32 @@ void HqlCppTranslator::applyGlobalOptimizations(HqlExprArray & exprs)
     modifyOutputLocations(exprs);
 }
 
+//Records the time taken by a single transformation pass if timeTransforms is enabled
+class TransformPassTimer
+{
+public:
+    TransformPassTimer(HqlCppTranslator & _translator, const char * _name)
+    : translator(_translator), name(_name), startCycles(get_cycles_now())
+    {
+    }
+    ~TransformPassTimer()
+    {
+        if (translator.queryOptions().timeTransforms)
+            translator.noteFinishedTiming(name, startCycles);
+    }
+
+protected:
+    HqlCppTranslator & translator;
+    const char * name;
+    cycle_t startCycles;
+};
+
 void HqlCppTranslator::transformWorkflowItem(WorkflowItem & curWorkflow)
 {
 #ifdef USE_SELSEQ_UID
     if (options.normalizeSelectorSequence)
     {
+        TransformPassTimer timer(*this, ">compile:>transform:>normalize selectors");
         LeftRightTransformer normalizer;
         normalizer.process(curWorkflow.queryExprs());
         //traceExpressions("afterImplicitAlias", workflow);
@@ -14237,17 +14258,20 @@ void HqlCppTranslator::transformWorkflowItem(WorkflowItem & curWorkflow)
 
     if (queryOptions().createImplicitAliases)
     {
+        TransformPassTimer timer(*this, ">compile:>transform:>implicit alias");
         ImplicitAliasTransformer normalizer;
         normalizer.process(curWorkflow.queryExprs());
         //traceExpressions("afterImplicitAlias", workflow);
     }
 
     {
+        TransformPassTimer timer(*this, ">compile:>transform:>hoist compound");
         hoistNestedCompound(*this, curWorkflow.queryExprs());
     }
 
     if (options.optimizeNestedConditional)
     {
+        TransformPassTimer timer(*this, ">compile:>transform:>nested conditional");
         optimizeNestedConditional(curWorkflow.queryExprs());
         traceExpressions("nested", curWorkflow);
         checkNormalized(curWorkflow);
@@ -14256,6 +14280,7 @@ void HqlCppTranslator::transformWorkflowItem(WorkflowItem & curWorkflow)
     checkNormalized(curWorkflow);
     //sort(x)[n] -> topn(x, n)[]n, count(x)>n -> count(choosen(x,n+1)) > n and possibly others
     {
+        TransformPassTimer timer(*this, ">compile:>transform:>optimize activities");
         optimizeActivities(curWorkflow.queryWfid(), curWorkflow.queryExprs(), !targetThor(), options.optimizeNonEmpty);
     }
     checkNormalized(curWorkflow);
@@ -14263,6 +14288,7 @@ void HqlCppTranslator::transformWorkflowItem(WorkflowItem & curWorkflow)
     //----------------------------- Transformations below this mark may have created globals so be very careful with hoisting ---------------------
 
     {
+        TransformPassTimer timer(*this, ">compile:>transform:>migrate");
         migrateExprToNaturalLevel(curWorkflow, wu(), *this);       // Ensure expressions are evaluated at the best level - e.g., counts moved to most appropriate level.
         //transformToAliases(exprs);
         traceExpressions("migrate", curWorkflow);
@@ -14271,6 +14297,7 @@ void HqlCppTranslator::transformWorkflowItem(WorkflowItem & curWorkflow)
 
     if (!curWorkflow.isFunction())
     {
+        TransformPassTimer timer(*this, ">compile:>transform:>thor boundaries");
         markThorBoundaries(curWorkflow);                                               // work out which engine is going to perform which operation.
         traceExpressions("boundary", curWorkflow);
         checkNormalized(curWorkflow);
@@ -14278,16 +14305,23 @@ void HqlCppTranslator::transformWorkflowItem(WorkflowItem & curWorkflow)
 
     if (options.optimizeGlobalProjects)
     {
+        TransformPassTimer timer(*this, ">compile:>transform:>implicit projects");
         insertImplicitProjects(*this, curWorkflow.queryExprs());
         traceExpressions("implicit", curWorkflow);
         checkNormalized(curWorkflow);
     }
 
-    normalizeResultFormat(curWorkflow, options);
+    {
+        TransformPassTimer timer(*this, ">compile:>transform:>results");
+        normalizeResultFormat(curWorkflow, options);
+    }
     traceExpressions("results", curWorkflow);
     checkNormalized(curWorkflow);
 
-    optimizePersists(curWorkflow.queryExprs());
+    {
+        TransformPassTimer timer(*this, ">compile:>transform:>persists");
+        optimizePersists(curWorkflow.queryExprs());
+    }
 
     traceExpressions("per", curWorkflow);
     checkNormalized(curWorkflow);
@@ -14295,6 +14329,7 @@ void HqlCppTranslator::transformWorkflowItem(WorkflowItem & curWorkflow)
 //  traceExpressions("flatten", workflow);
 
     {
+        TransformPassTimer timer(*this, ">compile:>transform:>merge graphs");
         mergeThorGraphs(curWorkflow, options.resourceConditionalActions, options.resourceSequential);          // reduces number of graphs sent to thor
     }
 
@@ -14304,17 +14339,24 @@ void HqlCppTranslator::transformWorkflowItem(WorkflowItem & curWorkflow)
     if (queryOptions().normalizeLocations)
         normalizeAnnotations(*this, curWorkflow.queryExprs());
 
-    spotGlobalCSE(curWorkflow);                                                        // spot CSE within those graphs, and create some more
+    {
+        TransformPassTimer timer(*this, ">compile:>transform:>global cse");
+        spotGlobalCSE(curWorkflow);                                                    // spot CSE within those graphs, and create some more
+    }
     checkNormalized(curWorkflow);
 
     //expandGlobalDatasets(workflow, wu(), *this);
 
     {
+        TransformPassTimer timer(*this, ">compile:>transform:>merge graphs");
         mergeThorGraphs(curWorkflow, options.resourceConditionalActions, options.resourceSequential);
     }
     checkNormalized(curWorkflow);
 
-    removeTrivialGraphs(curWorkflow);
+    {
+        TransformPassTimer timer(*this, ">compile:>transform:>trivial graphs");
+        removeTrivialGraphs(curWorkflow);
+    }
     checkNormalized(curWorkflow);
 }
 
@@ -14388,7 +14430,10 @@ bool HqlCppTranslator::transformGraphForGeneration(HqlQueryContext & query, Work
         WorkflowItem & curWorkflow = workflow.item(i2);
         traceExpressions("beforeConvertLogicalToActivities", curWorkflow);
 
-        convertLogicalToActivities(curWorkflow);                                           // e.g., merge disk reads, transform group, all to sort etc.
+        {
+            TransformPassTimer timer(*this, ">compile:>transform:>logical to activities");
+            convertLogicalToActivities(curWorkflow);                                       // e.g., merge disk reads, transform group, all to sort etc.
+        }
 
     #ifndef _DEBUG
         if (options.regressionTest)
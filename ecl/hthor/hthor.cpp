@@ -19,6 +19,7 @@
 #include "jexcept.hpp"
 #include "jmisc.hpp"
 #include "jthread.hpp"
+#include "jqueue.hpp"
 #include "jsocket.hpp"
 #include "jprop.hpp"
 #include "jdebug.hpp"
@@ -12145,6 +12146,149 @@ MAKEFACTORY(FilterGroup);
 MAKEFACTORY(StreamedIterator);
 MAKEFACTORY_EXTRA(External, IPropertyTree *);
 
+//=====================================================================================================
+
+// Pipeline parallelism for an edge of the graph: the upstream activities are pulled on a separate thread, and the rows
+// passed to the consumer through a bounded queue.  Ends of groups are passed as a marker since the queue cannot
+// contain nulls, and end of file is signalled by the writer stopping.
+class CHThorReadAheadInput : public CInterfaceOf<IHThorInput>, implements IEngineRowStream, implements IThreaded
+{
+    static constexpr byte endOfGroupMarker = 0;
+
+    IHThorInput * input;
+    const unsigned maxRows;
+    Owned<IRowQueue> queue;
+    CThreadedPersistent threaded;
+    Owned<IException> exception;
+    bool grouped = false;
+    bool started = false;
+
+    static inline bool isEndOfGroup(const void * row) { return row == &endOfGroupMarker; }
+
+    void startReading()
+    {
+        queue->reset();
+        exception.clear();
+        started = true;
+        threaded.start(true);
+    }
+    void stopReading()
+    {
+        if (!started)
+            return;
+        queue->abort();
+        threaded.join(INFINITE, false);
+        queue->reset();
+        const void * next;
+        while (queue->tryDequeue(next))
+        {
+            if (!isEndOfGroup(next))
+                ReleaseRoxieRow(next);
+        }
+        started = false;
+    }
+
+public:
+    IMPLEMENT_IINTERFACE_USING(CInterfaceOf<IHThorInput>)
+
+    CHThorReadAheadInput(IHThorInput * _input, unsigned _maxRows)
+        : input(_input), maxRows(_maxRows), threaded("CHThorReadAheadInput", this)
+    {
+        queue.setown(createRowQueue(1, 1, maxRows, 0));
+    }
+    ~CHThorReadAheadInput()
+    {
+        stopReading();
+    }
+
+//interface IThreaded
+    virtual void threadmain() override
+    {
+        try
+        {
+            bool lastWasEndOfGroup = true;
+            for (;;)
+            {
+                const void * row = input->nextRow();
+                if (!row)
+                {
+                    if (!grouped || lastWasEndOfGroup)
+                        break;
+                    lastWasEndOfGroup = true;
+                    if (!queue->enqueue(&endOfGroupMarker))
+                        break;
+                }
+                else
+                {
+                    lastWasEndOfGroup = false;
+                    if (!queue->enqueue(row))
+                    {
+                        ReleaseRoxieRow(row);
+                        break;
+                    }
+                }
+            }
+        }
+        catch (IException * e)
+        {
+            exception.setown(e);
+        }
+        queue->noteWriterStopped();
+    }
+
+//interface IHThorInput
+    virtual IOutputMetaData * queryOutputMeta() const override { return input->queryOutputMeta(); }
+    virtual bool isGrouped() override { return input->isGrouped(); }
+    virtual void ready() override
+    {
+        stopReading();
+        input->ready();
+        grouped = input->isGrouped();
+    }
+    virtual void updateProgress(IStatisticGatherer &progress) const override
+    {
+        input->updateProgress(progress);
+    }
+    virtual IEngineRowStream &queryStream() override { return *this; }
+
+//interface IEngineRowStream
+    virtual const void * nextRow() override
+    {
+        if (!started)
+            startReading();
+        const void * next;
+        if (!queue->dequeue(next))
+        {
+            if (exception)
+            {
+                threaded.join(INFINITE, false);
+                throw exception.getClear();
+            }
+            return nullptr;
+        }
+        if (isEndOfGroup(next))
+            return nullptr;
+        return next;
+    }
+    virtual void stop() override
+    {
+        stopReading();
+        input->stop();
+    }
+    virtual void resetEOF() override
+    {
+        stopReading();
+        input->resetEOF();
+    }
+};
+
+extern HTHOR_API IHThorInput *createReadAheadInput(IHThorInput * input, unsigned maxRows)
+{
+    return new CHThorReadAheadInput(input, maxRows);
+}
+
+//=====================================================================================================
+
 IHThorException * makeHThorException(ThorActivityKind kind, unsigned activityId, unsigned subgraphId, int code, char const * format, ...)
 {
     va_list args;
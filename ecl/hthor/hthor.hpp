@@ -211,6 +211,9 @@ extern HTHOR_API IHThorActivity *createNonEmptyActivity(IAgentContext &, unsigne
 extern HTHOR_API IHThorActivity *createStreamedIteratorActivity(IAgentContext &, unsigned _activityId, unsigned _subgraphId, IHThorStreamedIteratorArg &arg, ThorActivityKind kind, EclGraph & _graph);
 extern HTHOR_API IHThorActivity *createExternalActivity(IAgentContext &, unsigned _activityId, unsigned _subgraphId, IHThorExternalArg &arg, ThorActivityKind kind, EclGraph & _graph, IPropertyTree * graphNode);
 
+// Returns an input that reads up to maxRows ahead of its consumer on a separate thread.  Does not support stepping.
+extern HTHOR_API IHThorInput *createReadAheadInput(IHThorInput * input, unsigned maxRows);
+
 #define OwnedHThorRowArray OwnedRowArray
 class HTHOR_API IHThorException : public IException
 {
@@ -26,7 +26,7 @@
 # in your build directory. (option: -e $BUILDDIR/Debug/bin/eclcc)
 ##############################################################################
 
-syntax="syntax: $0 [-t target_dir] [-c compare_dir] [-I include_dir ...] [-e eclcc] [-d diff_program] [-q query.ecl] [-l log_file] "
+syntax="syntax: $0 [-t target_dir] [-c compare_dir] [-I include_dir ...] [-e eclcc] [-d diff_program] [-q query.ecl] [-l log_file] [-m] "
 
 ## Default arguments
 target_dir=run_$$
@@ -38,6 +38,7 @@ eclcc=
 diff=
 query=
 valgrind=
+measure=
 np=`getconf _NPROCESSORS_ONLN`
 export ECLCC_ECLINCLUDE_PATH=
 
@@ -56,11 +57,12 @@ if [[ $1 = '' ]]; then
     echo " * -p changes the number of parallel compiles"
     echo " * -f allows you to add a debug option"
     echo " * -x allows you to pass through an arbitrary option"
+    echo " * -m records the peak memory and elapsed time of each compile"
     echo
     exit -1
 fi
 if [[ $* != '' ]]; then
-    while getopts "t:c:I:e:d:f:q:l:p:x:vw" opt; do
+    while getopts "t:c:I:e:d:f:q:l:p:x:vwm" opt; do
         case $opt in
             t)
                 target_dir=$OPTARG
@@ -105,6 +107,9 @@ if [[ $* != '' ]]; then
                 eclcc="$valgrind $eclcc"
                 compare_dir=
                 ;;
+            m)
+                measure=1
+                ;;
             :)
                 echo $syntax
                 exit -1
@@ -130,6 +135,13 @@ if [[ $eclcc != '' ]]; then
     fi
     mkdir -p $target_dir
 
+    ## Record "peak-memory-KB elapsed-seconds command" for each compile (outside the target so it is not compared)
+    if [[ $measure != '' ]]; then
+        measure_log=$target_dir.memory.log
+        rm -f $measure_log
+        eclcc="/usr/bin/time -a -o $measure_log -f \"%M %e %C\" $eclcc"
+    fi
+
     ## Create Makefile (git doesn't like tabs)
     echo "#Auto generated make file" > Makefile
     echo "FLAGS=$flags" >> Makefile
@@ -172,6 +184,13 @@ if [[ $eclcc != '' ]]; then
         cat thisTimings.log >> regressionTimings.log
         cat thisTimings.log
     fi
+
+    if [[ $measure != '' && -f $measure_log ]]; then
+        echo "* Compiles with the highest peak memory (KB, seconds, query)"
+        sort -rn $measure_log | head -20 | awk '{ print $1, $2, $NF }'
+        awk '{ mem += $1; secs += $2; if ($1 > peak) peak = $1 } END { if (NR) printf "%d compiles: total %.1fs, mean peak memory %dKB, max peak memory %dKB\n", NR, secs, mem/NR, peak }' $measure_log
+        echo
+    fi
 fi
 
 ## Compare to golden standard (ignore obvious differences)
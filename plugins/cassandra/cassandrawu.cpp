@@ -43,6 +43,8 @@
 #include "cassandraembed.hpp"
 
 #include <list>
+#include <unordered_map>
+#include <vector>
 #include <string>
 #include <algorithm>
 
@@ -52,6 +54,8 @@ namespace cassandraembed {
 
 #define CASS_WU_QUERY_EXPIRES  (1000*60*5)
 #define CASS_WORKUNIT_POSTSORT_LIMIT 10000
+#define CASS_WORKUNIT_PIPELINE_LIMIT 64
+#define DEFAULT_SECTION_CACHE_MB 32
 
 #define DEFAULT_PREFIX_SIZE 2
 #define MIN_PREFIX_SIZE 2
@@ -87,10 +91,15 @@ interface ICassandraSession : public IInterface  // MORE - rename!
     virtual void executeAsync(CIArrayOf<CassandraStatement> &batch, const char *what) const = 0;
 
     virtual const CassResult *fetchDataForWuid(const CassandraXmlMapping *mappings, const char *wuid, bool includeWuid) const = 0;
+    virtual CassandraStatement *createFetchForWuid(const CassandraXmlMapping *mappings, const char *wuid, bool includeWuid) const = 0;
     virtual const CassResult *fetchDataForWuidAndKey(const CassandraXmlMapping *mappings, const char *wuid, const char *key) const = 0;
     virtual void deleteChildByWuid(const CassandraXmlMapping *mappings, const char *wuid, CassBatch *batch) const = 0;
     virtual IPTree *cassandraToWorkunitXML(const char *wuid) const = 0;
 
+    virtual bool lookupSection(const char *wuid, const char *section, const char *version, MemoryBuffer &out) const = 0;
+    virtual void noteSection(const char *wuid, const char *section, const char *version, MemoryBuffer &in) const = 0;
+    virtual void clearSections(const char *wuid) const = 0;
+
     virtual unsigned queryPrefixSize() const = 0;
     virtual unsigned queryPartitions() const = 0;
 };
@@ -1306,6 +1315,32 @@ const CassResult *executeQuery(CassSession *session, CassStatement *statement)
     return cass_future_get_result(future);
 }
 
+// Issues a set of queries without waiting for each one to complete, so that the round trips overlap rather
+// than being serialized.  Results are collected in the order that the queries were added.
+
+class CassandraQueryPipeline
+{
+public:
+    CassandraQueryPipeline(CassSession *_session) : session(_session)
+    {
+    }
+    void add(CassStatement *statement)
+    {
+        futures.append(*new CassandraFuture(cass_session_execute(session, statement)));
+    }
+    const CassResult *getResult(unsigned idx, const char *why) const
+    {
+        CassandraFuture &future = futures.item(idx);
+        future.wait(why);
+        return cass_future_get_result(future);
+    }
+    inline unsigned ordinality() const { return futures.ordinality(); }
+    inline void kill() { futures.kill(); }
+private:
+    CassSession *session;
+    CIArrayOf<CassandraFuture> futures;
+};
+
 void deleteSecondaryByKey(const char * xpath, const char *key, const char *wuid, const ICassandraSession *sessionCache, CIArrayOf<CassandraStatement> &batch)
 {
     if (key)
@@ -2246,6 +2281,7 @@ public:
         check(cass_batch_add_statement(mainBatch, update));
         executeBatch(mainBatch, "delete wu");
         executeAsync(deleteSearches, "delete wu");
+        sessionCache->clearSections(wuid);
     }
 
     virtual void commit()
@@ -2264,6 +2300,8 @@ public:
         {
             if (prev) // Holds the values of the "basic" info at the last commit
                 updateSecondaries(wuid, secondaryBatch);
+            if (cachedSectionsDirty())
+                stampCachedSections();
             simpleXMLtoCassandra(sessionCache, batch, workunitsMappings, p);  // This just does the parent row
         }
         if (allDirty && !isGlobal)
@@ -2344,6 +2382,8 @@ public:
         CassandraFuture futureBatch(cass_session_execute_batch(sessionCache->querySession(), batch));
         futureBatch.wait("commit updates");
         executeAsync(secondaryBatch, "commit");
+        if (allDirty || dirtyPaths.count())
+            sessionCache->clearSections(wuid);
         if (stateChanged)
         {
             // Signal changes to state to anyone that might be watching via Dali
@@ -2579,8 +2619,7 @@ public:
         IPropertyTree *fromP = queryExtendedWU(cached)->queryPTree();
         for (const char * const *search = searchPaths; *search; search++)
             trackSecondaryChange(fromP->queryProp(*search), *search);
-        for (const ChildTableInfo * const * table = childTables; *table != NULL; table++)
-            checkChildLoaded(**table);
+        checkChildrenLoaded(childTables);
         CPersistedWorkUnit::copyWorkUnit(cached, copyStats, all);
         memset(childLoaded, 1, sizeof(childLoaded));
         allDirty = true;
@@ -2843,8 +2882,7 @@ public:
     {
         // If anyone wants the whole ptree, we'd better make sure we have fully loaded it...
         CriticalBlock b(crit);
-        for (const ChildTableInfo * const * table = childTables; *table != NULL; table++)
-            checkChildLoaded(**table);
+        checkChildrenLoaded(childTables);
         return CPersistedWorkUnit::getUnpackedTree(includeProgress);
     }
 
@@ -2852,8 +2890,7 @@ public:
     {
         // If anyone wants the whole ptree, we'd better make sure we have fully loaded it...
         CriticalBlock b(crit);
-        for (const ChildTableInfo * const * table = childTables; *table != NULL; table++)
-            checkChildLoaded(**table);
+        checkChildrenLoaded(childTables);
         // And a hack for the fact that Dali stores state in both @state and <state>
         const char *stateStr = p->queryProp("@state");
         if (stateStr)
@@ -2966,29 +3003,57 @@ protected:
     void checkChildLoaded(const ChildTableInfo &childTable) const
     {
         // NOTE - should be called inside critsec
-        if (!childLoaded[childTable.index])
+        const ChildTableInfo * const tables[] = { &childTable, NULL };
+        checkChildrenLoaded(tables);
+    }
+
+    // Lazy-populate several child tables - the queries for any that are not yet loaded are issued together
+    void checkChildrenLoaded(const ChildTableInfo * const * tables) const
+    {
+        // NOTE - should be called inside critsec
+        CassandraQueryPipeline pipeline(sessionCache->querySession());
+        std::vector<const ChildTableInfo *> pending;
+        bool pendingIndex[ChildTablesSize] = { false };
+        for (const ChildTableInfo * const * table = tables; *table != NULL; table++)
+        {
+            const ChildTableInfo &childTable = **table;
+            if (childLoaded[childTable.index] || pendingIndex[childTable.index])
+                continue;
+            if (loadCachedSection(childTable))
+            {
+                childLoaded[childTable.index] = true;
+                continue;
+            }
+            try
+            {
+                Owned<CassandraStatement> select = sessionCache->createFetchForWuid(childTable.mappings, queryWuid(), false);
+                pipeline.add(*select);
+            }
+            catch (IException* e)
+            {
+                failChildRead(childTable, e);
+            }
+            pending.push_back(&childTable);
+            pendingIndex[childTable.index] = true;
+        }
+
+        for (unsigned i = 0; i < pending.size(); i++)
         {
+            const ChildTableInfo &childTable = *pending[i];
             const CassResult* cassResult;
             try
             {
-                cassResult = sessionCache->fetchDataForWuid(childTable.mappings, queryWuid(), false);
+                cassResult = pipeline.getResult(i, "load child table");
             }
             catch (IException* e)
             {
-                int errorCode = e->errorCode();
-                StringBuffer origErrorMsg;
-                e->errorMessage(origErrorMsg);
-                e->Release();
-
-                const char* tableName = queryTableName(childTable.mappings);
-
-                VStringBuffer newErrorMsg("Failed to read from cassandra table '%s' (Have you run wutool to initialize cassandra repository?), [%s]", tableName, origErrorMsg.str());
-
-                rtlFail(errorCode, newErrorMsg);
+                failChildRead(childTable, e);
             }
 
             CassandraResult result(cassResult);
             IPTree *results = p->queryPropTree(childTable.parentElement);
+            StringBuffer sectionVersion;
+            bool cacheable = !results && getSectionVersion(sectionVersion, childTable);
             CassandraIterator rows(cass_iterator_from_result(result));
             while (cass_iterator_next(rows))
             {
@@ -3015,10 +3080,87 @@ protected:
                     results->addPropTree(childName, child.getClear());
                 }
             }
+            if (cacheable && results)
+            {
+                MemoryBuffer serialized;
+                results->serialize(serialized);
+                sessionCache->noteSection(queryWuid(), childTable.parentElement, sectionVersion, serialized);
+            }
             childLoaded[childTable.index] = true;
         }
     }
 
+    static void failChildRead(const ChildTableInfo &childTable, IException *e)
+    {
+        int errorCode = e->errorCode();
+        StringBuffer origErrorMsg;
+        e->errorMessage(origErrorMsg);
+        e->Release();
+
+        const char* tableName = queryTableName(childTable.mappings);
+
+        VStringBuffer newErrorMsg("Failed to read from cassandra table '%s' (Have you run wutool to initialize cassandra repository?), [%s]", tableName, origErrorMsg.str());
+
+        rtlFail(errorCode, newErrorMsg);
+    }
+
+    // The query and the graphs of a workunit that has finished rarely change, so they can be served from a cache
+    // in the factory rather than being re-read every time the workunit is opened.  Every commit that writes either
+    // section stores a new stamp in the (always re-read) workunit row, and the stamp is the version of a cached
+    // section, so changes made by any process are seen.  Workunits without a stamp are never cached.
+    bool cachedSectionsDirty() const
+    {
+        if (allDirty)
+            return true;
+        HashIterator iter(dirtyPaths);
+        ForEach (iter)
+        {
+            const CassandraXmlMapping *table = *dirtyPaths.mapToValue(&iter.query());
+            if ((table == wuQueryMappings) || (table == wuGraphsMappings))
+                return true;
+        }
+        return false;
+    }
+    void stampCachedSections()
+    {
+        VStringBuffer stamp("%" I64F "x.%x", getTimeStampNowValue(), getRandom());
+        p->setProp("@_sectionStamp", stamp);
+    }
+    bool getSectionVersion(StringBuffer &version, const ChildTableInfo &childTable) const
+    {
+        if ((&childTable != &wuQueriesTable) && (&childTable != &wuGraphsTable))
+            return false;
+        if (allDirty)
+            return false;
+        const char *stamp = p->queryProp("@_sectionStamp");
+        if (!stamp)
+            return false;
+        switch (getState())
+        {
+        case WUStateCompleted:
+        case WUStateFailed:
+        case WUStateAborted:
+        case WUStateArchived:
+            break;
+        default:
+            return false;
+        }
+        version.append(p->queryProp("@state")).append('|').append(stamp);
+        return true;
+    }
+
+    bool loadCachedSection(const ChildTableInfo &childTable) const
+    {
+        StringBuffer sectionVersion;
+        if (p->hasProp(childTable.parentElement) || !getSectionVersion(sectionVersion, childTable))
+            return false;
+        MemoryBuffer serialized;
+        if (!sessionCache->lookupSection(queryWuid(), childTable.parentElement, sectionVersion, serialized))
+            return false;
+        p->setPropTree(childTable.parentElement, createPTree(serialized));
+        return true;
+    }
+
     // Update secondary tables (used to search wuids by owner, state, jobname etc)
 
     void updateSecondaryTable(const char *xpath, const char *prevKey, const char *wuid, CIArrayOf<CassandraStatement> &batch)
@@ -3222,6 +3364,93 @@ public:
     }
 };
 
+// A size limited LRU cache of serialized workunit sections that do not change once the workunit has finished.
+// Each entry is tagged with a version supplied by the caller - a lookup only matches if the versions agree.
+
+class CassandraSectionCache
+{
+    struct Entry
+    {
+        std::string key;
+        std::string version;
+        MemoryBuffer data;
+    };
+    typedef std::list<Entry> EntryList;
+public:
+    CassandraSectionCache() : maxSize((memsize_t)DEFAULT_SECTION_CACHE_MB * 0x100000)
+    {
+    }
+    void setLimit(memsize_t _maxSize)
+    {
+        CriticalBlock b(crit);
+        maxSize = _maxSize;
+        trim();
+    }
+    bool lookup(const char *wuid, const char *section, const char *version, MemoryBuffer &out)
+    {
+        std::string key = makeKey(wuid, section);
+        CriticalBlock b(crit);
+        auto match = entries.find(key);
+        if (match == entries.end() || match->second->version != version)
+            return false;
+        lru.splice(lru.begin(), lru, match->second);
+        out.append(match->second->data.length(), match->second->data.toByteArray());
+        return true;
+    }
+    void add(const char *wuid, const char *section, const char *version, MemoryBuffer &in)
+    {
+        if (in.length() > maxSize / 4)
+            return;
+        std::string key = makeKey(wuid, section);
+        CriticalBlock b(crit);
+        removeKey(key);
+        lru.emplace_front();
+        Entry &entry = lru.front();
+        entry.key = key;
+        entry.version = version;
+        entry.data.append(in.length(), in.toByteArray());
+        entries[key] = lru.begin();
+        curSize += in.length();
+        trim();
+    }
+    void remove(const char *wuid)
+    {
+        CriticalBlock b(crit);
+        for (const char * const * table = cachedSections; *table; table++)
+            removeKey(makeKey(wuid, *table));
+    }
+private:
+    static std::string makeKey(const char *wuid, const char *section)
+    {
+        std::string key(wuid);
+        key.push_back('|');
+        key.append(section);
+        return key;
+    }
+    void removeKey(const std::string &key)
+    {
+        auto match = entries.find(key);
+        if (match != entries.end())
+        {
+            curSize -= match->second->data.length();
+            lru.erase(match->second);
+            entries.erase(match);
+        }
+    }
+    void trim()
+    {
+        while (curSize > maxSize && !lru.empty())
+            removeKey(lru.back().key);
+    }
+
+    static constexpr const char *cachedSections[] = { "Query", "Graphs", nullptr };
+    CriticalSection crit;
+    EntryList lru;
+    std::unordered_map<std::string, EntryList::iterator> entries;
+    memsize_t maxSize;
+    memsize_t curSize = 0;
+};
+
 class CCasssandraWorkUnitFactory : public CWorkUnitFactory, implements ICassandraSession
 {
     IMPLEMENT_IINTERFACE;
@@ -3248,6 +3477,8 @@ public:
                     else if (partitions > MAX_PARTITIONS)
                         partitions = MAX_PARTITIONS;
                 }
+                else if (strieq(opt, "sectionCacheMB"))
+                    sectionCache.setLimit((memsize_t)atoi(val) * 0x100000);
                 else if (strieq(opt, "prefixSize"))
                 {
                     prefixSize = atoi(val);   // Note this value is only used when creating a new repo
@@ -3685,12 +3916,27 @@ public:
                 const IPostFilter &fileFilter = fileFilters.item(0);
                 CassandraResult wuids(fetchDataForFiles(fileFilter.queryValue(), wuidFilters, fileFilter.queryField()==WUSFfileread));
                 CassandraIterator rows(cass_iterator_from_result(wuids));
+                CassandraQueryPipeline pipeline(querySession());
                 StringBuffer value;
-                while (cass_iterator_next(rows))
+                for (;;)
                 {
-                    const CassRow *row = cass_iterator_get_row(rows);
-                    getCassString(value.clear(), cass_row_get_column(row, 0));
-                    merger->addResult(*new CassandraResult(fetchDataForWuid(workunitInfoMappings, value, true)));
+                    bool more = cass_iterator_next(rows);
+                    if (more)
+                    {
+                        const CassRow *row = cass_iterator_get_row(rows);
+                        getCassString(value.clear(), cass_row_get_column(row, 0));
+                        Owned<CassandraStatement> select = createFetchForWuid(workunitInfoMappings, value, true);
+                        pipeline.add(*select);
+                    }
+                    // Limit the number of lookups that are in flight at once
+                    if (!more || pipeline.ordinality() >= CASS_WORKUNIT_PIPELINE_LIMIT)
+                    {
+                        for (unsigned i = 0; i < pipeline.ordinality(); i++)
+                            merger->addResult(*new CassandraResult(pipeline.getResult(i, "fetch for files")));
+                        pipeline.kill();
+                    }
+                    if (!more)
+                        break;
                 }
             }
             else if (sortByThorTime || !thorTimeThreshold.isEmpty())
@@ -3723,12 +3969,7 @@ public:
                 {
                     StringArray values;
                     values.appendListUniq(queryValue, "|");
-                    ForEachItemIn(vidx, values)
-                    {
-                        const char *thisValue = values.item(vidx);
-                        if (!isEmptyString(thisValue))
-                            merger->addResult(*new CassandraResult(fetchDataForKeyWithFilter(best.queryXPath(), thisValue, wuidFilters, sortorder, merger->hasPostFilters() ? 0 : pageSize+startOffset)));
-                    }
+                    fetchDataForKeysWithFilter(*merger, best.queryXPath(), values, wuidFilters, sortorder, merger->hasPostFilters() ? 0 : pageSize+startOffset);
                 }
                 else
                     merger->addResult(*new CassandraResult(fetchDataForKeyWithFilter(best.queryXPath(), best.queryValue(), wuidFilters, sortorder, merger->hasPostFilters() ? 0 : pageSize+startOffset)));
@@ -3743,12 +3984,7 @@ public:
                 {
                     StringArray values;
                     values.appendListUniq(queryValue, "|");
-                    ForEachItemIn(vidx, values)
-                    {
-                        const char *thisValue = values.item(vidx);
-                        if (!isEmptyString(thisValue))
-                            merger->addResult(*new CassandraResult(fetchDataForKeyWithFilter(best.queryXPath(), thisValue, wuidFilters, sortorder, merger->hasPostFilters() ? 0 : pageSize+startOffset)));
-                    }
+                    fetchDataForKeysWithFilter(*merger, best.queryXPath(), values, wuidFilters, sortorder, merger->hasPostFilters() ? 0 : pageSize+startOffset);
                 }
                 else
                     merger->addResult(*new CassandraResult(fetchDataForKeyWithFilter(best.queryXPath(), best.queryValue(), wuidFilters, sortorder, merger->hasPostFilters() ? 0 : pageSize+startOffset)));
@@ -3761,18 +3997,12 @@ public:
                 StringArray fieldValues;
                 const IPostFilter &best= remoteWildFilters.item(0);
                 _getUniqueValues(best.queryXPath(), best.queryValue(), fieldValues);
-                ForEachItemIn(idx, fieldValues)
-                {
-                    merger->addResult(*new CassandraResult(fetchDataForKeyWithFilter(best.queryXPath(), fieldValues.item(idx), wuidFilters, sortorder, merger->hasPostFilters() ? 0 : pageSize+startOffset)));
-                }
+                fetchDataForKeysWithFilter(*merger, best.queryXPath(), fieldValues, wuidFilters, sortorder, merger->hasPostFilters() ? 0 : pageSize+startOffset);
             }
             else
             {
                 // If all we have is a wuid range (or nothing), search the wuid table and/or return everything
-                for (int i = 0; i < partitions; i++)
-                {
-                    merger->addResult(*new CassandraResult(fetchDataByPartition(workunitInfoMappings, i, wuidFilters, sortorder, merger->hasPostFilters() ? 0 : pageSize+startOffset)));
-                }
+                fetchDataByAllPartitions(*merger, workunitInfoMappings, wuidFilters, sortorder, merger->hasPostFilters() ? 0 : pageSize+startOffset);
             }
 
             // The result we have will be sorted by wuid (ascending or descending)
@@ -4123,10 +4353,7 @@ private:
         if (!key || !*key)
         {
             IArrayOf<IPostFilter> wuidFilters;
-            for (int i = 0; i < partitions; i++)
-            {
-                merger->addResult(*new CassandraResult(fetchDataByPartition(workunitInfoMappings, i, wuidFilters)));
-            }
+            fetchDataByAllPartitions(*merger, workunitInfoMappings, wuidFilters);
         }
         else
             merger->addResult(*new CassandraResult(fetchDataForKey(xpath, key)));
@@ -4259,6 +4486,21 @@ private:
             return NULL;
     }
 
+    virtual bool lookupSection(const char *wuid, const char *section, const char *version, MemoryBuffer &out) const override
+    {
+        return sectionCache.lookup(wuid, section, version, out);
+    }
+
+    virtual void noteSection(const char *wuid, const char *section, const char *version, MemoryBuffer &in) const override
+    {
+        sectionCache.add(wuid, section, version, in);
+    }
+
+    virtual void clearSections(const char *wuid) const override
+    {
+        sectionCache.remove(wuid);
+    }
+
     // Fetch all rows from a table
 
     const CassResult *fetchData(const CassandraXmlMapping *mappings) const
@@ -4276,6 +4518,26 @@ private:
     // Fetch all rows from a single partition of a table
 
     const CassResult *fetchDataByPartition(const CassandraXmlMapping *mappings, int partition, const IArrayOf<IPostFilter> &wuidFilters, unsigned sortOrder=WUSFwuid|WUSFreverse, unsigned limit=0) const
+    {
+        Owned<CassandraStatement> select = createFetchByPartition(mappings, partition, wuidFilters, sortOrder, limit);
+        return executeQuery(querySession(), *select);
+    }
+
+    // Fetch from every partition, with the queries executing concurrently
+
+    void fetchDataByAllPartitions(CassMultiIterator &merger, const CassandraXmlMapping *mappings, const IArrayOf<IPostFilter> &wuidFilters, unsigned sortOrder=WUSFwuid|WUSFreverse, unsigned limit=0) const
+    {
+        CassandraQueryPipeline pipeline(querySession());
+        for (int i = 0; i < partitions; i++)
+        {
+            Owned<CassandraStatement> select = createFetchByPartition(mappings, i, wuidFilters, sortOrder, limit);
+            pipeline.add(*select);
+        }
+        for (unsigned i = 0; i < pipeline.ordinality(); i++)
+            merger.addResult(*new CassandraResult(pipeline.getResult(i, "fetch by partition")));
+    }
+
+    CassandraStatement *createFetchByPartition(const CassandraXmlMapping *mappings, int partition, const IArrayOf<IPostFilter> &wuidFilters, unsigned sortOrder, unsigned limit) const
     {
         StringBuffer names;
         StringBuffer tableName;
@@ -4305,29 +4567,35 @@ private:
         if (limit)
             selectQuery.appendf(" LIMIT %u", limit);
         selectQuery.append(';');
-        CassandraStatement select(prepareStatement(selectQuery));
-        select.bindInt32(0, partition);
+        Owned<CassandraStatement> select = new CassandraStatement(prepareStatement(selectQuery));
+        select->bindInt32(0, partition);
         ForEachItemIn(idx2, wuidFilters)
         {
             const IPostFilter &wuidFilter = wuidFilters.item(idx2);
-            select.bindString(idx2+1, wuidFilter.queryValue());
+            select->bindString(idx2+1, wuidFilter.queryValue());
         }
-        return executeQuery(querySession(), select);
+        return select.getClear();
     }
 
     // Fetch matching rows from a child table, or the main wu table
 
     const CassResult *fetchDataForWuid(const CassandraXmlMapping *mappings, const char *wuid, bool includeWuid) const
+    {
+        Owned<CassandraStatement> select = createFetchForWuid(mappings, wuid, includeWuid);
+        return executeQuery(querySession(), *select);
+    }
+
+    CassandraStatement *createFetchForWuid(const CassandraXmlMapping *mappings, const char *wuid, bool includeWuid) const
     {
         assertex(wuid && *wuid);
         StringBuffer names;
         StringBuffer tableName;
         getFieldNames(mappings + (includeWuid ? 1 : 2), names, tableName);  // mappings+2 means we don't return the partition or wuid columns
         VStringBuffer selectQuery("select %s from %s where partition=? and wuid=?;", names.str()+1, tableName.str());
-        CassandraStatement select(prepareStatement(selectQuery));
-        select.bindInt32(0, rtlHash32VStr(wuid, 0) % partitions);
-        select.bindString(1, wuid);
-        return executeQuery(querySession(), select);
+        Owned<CassandraStatement> select = new CassandraStatement(prepareStatement(selectQuery));
+        select->bindInt32(0, rtlHash32VStr(wuid, 0) % partitions);
+        select->bindString(1, wuid);
+        return select.getClear();
     }
 
     const CassResult *fetchDataForWuidAndKey(const CassandraXmlMapping *mappings, const char *wuid, const char *key) const
@@ -4366,6 +4634,30 @@ private:
     // Fetch matching rows from the search table, for all wuids, sorted by wuid
 
     const CassResult *fetchDataForKeyWithFilter(const char *xpath, const char *key, const IArrayOf<IPostFilter> &wuidFilters, unsigned sortOrder, unsigned limit) const
+    {
+        Owned<CassandraStatement> select = createFetchForKeyWithFilter(xpath, key, wuidFilters, sortOrder, limit);
+        return executeQuery(querySession(), *select);
+    }
+
+    // As above, for a list of keys, with the queries executing concurrently
+
+    void fetchDataForKeysWithFilter(CassMultiIterator &merger, const char *xpath, const StringArray &keys, const IArrayOf<IPostFilter> &wuidFilters, unsigned sortOrder, unsigned limit) const
+    {
+        CassandraQueryPipeline pipeline(querySession());
+        ForEachItemIn(idx, keys)
+        {
+            const char *key = keys.item(idx);
+            if (!isEmptyString(key))
+            {
+                Owned<CassandraStatement> select = createFetchForKeyWithFilter(xpath, key, wuidFilters, sortOrder, limit);
+                pipeline.add(*select);
+            }
+        }
+        for (unsigned i = 0; i < pipeline.ordinality(); i++)
+            merger.addResult(*new CassandraResult(pipeline.getResult(i, "fetch for key")));
+    }
+
+    CassandraStatement *createFetchForKeyWithFilter(const char *xpath, const char *key, const IArrayOf<IPostFilter> &wuidFilters, unsigned sortOrder, unsigned limit) const
     {
         StringBuffer names;
         StringBuffer tableName;
@@ -4394,16 +4686,16 @@ private:
         }
         if (limit)
             selectQuery.appendf(" LIMIT %u", limit);
-        CassandraStatement select(prepareStatement(selectQuery));
-        select.bindString(0, xpath);
-        select.bindString_n(1, ucKey, prefixSize);
-        select.bindString(2, ucKey);
+        Owned<CassandraStatement> select = new CassandraStatement(prepareStatement(selectQuery));
+        select->bindString(0, xpath);
+        select->bindString_n(1, ucKey, prefixSize);
+        select->bindString(2, ucKey);
         ForEachItemIn(idx2, wuidFilters)
         {
             const IPostFilter &wuidFilter = wuidFilters.item(idx2);
-            select.bindString(3+idx2, wuidFilter.queryValue());
+            select->bindString(3+idx2, wuidFilter.queryValue());
         }
-        return executeQuery(querySession(), select);
+        return select.getClear();
     }
 
     // Fetch matching rows from the search or uniqueSearch table, for a given prefix
@@ -4609,6 +4901,7 @@ private:
     CassandraClusterSession cluster;
     mutable CriticalSection cacheCrit;
     mutable MapXToMyClass<__uint64, __uint64, CCassandraWuUQueryCacheEntry> cacheIdMap;
+    mutable CassandraSectionCache sectionCache;
 };
 
 
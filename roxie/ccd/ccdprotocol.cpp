@@ -59,6 +59,9 @@ public:
         numRequestArrayThreads = ctx.ctxGetPropInt("@requestArrayThreads", 5);
         maxHttpConnectionRequests = ctx.ctxGetPropInt("@maxHttpConnectionRequests", 0);
         maxHttpKeepAliveWait = ctx.ctxGetPropInt("@maxHttpKeepAliveWait", 5000); // In milliseconds
+        numAcceptThreads = ctx.ctxGetPropInt("@acceptThreads", 1);
+        if (!numAcceptThreads)
+            numAcceptThreads = 1;
     }
     IHpccProtocolListener *createListener(const char *protocol, IHpccProtocolMsgSink *sink, unsigned port, unsigned listenQueue, const char *config, const ISyncedPropertyTree *tlsConfig)
     {
@@ -72,6 +75,7 @@ public:
     unsigned numRequestArrayThreads;
     unsigned maxHttpConnectionRequests = 0;
     unsigned maxHttpKeepAliveWait = 5000;
+    unsigned numAcceptThreads = 1;
     bool trapTooManyActiveQueries;
 };
 
@@ -219,9 +223,44 @@ unsigned ProtocolListener::lastCore;
 
 class ProtocolSocketListener : public ProtocolListener
 {
+    // Additional threads accepting connections on their own listening socket, sharing the port (SO_REUSEPORT)
+    // with the main listener thread so that the kernel spreads incoming connections between them.
+    class CAcceptThread : public Thread
+    {
+        ProtocolSocketListener &owner;
+        Owned<ISocket> socket;
+        std::atomic<bool> closing{false};
+    public:
+        CAcceptThread(ProtocolSocketListener &_owner, ISocket *_socket) : Thread("RoxieAcceptor"), owner(_owner), socket(_socket)
+        {
+        }
+        virtual int run() override
+        {
+            owner.acceptConnections(*socket, &closing);
+            return 0;
+        }
+        void cancel()
+        {
+            if (socket)
+                socket->cancel_accept();
+        }
+        void closeSocket()
+        {
+            // The thread may be blocked in accept() on the socket - it must have exited before the socket is released
+            closing = true;
+            cancel();
+            if (join(acceptorCloseTimeout))
+                socket.clear();
+        }
+    };
+
+    static constexpr unsigned acceptorCloseTimeout = 5000;
+
     unsigned port;
     unsigned listenQueue;
+    unsigned numAcceptThreads = 1;
     Owned<ISocket> socket;
+    CIArrayOf<CAcceptThread> acceptors;
     SocketEndpoint ep;
     StringAttr protocol;
     Owned<ISecureSocketContext> secureContext;
@@ -233,6 +272,8 @@ public:
     {
         port = _port;
         listenQueue = _listenQueue;
+        if (global)
+            numAcceptThreads = global->numAcceptThreads;
         ep.set(port, queryHostIP());
         protocol.set(_protocol);
         isSSL = streq(protocol.str(), "ssl");
@@ -252,9 +293,19 @@ public:
 
     virtual bool stop()
     {
+        bool wasRunning = running;
         if (socket)
             socket->cancel_accept();
-        return ProtocolListener::stop();
+        ForEachItemIn(i, acceptors)
+            acceptors.item(i).cancel();
+        bool ret = ProtocolListener::stop();
+        if (wasRunning)
+        {
+            ForEachItemIn(i2, acceptors)
+                acceptors.item(i2).join();
+        }
+        acceptors.kill();
+        return ret;
     }
 
     virtual void disconnectQueue()
@@ -269,6 +320,8 @@ public:
         {
             DBGLOG("Closing listening socket %d", port);
             socket.clear();
+            ForEachItemIn(i, acceptors)
+                acceptors.item(i).closeSocket();
             DBGLOG("Closed listening socket %d", port);
         }
         catch(...)
@@ -330,20 +383,46 @@ public:
     virtual int run()
     {
         DBGLOG("ProtocolSocketListener (%d threads) listening to socket on port %d", sink->getPoolSize(), port);
-        socket.setown(ISocket::create(port, listenQueue));
+        if (numAcceptThreads > 1)
+        {
+            socket.setown(ISocket::create_shared(port, listenQueue));
+            for (unsigned i=1; i < numAcceptThreads; i++)
+            {
+                try
+                {
+                    acceptors.append(*new CAcceptThread(*this, ISocket::create_shared(port, listenQueue)));
+                }
+                catch (IException *E)
+                {
+                    EXCLOG(E, "ProtocolSocketListener failed to create additional listening socket");
+                    E->Release();
+                    break;
+                }
+            }
+            DBGLOG("ProtocolSocketListener accepting connections on port %d using %u threads", port, acceptors.ordinality()+1);
+        }
+        else
+            socket.setown(ISocket::create(port, listenQueue));
         running = true;
+        ForEachItemIn(i, acceptors)
+            acceptors.item(i).start(false);
         started.signal();
-        while (running)
+        acceptConnections(*socket);
+        DBGLOG("ProtocolSocketListener closed query socket");
+        return 0;
+    }
+
+    void acceptConnections(ISocket &listenSocket, const std::atomic<bool> *closing = nullptr)
+    {
+        while (running && !(closing && *closing))
         {
-            Owned<ISocket> client = socket->accept(true);
+            Owned<ISocket> client = listenSocket.accept(true);
             if (client)
             {
                 client->set_linger(-1);
                 pool->start(client.getClear());
             }
         }
-        DBGLOG("ProtocolSocketListener closed query socket");
-        return 0;
     }
 
     virtual IPooledThread *createNew();
@@ -10319,14 +10319,52 @@ IRoxieServerActivityFactory *createRoxieServerStreamedIteratorActivityFactory(un
 
 class CRoxieServerFilterActivity : public CRoxieServerLateStartActivity
 {
+    static constexpr unsigned filterBlockSize = 64;
+
     IHThorFilterArg &helper;
     bool anyThisGroup;
     IRangeCompare * stepCompare;
+    //Unless the input can be stepped, rows are read and filtered a block at a time
+    RtlFilterBlock block;
+    bool useBlock = false;
+    bool endOfGroup = false;
+
+    const void * nextBlockRow()
+    {
+        for (;;)
+        {
+            const void * ret = block.nextResult();
+            if (ret)
+            {
+                anyThisGroup = true;
+                processed++;
+                return ret;
+            }
+            const void * firstRow = NULL;
+            if (endOfGroup)
+            {
+                endOfGroup = false;
+                //stop returning two NULLs in a row.
+                if (anyThisGroup)
+                {
+                    anyThisGroup = false;
+                    return NULL;
+                }
+                firstRow = inputStream->nextRow();
+                if (!firstRow)
+                {
+                    eof = true;
+                    return NULL;                // eof...
+                }
+            }
+            endOfGroup = block.fill(*inputStream, firstRow);
+        }
+    }
 
 public:
 
     CRoxieServerFilterActivity(IRoxieAgentContext *_ctx, const IRoxieServerActivityFactory *_factory, IProbeManager *_probeManager)
-        : CRoxieServerLateStartActivity(_ctx, _factory, _probeManager), helper((IHThorFilterArg &)basehelper)
+        : CRoxieServerLateStartActivity(_ctx, _factory, _probeManager), helper((IHThorFilterArg &)basehelper), block(helper, filterBlockSize)
     {
         anyThisGroup = false;
         stepCompare = NULL;
@@ -10335,23 +10373,44 @@ public:
     virtual void doStart(unsigned parentExtractSize, const byte *parentExtract, bool paused)
     {
         anyThisGroup = false;
+        block.reset();
+        endOfGroup = false;
         CRoxieServerLateStartActivity::doStart(parentExtractSize, parentExtract, paused);
         lateStart(parentExtractSize, parentExtract, helper.canMatchAny());
 
         stepCompare = NULL;
+        useBlock = false;
         if (!eof)
         {
             IInputSteppingMeta * stepMeta = input->querySteppingMeta();
             if (stepMeta)
                 stepCompare = stepMeta->queryCompare();
+            else
+                useBlock = true;
         }
     }
 
+    virtual void stop()
+    {
+        block.reset();
+        endOfGroup = false;
+        CRoxieServerLateStartActivity::stop();
+    }
+
+    virtual void reset()
+    {
+        block.reset();
+        endOfGroup = false;
+        CRoxieServerLateStartActivity::reset();
+    }
+
     virtual const void * nextRow()
     {
         ActivityTimer t(activityStats, timeActivities);
         if (eof)
             return NULL;
+        if (useBlock)
+            return nextBlockRow();
         for (;;)
         {
             OwnedConstRoxieRow ret(inputStream->nextRow());
@@ -10436,6 +10495,8 @@ public:
     { 
         eof = prefiltered;
         anyThisGroup = false;
+        block.reset();
+        endOfGroup = false;
         inputStream->resetEOF();
     }
 
@@ -15073,40 +15134,65 @@ class CRoxieServerStrandedProjectActivity : public CRoxieServerStrandedActivity
     class ProjectProcessor : public StrandProcessor
     {
     protected:
+        static constexpr unsigned projectBlockSize = 64;
+
         IHThorProjectArg &helper;
+        RtlProjectBlock block;
+        bool endOfGroup = false;
 
     public:
         ProjectProcessor(CRoxieServerActivity &_parent, IEngineRowStream *_inputStream, IHThorProjectArg &_helper)
-        : StrandProcessor(_parent, _inputStream, true), helper(_helper)
+        : StrandProcessor(_parent, _inputStream, true), helper(_helper), block(_helper, rowAllocator, projectBlockSize)
+        {
+        }
+        virtual void stop() override
+        {
+            block.reset();
+            endOfGroup = false;
+            StrandProcessor::stop();
+        }
+        virtual void reset() override
+        {
+            block.reset();
+            endOfGroup = false;
+            StrandProcessor::reset();
+        }
+        virtual void resetEOF() override
         {
+            block.reset();
+            endOfGroup = false;
+            StrandProcessor::resetEOF();
         }
         virtual const void * nextRow()
         {
             ActivityTimer t(activityStats, timeActivities);
             for (;;)
             {
-                OwnedConstRoxieRow in = inputStream->nextRow();
-                if (!in)
+                const void * ret = block.nextResult();
+                if (ret)
                 {
-                    if (numProcessedLastGroup == processed)
-                        in.setown(inputStream->nextRow());
-                    if (!in)
+                    processed++;
+                    return ret;
+                }
+
+                //Transform the rows up to the end of the group (or a block full) with a single call to the helper
+                const void * firstRow = NULL;
+                if (endOfGroup)
+                {
+                    endOfGroup = false;
+                    if (numProcessedLastGroup != processed)
                     {
                         numProcessedLastGroup = processed;
                         return NULL;
                     }
+                    //Nothing was returned for the group, so skip it.  Two ends of group in a row indicates eof.
+                    firstRow = inputStream->nextRow();
+                    if (!firstRow)
+                        return NULL;
                 }
-
                 try
                 {
-                    RtlDynamicRowBuilder rowBuilder(rowAllocator);
-                    size32_t outSize;
-                    outSize = helper.transform(rowBuilder, in);
-                    if (outSize)
-                    {
-                        processed++;
-                        return rowBuilder.finalizeRowClear(outSize);
-                    }
+                    endOfGroup = block.fill(*inputStream, firstRow);
                 }
                 catch (IException *E)
                 {
@@ -6541,6 +6541,8 @@ class EclRtlTests : public CppUnit::TestFixture
     CPPUNIT_TEST_SUITE( EclRtlTests );
         CPPUNIT_TEST(RegexTest);
         CPPUNIT_TEST(MultiRegexTest);
+        CPPUNIT_TEST(FixedCompareTest);
+        CPPUNIT_TEST(FixedHashTest);
     CPPUNIT_TEST_SUITE_END();
 
 protected:
@@ -6588,6 +6590,56 @@ protected:
         t2.join();
         t3.join();
     }
+
+    static int sign(int value)
+    {
+        return (value > 0) - (value < 0);
+    }
+
+    void FixedCompareTest()
+    {
+        //Compare with memcmp for all lengths that exercise the 8, 4 and single byte paths, with the difference at each offset
+        byte left[40];
+        byte right[40];
+        for (unsigned i=0; i < sizeof(left); i++)
+            left[i] = (byte)(i * 37);
+        for (size32_t len=0; len <= sizeof(left); len++)
+        {
+            memcpy(right, left, sizeof(left));
+            CPPUNIT_ASSERT_EQUAL(0, rtlCompareFixedData(left, right, len));
+            for (size32_t offset=0; offset < len; offset++)
+            {
+                for (int delta : { -1, +1, 0x80 })
+                {
+                    memcpy(right, left, sizeof(left));
+                    right[offset] = (byte)(right[offset] + delta);
+                    CPPUNIT_ASSERT_EQUAL(sign(memcmp(left, right, len)), sign(rtlCompareFixedData(left, right, len)));
+                    CPPUNIT_ASSERT_EQUAL(sign(memcmp(right, left, len)), sign(rtlCompareFixedData(right, left, len)));
+                }
+            }
+        }
+    }
+
+    void FixedHashTest()
+    {
+        //Check the hash is sensitive to every byte, and distributes sequential values evenly across buckets
+        byte data[24] = { 0 };
+        unsigned base = rtlHash32FixedData(sizeof(data), data, HASH32_INIT);
+        for (unsigned i=0; i < sizeof(data); i++)
+        {
+            data[i] = 1;
+            CPPUNIT_ASSERT(rtlHash32FixedData(sizeof(data), data, HASH32_INIT) != base);
+            data[i] = 0;
+        }
+
+        constexpr unsigned numBuckets = 64;
+        constexpr unsigned perBucket = 1000;
+        unsigned counts[numBuckets] = { 0 };
+        for (unsigned i=0; i < numBuckets * perBucket; i++)
+            counts[rtlHash32FixedData(sizeof(i), &i, HASH32_INIT) % numBuckets]++;
+        for (unsigned i=0; i < numBuckets; i++)
+            CPPUNIT_ASSERT(counts[i] > perBucket * 8 / 10 && counts[i] < perBucket * 12 / 10);
+    }
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION( EclRtlTests );
@@ -329,4 +329,106 @@ inline unsigned rtlHash32Data8(const void *_buf, unsigned hval)
                 buf[7]);
 }
 
+//Inline functions for comparing and hashing fixed size blocks of memory a word at a time.  They are used for keys where
+//all the fields are fixed size, so the length is a constant and the loops are unrolled when the functions are inlined.
+
+//Read a word so that comparing two words as unsigned integers gives the same result as memcmp()
+inline unsigned __int64 rtlReadBigEndianWord8(const void * data)
+{
+    unsigned __int64 value;
+    memcpy(&value, data, sizeof(value));
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+#ifdef _MSC_VER
+    value = _byteswap_uint64(value);
+#else
+    value = __builtin_bswap64(value);
+#endif
+#endif
+    return value;
+}
+
+inline unsigned rtlReadBigEndianWord4(const void * data)
+{
+    unsigned value;
+    memcpy(&value, data, sizeof(value));
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+#ifdef _MSC_VER
+    value = _byteswap_ulong(value);
+#else
+    value = __builtin_bswap32(value);
+#endif
+#endif
+    return value;
+}
+
+//Returns a value with the same sign as memcmp(left, right, len)
+inline int rtlCompareFixedData(const void * _left, const void * _right, size32_t len)
+{
+    const byte * left = (const byte *)_left;
+    const byte * right = (const byte *)_right;
+    while (len >= 8)
+    {
+        unsigned __int64 leftValue = rtlReadBigEndianWord8(left);
+        unsigned __int64 rightValue = rtlReadBigEndianWord8(right);
+        if (leftValue != rightValue)
+            return (leftValue < rightValue) ? -1 : +1;
+        left += 8;
+        right += 8;
+        len -= 8;
+    }
+    if (len >= 4)
+    {
+        unsigned leftValue = rtlReadBigEndianWord4(left);
+        unsigned rightValue = rtlReadBigEndianWord4(right);
+        if (leftValue != rightValue)
+            return (leftValue < rightValue) ? -1 : +1;
+        left += 4;
+        right += 4;
+        len -= 4;
+    }
+    for (; len; len--)
+    {
+        if (*left != *right)
+            return (*left < *right) ? -1 : +1;
+        left++;
+        right++;
+    }
+    return 0;
+}
+
+inline unsigned __int64 rtlHashMixWord8(unsigned __int64 hval, unsigned __int64 value)
+{
+    value *= U64C(0x87c37b91114253d5);
+    value = (value << 31) | (value >> 33);
+    value *= U64C(0x4cf5ad432745937f);
+    hval ^= value;
+    hval = (hval << 27) | (hval >> 37);
+    return hval * 5 + 0x52dce729;
+}
+
+//A hash of a fixed size field which processes a word at a time, rather than a byte at a time like rtlHash32Data().
+//The values are different from rtlHash32Data(), so it must only be used for hash values that are never visible outside
+//the query, e.g. the hash tables used by hash dedup and hash aggregate.  Unlike rtlHash32Data(), hashing two blocks
+//does not give the same result as hashing the combined block.
+inline unsigned rtlHash32FixedData(size32_t len, const void * _buf, unsigned hval)
+{
+    const byte * buf = (const byte *)_buf;
+    unsigned __int64 result = hval;
+    while (len >= 8)
+    {
+        unsigned __int64 value;
+        memcpy(&value, buf, sizeof(value));
+        result = rtlHashMixWord8(result, value);
+        buf += 8;
+        len -= 8;
+    }
+    if (len)
+    {
+        unsigned __int64 value = 0;
+        memcpy(&value, buf, len);
+        result = rtlHashMixWord8(result, value);
+    }
+    return (unsigned)(result ^ (result >> 32));
+}
+
 #endif
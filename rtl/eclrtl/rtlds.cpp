@@ -303,6 +303,179 @@ void RtlDynamicRowBuilder::swapWith(RtlDynamicRowBuilder & other)
     other.setown(savedMaxLength, savedSelf);
 }
 
+//---------------------------------------------------------------------------
+
+RtlFilterBlock::RtlFilterBlock(IHThorFilterArg & _helper, unsigned _maxRows) : helper(_helper)
+{
+    blockHelper = dynamic_cast<IHThorFilterBlockExtra *>(&helper);
+    maxRows = blockHelper ? _maxRows : 1;
+    rows = new const void * [maxRows];
+    selected = new unsigned[maxRows];
+}
+
+RtlFilterBlock::~RtlFilterBlock()
+{
+    kill();
+    delete [] rows;
+    delete [] selected;
+}
+
+bool RtlFilterBlock::fill(IRowStream & input, const void * firstRow)
+{
+    kill();
+    unsigned numRows = 0;
+    if (firstRow)
+        rows[numRows++] = firstRow;
+    bool endOfGroup = false;
+    try
+    {
+        while (numRows < blockLimit)
+        {
+            const void * row = input.nextRow();
+            if (!row)
+            {
+                endOfGroup = true;
+                break;
+            }
+            rows[numRows++] = row;
+        }
+        if (blockHelper)
+            numResults = blockHelper->selectValid(numRows, rows, selected);
+        else
+        {
+            for (unsigned i=0; i < numRows; i++)
+            {
+                if (helper.isValid(rows[i]))
+                    selected[numResults++] = i;
+            }
+        }
+    }
+    catch (...)
+    {
+        for (unsigned i=0; i < numRows; i++)
+            rtlReleaseRow(rows[i]);
+        numResults = 0;
+        throw;
+    }
+    if (blockLimit < maxRows)
+        blockLimit = std::min(blockLimit * 2, maxRows);
+
+    //Release the rows that are not valid, and move the valid rows to the start of the block
+    unsigned next = 0;
+    for (unsigned i=0; i < numRows; i++)
+    {
+        if ((next < numResults) && (selected[next] == i))
+            rows[next++] = rows[i];
+        else
+            rtlReleaseRow(rows[i]);
+    }
+    return endOfGroup;
+}
+
+void RtlFilterBlock::kill()
+{
+    while (curResult < numResults)
+        rtlReleaseRow(rows[curResult++]);
+    numResults = 0;
+    curResult = 0;
+}
+
+void RtlFilterBlock::reset()
+{
+    kill();
+    blockLimit = 1;
+}
+
+//---------------------------------------------------------------------------
+
+RtlProjectBlock::RtlProjectBlock(IHThorProjectArg & _helper, IEngineRowAllocator * _rowAllocator, unsigned _maxRows) : helper(_helper)
+{
+    blockHelper = dynamic_cast<IHThorProjectBlockExtra *>(&helper);
+    maxRows = blockHelper ? _maxRows : 1;
+    builders = new RtlDynamicRowBuilder * [maxRows];
+    rowBuilders = new ARowBuilder * [maxRows];
+    for (unsigned i=0; i < maxRows; i++)
+    {
+        builders[i] = new RtlDynamicRowBuilder(_rowAllocator, false);
+        rowBuilders[i] = builders[i];
+    }
+    inputRows = new const void * [maxRows];
+    sizes = new size32_t[maxRows];
+    results = new const void * [maxRows];
+}
+
+RtlProjectBlock::~RtlProjectBlock()
+{
+    kill();
+    for (unsigned i=0; i < maxRows; i++)
+        delete builders[i];
+    delete [] builders;
+    delete [] rowBuilders;
+    delete [] inputRows;
+    delete [] sizes;
+    delete [] results;
+}
+
+bool RtlProjectBlock::fill(IRowStream & input, const void * firstRow)
+{
+    kill();
+    unsigned numRows = 0;
+    if (firstRow)
+        inputRows[numRows++] = firstRow;
+    bool endOfGroup = false;
+    try
+    {
+        while (numRows < blockLimit)
+        {
+            const void * row = input.nextRow();
+            if (!row)
+            {
+                endOfGroup = true;
+                break;
+            }
+            inputRows[numRows++] = row;
+        }
+        for (unsigned i=0; i < numRows; i++)
+            builders[i]->ensureRow();
+        if (blockHelper)
+            blockHelper->transformBlock(numRows, rowBuilders, inputRows, sizes);
+        else
+        {
+            for (unsigned i=0; i < numRows; i++)
+                sizes[i] = helper.transform(*builders[i], inputRows[i]);
+        }
+    }
+    catch (...)
+    {
+        for (unsigned i=0; i < numRows; i++)
+            rtlReleaseRow(inputRows[i]);
+        throw;
+    }
+    if (blockLimit < maxRows)
+        blockLimit = std::min(blockLimit * 2, maxRows);
+
+    for (unsigned i=0; i < numRows; i++)
+    {
+        rtlReleaseRow(inputRows[i]);
+        if (sizes[i])
+            results[numResults++] = builders[i]->finalizeRowClear(sizes[i]);
+    }
+    return endOfGroup;
+}
+
+void RtlProjectBlock::kill()
+{
+    while (curResult < numResults)
+        rtlReleaseRow(results[curResult++]);
+    numResults = 0;
+    curResult = 0;
+}
+
+void RtlProjectBlock::reset()
+{
+    kill();
+    blockLimit = 1;
+}
 
 //---------------------------------------------------------------------------
 
@@ -285,6 +285,71 @@ protected:
 };
 
 
+//Used by the engines to read and filter blocks of rows.  If the helper implements IHThorFilterBlockExtra a block is
+//filtered with a single call, otherwise the rows are read and filtered one at a time.  Rows are read ahead of the
+//consumer, so the block size starts at 1 and doubles with each block read (up to maxRows) to avoid reading rows
+//that are never requested.
+class ECLRTL_API RtlFilterBlock
+{
+public:
+    RtlFilterBlock(IHThorFilterArg & _helper, unsigned _maxRows);
+    ~RtlFilterBlock();
+
+    //Reads rows (following firstRow if it is supplied) up to the end of the group or the block, and filters them.
+    //Returns true if the end of the group was reached.
+    bool fill(IRowStream & input, const void * firstRow);
+    //Returns ownership of the next valid row, or NULL if they have all been returned
+    inline const void * nextResult() { return (curResult < numResults) ? rows[curResult++] : NULL; }
+    //Releases the rows that have not been returned
+    void kill();
+    //Also restarts the block size from 1
+    void reset();
+
+protected:
+    IHThorFilterArg & helper;
+    IHThorFilterBlockExtra * blockHelper;
+    unsigned maxRows;
+    unsigned blockLimit = 1;
+    const void * * rows;
+    unsigned * selected;
+    unsigned numResults = 0;
+    unsigned curResult = 0;
+};
+
+//Used by the engines to read and transform blocks of rows, in the same way as RtlFilterBlock, using
+//IHThorProjectBlockExtra if the helper implements it.  The builders are reused from one block to the next, so a row
+//that is skipped does not need to be reallocated.
+class ECLRTL_API RtlProjectBlock
+{
+public:
+    RtlProjectBlock(IHThorProjectArg & _helper, IEngineRowAllocator * _rowAllocator, unsigned _maxRows);
+    ~RtlProjectBlock();
+
+    //Reads rows (following firstRow if it is supplied) up to the end of the group or the block, and transforms them.
+    //Returns true if the end of the group was reached.
+    bool fill(IRowStream & input, const void * firstRow);
+    //Returns ownership of the next row created by the last fill, or NULL if they have all been returned
+    inline const void * nextResult() { return (curResult < numResults) ? results[curResult++] : NULL; }
+    //Releases the rows that have not been returned
+    void kill();
+    //Also restarts the block size from 1
+    void reset();
+
+protected:
+    IHThorProjectArg & helper;
+    IHThorProjectBlockExtra * blockHelper;
+    unsigned maxRows;
+    unsigned blockLimit = 1;
+    RtlDynamicRowBuilder * * builders;
+    ARowBuilder * * rowBuilders;
+    const void * * inputRows;
+    size32_t * sizes;
+    const void * * results;
+    unsigned numResults = 0;
+    unsigned curResult = 0;
+};
+
+
 class ECLRTL_API RtlStaticRowBuilder : extends RtlRowBuilderBase
 {
 public:
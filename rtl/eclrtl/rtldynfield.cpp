@@ -18,6 +18,7 @@
 #include "platform.h"
 #include <math.h>
 #include <stdio.h>
+#include <vector>
 #include "jmisc.hpp"
 #include "jlib.hpp"
 #include "eclhelper.hpp"
@@ -1040,6 +1041,7 @@ public:
     {
         matchInfo = new MatchInfo[destRecInfo.getNumFields()];
         createMatchInfo();
+        createCopyPlan();
 #ifdef _DEBUG
         //describe();
 #endif
@@ -1163,303 +1165,353 @@ private:
             builder.ensureCapacity(offset+estimate, "record");
         }
         size32_t origOffset = offset;
-        for (unsigned idx = 0; idx < destRecInfo.getNumFields(); idx++)
+        if (copyPlan.size())
         {
-            const RtlFieldInfo *field = destRecInfo.queryField(idx);
-            if (field->omitable() && destRecInfo.excluded(field, builder.getSelf(), destConditions))
-                continue;
-            const RtlTypeInfo *type = field->type;
-            const MatchInfo &match = matchInfo[idx];
-            if (match.matchType == match_none || match.matchType==match_fail)
-            {
-                offset = type->buildNull(builder, offset, field);
-            }
-            else if (match.matchType == match_virtual)
+            const RtlRow &rtlRow = *(const RtlRow *)sourceRow;
+            const byte *sourceData = rtlRow.queryRow();
+            byte *dest = planFixedSize ? builder.ensureCapacity(offset+planFixedSize, "record") : nullptr;
+            for (const CopyStep &step : copyPlan)
             {
-                switch (getVirtualInitializer(field->initializer))
+                switch (step.kind)
                 {
-                case FVirtualFilePosition:
-                    offset = type->buildInt(builder, offset, field, callback.getFilePosition(sourceRow));
+                case copy_fixed:
+                    if (!planFixedSize)
+                        dest = builder.ensureCapacity(offset+step.size, step.name);
+                    memcpy(dest+offset, sourceData+step.sourceOffset, step.size);
+                    offset += step.size;
                     break;
-                case FVirtualLocalFilePosition:
-                    offset = type->buildInt(builder, offset, field, callback.getLocalFilePosition(sourceRow));
+                case copy_variable:
+                {
+                    size_t sourceOffset = rtlRow.getOffset(step.field);
+                    size32_t copySize = rtlRow.getOffset(step.lastField+1) - sourceOffset;
+                    dest = builder.ensureCapacity(offset+copySize, step.name);
+                    memcpy(dest+offset, sourceData+sourceOffset, copySize);
+                    offset += copySize;
                     break;
-                case FVirtualFilename:
-                    {
-                        const char * filename = callback.queryLogicalFilename(sourceRow);
-                        offset = type->buildString(builder, offset, field, strlen(filename), filename);
-                        break;
-                    }
-                default:
-                    throwUnexpected();
                 }
+                case copy_constant:
+                    if (!planFixedSize)
+                        dest = builder.ensureCapacity(offset+step.size, step.name);
+                    memcpy(dest+offset, constantValues.toByteArray()+step.sourceOffset, step.size);
+                    offset += step.size;
+                    break;
+                case copy_field:
+                {
+                    unsigned idx = step.field;
+                    offset = translateField(builder, callback, idx, offset, sourceRow, hasBlobs);
+                    break;
+                }
+                }
+            }
+        }
+        else
+        {
+            for (unsigned idx = 0; idx < destRecInfo.getNumFields(); idx++)
+            {
+                const RtlFieldInfo *field = destRecInfo.queryField(idx);
+                if (field->omitable() && destRecInfo.excluded(field, builder.getSelf(), destConditions))
+                    continue;
+                offset = translateField(builder, callback, idx, offset, sourceRow, hasBlobs);
+            }
+        }
+        if (estimate && offset-origOffset != estimate)
+        {
+            if (offset == origOffset)
+            {
+                //Zero size records are treated as single byte to avoid confusion with sizes returned from transforms etc.
+                offset++;
             }
             else
             {
-                unsigned matchField = match.matchIdx;
-                const RtlTypeInfo *sourceType = sourceRecInfo.queryType(matchField);
-
-                size_t sourceOffset = 0;
-                const byte *source = nullptr;
-                size_t copySize = 0;
-                if (binarySource)
-                {
-                    const RtlRow &rtlRow = *(const RtlRow *)sourceRow;
-                    sourceOffset = rtlRow.getOffset(matchField);
-                    source = rtlRow.queryRow() + sourceOffset;
-                    copySize = rtlRow.getSize(matchField);
-                }
-                if (match.matchType & match_deblob)
+                if (!hasBlobs)
+                    assert(offset-origOffset > estimate);  // Estimate is always supposed to be conservative
+#ifdef TRACE_TRANSLATION
+                DBGLOG("Wrote %u bytes to record (estimate was %u)\n", offset-origOffset, estimate);
+#endif
+            }
+        }
+        return offset;
+    }
+    // Translate a single field (or a run of perfectly matching fields, in which case idx is updated to the last one)
+    size32_t translateField(ARowBuilder &builder, IVirtualFieldCallback & callback, unsigned &idx, size32_t offset, const void *sourceRow, bool &hasBlobs) const
+    {
+        const RtlFieldInfo *field = destRecInfo.queryField(idx);
+        const RtlTypeInfo *type = field->type;
+        const MatchInfo &match = matchInfo[idx];
+        if (match.matchType == match_none || match.matchType==match_fail)
+        {
+            offset = type->buildNull(builder, offset, field);
+        }
+        else if (match.matchType == match_virtual)
+        {
+            switch (getVirtualInitializer(field->initializer))
+            {
+            case FVirtualFilePosition:
+                offset = type->buildInt(builder, offset, field, callback.getFilePosition(sourceRow));
+                break;
+            case FVirtualLocalFilePosition:
+                offset = type->buildInt(builder, offset, field, callback.getLocalFilePosition(sourceRow));
+                break;
+            case FVirtualFilename:
                 {
-                    offset_t blobId = sourceType->getInt(source);
-                    sourceType = sourceType->queryChildType();
-                    sourceOffset = 0;
-                    source = callback.lookupBlob(blobId);
-                    copySize = sourceType->size(source, source);
-                    hasBlobs = true;
+                    const char * filename = callback.queryLogicalFilename(sourceRow);
+                    offset = type->buildString(builder, offset, field, strlen(filename), filename);
+                    break;
                 }
-                if (copySize == 0 && (match.matchType & match_inifblock))  // Field is missing because of an ifblock - use default value
+            default:
+                throwUnexpected();
+            }
+        }
+        else
+        {
+            unsigned matchField = match.matchIdx;
+            const RtlTypeInfo *sourceType = sourceRecInfo.queryType(matchField);
+
+            size_t sourceOffset = 0;
+            const byte *source = nullptr;
+            size_t copySize = 0;
+            if (binarySource)
+            {
+                const RtlRow &rtlRow = *(const RtlRow *)sourceRow;
+                sourceOffset = rtlRow.getOffset(matchField);
+                source = rtlRow.queryRow() + sourceOffset;
+                copySize = rtlRow.getSize(matchField);
+            }
+            if (match.matchType & match_deblob)
+            {
+                offset_t blobId = sourceType->getInt(source);
+                sourceType = sourceType->queryChildType();
+                sourceOffset = 0;
+                source = callback.lookupBlob(blobId);
+                copySize = sourceType->size(source, source);
+                hasBlobs = true;
+            }
+            if (copySize == 0 && (match.matchType & match_inifblock))  // Field is missing because of an ifblock - use default value
+            {
+                offset = type->buildNull(builder, offset, field);
+            }
+            else
+            {
+                switch (match.matchType & ~(match_inifblock|match_deblob))
                 {
-                    offset = type->buildNull(builder, offset, field);
-                }
-                else
+                case match_perfect:
                 {
-                    switch (match.matchType & ~(match_inifblock|match_deblob))
+                    // Look ahead for other perfect matches and combine the copies.  Not done for a field in an ifblock
+                    // since the following fields would be skipped if the ifblock was not present.
+                    if (!(match.matchType & (match_deblob|match_inifblock)))
                     {
-                    case match_perfect:
-                    {
-                        // Look ahead for other perfect matches and combine the copies
-                        if (!(match.matchType & match_deblob))
+                        while (idx < destRecInfo.getNumFields()-1)
                         {
-                            while (idx < destRecInfo.getNumFields()-1)
+                            const MatchInfo &nextMatch = matchInfo[idx+1];
+                            if (nextMatch.matchType == match_perfect && nextMatch.matchIdx == matchField+1)
                             {
-                                const MatchInfo &nextMatch = matchInfo[idx+1];
-                                if (nextMatch.matchType == match_perfect && nextMatch.matchIdx == matchField+1)
-                                {
-                                    idx++;
-                                    matchField++;
-                                }
-                                else
-                                    break;
+                                idx++;
+                                matchField++;
                             }
-                            copySize = ((const RtlRow *)sourceRow)->getOffset(matchField+1) - sourceOffset;
+                            else
+                                break;
                         }
-                        builder.ensureCapacity(offset+copySize, field->name);
-                        memcpy(builder.getSelf()+offset, source, copySize);
-                        offset += copySize;
-                        break;
-                    }
-                    case match_truncate:
-                    {
-                        assert(type->isFixedSize());
-                        copySize = type->getMinSize();
-                        builder.ensureCapacity(offset+copySize, field->name);
-                        memcpy(builder.getSelf()+offset, source, copySize);
-                        offset += copySize;
-                        break;
+                        copySize = ((const RtlRow *)sourceRow)->getOffset(matchField+1) - sourceOffset;
                     }
-                    case match_extend:
-                    {
-                        assert(type->isFixedSize());
-                        size32_t destSize = type->getMinSize();
-                        builder.ensureCapacity(offset+destSize, field->name);
-                        memcpy(builder.getSelf()+offset, source, copySize);
-                        offset += copySize;
-                        unsigned fillSize = destSize - copySize;
-                        memset(builder.getSelf()+offset, match.fillChar, fillSize);
-                        offset += fillSize;
-                        break;
-                    }
-                    case match_filepos:
-                    case match_typecast:
-                        offset = translateScalar(builder, offset, field, *type, *sourceType, source);
-                        break;
-                    case match_typecast|match_dynamic:
+                    builder.ensureCapacity(offset+copySize, field->name);
+                    memcpy(builder.getSelf()+offset, source, copySize);
+                    offset += copySize;
+                    break;
+                }
+                case match_truncate:
+                {
+                    assert(type->isFixedSize());
+                    copySize = type->getMinSize();
+                    builder.ensureCapacity(offset+copySize, field->name);
+                    memcpy(builder.getSelf()+offset, source, copySize);
+                    offset += copySize;
+                    break;
+                }
+                case match_extend:
+                {
+                    assert(type->isFixedSize());
+                    size32_t destSize = type->getMinSize();
+                    builder.ensureCapacity(offset+destSize, field->name);
+                    memcpy(builder.getSelf()+offset, source, copySize);
+                    offset += copySize;
+                    unsigned fillSize = destSize - copySize;
+                    memset(builder.getSelf()+offset, match.fillChar, fillSize);
+                    offset += fillSize;
+                    break;
+                }
+                case match_filepos:
+                case match_typecast:
+                    offset = translateScalar(builder, offset, field, *type, *sourceType, source);
+                    break;
+                case match_typecast|match_dynamic:
+                {
+                    const IDynamicFieldValueFetcher &callbackRowHandler = *(const IDynamicFieldValueFetcher *)sourceRow;
+                    source = callbackRowHandler.queryValue(matchField, copySize);
+                    if (callbackRawType == type_string)
+                        offset = translateScalarFromString(builder, offset, field, *type, *sourceType, (const char *)source, (size_t)copySize);
+                    else
+                        offset = translateScalarFromUtf8(builder, offset, field, *type, *sourceType, (const char *)source, (size_t)copySize);
+                    break;
+                }
+                case match_link:
+                {
+                    // a 32-bit record count, and a (linked) pointer to an array of record pointers
+                    byte *dest = builder.ensureCapacity(offset+sizeof(size32_t)+sizeof(const byte **), field->name)+offset;
+                    *(size32_t *)dest = *(size32_t *)source;
+                    *(const byte ***)(dest + sizeof(size32_t)) = rtlLinkRowset(*(const byte ***)(source + sizeof(size32_t)));
+                    offset += sizeof(size32_t)+sizeof(const byte **);
+                    break;
+                }
+                case match_recurse|match_dynamic:
+                {
+                    const IDynamicFieldValueFetcher &callbackRowHandler = *(const IDynamicFieldValueFetcher *)sourceRow;
+                    Owned<IDynamicRowIterator> iterator = callbackRowHandler.getNestedIterator(matchField);
+                    if (type->getType()==type_record)
                     {
-                        const IDynamicFieldValueFetcher &callbackRowHandler = *(const IDynamicFieldValueFetcher *)sourceRow;
-                        source = callbackRowHandler.queryValue(matchField, copySize);
-                        if (callbackRawType == type_string)
-                            offset = translateScalarFromString(builder, offset, field, *type, *sourceType, (const char *)source, (size_t)copySize);
-                        else
-                            offset = translateScalarFromUtf8(builder, offset, field, *type, *sourceType, (const char *)source, (size_t)copySize);
-                        break;
+                        IDynamicFieldValueFetcher &fieldFetcher = iterator->query();
+                        offset = match.subTrans->doTranslateOpaqueType(builder, callback, offset, &fieldFetcher);
                     }
-                    case match_link:
+                    else if (type->isLinkCounted())
                     {
-                        // a 32-bit record count, and a (linked) pointer to an array of record pointers
-                        byte *dest = builder.ensureCapacity(offset+sizeof(size32_t)+sizeof(const byte **), field->name)+offset;
-                        *(size32_t *)dest = *(size32_t *)source;
-                        *(const byte ***)(dest + sizeof(size32_t)) = rtlLinkRowset(*(const byte ***)(source + sizeof(size32_t)));
-                        offset += sizeof(size32_t)+sizeof(const byte **);
-                        break;
+                        // a 32-bit record count, and a pointer to an array of record pointers
+                        IEngineRowAllocator *childAllocator = builder.queryAllocator()->createChildRowAllocator(type->queryChildType());
+                        assertex(childAllocator);  // May not be available when using serialized types (but unlikely to want to create linkcounted children remotely either)
+
+                        size32_t sizeInBytes = sizeof(size32_t) + sizeof(void *);
+                        builder.ensureCapacity(offset+sizeInBytes, field->name);
+                        size32_t numRows = 0;
+                        const byte **childRows = nullptr;
+                        ForEach(*iterator)
+                        {
+                            IDynamicFieldValueFetcher &fieldFetcher = iterator->query();
+                            RtlDynamicRowBuilder childBuilder(*childAllocator);
+                            size32_t childLen = match.subTrans->doTranslateOpaqueType(childBuilder, callback, 0, &fieldFetcher);
+                            childRows = childAllocator->appendRowOwn(childRows, ++numRows, (void *) childBuilder.finalizeRowClear(childLen));
+                        }
+                        if (type->getType() == type_dictionary)
+                        {
+                            const RtlTypeInfo * childType = type->queryChildType();
+                            assertex(childType && childType->getType() == type_record);
+                            CHThorHashLookupInfo lookupHelper(static_cast<const RtlRecordTypeInfo &>(*childType));
+                            rtlCreateDictionaryFromDataset(numRows, childRows, childAllocator, lookupHelper);
+                        }
+                        // Go back in and patch the count, remembering it may have moved
+                        rtlWriteInt4(builder.getSelf()+offset, numRows);
+                        * ( const void * * ) (builder.getSelf()+offset+sizeof(size32_t)) = childRows;
+                        offset += sizeInBytes;
                     }
-                    case match_recurse|match_dynamic:
+                    else
                     {
-                        const IDynamicFieldValueFetcher &callbackRowHandler = *(const IDynamicFieldValueFetcher *)sourceRow;
-                        Owned<IDynamicRowIterator> iterator = callbackRowHandler.getNestedIterator(matchField);
-                        if (type->getType()==type_record)
+                        size32_t countOffset = offset;
+                        byte *dest = builder.ensureCapacity(offset+sizeof(size32_t), field->name)+offset;
+                        offset += sizeof(size32_t);
+                        size32_t initialOffset = offset;
+                        *(size32_t *)dest = 0;  // patched below when true figure known
+                        ForEach(*iterator)
                         {
                             IDynamicFieldValueFetcher &fieldFetcher = iterator->query();
                             offset = match.subTrans->doTranslateOpaqueType(builder, callback, offset, &fieldFetcher);
                         }
-                        else if (type->isLinkCounted())
+                        dest = builder.getSelf() + countOffset;  // Note - may have been moved by reallocs since last calculated
+                        *(size32_t *)dest = offset - initialOffset;
+                    }
+                    break;
+                }
+                case match_recurse:
+                    if (type->getType()==type_record)
+                        offset = match.subTrans->doTranslate(builder, callback, offset, source);
+                    else if (type->isLinkCounted())
+                    {
+                        // a 32-bit record count, and a pointer to an array of record pointers
+                        Owned<IEngineRowAllocator> childAllocator = builder.queryAllocator()->createChildRowAllocator(type->queryChildType());
+                        assertex(childAllocator);  // May not be available when using serialized types (but unlikely to want to create linkcounted children remotely either)
+
+                        size32_t sizeInBytes = sizeof(size32_t) + sizeof(void *);
+                        builder.ensureCapacity(offset+sizeInBytes, field->name);
+                        size32_t numRows = 0;
+                        const byte **childRows = nullptr;
+                        if (sourceType->isLinkCounted())
                         {
-                            // a 32-bit record count, and a pointer to an array of record pointers
-                            IEngineRowAllocator *childAllocator = builder.queryAllocator()->createChildRowAllocator(type->queryChildType());
-                            assertex(childAllocator);  // May not be available when using serialized types (but unlikely to want to create linkcounted children remotely either)
-
-                            size32_t sizeInBytes = sizeof(size32_t) + sizeof(void *);
-                            builder.ensureCapacity(offset+sizeInBytes, field->name);
-                            size32_t numRows = 0;
-                            const byte **childRows = nullptr;
-                            ForEach(*iterator)
+                            // a 32-bit count, then a pointer to the source rows
+                            size32_t childCount = *(size32_t *) source;
+                            source += sizeof(size32_t);
+                            const byte ** sourceRows = *(const byte***) source;
+                            for (size32_t childRow = 0; childRow < childCount; childRow++)
                             {
-                                IDynamicFieldValueFetcher &fieldFetcher = iterator->query();
                                 RtlDynamicRowBuilder childBuilder(*childAllocator);
-                                size32_t childLen = match.subTrans->doTranslateOpaqueType(childBuilder, callback, 0, &fieldFetcher);
+                                size32_t childLen = match.subTrans->doTranslate(childBuilder, callback, 0, sourceRows[childRow]);
                                 childRows = childAllocator->appendRowOwn(childRows, ++numRows, (void *) childBuilder.finalizeRowClear(childLen));
                             }
-                            if (type->getType() == type_dictionary)
-                            {
-                                const RtlTypeInfo * childType = type->queryChildType();
-                                assertex(childType && childType->getType() == type_record);
-                                CHThorHashLookupInfo lookupHelper(static_cast<const RtlRecordTypeInfo &>(*childType));
-                                rtlCreateDictionaryFromDataset(numRows, childRows, childAllocator, lookupHelper);
-                            }
-                            // Go back in and patch the count, remembering it may have moved
-                            rtlWriteInt4(builder.getSelf()+offset, numRows);
-                            * ( const void * * ) (builder.getSelf()+offset+sizeof(size32_t)) = childRows;
-                            offset += sizeInBytes;
                         }
                         else
                         {
-                            size32_t countOffset = offset;
-                            byte *dest = builder.ensureCapacity(offset+sizeof(size32_t), field->name)+offset;
-                            offset += sizeof(size32_t);
-                            size32_t initialOffset = offset;
-                            *(size32_t *)dest = 0;  // patched below when true figure known
-                            ForEach(*iterator)
+                            // a 32-bit size, then rows inline
+                            size32_t childSize = *(size32_t *) source;
+                            source += sizeof(size32_t);
+                            const byte *initialSource = source;
+                            while ((size_t)(source - initialSource) < childSize)
                             {
-                                IDynamicFieldValueFetcher &fieldFetcher = iterator->query();
-                                offset = match.subTrans->doTranslateOpaqueType(builder, callback, offset, &fieldFetcher);
+                                RtlDynamicRowBuilder childBuilder(*childAllocator);
+                                size32_t childLen = match.subTrans->doTranslate(childBuilder, callback, 0, source);
+                                childRows = childAllocator->appendRowOwn(childRows, ++numRows, (void *) childBuilder.finalizeRowClear(childLen));
+                                source += sourceType->queryChildType()->size(source, nullptr); // MORE - shame to repeat a calculation that the translate above almost certainly just did
                             }
-                            dest = builder.getSelf() + countOffset;  // Note - may have been moved by reallocs since last calculated
-                            *(size32_t *)dest = offset - initialOffset;
                         }
-                        break;
+                        if (type->getType() == type_dictionary)
+                        {
+                            const RtlTypeInfo * childType = type->queryChildType();
+                            assertex(childType && childType->getType() == type_record);
+                            CHThorHashLookupInfo lookupHelper(static_cast<const RtlRecordTypeInfo &>(*childType));
+                            rtlCreateDictionaryFromDataset(numRows, childRows, childAllocator, lookupHelper);
+                        }
+
+                        // Go back in and patch the count, remembering it may have moved
+                        rtlWriteInt4(builder.getSelf()+offset, numRows);
+                        * ( const void * * ) (builder.getSelf()+offset+sizeof(size32_t)) = childRows;
+                        offset += sizeInBytes;
                     }
-                    case match_recurse:
-                        if (type->getType()==type_record)
-                            offset = match.subTrans->doTranslate(builder, callback, offset, source);
-                        else if (type->isLinkCounted())
+                    else
+                    {
+                        size32_t countOffset = offset;
+                        byte *dest = builder.ensureCapacity(offset+sizeof(size32_t), field->name)+offset;
+                        offset += sizeof(size32_t);
+                        size32_t initialOffset = offset;
+                        *(size32_t *)dest = 0;  // patched below when true figure known
+                        if (sourceType->isLinkCounted())
                         {
-                            // a 32-bit record count, and a pointer to an array of record pointers
-                            Owned<IEngineRowAllocator> childAllocator = builder.queryAllocator()->createChildRowAllocator(type->queryChildType());
-                            assertex(childAllocator);  // May not be available when using serialized types (but unlikely to want to create linkcounted children remotely either)
-
-                            size32_t sizeInBytes = sizeof(size32_t) + sizeof(void *);
-                            builder.ensureCapacity(offset+sizeInBytes, field->name);
-                            size32_t numRows = 0;
-                            const byte **childRows = nullptr;
-                            if (sourceType->isLinkCounted())
-                            {
-                                // a 32-bit count, then a pointer to the source rows
-                                size32_t childCount = *(size32_t *) source;
-                                source += sizeof(size32_t);
-                                const byte ** sourceRows = *(const byte***) source;
-                                for (size32_t childRow = 0; childRow < childCount; childRow++)
-                                {
-                                    RtlDynamicRowBuilder childBuilder(*childAllocator);
-                                    size32_t childLen = match.subTrans->doTranslate(childBuilder, callback, 0, sourceRows[childRow]);
-                                    childRows = childAllocator->appendRowOwn(childRows, ++numRows, (void *) childBuilder.finalizeRowClear(childLen));
-                                }
-                            }
-                            else
-                            {
-                                // a 32-bit size, then rows inline
-                                size32_t childSize = *(size32_t *) source;
-                                source += sizeof(size32_t);
-                                const byte *initialSource = source;
-                                while ((size_t)(source - initialSource) < childSize)
-                                {
-                                    RtlDynamicRowBuilder childBuilder(*childAllocator);
-                                    size32_t childLen = match.subTrans->doTranslate(childBuilder, callback, 0, source);
-                                    childRows = childAllocator->appendRowOwn(childRows, ++numRows, (void *) childBuilder.finalizeRowClear(childLen));
-                                    source += sourceType->queryChildType()->size(source, nullptr); // MORE - shame to repeat a calculation that the translate above almost certainly just did
-                                }
-                            }
-                            if (type->getType() == type_dictionary)
+                            // a 32-bit count, then a pointer to the source rows
+                            size32_t childCount = *(size32_t *) source;
+                            source += sizeof(size32_t);
+                            const byte ** sourceRows = *(const byte***) source;
+                            for (size32_t childRow = 0; childRow < childCount; childRow++)
                             {
-                                const RtlTypeInfo * childType = type->queryChildType();
-                                assertex(childType && childType->getType() == type_record);
-                                CHThorHashLookupInfo lookupHelper(static_cast<const RtlRecordTypeInfo &>(*childType));
-                                rtlCreateDictionaryFromDataset(numRows, childRows, childAllocator, lookupHelper);
+                                const byte * row = sourceRows[childRow];
+                                //Dictionaries have blank rows - ignore them when serializing (to a dataset)
+                                if (row)
+                                    offset = match.subTrans->doTranslate(builder, callback, offset, row);
                             }
-
-                            // Go back in and patch the count, remembering it may have moved
-                            rtlWriteInt4(builder.getSelf()+offset, numRows);
-                            * ( const void * * ) (builder.getSelf()+offset+sizeof(size32_t)) = childRows;
-                            offset += sizeInBytes;
                         }
                         else
                         {
-                            size32_t countOffset = offset;
-                            byte *dest = builder.ensureCapacity(offset+sizeof(size32_t), field->name)+offset;
-                            offset += sizeof(size32_t);
-                            size32_t initialOffset = offset;
-                            *(size32_t *)dest = 0;  // patched below when true figure known
-                            if (sourceType->isLinkCounted())
+                            // a 32-bit size, then rows inline
+                            size32_t childSize = *(size32_t *) source;
+                            source += sizeof(size32_t);
+                            const byte *initialSource = source;
+                            while ((size_t)(source - initialSource) < childSize)
                             {
-                                // a 32-bit count, then a pointer to the source rows
-                                size32_t childCount = *(size32_t *) source;
-                                source += sizeof(size32_t);
-                                const byte ** sourceRows = *(const byte***) source;
-                                for (size32_t childRow = 0; childRow < childCount; childRow++)
-                                {
-                                    const byte * row = sourceRows[childRow];
-                                    //Dictionaries have blank rows - ignore them when serializing (to a dataset)
-                                    if (row)
-                                        offset = match.subTrans->doTranslate(builder, callback, offset, row);
-                                }
-                            }
-                            else
-                            {
-                                // a 32-bit size, then rows inline
-                                size32_t childSize = *(size32_t *) source;
-                                source += sizeof(size32_t);
-                                const byte *initialSource = source;
-                                while ((size_t)(source - initialSource) < childSize)
-                                {
-                                    offset = match.subTrans->doTranslate(builder, callback, offset, source);
-                                    source += sourceType->queryChildType()->size(source, nullptr); // MORE - shame to repeat a calculation that the translate above almost certainly just did
-                                }
+                                offset = match.subTrans->doTranslate(builder, callback, offset, source);
+                                source += sourceType->queryChildType()->size(source, nullptr); // MORE - shame to repeat a calculation that the translate above almost certainly just did
                             }
-                            dest = builder.getSelf() + countOffset;  // Note - may have been moved by reallocs since last calculated
-                            *(size32_t *)dest = offset - initialOffset;
                         }
-                        break;
-                    default:
-                        throwUnexpected();
+                        dest = builder.getSelf() + countOffset;  // Note - may have been moved by reallocs since last calculated
+                        *(size32_t *)dest = offset - initialOffset;
                     }
+                    break;
+                default:
+                    throwUnexpected();
                 }
             }
         }
-        if (estimate && offset-origOffset != estimate)
-        {
-            if (offset == origOffset)
-            {
-                //Zero size records are treated as single byte to avoid confusion with sizes returned from transforms etc.
-                offset++;
-            }
-            else
-            {
-                if (!hasBlobs)
-                    assert(offset-origOffset > estimate);  // Estimate is always supposed to be conservative
-    #ifdef TRACE_TRANSLATION
-                DBGLOG("Wrote %u bytes to record (estimate was %u)\n", offset-origOffset, estimate);
-    #endif
-            }
-        }
         return offset;
     }
     inline FieldMatchType match() const
@@ -1487,6 +1539,28 @@ private:
         }
     } *matchInfo;
 
+    // A flat list of steps used to translate binary rows, rather than re-examining the match information for every field
+    // of every row.  Adjacent copies from fixed offsets in the source are combined, and default values are precalculated.
+    enum CopyStepKind : byte
+    {
+        copy_fixed,         // copy size bytes from sourceOffset in the source row
+        copy_variable,      // copy source fields field..lastField
+        copy_constant,      // copy size bytes from sourceOffset in constantValues
+        copy_field,         // translate destination field (using translateField)
+    };
+    struct CopyStep
+    {
+        CopyStepKind kind;
+        unsigned field;
+        unsigned lastField;
+        size32_t sourceOffset;
+        size32_t size;
+        const char *name;
+    };
+    std::vector<CopyStep> copyPlan;
+    MemoryBuffer constantValues;
+    size32_t planFixedSize = 0;    // The size of the translated row if every step has a fixed size (otherwise 0)
+
     static size32_t translateScalarFromUtf8(ARowBuilder &builder, size32_t offset, const RtlFieldInfo *field, const RtlTypeInfo &destType, const RtlTypeInfo &sourceType, const char *source, size_t srcSize)
     {
         switch(destType.getType())
@@ -1831,6 +1905,116 @@ private:
 #endif
         }
     }
+    void addFixedCopy(size32_t sourceOffset, size32_t size, const char *name)
+    {
+        if (copyPlan.size())
+        {
+            CopyStep &prev = copyPlan.back();
+            if ((prev.kind == copy_fixed) && (prev.sourceOffset + prev.size == sourceOffset))
+            {
+                prev.size += size;
+                return;
+            }
+        }
+        copyPlan.push_back({ copy_fixed, 0, 0, sourceOffset, size, name });
+    }
+    void addConstant(size32_t size, const void *value, const char *name)
+    {
+        size32_t valueOffset = constantValues.length();
+        constantValues.append(size, value);
+        if (copyPlan.size())
+        {
+            CopyStep &prev = copyPlan.back();
+            if ((prev.kind == copy_constant) && (prev.sourceOffset + prev.size == valueOffset))
+            {
+                prev.size += size;
+                return;
+            }
+        }
+        copyPlan.push_back({ copy_constant, 0, 0, valueOffset, size, name });
+    }
+    void createCopyPlan()
+    {
+        // ifblocks in the target are evaluated field by field as the row is built, so are not supported by a plan
+        if (!binarySource || !canTranslate() || destRecInfo.getNumIfBlocks())
+            return;
+        unsigned numFields = destRecInfo.getNumFields();
+        bool allFixed = true;
+        for (unsigned idx = 0; idx < numFields; idx++)
+        {
+            const RtlFieldInfo *field = destRecInfo.queryField(idx);
+            const RtlTypeInfo *type = field->type;
+            const MatchInfo &match = matchInfo[idx];
+            unsigned matchField = match.matchIdx;
+            switch (match.matchType)
+            {
+            case match_perfect:
+            {
+                unsigned lastField = matchField;
+                while ((idx+1 < numFields) && (matchInfo[idx+1].matchType == match_perfect) && (matchInfo[idx+1].matchIdx == lastField+1))
+                {
+                    idx++;
+                    lastField++;
+                }
+                if (sourceRecInfo.isFixedOffset(matchField) && sourceRecInfo.isFixedOffset(lastField+1))
+                {
+                    size32_t sourceOffset = sourceRecInfo.getFixedOffset(matchField);
+                    addFixedCopy(sourceOffset, sourceRecInfo.getFixedOffset(lastField+1) - sourceOffset, field->name);
+                }
+                else
+                {
+                    copyPlan.push_back({ copy_variable, matchField, lastField, 0, 0, field->name });
+                    allFixed = false;
+                }
+                continue;
+            }
+            case match_truncate:
+            case match_extend:
+            {
+                const RtlTypeInfo *sourceType = sourceRecInfo.queryType(matchField);
+                if (sourceRecInfo.isFixedOffset(matchField) && sourceType->isFixedSize())
+                {
+                    size32_t sourceOffset = sourceRecInfo.getFixedOffset(matchField);
+                    size32_t destSize = type->getMinSize();
+                    if (match.matchType == match_truncate)
+                        addFixedCopy(sourceOffset, destSize, field->name);
+                    else
+                    {
+                        size32_t sourceSize = sourceType->getMinSize();
+                        addFixedCopy(sourceOffset, sourceSize, field->name);
+                        MemoryBuffer fill;
+                        memset(fill.reserveTruncate(destSize - sourceSize), match.fillChar, destSize - sourceSize);
+                        addConstant(fill.length(), fill.toByteArray(), field->name);
+                    }
+                    continue;
+                }
+                break;
+            }
+            case match_none:
+                if (type->isScalar() && type->isFixedSize())
+                {
+                    // The default value is the same for every row, so build it once
+                    MemoryBuffer value;
+                    MemoryBufferBuilder valueBuilder(value, type->getMinSize());
+                    size32_t size = type->buildNull(valueBuilder, 0, field);
+                    valueBuilder.finishRow(size);
+                    addConstant(value.length(), value.toByteArray(), field->name);
+                    continue;
+                }
+                break;
+            }
+
+            // Anything else is translated a field at a time.  translateField() only combines exact perfect matches,
+            // which are handled above, so each of these steps translates a single field.
+            copyPlan.push_back({ copy_field, idx, idx, 0, 0, field->name });
+            allFixed = false;
+        }
+        if (allFixed)
+        {
+            for (const CopyStep &step : copyPlan)
+                planFixedSize += step.size;
+        }
+    }
     size32_t estimateNewSize(const RtlRow &sourceRow) const
     {
 #ifdef TRACE_TRANSLATION
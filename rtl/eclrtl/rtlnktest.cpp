@@ -26,6 +26,9 @@
 #include "rtlnewkey.hpp"
 #include "rtlfield.hpp"
 #include "rtldynfield.hpp"
+#include "rtlds_imp.hpp"
+#include "eclhelper_base.hpp"
+#include "roxiemem.hpp"
 
 #ifdef _USE_CPPUNIT
 #include <cppunit/extensions/HelperMacros.h>
@@ -1482,4 +1485,664 @@ protected:
 CPPUNIT_TEST_SUITE_REGISTRATION(ValueSetTest);
 CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(ValueSetTest, "ValueSetTest");
 
+
+// Layout changes that commonly occur between the record a query expects and the record of the file it reads
+class RecordTranslatorTest : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE(RecordTranslatorTest);
+        CPPUNIT_TEST(testTranslate);
+        CPPUNIT_TEST(testSourceIfBlock);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    // An ifblock that is present when the first (int4) field of the row is odd
+    struct OddIdIfBlockTypeInfo final : public RtlComplexIfBlockTypeInfo
+    {
+        constexpr OddIdIfBlockTypeInfo(const RtlFieldInfo * const * _fields)
+        : RtlComplexIfBlockTypeInfo(type_ifblock|RFTMunknownsize|RFTMnoserialize, 0, _fields, nullptr) {}
+        virtual void doDelete() const override final { delete this; }
+        using RtlComplexIfBlockTypeInfo::getCondition;
+        virtual bool getCondition(const byte * selfrow) const override { return (*(const int *)selfrow & 1) != 0; }
+    };
+
+    const RtlIntTypeInfo int4 = RtlIntTypeInfo(type_int, 4);
+    const RtlIntTypeInfo int8 = RtlIntTypeInfo(type_int, 8);
+    const RtlStringTypeInfo str2 = RtlStringTypeInfo(type_string, 2);
+    const RtlStringTypeInfo str8 = RtlStringTypeInfo(type_string, 8);
+    const RtlStringTypeInfo str10 = RtlStringTypeInfo(type_string, 10);
+    const RtlStringTypeInfo str12 = RtlStringTypeInfo(type_string, 12);
+    const RtlStringTypeInfo strx = RtlStringTypeInfo(type_string|RFTMunknownsize, 0);
+
+    // The file: id:int4 name:string10 val:int8 extra:string tail:string2
+    const RtlFieldInfo id = RtlFieldInfo("id", nullptr, &int4);
+    const RtlFieldInfo name = RtlFieldInfo("name", nullptr, &str10);
+    const RtlFieldInfo val = RtlFieldInfo("val", nullptr, &int8);
+    const RtlFieldInfo extra = RtlFieldInfo("extra", nullptr, &strx);
+    const RtlFieldInfo tail = RtlFieldInfo("tail", nullptr, &str2);
+    const RtlFieldInfo * const sourceFields[6] = { &id, &name, &val, &extra, &tail, nullptr };
+    const RtlRecordTypeInfo sourceType = RtlRecordTypeInfo(type_record, 0, sourceFields);
+
+    const RtlFieldInfo added = RtlFieldInfo("added", nullptr, &int4, 0, "\x07\x00\x00\x00");
+    const RtlFieldInfo name8 = RtlFieldInfo("name", nullptr, &str8);
+    const RtlFieldInfo name12 = RtlFieldInfo("name", nullptr, &str12);
+    const RtlFieldInfo val4 = RtlFieldInfo("val", nullptr, &int4);
+    const RtlFieldInfo * const addedFields[7] = { &id, &name, &val, &added, &extra, &tail, nullptr };
+    const RtlFieldInfo * const removedFields[5] = { &id, &val, &extra, &tail, nullptr };
+    const RtlFieldInfo * const extendFields[6] = { &id, &name12, &val, &extra, &tail, nullptr };
+    const RtlFieldInfo * const truncateFields[6] = { &id, &name8, &val, &extra, &tail, nullptr };
+    const RtlFieldInfo * const castFields[6] = { &id, &name, &val4, &extra, &tail, nullptr };
+    const RtlFieldInfo * const reorderFields[6] = { &val, &id, &name, &tail, &extra, nullptr };
+    const RtlFieldInfo * const fixedFields[5] = { &added, &id, &name12, &val, nullptr };
+
+    struct Scenario
+    {
+        const char *title;
+        const RtlFieldInfo * const *fields;
+    };
+    // The file: id:int4 IFBLOCK(odd(id)) opt:int4 END name:string10 val:int8
+    const RtlFieldInfo opt = RtlFieldInfo("opt", nullptr, &int4);
+    const RtlFieldInfo * const optFields[2] = { &opt, nullptr };
+    const OddIdIfBlockTypeInfo optIfBlockType = OddIdIfBlockTypeInfo(optFields);
+    const RtlFieldInfo optIfBlock = RtlFieldInfo(nullptr, nullptr, &optIfBlockType);
+    const RtlFieldInfo * const ifSourceFields[5] = { &id, &optIfBlock, &name, &val, nullptr };
+    const RtlRecordTypeInfo ifSourceType = RtlRecordTypeInfo(type_record, 0, ifSourceFields);
+    // The query record has the same fields without the ifblock
+    const RtlFieldInfo * const ifDestFields[5] = { &id, &opt, &name, &val, nullptr };
+
+    const Scenario scenarios[7] = {
+        { "identical", sourceFields },
+        { "added", addedFields },
+        { "removed", removedFields },
+        { "extended", extendFields },
+        { "truncated", truncateFields },
+        { "typecast", castFields },
+        { "reordered", reorderFields },
+    };
+    static constexpr unsigned numScenarios = sizeof(scenarios)/sizeof(scenarios[0]);
+
+    void createSourceRows(MemoryBuffer &rows, PointerArray &rowPtrs, unsigned numRows)
+    {
+        UnsignedArray offsets;
+        for (unsigned i=0; i < numRows; i++)
+        {
+            offsets.append(rows.length());
+            VStringBuffer nameValue("%-10.10s", VStringBuffer("n%u", i).str());
+            StringBuffer extraValue;
+            extraValue.appendN(i % 5, 'x');
+            rows.append((int)i).append(10, nameValue.str()).append((__int64)i*1000);
+            rows.append((int)extraValue.length()).append(extraValue.length(), extraValue.str()).append(2, "TT");
+        }
+        ForEachItemIn(o, offsets)
+            rowPtrs.append((void *)(rows.toByteArray() + offsets.item(o)));
+    }
+
+    static StringBuffer &getString(StringBuffer &out, const RtlRow &row, const RtlRecord &record, const char *field)
+    {
+        unsigned fieldNum = record.getFieldNum(field);
+        size32_t len;
+        rtlDataAttr text;
+        row.getString(len, text.refstr(), fieldNum);
+        return out.append(len, text.getstr());
+    }
+
+public:
+    void testTranslate()
+    {
+        MemoryBuffer rows;
+        PointerArray rowPtrs;
+        createSourceRows(rows, rowPtrs, 20);
+        RtlRecord sourceRecord(sourceType, true);
+        NullVirtualFieldCallback callback;
+        for (unsigned pass=0; pass <= numScenarios; pass++)
+        {
+            const RtlFieldInfo * const *fields = (pass < numScenarios) ? scenarios[pass].fields : fixedFields;
+            RtlRecordTypeInfo destType(type_record, 0, fields);
+            RtlRecord destRecord(destType, true);
+            Owned<const IDynamicTransform> translator = createRecordTranslator(destRecord, sourceRecord);
+            CPPUNIT_ASSERT(translator->canTranslate());
+            ForEachItemIn(i, rowPtrs)
+            {
+                MemoryBuffer out;
+                MemoryBufferBuilder builder(out, destRecord.getMinRecordSize());
+                size32_t len = translator->translate(builder, callback, (const byte *)rowPtrs.item(i));
+                builder.finishRow(len);
+                unsigned numVarFields = destRecord.getNumVarFields();
+                size_t *variableOffsets = new size_t[numVarFields+1];
+                RtlRow row(destRecord, out.toByteArray(), numVarFields+1, variableOffsets);
+                CPPUNIT_ASSERT_EQUAL((size32_t)destRecord.getRecordSize(out.toByteArray()), len);
+                CPPUNIT_ASSERT_EQUAL((__int64)i, row.getInt(destRecord.getFieldNum("id")));
+                CPPUNIT_ASSERT_EQUAL((__int64)i*1000, row.getInt(destRecord.getFieldNum("val")));
+                StringBuffer expectedName, nameValue;
+                expectedName.appendf("n%u", i);
+                getString(nameValue, row, destRecord, "name");
+                if (fields == removedFields)
+                    CPPUNIT_ASSERT_EQUAL(-1, (int)destRecord.getFieldNum("name"));
+                else
+                {
+                    size32_t nameLen = destRecord.queryType(destRecord.getFieldNum("name"))->length;
+                    expectedName.appendN(nameLen - expectedName.length(), ' ');
+                    CPPUNIT_ASSERT_EQUAL(std::string(expectedName.str()), std::string(nameValue.str()));
+                }
+                if (destRecord.getFieldNum("added") != (unsigned)-1)
+                    CPPUNIT_ASSERT_EQUAL((__int64)7, row.getInt(destRecord.getFieldNum("added")));
+                if (fields != fixedFields)
+                {
+                    StringBuffer extraValue, tailValue;
+                    CPPUNIT_ASSERT_EQUAL(i % 5, getString(extraValue, row, destRecord, "extra").length());
+                    CPPUNIT_ASSERT(streq("TT", getString(tailValue, row, destRecord, "tail")));
+                }
+                delete [] variableOffsets;
+            }
+        }
+    }
+
+    // A field in a source ifblock is followed by perfectly matching fields - check they are copied whether or not the
+    // ifblock is present
+    void testSourceIfBlock()
+    {
+        MemoryBuffer rows;
+        UnsignedArray offsets;
+        for (unsigned i=0; i < 4; i++)
+        {
+            offsets.append(rows.length());
+            VStringBuffer nameValue("%-10.10s", VStringBuffer("n%u", i).str());
+            rows.append((int)i);
+            if (i & 1)
+                rows.append((int)(i*10));
+            rows.append(10, nameValue.str()).append((__int64)i*1000);
+        }
+
+        RtlRecord sourceRecord(ifSourceType, true);
+        RtlRecordTypeInfo destType(type_record, 0, ifDestFields);
+        RtlRecord destRecord(destType, true);
+        Owned<const IDynamicTransform> translator = createRecordTranslator(destRecord, sourceRecord);
+        CPPUNIT_ASSERT(translator->canTranslate());
+        NullVirtualFieldCallback callback;
+        ForEachItemIn(i, offsets)
+        {
+            MemoryBuffer out;
+            MemoryBufferBuilder builder(out, destRecord.getMinRecordSize());
+            size32_t len = translator->translate(builder, callback, (const byte *)rows.toByteArray() + offsets.item(i));
+            builder.finishRow(len);
+            CPPUNIT_ASSERT_EQUAL((size32_t)destRecord.getFixedSize(), len);
+            size_t variableOffsets[1];
+            RtlRow row(destRecord, out.toByteArray(), 1, variableOffsets);
+            CPPUNIT_ASSERT_EQUAL((__int64)i, row.getInt(destRecord.getFieldNum("id")));
+            CPPUNIT_ASSERT_EQUAL((__int64)((i & 1) ? i*10 : 0), row.getInt(destRecord.getFieldNum("opt")));
+            StringBuffer expectedName, nameValue;
+            expectedName.appendf("%-10.10s", VStringBuffer("n%u", i).str());
+            CPPUNIT_ASSERT_EQUAL(std::string(expectedName.str()), std::string(getString(nameValue, row, destRecord, "name").str()));
+            CPPUNIT_ASSERT_EQUAL((__int64)i*1000, row.getInt(destRecord.getFieldNum("val")));
+        }
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(RecordTranslatorTest);
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(RecordTranslatorTest, "RecordTranslatorTest");
+
+class RecordTranslatorTiming : public RecordTranslatorTest
+{
+    CPPUNIT_TEST_SUITE(RecordTranslatorTiming);
+        CPPUNIT_TEST(testTiming);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void testTiming()
+    {
+        const unsigned numRows = 100000;
+        const unsigned numPasses = 20;
+        MemoryBuffer rows;
+        PointerArray rowPtrs;
+        createSourceRows(rows, rowPtrs, numRows);
+        RtlRecord sourceRecord(sourceType, true);
+        NullVirtualFieldCallback callback;
+        MemoryBuffer out;
+        out.ensureCapacity(rows.length() * 2);
+
+        // Baseline - the cost of copying the rows without any translation
+        CCycleTimer timer;
+        for (unsigned pass=0; pass < numPasses; pass++)
+        {
+            out.clear();
+            ForEachItemIn(i, rowPtrs)
+            {
+                const byte *row = (const byte *)rowPtrs.item(i);
+                out.append(sourceRecord.getRecordSize(row), row);
+            }
+        }
+        DBGLOG("RecordTranslatorTiming: direct copy %u rows x %u took %" I64F "u ms", numRows, numPasses, timer.elapsedMs());
+
+        for (unsigned scenario=0; scenario < numScenarios; scenario++)
+        {
+            RtlRecordTypeInfo destType(type_record, 0, scenarios[scenario].fields);
+            RtlRecord destRecord(destType, true);
+            Owned<const IDynamicTransform> translator = createRecordTranslator(destRecord, sourceRecord);
+            timer.reset();
+            for (unsigned pass=0; pass < numPasses; pass++)
+            {
+                out.clear();
+                MemoryBufferBuilder builder(out, destRecord.getMinRecordSize());
+                ForEachItemIn(i, rowPtrs)
+                {
+                    size32_t len = translator->translate(builder, callback, (const byte *)rowPtrs.item(i));
+                    builder.finishRow(len);
+                }
+            }
+            DBGLOG("RecordTranslatorTiming: %s %u rows x %u took %" I64F "u ms", scenarios[scenario].title, numRows, numPasses, timer.elapsedMs());
+        }
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(RecordTranslatorTiming);
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(RecordTranslatorTiming, "RecordTranslatorTiming");
+
+// Reading and filtering/projecting blocks of rows with RtlFilterBlock and RtlProjectBlock.  The rows are
+// roxiemem rows containing a single unsigned, so the row manager can check that none of them are leaked.
+class RtlBlockTest : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE(RtlBlockTest);
+        CPPUNIT_TEST(testSetup);
+        CPPUNIT_TEST(testFilterBlock);
+        CPPUNIT_TEST(testFilterSingle);
+        CPPUNIT_TEST(testFilterKillReset);
+        CPPUNIT_TEST(testFilterException);
+        CPPUNIT_TEST(testProjectBlock);
+        CPPUNIT_TEST(testProjectSingle);
+        CPPUNIT_TEST(testProjectKillReset);
+        CPPUNIT_TEST(testProjectException);
+        CPPUNIT_TEST(testCleanup);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    static constexpr unsigned endGroup = 0;     // the value used to mark the end of a group in the input
+
+    static const void * createRow(roxiemem::IRowManager * rowManager, unsigned value)
+    {
+        unsigned * row = (unsigned *)rowManager->allocate(sizeof(unsigned), 0);
+        *row = value;
+        return row;
+    }
+    static unsigned getValue(const void * row) { return *(const unsigned *)row; }
+
+    // Rows are only created when they are read, so any that are read ahead but not returned are visible
+    class TestRowStream : public CInterfaceOf<IRowStream>
+    {
+    public:
+        TestRowStream(roxiemem::IRowManager * _rowManager, std::initializer_list<unsigned> _values)
+        : rowManager(_rowManager), values(_values) {}
+
+        virtual const void * nextRow() override
+        {
+            if (numRead == (unsigned)values.size())
+                return nullptr;
+            unsigned value = values[numRead++];
+            return (value == endGroup) ? nullptr : createRow(rowManager, value);
+        }
+        virtual void stop() override { numRead = (unsigned)values.size(); }
+
+    public:
+        unsigned numRead = 0;
+    protected:
+        roxiemem::IRowManager * rowManager;
+        std::vector<unsigned> values;
+    };
+
+    // Creates fixed size rows from the row manager - only the functions used by RtlDynamicRowBuilder are supported
+    class TestRowAllocator : public CInterfaceOf<IEngineRowAllocator>
+    {
+    public:
+        TestRowAllocator(roxiemem::IRowManager * _rowManager) : rowManager(_rowManager) {}
+
+        virtual const byte * * createRowset(unsigned _numItems) override { throwUnexpected(); }
+        virtual const byte * * linkRowset(const byte * * rowset) override { throwUnexpected(); }
+        virtual void releaseRowset(unsigned count, const byte * * rowset) override { throwUnexpected(); }
+        virtual const byte * * appendRowOwn(const byte * * rowset, unsigned newRowCount, void * row) override { throwUnexpected(); }
+        virtual const byte * * reallocRows(const byte * * rowset, unsigned oldRowCount, unsigned newRowCount) override { throwUnexpected(); }
+
+        virtual void * createRow() override { return rowManager->allocate(sizeof(unsigned), 0); }
+        virtual void releaseRow(const void * row) override { ReleaseRoxieRow(row); }
+        virtual void * linkRow(const void * row) override { LinkRoxieRow(row); return const_cast<void *>(row); }
+
+        virtual void * createRow(size32_t & allocatedSize) override
+        {
+            allocatedSize = sizeof(unsigned);
+            return createRow();
+        }
+        virtual void * createRow(size32_t initialSize, size32_t & allocatedSize) override
+        {
+            assertex(initialSize <= sizeof(unsigned));
+            return createRow(allocatedSize);
+        }
+        virtual void * resizeRow(size32_t newSize, void * row, size32_t & size) override { throwUnexpected(); }
+        virtual void * finalizeRow(size32_t newSize, void * row, size32_t oldSize) override { return row; }
+
+        virtual IOutputMetaData * queryOutputMeta() override { return nullptr; }
+        virtual unsigned queryActivityId() const override { return 0; }
+        virtual StringBuffer &getId(StringBuffer & out) override { return out; }
+        virtual IOutputRowSerializer *createDiskSerializer(ICodeContext *ctx) override { return nullptr; }
+        virtual IOutputRowDeserializer *createDiskDeserializer(ICodeContext *ctx) override { return nullptr; }
+        virtual IOutputRowSerializer *createInternalSerializer(ICodeContext *ctx) override { return nullptr; }
+        virtual IOutputRowDeserializer *createInternalDeserializer(ICodeContext *ctx) override { return nullptr; }
+        virtual IEngineRowAllocator *createChildRowAllocator(const RtlTypeInfo *childtype) override { return nullptr; }
+
+        virtual void gatherStats(CRuntimeStatisticCollection & stats) override {}
+        virtual void releaseAllRows() override {}
+        virtual void emptyCache() override {}
+
+    protected:
+        roxiemem::IRowManager * rowManager;
+    };
+
+    // Selects even values, and throws an exception when it sees throwValue
+    class TestFilterArg : public CThorFilterArg
+    {
+    public:
+        virtual IOutputMetaData * queryOutputMeta() override { return nullptr; }
+        virtual bool isValid(const void * _left) override
+        {
+            unsigned value = getValue(_left);
+            if (value == throwValue)
+                throw makeStringExceptionV(0, "Filter failed on row %u", value);
+            return (value % 2) == 0;
+        }
+
+    public:
+        unsigned throwValue = 0;
+    };
+
+    class TestFilterBlockArg : public TestFilterArg, public IHThorFilterBlockExtra
+    {
+    public:
+        virtual unsigned selectValid(unsigned numRows, const void * * rows, unsigned * selected) override
+        {
+            blockSizes.push_back(numRows);
+            unsigned numSelected = 0;
+            for (unsigned i=0; i < numRows; i++)
+            {
+                if (isValid(rows[i]))
+                    selected[numSelected++] = i;
+            }
+            return numSelected;
+        }
+
+    public:
+        std::vector<unsigned> blockSizes;
+    };
+
+    // Multiplies each value by 10, skips multiples of 3, and throws an exception when it sees throwValue
+    class TestProjectArg : public CThorProjectArg
+    {
+    public:
+        virtual IOutputMetaData * queryOutputMeta() override { return nullptr; }
+        virtual size32_t transform(ARowBuilder & rowBuilder, const void * _left) override
+        {
+            unsigned value = getValue(_left);
+            if (value == throwValue)
+                throw makeStringExceptionV(0, "Project failed on row %u", value);
+            if ((value % 3) == 0)
+                return 0;
+            *(unsigned *)rowBuilder.getSelf() = value * 10;
+            return sizeof(unsigned);
+        }
+
+    public:
+        unsigned throwValue = 0;
+    };
+
+    class TestProjectBlockArg : public TestProjectArg, public IHThorProjectBlockExtra
+    {
+    public:
+        virtual void transformBlock(unsigned numRows, ARowBuilder * * builders, const void * * rows, size32_t * sizes) override
+        {
+            blockSizes.push_back(numRows);
+            for (unsigned i=0; i < numRows; i++)
+                sizes[i] = transform(*builders[i], rows[i]);
+        }
+
+    public:
+        std::vector<unsigned> blockSizes;
+    };
+
+    template <class BLOCK>
+    static std::string fillNext(BLOCK & block, IRowStream & input, bool expectedEndOfGroup)
+    {
+        bool endOfGroup = block.fill(input, nullptr);
+        CPPUNIT_ASSERT_EQUAL(expectedEndOfGroup, endOfGroup);
+        return getResults(block);
+    }
+
+    template <class BLOCK>
+    static std::string getResults(BLOCK & block)
+    {
+        std::string results;
+        for (;;)
+        {
+            const void * row = block.nextResult();
+            if (!row)
+                return results;
+            if (!results.empty())
+                results += ",";
+            results += std::to_string(getValue(row));
+            ReleaseRoxieRow(row);
+        }
+    }
+
+    static roxiemem::IRowManager * createRowManager()
+    {
+        return roxiemem::createRowManager(0, nullptr, queryDummyContextLogger(), nullptr, false);
+    }
+
+    void testSetup()
+    {
+        roxiemem::setTotalMemoryLimit(false, false, false, false, 20 * 0x100000, 0, nullptr, nullptr);
+    }
+
+    void testCleanup()
+    {
+        roxiemem::releaseRoxieHeap();
+    }
+
+    void testFilterBlock()
+    {
+        Owned<roxiemem::IRowManager> rowManager = createRowManager();
+        TestRowStream input(rowManager, { 1, 2, 3, endGroup, 4, 5, 6, 7, 8, 9, 10, endGroup });
+        TestFilterBlockArg helper;
+        {
+            RtlFilterBlock block(helper, 4);
+            //The block size starts at 1 so a consumer that only wants one row does not read any more
+            CPPUNIT_ASSERT_EQUAL(std::string(""), fillNext(block, input, false));
+            CPPUNIT_ASSERT_EQUAL(1U, input.numRead);
+            CPPUNIT_ASSERT_EQUAL(std::string("2"), fillNext(block, input, false));
+            CPPUNIT_ASSERT_EQUAL(std::string(""), fillNext(block, input, true));
+            //Doubles until it reaches the maximum, and stops at the end of a group
+            CPPUNIT_ASSERT_EQUAL(std::string("4,6"), fillNext(block, input, false));
+            CPPUNIT_ASSERT_EQUAL(std::string("8,10"), fillNext(block, input, true));
+            CPPUNIT_ASSERT_EQUAL(std::string(""), fillNext(block, input, true));
+            CPPUNIT_ASSERT((helper.blockSizes == std::vector<unsigned>{ 1, 2, 0, 4, 3, 0 }));
+        }
+        //The rows that were rejected have all been released
+        CPPUNIT_ASSERT_EQUAL(0U, rowManager->allocated());
+    }
+
+    void testFilterSingle()
+    {
+        Owned<roxiemem::IRowManager> rowManager = createRowManager();
+        TestRowStream input(rowManager, { 1, 2, endGroup, 4, 6 });
+        TestFilterArg helper;
+        {
+            //Without the block interface the rows are filtered one at a time, whatever the maximum
+            RtlFilterBlock block(helper, 4);
+            CPPUNIT_ASSERT_EQUAL(std::string(""), fillNext(block, input, false));
+            CPPUNIT_ASSERT_EQUAL(std::string("2"), fillNext(block, input, false));
+            CPPUNIT_ASSERT_EQUAL(std::string(""), fillNext(block, input, true));
+            CPPUNIT_ASSERT_EQUAL(std::string("4"), fillNext(block, input, false));
+            CPPUNIT_ASSERT_EQUAL(4U, input.numRead);
+            CPPUNIT_ASSERT_EQUAL(std::string("6"), fillNext(block, input, false));
+            CPPUNIT_ASSERT_EQUAL(std::string(""), fillNext(block, input, true));
+        }
+        CPPUNIT_ASSERT_EQUAL(0U, rowManager->allocated());
+    }
+
+    void testFilterKillReset()
+    {
+        Owned<roxiemem::IRowManager> rowManager = createRowManager();
+        TestRowStream input(rowManager, { 1, 2, 4, 6, 8, 10, 12, 14, 16 });
+        TestFilterBlockArg helper;
+        {
+            RtlFilterBlock block(helper, 8);
+            fillNext(block, input, false);
+            CPPUNIT_ASSERT_EQUAL(std::string("2,4"), fillNext(block, input, false));
+
+            //kill() releases the rows that have not been returned
+            CPPUNIT_ASSERT(!block.fill(input, nullptr));
+            const void * row = block.nextResult();
+            CPPUNIT_ASSERT_EQUAL(6U, getValue(row));
+            block.kill();
+            CPPUNIT_ASSERT(!block.nextResult());
+            CPPUNIT_ASSERT_EQUAL(1U, rowManager->allocated());
+            ReleaseRoxieRow(row);
+
+            //reset() restarts the block size from 1 - firstRow counts towards the block
+            block.reset();
+            CPPUNIT_ASSERT(!block.fill(input, createRow(rowManager, 20)));
+            CPPUNIT_ASSERT_EQUAL(std::string("20"), getResults(block));
+            CPPUNIT_ASSERT(!block.fill(input, nullptr));
+            CPPUNIT_ASSERT((helper.blockSizes == std::vector<unsigned>{ 1, 2, 4, 1, 2 }));
+
+            //The destructor releases any rows that are left
+            CPPUNIT_ASSERT_EQUAL(2U, rowManager->allocated());
+        }
+        CPPUNIT_ASSERT_EQUAL(0U, rowManager->allocated());
+    }
+
+    void testFilterException()
+    {
+        Owned<roxiemem::IRowManager> rowManager = createRowManager();
+        TestRowStream input(rowManager, { 2, 4, 6, 8, 10, 12 });
+        TestFilterBlockArg helper;
+        helper.throwValue = 8;
+        {
+            RtlFilterBlock block(helper, 4);
+            CPPUNIT_ASSERT_EQUAL(std::string("2"), fillNext(block, input, false));
+            CPPUNIT_ASSERT_EQUAL(std::string("4,6"), fillNext(block, input, false));
+            bool thrown = false;
+            try
+            {
+                block.fill(input, nullptr);
+            }
+            catch (IException * e)
+            {
+                e->Release();
+                thrown = true;
+            }
+            CPPUNIT_ASSERT(thrown);
+            //All the rows read for the failed block are released, and nothing is returned
+            CPPUNIT_ASSERT_EQUAL(6U, input.numRead);
+            CPPUNIT_ASSERT_EQUAL(0U, rowManager->allocated());
+            CPPUNIT_ASSERT(!block.nextResult());
+        }
+        CPPUNIT_ASSERT_EQUAL(0U, rowManager->allocated());
+    }
+
+    void testProjectBlock()
+    {
+        Owned<roxiemem::IRowManager> rowManager = createRowManager();
+        TestRowStream input(rowManager, { 1, 2, 3, endGroup, 4, 5, 6, 7, 8, 9, 10, endGroup });
+        TestRowAllocator allocator(rowManager);
+        TestProjectBlockArg helper;
+        {
+            RtlProjectBlock block(helper, &allocator, 4);
+            CPPUNIT_ASSERT_EQUAL(std::string("10"), fillNext(block, input, false));
+            CPPUNIT_ASSERT_EQUAL(1U, input.numRead);
+            CPPUNIT_ASSERT_EQUAL(std::string("20"), fillNext(block, input, false));
+            CPPUNIT_ASSERT_EQUAL(std::string(""), fillNext(block, input, true));
+            CPPUNIT_ASSERT_EQUAL(std::string("40,50,70"), fillNext(block, input, false));
+            CPPUNIT_ASSERT_EQUAL(std::string("80,100"), fillNext(block, input, true));
+            CPPUNIT_ASSERT_EQUAL(std::string(""), fillNext(block, input, true));
+            CPPUNIT_ASSERT((helper.blockSizes == std::vector<unsigned>{ 1, 2, 0, 4, 3, 0 }));
+            //The input rows have been released, the builders of the skipped rows are retained for the next block
+            CPPUNIT_ASSERT(rowManager->allocated() <= 4);
+        }
+        CPPUNIT_ASSERT_EQUAL(0U, rowManager->allocated());
+    }
+
+    void testProjectSingle()
+    {
+        Owned<roxiemem::IRowManager> rowManager = createRowManager();
+        TestRowStream input(rowManager, { 2, 3, endGroup, 4 });
+        TestRowAllocator allocator(rowManager);
+        TestProjectArg helper;
+        {
+            RtlProjectBlock block(helper, &allocator, 4);
+            CPPUNIT_ASSERT_EQUAL(std::string("20"), fillNext(block, input, false));
+            CPPUNIT_ASSERT_EQUAL(std::string(""), fillNext(block, input, false));
+            CPPUNIT_ASSERT_EQUAL(std::string(""), fillNext(block, input, true));
+            CPPUNIT_ASSERT_EQUAL(std::string("40"), fillNext(block, input, false));
+            CPPUNIT_ASSERT_EQUAL(4U, input.numRead);
+            CPPUNIT_ASSERT_EQUAL(std::string(""), fillNext(block, input, true));
+        }
+        CPPUNIT_ASSERT_EQUAL(0U, rowManager->allocated());
+    }
+
+    void testProjectKillReset()
+    {
+        Owned<roxiemem::IRowManager> rowManager = createRowManager();
+        TestRowStream input(rowManager, { 1, 2, 4, 5, 7, 8, 10, 11, 13 });
+        TestRowAllocator allocator(rowManager);
+        TestProjectBlockArg helper;
+        {
+            RtlProjectBlock block(helper, &allocator, 8);
+            fillNext(block, input, false);
+            CPPUNIT_ASSERT_EQUAL(std::string("20,40"), fillNext(block, input, false));
+
+            CPPUNIT_ASSERT(!block.fill(input, nullptr));
+            const void * row = block.nextResult();
+            CPPUNIT_ASSERT_EQUAL(50U, getValue(row));
+            block.kill();
+            CPPUNIT_ASSERT(!block.nextResult());
+            ReleaseRoxieRow(row);
+
+            block.reset();
+            CPPUNIT_ASSERT(!block.fill(input, createRow(rowManager, 14)));
+            CPPUNIT_ASSERT_EQUAL(std::string("140"), getResults(block));
+            CPPUNIT_ASSERT(!block.fill(input, nullptr));
+            CPPUNIT_ASSERT((helper.blockSizes == std::vector<unsigned>{ 1, 2, 4, 1, 2 }));
+        }
+        CPPUNIT_ASSERT_EQUAL(0U, rowManager->allocated());
+    }
+
+    void testProjectException()
+    {
+        Owned<roxiemem::IRowManager> rowManager = createRowManager();
+        TestRowStream input(rowManager, { 1, 2, 4, 5, 7, 8 });
+        TestRowAllocator allocator(rowManager);
+        TestProjectBlockArg helper;
+        helper.throwValue = 5;
+        {
+            RtlProjectBlock block(helper, &allocator, 4);
+            CPPUNIT_ASSERT_EQUAL(std::string("10"), fillNext(block, input, false));
+            CPPUNIT_ASSERT_EQUAL(std::string("20,40"), fillNext(block, input, false));
+            bool thrown = false;
+            try
+            {
+                block.fill(input, nullptr);
+            }
+            catch (IException * e)
+            {
+                e->Release();
+                thrown = true;
+            }
+            CPPUNIT_ASSERT(thrown);
+            CPPUNIT_ASSERT_EQUAL(6U, input.numRead);
+            CPPUNIT_ASSERT(!block.nextResult());
+            //Only the builders (one per row in the failed block) still hold rows
+            CPPUNIT_ASSERT(rowManager->allocated() <= 3);
+        }
+        CPPUNIT_ASSERT_EQUAL(0U, rowManager->allocated());
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(RtlBlockTest);
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(RtlBlockTest, "RtlBlockTest");
+
 #endif
@@ -1287,6 +1287,13 @@ struct IHThorFilterArg : public IHThorArg
     virtual bool canMatchAny() = 0;
 };
 
+//Optionally implemented by the helper of a simple filter (check with dynamic_cast), so a block of rows can be filtered in one call
+interface IHThorFilterBlockExtra
+{
+    //Fills selected with the indexes of the rows that are valid, and returns how many there are
+    virtual unsigned selectValid(unsigned numRows, const void * * rows, unsigned * selected) = 0;
+};
+
 struct IHThorFilterGroupArg : public IHThorArg
 {
     virtual bool isValid(unsigned _num, const void * * _rows) = 0;
@@ -1327,6 +1334,13 @@ struct IHThorProjectArg : public IHThorArg
     virtual size32_t transform(ARowBuilder & rowBuilder, const void * _left) = 0;
 };
 
+//Optionally implemented by the helper of a simple project (check with dynamic_cast), so a block of rows can be transformed in one call
+interface IHThorProjectBlockExtra
+{
+    //Transforms rows[i] into builders[i] and sets sizes[i] to the size returned by transform (0 if it was skipped)
+    virtual void transformBlock(unsigned numRows, ARowBuilder * * builders, const void * * rows, size32_t * sizes) = 0;
+};
+
 struct IHThorCountProjectArg : public IHThorArg
 {
     virtual bool canFilter() = 0;
@@ -40,8 +40,12 @@
 
 #include "jfile.hpp"
 #include "jdebug.hpp"
+#include "jmd5.hpp"
 #include "jcomp.ipp"
 
+#include <algorithm>
+#include <vector>
+
 #define CC_EXTRA_OPTIONS        ""
 #ifdef GENERATE_LISTING
 #undef CC_EXTRA_OPTIONS
@@ -50,6 +54,9 @@
 
 //---------------------------------------------------------------------------
 
+#define OBJECT_CACHE_PRUNE_INTERVAL     60000       // ms between scans of the object cache directory
+#define OBJECT_CACHE_STALE_TEMP_MINUTES 60
+
 #define BASE_ADDRESS "0x00480000"
 //#define BASE_ADDRESS        "0x10000000"
 
@@ -224,6 +231,8 @@ public:
 
     StringBuffer        cmdline;
     StringBuffer        logfile;
+    StringBuffer        objectName;     // only set if the object should be added to the object cache
+    StringBuffer        cacheName;
     Semaphore          &finishedCompiling;
     StringBuffer       &batchOutText;
     bool                describeOnly;
@@ -352,6 +361,7 @@ CppCompiler::CppCompiler(const char * _coreName, const char * _sourceDir, const
     setDirectoryPrefix(sourceDir, _sourceDir);
     setDirectoryPrefix(targetDir, _targetDir);
     maxCompileThreads = 1;
+    objectCacheHits = 0;
     onlyCompile = false;
     verbose = _verbose;
     saveTemps = false;
@@ -492,6 +502,7 @@ bool CppCompiler::compile()
     Semaphore finishedCompiling;
     int numSubmitted = 0;
     numFailed.store(0);
+    objectCacheHits = 0;
 
     if (reportOnly())
         batchOutText.append("#compile").newline();
@@ -595,15 +606,41 @@ bool CppCompiler::compileFile(IThreadPool * pool, const char * filename, const c
     }
     cmdline.append(filename);
     cmdline.append("\" ");
-    expandCompileOptions(cmdline, isC);
 
+    StringBuffer options;
+    expandCompileOptions(options, isC);
     if (useDebugLibrary)
-        cmdline.append(" ").append(LIBFLAG_DEBUG[targetCompiler]);
+        options.append(" ").append(LIBFLAG_DEBUG[targetCompiler]);
     else
-        cmdline.append(" ").append(LIBFLAG_RELEASE[targetCompiler]);
+        options.append(" ").append(LIBFLAG_RELEASE[targetCompiler]);
+    _addInclude(options, stdIncludes);
+    cmdline.append(options);
+
+    StringBuffer cacheName;
+    if (objectCacheDir && !precompileHeader && (targetCompiler != Vs6CppCompiler))
+    {
+        StringBuffer keyOptions;
+        keyOptions.append(isC ? CC_NAME_C[targetCompiler] : CC_NAME_CPP[targetCompiler]).append(options);
+        if (flags)
+            keyOptions.append(" ").append(flags);
+        if (!getCachedObjectName(cacheName, filename, keyOptions))
+            cacheName.clear();
+        else if (!reportOnly())
+        {
+            //When only generating a batch file the check is deferred until the batch is executed
+            StringBuffer objectName;
+            getObjectName(objectName, filename);
+            if (copyFromObjectCache(cacheName, objectName))
+            {
+                objectCacheHits++;
+                if (verbose)
+                    DBGLOG("Reusing cached object %s for %s", cacheName.str(), filename);
+                finishedCompiling.signal();
+                return true;
+            }
+        }
+    }
 
-    _addInclude(cmdline, stdIncludes);
-    
     if (targetCompiler == Vs6CppCompiler)
     {
         if (targetDir.get())
@@ -635,11 +672,216 @@ bool CppCompiler::compileFile(IThreadPool * pool, const char * filename, const c
     if (verbose)
         DBGLOG("%s", expanded.str());
     parm.setown(new CCompilerThreadParam(expanded, finishedCompiling, logFile, batchOutText, reportOnly()));
+    if (cacheName.length())
+    {
+        getObjectName(parm->objectName, filename);
+        parm->cacheName.swapWith(cacheName);
+    }
     pool->start(parm.get());
 
     return true;
 }
 
+//The key for the object cache is the md5 of the compiler options and the source, with any #include of a file that
+//can be resolved relative to the source directory replaced by the content of that file.  The generated sources include
+//a header whose name is derived from the workunit, so hashing the name would prevent any reuse between workunits.
+bool CppCompiler::getCachedObjectName(StringBuffer & out, const char * filename, const char * options)
+{
+    StringBuffer sourcePath;
+    if (sourceDir.length())
+        addPathSepChar(sourcePath.append(sourceDir));
+    sourcePath.append(filename);
+
+    StringBuffer source;
+    try
+    {
+        source.loadFile(sourcePath);
+    }
+    catch (IException * e)
+    {
+        e->Release();
+        return false;
+    }
+
+    MemoryBuffer key;
+    key.append(hpccBuildInfo.buildTag).append(options);
+    const char * includePrefix = "#include \"";
+    size_t includePrefixLen = strlen(includePrefix);
+    const char * cur = source.str();
+    while (*cur)
+    {
+        const char * eol = strchr(cur, '\n');
+        const char * next = eol ? eol + 1 : cur + strlen(cur);
+        bool expanded = false;
+        if (strncmp(cur, includePrefix, includePrefixLen) == 0)
+        {
+            const char * start = cur + includePrefixLen;
+            const char * end = strchr(start, '"');
+            if (end && (end < next))
+            {
+                StringBuffer includePath;
+                StringBuffer includeName(end - start, start);
+                if (!isAbsolutePath(includeName) && sourceDir.length())
+                    addPathSepChar(includePath.append(sourceDir));
+                includePath.append(includeName);
+                if (checkFileExists(includePath))
+                {
+                    StringBuffer header;
+                    header.loadFile(includePath);
+                    key.append(header.length(), header.str());
+                    expanded = true;
+                }
+            }
+        }
+        if (!expanded)
+            key.append((size32_t)(next - cur), cur);
+        cur = next;
+    }
+
+    StringBuffer digest;
+    md5_data(key, digest);
+    out.append(objectCacheDir).append(digest).append('.').append(OBJECT_FILE_EXT[targetCompiler]);
+    return true;
+}
+
+bool copyFromObjectCache(const char * cacheName, const char * objectName)
+{
+    if (!checkFileExists(cacheName))
+        return false;
+    try
+    {
+        copyFile(objectName, cacheName);
+        //Refresh the modified time so that objects which are still being reused are the last to be pruned
+        CDateTime now;
+        now.setNow();
+        Owned<IFile> cached = createIFile(cacheName);
+        cached->setTime(nullptr, &now, nullptr);
+        return true;
+    }
+    catch (IException * e)
+    {
+        EXCLOG(e, "copyFromObjectCache");
+        e->Release();
+        return false;
+    }
+}
+
+//Remove the least recently used objects until the cache is comfortably below its limit.  The directory may be
+//shared by several processes, so the scan is only repeated after an interval rather than on every write.
+static void pruneObjectCache(const char * cacheName, unsigned maxSizeMB)
+{
+    static CriticalSection pruneCrit;
+    static unsigned lastPruneTick = 0;
+    static bool pruned = false;
+
+    CriticalBlock block(pruneCrit);
+    if (pruned && (msTick() - lastPruneTick < OBJECT_CACHE_PRUNE_INTERVAL))
+        return;
+    pruned = true;
+    lastPruneTick = msTick();
+
+    struct CacheEntry
+    {
+        StringAttr name;
+        CDateTime modified;
+        offset_t size;
+    };
+
+    StringBuffer dir;
+    splitDirTail(cacheName, dir);
+    std::vector<CacheEntry> entries;
+    offset_t totalSize = 0;
+    CDateTime staleTemp;
+    staleTemp.setNow();
+    staleTemp.adjustTime(-OBJECT_CACHE_STALE_TEMP_MINUTES);
+    Owned<IDirectoryIterator> iter = createDirectoryIterator(dir, "*");
+    ForEach(*iter)
+    {
+        if (iter->isDir())
+            continue;
+        CacheEntry entry;
+        StringBuffer name;
+        iter->getName(name);
+        iter->getModifiedTime(entry.modified);
+        //Temporaries that are being written by another compile are left alone, but ones left by a crash are removed
+        if (endsWith(name, ".tmp") && (entry.modified.compare(staleTemp) > 0))
+            continue;
+        entry.name.set(iter->query().queryFilename());
+        entry.size = iter->getFileSize();
+        totalSize += entry.size;
+        entries.push_back(entry);
+    }
+
+    offset_t maxSize = (offset_t)maxSizeMB * 0x100000;
+    if (totalSize <= maxSize)
+        return;
+
+    std::sort(entries.begin(), entries.end(), [](const CacheEntry & l, const CacheEntry & r) { return l.modified.compare(r.modified) < 0; });
+    offset_t targetSize = maxSize / 4 * 3;
+    unsigned numRemoved = 0;
+    for (const CacheEntry & entry : entries)
+    {
+        if (totalSize <= targetSize)
+            break;
+        try
+        {
+            Owned<IFile> file = createIFile(entry.name);
+            if (file->remove())
+                numRemoved++;
+        }
+        catch (IException * e)
+        {
+            EXCLOG(e, "pruneObjectCache");
+            e->Release();
+        }
+        totalSize -= entry.size;
+    }
+    DBGLOG("Removed %u objects from object cache %s", numRemoved, dir.str());
+}
+
+void addToObjectCache(const char * cacheName, const char * objectName, unsigned maxSizeMB)
+{
+    //Copy to a unique temporary and rename so that concurrent compiles (possibly in other processes) sharing the
+    //cache directory never see a partially written object.
+    static std::atomic<unsigned> nextTempId{0};
+    StringBuffer tempName(cacheName);
+    tempName.append('.').append((unsigned)GetCurrentProcessId()).append('_').append(++nextTempId).append(".tmp");
+    try
+    {
+        copyFile(tempName, objectName);
+        renameFile(cacheName, tempName, true);
+    }
+    catch (IException * e)
+    {
+        EXCLOG(e, "addToObjectCache");
+        e->Release();
+        Owned<IFile> temp = createIFile(tempName);
+        temp->remove();
+    }
+    if (maxSizeMB)
+        pruneObjectCache(cacheName, maxSizeMB);
+}
+
+void CppCompiler::setObjectCacheDir(const char * dir, unsigned maxSizeMB)
+{
+    objectCacheMaxSizeMB = maxSizeMB;
+    if (isEmptyString(dir))
+    {
+        objectCacheDir.clear();
+        return;
+    }
+
+    StringBuffer path(dir);
+    addPathSepChar(path);
+    if (!recursiveCreateDirectory(path))
+    {
+        IWARNLOG("Could not create object cache directory %s - object cache disabled", path.str());
+        objectCacheDir.clear();
+        return;
+    }
+    objectCacheDir.set(path);
+}
+
 void CppCompiler::extractErrors(IArrayOf<IError> & errors)
 {
     ForEachItemIn(i, exceptions)
@@ -998,6 +1240,9 @@ public:
         {
             if (params->describeOnly)
             {
+                //Cached compiles are written as "cached <cache-file>\t<object-file>\t<command>" for the batch executor
+                if (params->cacheName.length())
+                    params->batchOutText.append("cached ").append(params->cacheName).append('\t').append(params->objectName).append('\t');
                 params->batchOutText.append(params->cmdline).newline();
                 success = true;
             }
@@ -1018,6 +1263,8 @@ public:
 
         if (!success || aborted || runcode != 0)
             compiler->numFailed++;
+        else if (params->cacheName.length() && !params->describeOnly)
+            addToObjectCache(params->cacheName, params->objectName, compiler->objectCacheMaxSizeMB);
         params->finishedCompiling.signal();
         if (error)
             throw error.getClear();
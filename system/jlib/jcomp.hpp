@@ -45,6 +45,10 @@ extern jlib_decl void setCompilerPath(const char * path, const char *ipath, cons
 extern jlib_decl bool fileIsOlder(const char *dest, const char *src);
 extern jlib_decl void extractErrorsFromCppLog(IArrayOf<IError> & errors, const char * cur, bool linkFailed);
 
+#define DEFAULT_OBJECT_CACHE_MAX_MB 2048        // The least recently used objects are pruned beyond this size, 0 = unlimited
+extern jlib_decl bool copyFromObjectCache(const char * cacheName, const char * objectName);
+extern jlib_decl void addToObjectCache(const char * cacheName, const char * objectName, unsigned maxSizeMB = DEFAULT_OBJECT_CACHE_MAX_MB);
+
 interface ICppCompiler : public IInterface
 {
 public:
@@ -74,6 +78,8 @@ public:
     virtual void removeTempDir(const char *fname) = 0;
     virtual bool reportOnly() const = 0;
     virtual void finish() = 0;
+    virtual void setObjectCacheDir(const char * dir, unsigned maxSizeMB = DEFAULT_OBJECT_CACHE_MAX_MB) = 0;    // Reuse object files for sources whose content and options are unchanged
+    virtual unsigned queryObjectCacheHits() const = 0;
 
 };
 
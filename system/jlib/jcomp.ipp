@@ -56,6 +56,8 @@ public:
     virtual void removeTemporary(const char *fname);
     virtual bool reportOnly() const;
     virtual void finish();
+    virtual void setObjectCacheDir(const char * dir, unsigned maxSizeMB);
+    virtual unsigned queryObjectCacheHits() const { return objectCacheHits; }
 
 protected:
     void expandCompileOptions(StringBuffer & target, bool isC);
@@ -63,11 +65,13 @@ protected:
     StringBuffer & getObjectName(StringBuffer & out, const char * filename);
     void removeTemporaries();
     bool compileFile(IThreadPool * pool, const char * filename, const char *flags, Semaphore & finishedCompiling);
+    bool getCachedObjectName(StringBuffer & out, const char * filename, const char * options);
     bool doLink();
     void writeLogFile(const char* filepath, StringBuffer& log) ;
 
 public:
     std::atomic_uint numFailed;
+    unsigned        objectCacheMaxSizeMB = DEFAULT_OBJECT_CACHE_MAX_MB;
 
 protected:
     StringBuffer    compilerOptions;
@@ -82,8 +86,10 @@ protected:
     StringArray     logFiles;
     StringAttr      ccLogPath;
     StringAttr      coreName;
+    StringAttr      objectCacheDir;
     unsigned        targetCompiler;
     unsigned        maxCompileThreads;
+    unsigned        objectCacheHits;
     bool            onlyCompile;
     bool            createDLL;
     bool            targetDebug;
@@ -35,6 +35,9 @@
 #include "yaml.h"
 
 #include <initializer_list>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #define MAKE_LSTRING(name,src,length) \
     const char *name = (const char *) alloca((length)+1); \
@@ -42,6 +45,7 @@
     *(char *) (name+(length)) = '\0';
 
 #include "jfile.hpp"
+#include "jthread.hpp"
 #include "jlog.hpp"
 #include "jptree.ipp"
 
@@ -3833,6 +3837,14 @@ void CAtomPTree::setName(const char *_name)
     }
 }
 
+void CAtomPTree::createChildMap()
+{
+    if (isnocase())
+        children = new CCompactChildMap<ChildMapNC>();
+    else
+        children = new CCompactChildMap<ChildMap>();
+}
+
 const char *CAtomPTree::queryName() const
 {
     return name.get();
@@ -4604,6 +4616,98 @@ IPTreeReadException *createPTreeReadException(int code, const char *msg, const c
     return new CPTreeReadException(code, msg, context, line, offset);
 }
 
+/*
+ * Bulk scanning for the readers.
+ * Rather than consuming runs of ordinary characters one readNext() at a time, the readers scan the buffered input
+ * for the next character that needs attention (16 bytes at a time where SSE2 is available), and append or skip the
+ * whole run at once. Every stop set also stops at '\0', so the unbounded scan used by string readers is safe.
+ */
+enum ReaderScanStops { rss_whiteSpace, rss_xmlText, rss_xmlAttrDQ, rss_xmlAttrSQ, rss_jsonString };
+
+template <char C>
+struct CScanCharStops // stop at C or '\0'
+{
+    static inline bool isStop(byte c) { return (C == (char)c) || ('\0' == c); }
+#ifdef __SSE2__
+    static inline __m128i match(__m128i v) { return _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(C)), _mm_cmpeq_epi8(v, _mm_setzero_si128())); }
+#endif
+};
+
+struct CScanNonSpaceStops // stop at anything isspace() rejects
+{
+    static inline bool isStop(byte c) { return (' ' != c) && ((c < '\t') || (c > '\r')); }
+#ifdef __SSE2__
+    static inline __m128i match(__m128i v)
+    {
+        __m128i spaces = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                                      _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('\t'-1)), _mm_cmplt_epi8(v, _mm_set1_epi8('\r'+1))));
+        return _mm_xor_si128(spaces, _mm_set1_epi8(-1));
+    }
+#endif
+};
+
+struct CScanJSONStringStops // stop at a quote, an escape, control characters and non-ascii (which are validated individually)
+{
+    static inline bool isStop(byte c) { return ('"' == c) || ('\\' == c) || (c < 32) || (c >= 0x80); }
+#ifdef __SSE2__
+    static inline __m128i match(__m128i v)
+    {
+        // NB: signed compare, so bytes >= 0x80 are also < 32
+        return _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))),
+                            _mm_cmplt_epi8(v, _mm_set1_epi8(32)));
+    }
+#endif
+};
+
+// Returns the length of the run at p that contains no stop character, and counts the newlines within it
+template <class STOPS>
+static inline size32_t scanRun(const byte *p, size32_t len, unsigned &newlines)
+{
+    size32_t i = 0;
+#ifdef __SSE2__
+    const __m128i nl = _mm_set1_epi8('\n');
+    while (len - i >= 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(p + i));
+        unsigned stopMask = _mm_movemask_epi8(STOPS::match(v));
+        unsigned nlMask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, nl));
+        if (stopMask)
+        {
+            unsigned pos = __builtin_ctz(stopMask);
+            newlines += __builtin_popcount(nlMask & ((1U << pos) - 1));
+            return i + pos;
+        }
+        newlines += __builtin_popcount(nlMask);
+        i += 16;
+    }
+#endif
+    for (; i < len; i++)
+    {
+        byte c = p[i];
+        if (STOPS::isStop(c))
+            break;
+        if ('\n' == c)
+            newlines++;
+    }
+    return i;
+}
+
+// As scanRun, for null terminated input of unknown length, where reading ahead in blocks could pass the terminator
+template <class STOPS>
+static inline size32_t scanRunNullTerm(const byte *p, unsigned &newlines)
+{
+    const byte *start = p;
+    for (;; p++)
+    {
+        byte c = *p;
+        if (STOPS::isStop(c))
+            break;
+        if ('\n' == c)
+            newlines++;
+    }
+    return (size32_t)(p - start);
+}
+
 template <typename T>
 class CommonReaderBase : public CInterface
 {
@@ -4815,7 +4919,68 @@ protected:
     }
     inline void skipWS()
     {
-        while (isspace(nextChar)) readNext();
+        if (isspace(nextChar))
+            skipRun<CScanNonSpaceStops>();
+    }
+    // Equivalent to: while (!isStop(nextChar)) { out.append(nextChar); readNext(); }
+    void readRun(StringBuffer &out, ReaderScanStops stops)
+    {
+        switch (stops)
+        {
+        case rss_xmlText:
+            doReadRun<CScanCharStops<'<'>>(out);
+            break;
+        case rss_xmlAttrDQ:
+            doReadRun<CScanCharStops<'"'>>(out);
+            break;
+        case rss_xmlAttrSQ:
+            doReadRun<CScanCharStops<'\''>>(out);
+            break;
+        case rss_jsonString:
+            doReadRun<CScanJSONStringStops>(out);
+            break;
+        default:
+            throwUnexpected();
+        }
+    }
+private:
+    template <class STOPS>
+    inline size32_t consumeRun()
+    {
+        // consumes the run that follows nextChar, leaving the stop character (or the end of the buffer) next
+        unsigned newlines = 0;
+        size32_t n = nullTerm ? scanRunNullTerm<STOPS>(bufPtr, newlines) : scanRun<STOPS>(bufPtr, bufRemaining, newlines);
+        if (n)
+        {
+            bufPtr += n;
+            if (!nullTerm)
+                bufRemaining -= n;
+            curOffset += n;
+            line += newlines;
+        }
+        return n;
+    }
+    template <class STOPS>
+    void doReadRun(StringBuffer &out)
+    {
+        while (!STOPS::isStop((byte)nextChar))
+        {
+            out.append(nextChar);
+            const byte *start = bufPtr;
+            size32_t n = consumeRun<STOPS>();
+            if (n)
+                out.append(n, (const char *)start);
+            readNext();
+        }
+    }
+    template <class STOPS>
+    void skipRun()
+    {
+        while (!STOPS::isStop((byte)nextChar))
+        {
+            consumeRun<STOPS>();
+            readNext();
+        }
     }
 };
 
@@ -4890,6 +5055,7 @@ public:
     using PARENT::match;
     using PARENT::error;
     using PARENT::skipWS;
+    using PARENT::readRun;
     using PARENT::rewind;
     using PARENT::readerOptions;
 
@@ -5256,6 +5422,7 @@ public:
     using PARENT::match;
     using PARENT::error;
     using PARENT::skipWS;
+    using PARENT::readRun;
     using PARENT::checkBOM;
     using PARENT::checkReadNext;
     using PARENT::checkSkipWS;
@@ -5404,20 +5571,19 @@ restart:
             if (nextChar == '"')
             {
                 readNext();
-                while (nextChar != '"')
-                {
-                    if (!nextChar)
-                        eos();
-                    attrval.append(nextChar);
-                    readNext();
-                }
+                readRun(attrval, rss_xmlAttrDQ);
+                if (!nextChar)
+                    eos();
             }
             else if (nextChar == '\'')
             {
                 readNext();
-                while (nextChar != '\'')
+                for (;;)
                 {
-                    attrval.append(nextChar);
+                    readRun(attrval, rss_xmlAttrSQ);
+                    if (nextChar == '\'')
+                        break;
+                    attrval.append(nextChar); // embedded '\0'
                     readNext();
                 }
             }
@@ -5451,7 +5617,7 @@ restart:
                         if ('\0' == nextChar)
                             eos();
                         StringBuffer mark;
-                        while (nextChar && nextChar !='<') { mark.append(nextChar); readNext(); }
+                        readRun(mark, rss_xmlText);
                         size32_t l = mark.length();
                         size32_t r = l+1;
                         if (l)
@@ -5525,6 +5691,7 @@ class CPullXMLReader : public CXMLReaderBase<X>, implements IPullPTreeReader
     using PARENT::match;
     using PARENT::error;
     using PARENT::skipWS;
+    using PARENT::readRun;
     using PARENT::checkBOM;
     using PARENT::checkReadNext;
     using PARENT::checkSkipWS;
@@ -5737,20 +5904,19 @@ public:
                     if (nextChar == '"')
                     {
                         readNext();
-                        while (nextChar != '"')
-                        {
-                            if (!nextChar)
-                                eos();
-                            attrval.append(nextChar);
-                            readNext();
-                        }
+                        readRun(attrval, rss_xmlAttrDQ);
+                        if (!nextChar)
+                            eos();
                     }
                     else if (nextChar == '\'')
                     {
                         readNext();
-                        while (nextChar != '\'')
+                        for (;;)
                         {
-                            attrval.append(nextChar);
+                            readRun(attrval, rss_xmlAttrSQ);
+                            if (nextChar == '\'')
+                                break;
+                            attrval.append(nextChar); // embedded '\0'
                             readNext();
                         }
                     }
@@ -5799,7 +5965,7 @@ public:
                             eos();
                         mark.clear();
                         state = tagMarker;
-                        while (nextChar && nextChar !='<') { mark.append(nextChar); readNext(); }
+                        readRun(mark, rss_xmlText);
                         if (!nextChar)
                             break;
                         size32_t l = mark.length();
@@ -6083,6 +6249,324 @@ IPropertyTree *createPTreeFromXMLString(unsigned len, const char *xml, byte flag
     return LINK(iMaker->queryRoot());
 }
 
+//////////////////////////
+// Parallel xml parsing.
+//
+// The document is first scanned (without building anything) to find the extent of each element directly below
+// the root, and of each element directly below those.  The root and the top level elements are then created
+// from their start tags alone, and the elements below them are parsed independently on a pool of threads and
+// attached in document order.  A top level element that contains text, or few children, is parsed as a whole.
+
+class CXMLBoundaryScanner
+{
+public:
+    CXMLBoundaryScanner(const char *_start, const char *_end) : cur(_start), end(_end)
+    {
+    }
+
+    // Skip the prolog up to the root element - returns false if there is anything that might affect the parse
+    bool skipProlog()
+    {
+        if ((end-cur >= 3) && (memcmp(cur, "\xEF\xBB\xBF", 3) == 0))
+            cur += 3;
+        for (;;)
+        {
+            while ((cur < end) && isspace((byte)*cur))
+                cur++;
+            if ((cur == end) || (*cur != '<'))
+                return false;
+            if (startsWith("<?"))
+            {
+                if (!skipPast("?>"))
+                    return false;
+            }
+            else if (startsWith("<!--"))
+            {
+                if (!skipPast("-->"))
+                    return false;
+            }
+            else if (cur[1] == '!' || cur[1] == '/')
+                return false;   // e.g. a DOCTYPE, which may define entities
+            else
+                return true;
+        }
+    }
+
+    // Scan a start tag, leaving cur after the closing '>'
+    bool scanStartTag(bool &selfClosing)
+    {
+        char quote = 0;
+        for (const char *p = cur+1; p < end; p++)
+        {
+            char c = *p;
+            if (quote)
+            {
+                if (c == quote)
+                    quote = 0;
+            }
+            else if ((c == '"') || (c == '\''))
+                quote = c;
+            else if (c == '>')
+            {
+                selfClosing = (p[-1] == '/');
+                cur = p+1;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Scan a complete element, starting at its start tag
+    bool scanElement()
+    {
+        bool selfClosing;
+        if (!scanStartTag(selfClosing))
+            return false;
+        if (selfClosing)
+            return true;
+        unsigned depth = 1;
+        for (;;)
+        {
+            cur = (const char *)memchr(cur, '<', end-cur);
+            if (!cur)
+                return false;
+            if (!skipMarkup())
+            {
+                if (cur+1 >= end)
+                    return false;
+                if (cur[1] == '/')
+                {
+                    if (!skipPast(">"))
+                        return false;
+                    if (--depth == 0)
+                        return true;
+                }
+                else if (cur[1] == '!')
+                    return false;
+                else
+                {
+                    if (!scanStartTag(selfClosing))
+                        return false;
+                    if (!selfClosing)
+                        depth++;
+                }
+            }
+            else if (!cur)
+                return false;
+        }
+    }
+
+    // Scan the content of an element up to (and including) its end tag, recording the extent of each child element.
+    // Returns false if the content cannot be split - because of text, or anything unexpected.
+    bool scanChildren(std::vector<std::pair<const char *, size32_t>> &children)
+    {
+        for (;;)
+        {
+            while ((cur < end) && isspace((byte)*cur))
+                cur++;
+            if ((cur == end) || (*cur != '<'))
+                return false;  // text content (or a truncated document)
+            if (startsWith("<!--") || startsWith("<?"))
+            {
+                if (!skipMarkup() || !cur)
+                    return false;
+            }
+            else if (startsWith("</"))
+                return skipPast(">");
+            else if (startsWith("<!"))
+                return false;  // CDATA is text
+            else
+            {
+                const char *start = cur;
+                if (!scanElement())
+                    return false;
+                children.emplace_back(start, (size32_t)(cur-start));
+            }
+        }
+    }
+
+    inline const char *queryCur() const { return cur; }
+    inline void setCur(const char *_cur) { cur = _cur; }
+
+private:
+    inline bool startsWith(const char *text) const
+    {
+        size_t len = strlen(text);
+        return ((size_t)(end-cur) >= len) && (memcmp(cur, text, len) == 0);
+    }
+    bool skipPast(const char *text)
+    {
+        size_t len = strlen(text);
+        const char *match = std::search(cur, end, text, text+len);
+        if (match == end)
+            return false;
+        cur = match+len;
+        return true;
+    }
+    // Skip a comment, processing instruction or CDATA section.  Returns false if cur is not at one of them,
+    // and sets cur to NULL if it is not terminated.
+    bool skipMarkup()
+    {
+        const char *terminator;
+        if (startsWith("<!--"))
+            terminator = "-->";
+        else if (startsWith("<?"))
+            terminator = "?>";
+        else if (startsWith("<![CDATA["))
+            terminator = "]]>";
+        else
+            return false;
+        if (!skipPast(terminator))
+            cur = nullptr;
+        return true;
+    }
+
+    const char *cur;
+    const char *end;
+};
+
+static constexpr size32_t minParallelXMLTask = 0x10000;
+
+IPropertyTree *createPTreeFromXMLBufferParallel(size32_t len, const char *xml, byte flags, PTreeReaderOptions readFlags, std::function<IPTreeMaker *()> createMaker, const bool *abort)
+{
+    // Whitespace between the elements is only insignificant if it is being ignored
+    if ((0 != ((unsigned)readFlags & (unsigned)ptr_noRoot)) || (0 == ((unsigned)readFlags & (unsigned)ptr_ignoreWhiteSpace)))
+        return nullptr;
+
+    auto newMaker = [&]() -> IPTreeMaker *
+    {
+        return createMaker ? createMaker() : createDefaultPTreeMaker(flags, readFlags);
+    };
+    // Parse a single element, or a start tag with the closing '>' replaced by "/>"
+    auto parseElement = [&](IPTreeMaker &maker, const char *start, size32_t size, bool startTagOnly) -> IPropertyTree *
+    {
+        maker.reset();
+        if (startTagOnly)
+        {
+            StringBuffer shell;
+            shell.append(size-1, start).append("/>");
+            Owned<IPTreeReader> reader = createXMLBufferReader(shell.str(), shell.length(), maker, readFlags);
+            reader->load();
+        }
+        else
+        {
+            Owned<IPTreeReader> reader = createXMLBufferReader(start, size, maker, readFlags);
+            reader->load();
+        }
+        return LINK(maker.queryRoot());
+    };
+
+    // Phase 1: find the boundaries of the elements
+    struct TopLevelElement
+    {
+        const char *start = nullptr;
+        size32_t startTagLen = 0;
+        size32_t size = 0;
+        std::vector<std::pair<const char *, size32_t>> children;
+        bool split = false;
+    };
+    CXMLBoundaryScanner scanner(xml, xml+len);
+    if (!scanner.skipProlog())
+        return nullptr;
+    const char *rootStart = scanner.queryCur();
+    bool selfClosing;
+    if (!scanner.scanStartTag(selfClosing) || selfClosing)
+        return nullptr;
+    size32_t rootStartTagLen = (size32_t)(scanner.queryCur() - rootStart);
+    std::vector<std::pair<const char *, size32_t>> topLevel;
+    if (!scanner.scanChildren(topLevel) || topLevel.empty())
+        return nullptr;
+
+    unsigned numThreads = getAffinityCpus();
+    size32_t taskSize = std::max((size32_t)(len / (numThreads * 16)), minParallelXMLTask);
+    std::vector<TopLevelElement> elements(topLevel.size());
+    for (unsigned i=0; i < topLevel.size(); i++)
+    {
+        TopLevelElement &element = elements[i];
+        element.start = topLevel[i].first;
+        element.size = topLevel[i].second;
+        if (element.size < taskSize)
+            continue;
+        CXMLBoundaryScanner elementScanner(element.start, element.start+element.size);
+        if (!elementScanner.scanStartTag(selfClosing) || selfClosing)
+            continue;
+        element.startTagLen = (size32_t)(elementScanner.queryCur() - element.start);
+        if (elementScanner.scanChildren(element.children) && (element.children.size() > 1))
+            element.split = true;
+        else
+            element.children.clear();
+    }
+
+    // Phase 2: group the pieces that can be parsed independently into tasks of a reasonable size
+    struct Piece
+    {
+        const char *start;
+        size32_t size;
+        Owned<IPropertyTree> tree;
+    };
+    std::vector<Piece> pieces;
+    std::vector<unsigned> firstPiece(elements.size()+1);
+    for (unsigned i=0; i < elements.size(); i++)
+    {
+        firstPiece[i] = (unsigned)pieces.size();
+        TopLevelElement &element = elements[i];
+        if (element.split)
+        {
+            for (auto &child : element.children)
+                pieces.push_back({ child.first, child.second, nullptr });
+        }
+        else
+            pieces.push_back({ element.start, element.size, nullptr });
+    }
+    firstPiece[elements.size()] = (unsigned)pieces.size();
+
+    std::vector<unsigned> taskStarts;
+    size32_t curTaskSize = 0;
+    for (unsigned i=0; i < pieces.size(); i++)
+    {
+        if (taskStarts.empty() || (curTaskSize >= taskSize))
+        {
+            taskStarts.push_back(i);
+            curTaskSize = 0;
+        }
+        curTaskSize += pieces[i].size;
+    }
+    taskStarts.push_back((unsigned)pieces.size());
+
+    asyncFor((unsigned)taskStarts.size()-1, numThreads, true, [&](unsigned task)
+    {
+        if (abort && *abort)
+            throw MakeStringException(PTreeRead_syntax, "Parallel xml parse aborted");
+        Owned<IPTreeMaker> maker = newMaker();
+        for (unsigned i=taskStarts[task]; i < taskStarts[task+1]; i++)
+            pieces[i].tree.setown(parseElement(*maker, pieces[i].start, pieces[i].size, false));
+    });
+    if (abort && *abort)
+        throw MakeStringException(PTreeRead_syntax, "Parallel xml parse aborted");
+
+    // Phase 3: create the root and the split top level elements, and attach everything in document order
+    Owned<IPTreeMaker> maker = newMaker();
+    Owned<IPropertyTree> root = parseElement(*maker, rootStart, rootStartTagLen, true);
+    for (unsigned i=0; i < elements.size(); i++)
+    {
+        TopLevelElement &element = elements[i];
+        IPropertyTree *parent = root;
+        if (element.split)
+        {
+            Owned<IPropertyTree> top = parseElement(*maker, element.start, element.startTagLen, true);
+            const char *tag = top->queryName();
+            parent = root->addPropTree(tag, top.getClear());
+        }
+        for (unsigned p=firstPiece[i]; p < firstPiece[i+1]; p++)
+        {
+            IPropertyTree *tree = pieces[p].tree.getClear();
+            const char *tag = tree->queryName();
+            parent->addPropTree(tag, tree);
+        }
+    }
+    return root.getClear();
+}
+
 
 void addPTreeItem(IPropertyTree *ptree, const char * name, const char * value)
 {
@@ -7234,6 +7718,7 @@ public:
     using PARENT::match;
     using PARENT::error;
     using PARENT::skipWS;
+    using PARENT::readRun;
     using PARENT::rewind;
     using PARENT::ignoreWhiteSpace;
 
@@ -7272,8 +7757,11 @@ protected:
         readNext();
         StringBuffer s;
         bool decode=false;
-        while ('\"'!=nextChar)
+        for (;;)
         {
+            readRun(s, rss_jsonString); // plain ascii, escapes and other characters are validated below
+            if ('\"'==nextChar)
+                break;
             if (nextChar=='\\')
                 decode=true;
             appendChar(s, nextChar);
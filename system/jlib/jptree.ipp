@@ -73,6 +73,9 @@ public:
     ChildMap() : SuperHashTableOf<IPropertyTree, constcharptr>(4)
     { 
     }
+    ChildMap(unsigned initSize) : SuperHashTableOf<IPropertyTree, constcharptr>(initSize)
+    {
+    }
     ~ChildMap() 
     { 
         _releaseAll();
@@ -105,6 +108,9 @@ public:
 class jlib_decl ChildMapNC : public ChildMap
 {
 public:
+    ChildMapNC() { }
+    ChildMapNC(unsigned initSize) : ChildMap(initSize) { }
+
 // SuperHashTable definitions
     virtual unsigned getHashFromFindParam(const void *fp) const override
     {
@@ -117,6 +123,128 @@ public:
 };
 
 
+/* Child map for low memory trees.
+ * Most nodes in large stores have only a handful of distinct child names, so rather than a mostly empty hash table,
+ * up to COMPACT_CHILDMAP_MAX children are kept densely packed at the front of the table and found by a linear scan.
+ * Once outgrown, the table is rehashed in place and the map behaves exactly like BASECHILDMAP.
+ * The dense table is still a valid SuperHashTable for iteration and release (elements all hash to 0 while dense).
+ */
+#define COMPACT_CHILDMAP_MAX 8
+
+template <class BASECHILDMAP>
+class CCompactChildMap : public BASECHILDMAP
+{
+    typedef BASECHILDMAP PARENT;
+    bool dense = true;
+
+    unsigned findDense(const char *key) const
+    {
+        for (unsigned i=0; i<this->tablecount; i++)
+        {
+            if (this->matchesFindParam(this->table[i], key, 0))
+                return i;
+        }
+        return NotFound;
+    }
+    unsigned findDenseExact(const IPropertyTree *child) const
+    {
+        for (unsigned i=0; i<this->tablecount; i++)
+        {
+            if (this->table[i] == child)
+                return i;
+        }
+        return NotFound;
+    }
+    void removeDense(unsigned pos)
+    {
+        void *child = this->table[pos];
+        unsigned last = --this->tablecount;
+        this->table[pos] = this->table[last];
+        this->table[last] = nullptr;
+        this->setCache(0);
+        this->onRemove(child);
+    }
+    void addDense(IPropertyTree *tree)
+    {
+        if (this->tablecount == this->tablesize)
+        {
+            if (this->tablesize >= COMPACT_CHILDMAP_MAX)
+            {
+                dense = false;
+                this->ensure(this->tablecount+1); // rehashes existing elements, without onAdd/onRemove
+                PARENT::set(tree->queryName(), tree);
+                return;
+            }
+            unsigned newSize = this->tablesize * 2;
+            this->table = (void **)checked_realloc(this->table, newSize*sizeof(void *), this->tablesize*sizeof(void *), -604);
+            memset(this->table+this->tablesize, 0, (newSize-this->tablesize)*sizeof(void *));
+            this->tablesize = newSize;
+        }
+        this->table[this->tablecount++] = tree;
+        this->onAdd(tree);
+    }
+    bool setDense(IPropertyTree *tree)
+    {
+        unsigned pos = findDense(tree->queryName());
+        if (NotFound == pos)
+            addDense(tree);
+        else
+        {
+            void *old = this->table[pos];
+            this->table[pos] = tree;
+            this->onRemove(old);
+            this->onAdd(tree);
+        }
+        return true;
+    }
+protected:
+    virtual unsigned getHashFromElement(const void *e) const override
+    {
+        return dense ? 0 : PARENT::getHashFromElement(e);
+    }
+public:
+    CCompactChildMap() : PARENT(1) { }
+
+    inline bool isDense() const { return dense; }
+
+    virtual bool set(const char *key, IPropertyTree *tree) override
+    {
+        return dense ? setDense(tree) : PARENT::set(key, tree);
+    }
+    virtual bool replace(const char *key, IPropertyTree *tree) override
+    {
+        return dense ? setDense(tree) : PARENT::replace(key, tree);
+    }
+    virtual IPropertyTree *query(const char *key) override
+    {
+        if (!dense)
+            return PARENT::query(key);
+        unsigned pos = findDense(key);
+        return (NotFound == pos) ? nullptr : (IPropertyTree *)this->table[pos];
+    }
+    virtual bool remove(const char *key) override
+    {
+        if (!dense)
+            return PARENT::remove(key);
+        unsigned pos = findDense(key);
+        if (NotFound == pos)
+            return false;
+        removeDense(pos);
+        return true;
+    }
+    virtual bool removeExact(IPropertyTree *child) override
+    {
+        if (!dense)
+            return PARENT::removeExact(child);
+        unsigned pos = findDenseExact(child);
+        if (NotFound == pos)
+            return false;
+        removeDense(pos);
+        return true;
+    }
+};
+
+
 inline static int validJSONUtf8ChrLen(unsigned char c)
 {
     if (c <= 31)
@@ -813,6 +941,7 @@ public:
     virtual unsigned queryHash() const override;
     virtual void setName(const char *_name) override;
     virtual void setAttribute(const char *attr, const char *val, bool encoded) override;
+    virtual void createChildMap() override;
     virtual bool isEquivalent(IPropertyTree *tree) const override { return (nullptr != QUERYINTERFACE(tree, CAtomPTree)); }
     virtual IPropertyTree *create(const char *name=nullptr, IPTArrayValue *value=nullptr, ChildMap *children=nullptr, bool existing=false) override
     {
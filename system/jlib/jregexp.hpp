@@ -117,6 +117,7 @@ public:
     unsigned getMatch(unsigned maxLength, const char * text, unsigned & matchLen);
     bool queryAddEntry(unsigned len, const char * text, unsigned action);
     void reset()            {   freeLevel(firstLevel); }
+    inline bool isLeadingChar(byte c) const { return (firstLevel[c].value != 0) || (firstLevel[c].table != nullptr); }
 
 protected:
     struct entry { unsigned value; entry * table; };
@@ -53,8 +53,12 @@
 #include <errno.h>
 #include <net/if.h>
 #include <poll.h>
+#include <sys/uio.h>
 #endif
 #include <limits.h>
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
 
 #include "jmutex.hpp"
 #include "jsocket.hpp"
@@ -514,7 +518,7 @@ protected:
 #endif
     
 public:
-    void        open(int listen_queue_size,bool reuseports=false);
+    void        open(int listen_queue_size,bool reuseports=false,bool sharedport=false);
     bool        connect_timeout( unsigned timeout, bool noexception);
     void        connect_wait( unsigned timems);
     void        udpconnect();
@@ -1036,12 +1040,14 @@ int CSocket::post_connect ()
 }
 
 
-void CSocket::open(int listen_queue_size,bool reuseports)
+void CSocket::open(int listen_queue_size,bool reuseports,bool sharedport)
 {
     // If listen_queue_size==0 then bind port to address but
     // do not actually listen() for accepting connections.
     // This is used when a unique IP:port is needed for MP client
     // INode/IGroup internals, but client never actually accepts connections.
+    // If sharedport is set then several listening sockets can bind to the same port (where supported),
+    // and the kernel distributes incoming connections between them.
 
     if (IP6preferred)
         sock = ::socket(AF_INET6, connectionless()?SOCK_DGRAM:SOCK_STREAM, PF_INET6);
@@ -1075,6 +1081,16 @@ void CSocket::open(int listen_queue_size,bool reuseports)
         int on = 1;
         setsockopt( sock, SOL_SOCKET, SO_REUSEADDR, (char *)&on, sizeof(on));
     }
+#ifdef SO_REUSEPORT
+    if (sharedport && listen_queue_size) {
+        int on = 1;
+        if (setsockopt( sock, SOL_SOCKET, SO_REUSEPORT, (char *)&on, sizeof(on)) != 0) {
+            int saverr = SOCKETERRNO();
+            closesock();
+            THROWJSOCKTARGETEXCEPTION(saverr);
+        }
+    }
+#endif
 
     DEFINE_SOCKADDR(u);
     socklen_t  ul;
@@ -2319,44 +2335,58 @@ EintrRetry:
         res = write(b,total);
     }
 #else
-    // send in equal chunks about 64K
-    unsigned n = (total+0xffff)/0x10000;
-    size32_t outbufsize = (total+n-1)/n;
-    MemoryAttr ma;
-    byte *outbuf = (byte *)ma.allocate(outbufsize);
-    i = 0;
-    size32_t os = 0;
-    size32_t left = total;
-    byte *b = NULL;
-    size32_t s=0;
-    for (;;) {
-        while (!s&&(i<num)) {
-            b = (byte *)buf[i];
-            s = size[i];
-            i++;
-        }
-        if ((os==0)&&(s==left)) {
-            write(b,s);     // go for it
-            break;
+    // gather directly from the callers buffers (no intermediate copy), resuming after partial sends
+    struct iovec *iov = (struct iovec *)alloca(sizeof(struct iovec)*num);
+    unsigned niov = 0;
+    for (i=0;i<num;i++) {
+        if (size[i]) {
+            iov[niov].iov_base = (void *)buf[i];
+            iov[niov].iov_len = size[i];
+            niov++;
         }
-        else {
-            size32_t cpy = outbufsize-os;
-            if (cpy>s)
-                cpy = s;
-            memcpy(outbuf+os,b,cpy);
-            os += cpy;
-            left -= cpy;
-            s -= cpy;
-            b += cpy;
-            if (left==0)  {
-                write(outbuf,os);       
-                break;
+    }
+    struct iovec *cur = iov;
+    unsigned retrycount=100;
+    while (niov) {
+        struct msghdr msg;
+        memset(&msg,0,sizeof(msg));
+        msg.msg_iov = cur;
+        msg.msg_iovlen = (niov>IOV_MAX) ? IOV_MAX : niov;
+        ssize_t rc = sendmsg(sock,&msg,SEND_FLAGS);
+        if (rc<0) {
+            int err=SOCKETERRNO();
+            if (BADSOCKERR(err)) {
+                LOGERR2(err,8,"Socket closed during write");
+                rc = 0;
+            }
+            else if ((err==JSE_INTR)&&(retrycount--!=0)) {
+                LOGERR2(err,8,"EINTR retrying");
+                continue;
             }
-            else if (os==outbufsize) {
-                write(outbuf,os);   
-                os = 0;
+            else {
+                LOGERR2(err,8,"write_multiple");
+                if ((err==JSE_CONNRESET)||(err==JSE_INTR)||(err==JSE_CONNABORTED)||(err==EPIPE)||(err==JSE_TIMEDOUT)) {
+                    errclose();
+                    err = JSOCKERR_broken_pipe;
+                }
+                THROWJSOCKTARGETEXCEPTION(err);
             }
         }
+        if (rc==0) {
+            state = ss_shutdown;
+            THROWJSOCKTARGETEXCEPTION(JSOCKERR_graceful_close);
+        }
+        res += (size32_t)rc;
+        size_t done = (size_t)rc;
+        while (niov&&(done>=cur->iov_len)) {
+            done -= cur->iov_len;
+            cur++;
+            niov--;
+        }
+        if (done) {
+            cur->iov_base = (byte *)cur->iov_base+done;
+            cur->iov_len -= done;
+        }
     }
 #endif
 #endif
@@ -2868,6 +2898,18 @@ ISocket* ISocket::create(unsigned short p,int listen_queue_size)
 }
 
 
+ISocket* ISocket::create_shared(unsigned short p,int listen_queue_size)
+{
+    if (p==0)
+        THROWJSOCKEXCEPTION(JSOCKERR_bad_address);
+    SocketEndpoint ep;
+    ep.port = p;
+    Owned<CSocket> sock = new CSocket(ep,sm_tcp_server,NULL);
+    sock->open(listen_queue_size,false,true);
+    return sock.getClear();
+}
+
+
 ISocket* ISocket::create_ip(unsigned short p,const char *host,int listen_queue_size)
 {
     if (p==0)
@@ -260,6 +260,14 @@ public:
     static ISocket*  create( unsigned short port,
                                        int listen_queue_size =  DEFAULT_LISTEN_QUEUE_SIZE);
 
+    //
+    // Create server TCP socket that can share its port with other listening sockets (SO_REUSEPORT).
+    // The kernel balances incoming connections between the sockets.  Where this is not supported
+    // the second socket created for a port will fail with JSOCKERR_port_in_use.
+    //
+    static ISocket*  create_shared( unsigned short port,
+                                       int listen_queue_size =  DEFAULT_LISTEN_QUEUE_SIZE);
+
     //
     // Create server TCP socket listening a specific IP
     //
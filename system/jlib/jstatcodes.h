@@ -302,6 +302,7 @@ enum StatisticKind
     StSizeContinuationData,
     StNumContinuationRequests,
     StNumFailures,
+    StNumObjectsFromCache,
     StMax,
 
     //For any quantity there is potentially the following variants.
@@ -974,6 +974,7 @@ static const constexpr StatisticMeta statsMetaData[StMax] = {
     { SIZESTAT(ContinuationData), "The total size of continuation data sent from agent to the server\nA large number may indicate a poor filter, or merging from many different index locations" },
     { NUMSTAT(ContinuationRequests), "The number of times the agent indicated there was more data to be returned" },
     { NUMSTAT(Failures), "The number of times a query has failed" },
+    { NUMSTAT(ObjectsFromCache), "The number of generated C++ files whose object file was taken from the compiler object cache instead of being recompiled" },
 };
 
 static MapStringTo<StatisticKind, StatisticKind> statisticNameMap(true);
@@ -24,6 +24,7 @@
     look at all timeouts
 */
 
+#include <algorithm>
 #include <future>
 #include <vector>
 
@@ -48,6 +49,13 @@
 
 #include "securesocket.hpp"
 
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #ifdef _MSC_VER
 #pragma warning (disable : 4355)
 #endif
@@ -193,6 +201,15 @@ unsigned PacketHeader::lasttick=0;
 #define MINIMUMPACKETSIZE       sizeof(PacketHeader) 
 #define MAXDATAPERPACKET        50000
 
+// Coalesced sends (TAG_SYS_BATCH) - a batch packet is a PacketHeader followed by complete user packets.
+// NB: all processes on a cluster must understand TAG_SYS_BATCH before coalescing is enabled
+#define MAXBATCHMESSAGES        64
+#define DEFAULT_COALESCE_MAXMSGSIZE 4096
+
+// Shared memory transport (TAG_SYS_SHM*) for channels between processes on the same host
+#define DEFAULT_SHM_RINGSIZE    (2*1024*1024)
+#define DEFAULT_SHM_MINPACKETSIZE 1024
+
 struct MultiPacketHeader
 {
     mptag_t tag;
@@ -214,6 +231,165 @@ struct MultiPacketHeader
     }
 };
 
+// --------------------------------------------------------
+// Shared memory ring used for packets sent to another process on the same host.
+// The sending side of a channel owns the ring. Complete packets (header and body) are copied into it and only
+// a ShmPacketRef is sent on the socket, so ordering with packets that are still written to the socket (e.g. when
+// the ring is full) is preserved. The receiver advances tail as it consumes packets.
+
+#define SHM_RING_MAGIC          0x4d50524e  // "MPRN"
+#define SHM_RING_HEADERSIZE     64          // keep the data area cache line aligned
+
+struct ShmRingHeader
+{
+    unsigned magic;
+    size32_t datasize;
+    std::atomic<unsigned __int64> tail;     // stream position consumed by the receiver
+};
+
+struct ShmPacketRef
+{
+    unsigned __int64 pos;                   // stream position of the packet, packets never wrap
+    size32_t size;                          // total packet size including its PacketHeader
+};
+
+class CMPSharedRing: public CInterface
+{
+    StringAttr name;
+    byte *base;
+    size_t mapsize;
+    ShmRingHeader *header;
+    byte *data;
+    size32_t datasize;
+    unsigned __int64 head = 0;              // only used by the sender
+    bool unlinked;
+
+    CMPSharedRing(const char *_name, void *_base, size_t _mapsize, bool owner)
+        : name(_name), base((byte *)_base), mapsize(_mapsize), unlinked(!owner)
+    {
+        header = (ShmRingHeader *)base;
+        data = base+SHM_RING_HEADERSIZE;
+        datasize = (size32_t)(mapsize-SHM_RING_HEADERSIZE);
+    }
+public:
+    ~CMPSharedRing()
+    {
+#ifndef _WIN32
+        munmap(base, mapsize);
+#endif
+        unlink();
+    }
+    static CMPSharedRing *create(size32_t size)
+    {
+#ifndef _WIN32
+        static std::atomic<unsigned> nextid{0};
+        VStringBuffer name("/hpccmp_%u_%u", (unsigned)getpid(), ++nextid);
+        int fd = shm_open(name, O_RDWR|O_CREAT|O_EXCL, S_IRUSR|S_IWUSR);
+        if (fd < 0)
+        {
+            WARNLOG("MP: failed to create shared memory %s (%d)", name.str(), errno);
+            return nullptr;
+        }
+        size_t mapsize = SHM_RING_HEADERSIZE+size;
+        void *base = MAP_FAILED;
+        if (ftruncate(fd, mapsize) == 0)
+            base = mmap(nullptr, mapsize, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (base == MAP_FAILED)
+        {
+            WARNLOG("MP: failed to map shared memory %s (%d)", name.str(), errno);
+            shm_unlink(name);
+            return nullptr;
+        }
+        ShmRingHeader *header = new (base) ShmRingHeader;
+        header->magic = SHM_RING_MAGIC;
+        header->datasize = size;
+        header->tail.store(0);
+        return new CMPSharedRing(name, base, mapsize, true);
+#else
+        return nullptr;
+#endif
+    }
+    static CMPSharedRing *open(const char *name, size32_t size)
+    {
+#ifndef _WIN32
+        int fd = shm_open(name, O_RDWR, 0);
+        if (fd < 0)
+        {
+            WARNLOG("MP: failed to open shared memory %s (%d)", name, errno);
+            return nullptr;
+        }
+        size_t mapsize = SHM_RING_HEADERSIZE+size;
+        void *base = MAP_FAILED;
+        struct stat st;
+        if ((fstat(fd, &st) == 0) && ((size_t)st.st_size == mapsize))
+            base = mmap(nullptr, mapsize, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (base == MAP_FAILED)
+        {
+            WARNLOG("MP: failed to map shared memory %s", name);
+            return nullptr;
+        }
+        ShmRingHeader *header = (ShmRingHeader *)base;
+        if ((header->magic != SHM_RING_MAGIC) || (header->datasize != size))
+        {
+            WARNLOG("MP: shared memory %s has an unexpected format", name);
+            munmap(base, mapsize);
+            return nullptr;
+        }
+        return new CMPSharedRing(name, base, mapsize, false);
+#else
+        return nullptr;
+#endif
+    }
+    const char *queryName() const { return name; }
+    size32_t querySize() const { return datasize; }
+    void unlink()
+    {
+        // once both ends have it mapped the name is no longer needed
+        if (!unlinked)
+        {
+#ifndef _WIN32
+            shm_unlink(name);
+#endif
+            unlinked = true;
+        }
+    }
+    bool write(unsigned n, const void **bufs, size32_t *sizes, size32_t total, ShmPacketRef &ref)
+    {
+        // sender, returns false if there is not room (caller writes to the socket instead)
+        if (total > datasize)
+            return false;
+        unsigned __int64 pos = head;
+        size32_t offset = (size32_t)(pos % datasize);
+        if (offset+total > datasize)
+            pos += datasize-offset;     // skip the remainder so the packet is contiguous
+        if (pos+total-header->tail.load(std::memory_order_acquire) > datasize)
+            return false;
+        byte *dst = data+(size32_t)(pos % datasize);
+        for (unsigned i=0; i<n; i++)
+        {
+            memcpy(dst, bufs[i], sizes[i]);
+            dst += sizes[i];
+        }
+        head = pos+total;
+        ref.pos = pos;
+        ref.size = total;
+        return true;
+    }
+    const byte *queryPacket(const ShmPacketRef &ref) const
+    {
+        // receiver
+        if ((ref.size > datasize) || ((ref.pos % datasize)+ref.size > datasize))
+            return nullptr;
+        return data+(size32_t)(ref.pos % datasize);
+    }
+    void release(const ShmPacketRef &ref)
+    {
+        header->tail.store(ref.pos+ref.size, std::memory_order_release);
+    }
+};
+
 
 // 
 
@@ -575,6 +751,7 @@ class PingReplyPacketHandler;
 class MultiPacketHandler;
 class BroadcastPacketHandler;
 class ForwardPacketHandler;
+class BatchPacketHandler;
 class UserPacketHandler;
 class CMPNotifyClosedThread;
 
@@ -595,6 +772,12 @@ public:
     bool tryReopenChannel = false;
     bool useTLS = false;
     unsigned mpTraceLevel = 0;
+    bool coalesceSends = false;             // merge small concurrent sends on a channel into TAG_SYS_BATCH packets
+    unsigned coalesceWindowMs = 0;          // additional time to wait for more messages before a batch is written
+    size32_t coalesceMaxMsgSize = DEFAULT_COALESCE_MAXMSGSIZE;
+    bool useSharedMemory = false;           // use a shared memory ring for channels to processes on the same host
+    size32_t shmRingSize = DEFAULT_SHM_RINGSIZE;
+    size32_t shmMinPacketSize = DEFAULT_SHM_MINPACKETSIZE;   // smaller packets are written to the socket
 
 // packet handlers
     PingPacketHandler           *pingpackethandler;         // TAG_SYS_PING
@@ -602,6 +785,7 @@ public:
     ForwardPacketHandler        *forwardpackethandler;      // TAG_SYS_FORWARD
     MultiPacketHandler          *multipackethandler;        // TAG_SYS_MULTI
     BroadcastPacketHandler      *broadcastpackethandler;    // TAG_SYS_BCAST
+    BatchPacketHandler          *batchpackethandler;        // TAG_SYS_BATCH
     UserPacketHandler           *userpackethandler;         // default
 
     IMPLEMENT_IINTERFACE_USING(CMPChannelHT);
@@ -680,6 +864,27 @@ public:
                 tryReopenChannel = tf;
                 break;
             }
+            case mpsopt_coalesce:
+            {
+                bool tf = (nullptr != value) ? strToBool(value) : false;
+                PROGLOG("Setting Coalesce = %s", tf ? "true" : "false");
+                coalesceSends = tf;
+                break;
+            }
+            case mpsopt_coalescewindow:
+            {
+                coalesceWindowMs = (nullptr != value) ? (unsigned)atoi(value) : 0;
+                PROGLOG("Setting CoalesceWindow = %u", coalesceWindowMs);
+                break;
+            }
+            case mpsopt_coalescemaxsize:
+            {
+                coalesceMaxMsgSize = (nullptr != value) ? (size32_t)atoi(value) : DEFAULT_COALESCE_MAXMSGSIZE;
+                if (coalesceMaxMsgSize > MAXDATAPERPACKET)
+                    coalesceMaxMsgSize = MAXDATAPERPACKET;
+                PROGLOG("Setting CoalesceMaxSize = %u", coalesceMaxMsgSize);
+                break;
+            }
             default:
                 // ignore
                 break;
@@ -913,6 +1118,18 @@ struct ConnectHdr
 
 class CMPPacketReader;
 
+struct CoalescedSend        // a small message waiting to be written as part of a batch
+{
+    enum State { cs_queued, cs_leader, cs_inflight, cs_sent, cs_unsent, cs_failed };
+
+    CoalescedSend(PacketHeader &_hdr, MemoryBuffer &_mb) : hdr(_hdr), mb(_mb) {}
+
+    PacketHeader &hdr;
+    MemoryBuffer &mb;
+    Semaphore done;
+    State state = cs_queued;
+};
+
 class CMPChannel: public CInterface
 {
     ISocket *channelsock = nullptr;
@@ -930,6 +1147,21 @@ class CMPChannel: public CInterface
     unsigned __int64 attachaddrval = 0;
     SocketEndpoint attachep, attachPeerEp;
     std::atomic<unsigned> attachchk;
+    CriticalSection batchsect;
+    std::vector<CoalescedSend *> pendingbatch;  // first entry is the current leader (if any)
+    size32_t pendingbatchsize = 0;
+    bool batchleader = false;                   // a thread is collecting/writing pendingbatch
+    bool batchwindowwaiting = false;
+    Semaphore batchfullsig;
+    bool shmcandidate = false;                  // remote process is on this host
+    bool shmoffered = false;
+    bool shmsenderactive = false;               // peer has mapped shmsender
+    Owned<CMPSharedRing> shmsender;             // ring for packets sent to the peer
+    Owned<CMPSharedRing> shmreceiver;           // peer's ring for packets received
+    StringAttr shmacceptpending;                // name of shmreceiver, accepted ahead of the next packet sent to the peer
+
+    bool sendCoalesced(PacketHeader &hdr, MemoryBuffer &mb, CTimeMon &tm);
+    bool writeCoalesced(CoalescedSend &entry, CTimeMon &tm);
 
 protected: friend class CMPServer;
     SocketEndpoint remoteep;
@@ -1270,8 +1502,63 @@ public:
     bool attachSocket(ISocket *newsock,const SocketEndpoint &_remoteep,const SocketEndpoint &_localep,bool ismaster,size32_t *confirm, unsigned __int64 addrval=0);
 
     bool writepacket(const void *hdr,size32_t hdrsize,const void *hdr2,size32_t hdr2size,const void *body,size32_t bodysize,CTimeMon &tm)
+    {
+        unsigned n = 0;
+        const void *bufs[3];
+        size32_t sizes[3];
+        if (hdrsize) {
+            bufs[n] = hdr;
+            sizes[n++] = hdrsize;
+        }
+        if (hdr2size) {
+            bufs[n] = hdr2;
+            sizes[n++] = hdr2size;
+        }
+        if (bodysize) {
+            bufs[n] = body;
+            sizes[n++] = bodysize;
+        }
+        return writepackets(n,bufs,sizes,tm);
+    }
+
+    void offerSharedMemory(ISocket *dest)
+    {
+        // must be called in sendmutex
+        Owned<CMPSharedRing> ring;
+        {
+            CriticalBlock block(connectsect);
+            if (shmoffered||(dest!=channelsock))
+                return;
+            shmoffered = true;
+            ring.setown(CMPSharedRing::create(parent->shmRingSize));
+            if (!ring)
+                return;
+            shmsender.set(ring);
+        }
+        MemoryBuffer mb;
+        mb.append(ring->queryName()).append(ring->querySize());
+        PacketHeader hdr(sizeof(PacketHeader)+mb.length(),localep,remoteep,TAG_SYS_SHM_OFFER,TAG_NULL);
+        const void *bufs[2] = { &hdr, mb.toByteArray() };
+        size32_t sizes[2] = { sizeof(hdr), mb.length() };
+        dest->write_multiple(2,bufs,sizes);
+    }
+
+    void acceptSharedMemory(ISocket *dest, const char *name)
+    {
+        // must be called in sendmutex
+        MemoryBuffer mb;
+        mb.append(name);
+        PacketHeader hdr(sizeof(PacketHeader)+mb.length(),localep,remoteep,TAG_SYS_SHM_ACCEPT,TAG_NULL);
+        const void *bufs[2] = { &hdr, mb.toByteArray() };
+        size32_t sizes[2] = { sizeof(hdr), mb.length() };
+        dest->write_multiple(2,bufs,sizes);
+    }
+
+    bool writepackets(unsigned n,const void **bufs,size32_t *sizes,CTimeMon &tm) // writes all blocks with a single vectored send
     {
         Linked<ISocket> dest;
+        Linked<CMPSharedRing> ring;
+        StringAttr shmaccept;
         {
             CriticalBlock block(connectsect);
             if (closed) {
@@ -1291,6 +1578,12 @@ public:
                 }
             }
             dest.set(channelsock);
+            if (shmsenderactive)
+                ring.set(shmsender);
+            if (shmacceptpending) {
+                shmaccept.set(shmacceptpending);
+                shmacceptpending.clear();
+            }
         }
         try {
 #ifdef _FULLTRACE
@@ -1310,30 +1603,30 @@ public:
             // exception checking TBD
 #ifdef _FULLTRACE
             StringBuffer ep1;
-            StringBuffer ep2;
-            LOG(MCdebugInfo, "WritePacket(target=%s,(%d,%d,%d))",remoteep.getEndpointHostText(ep1).str(),hdrsize,hdr2size,bodysize);
+            LOG(MCdebugInfo, "WritePacket(target=%s,blocks=%u,first=%u)",remoteep.getEndpointHostText(ep1).str(),n,n?sizes[0]:0);
             unsigned t2 = msTick();
 #endif
-            unsigned n = 0;
-            const void *bufs[3];
-            size32_t sizes[3];
-            if (hdrsize) {
-                bufs[n] = hdr;
-                sizes[n++] = hdrsize;
-            }
-            if (hdr2size) {
-                bufs[n] = hdr2;
-                sizes[n++] = hdr2size;
-            }
-            if (bodysize) {
-                bufs[n] = body;
-                sizes[n++] = bodysize;
-            }
             if (!dest) {
                 LOG(MCdebugInfo, "MP Warning: WritePacket unexpected NULL socket");
                 return false;
             }
-            dest->write_multiple(n,bufs,sizes);  
+            if (shmaccept)
+                acceptSharedMemory(dest, shmaccept);
+            size32_t total = 0;
+            for (unsigned i=0; i<n; i++)
+                total += sizes[i];
+            ShmPacketRef ref;
+            if (ring&&(total>=parent->shmMinPacketSize)&&ring->write(n,bufs,sizes,total,ref)) {
+                PacketHeader refhdr(sizeof(PacketHeader)+sizeof(ref),localep,remoteep,TAG_SYS_SHM,TAG_NULL);
+                const void *refbufs[2] = { &refhdr, &ref };
+                size32_t refsizes[2] = { sizeof(refhdr), sizeof(ref) };
+                dest->write_multiple(2,refbufs,refsizes);
+            }
+            else {
+                if (!ring&&shmcandidate&&!shmoffered&&parent->useSharedMemory)
+                    offerSharedMemory(dest);
+                dest->write_multiple(n,bufs,sizes);
+            }
             lastxfer = msTick();
 #ifdef _FULLTRACE
             LOG(MCdebugInfo, "WritePacket(timewaiting=%d,timesending=%d)",t2-t1,lastxfer-t2);
@@ -1398,6 +1691,10 @@ public:
 
     bool send(MemoryBuffer &mb, mptag_t tag, mptag_t replytag, CTimeMon &tm, bool reply);
 
+    void openSharedMemory(CMessageBuffer &msg);
+    void acceptSharedMemory(CMessageBuffer &msg);
+    CMessageBuffer *readSharedMemoryPacket(CMessageBuffer *msg);
+
 
     void closeSocket(bool keepsocket=false, bool trace=false)
     {
@@ -1413,6 +1710,11 @@ public:
                 parent->checkclosed = true;
             s=channelsock;
             channelsock = nullptr;
+            shmoffered = false;
+            shmsenderactive = false;
+            shmsender.clear();
+            shmreceiver.clear();
+            shmacceptpending.clear();
             {
                 CriticalBlock block(attachsect);
                 attachaddrval = 0;
@@ -1695,6 +1997,76 @@ public:
     }
 };
 
+class BatchPacketHandler // TAG_SYS_BATCH
+{
+    CMPServer *server;
+    unsigned lastErrMs = 0;
+public:
+    BatchPacketHandler(CMPServer *_server) : server(_server)
+    {
+    }
+    CMessageBuffer *handle(CMessageBuffer * msg)
+    {
+        // split into the original user packets, each is queued exactly as if received individually
+        if (!msg)
+            return NULL;
+        while (msg->remaining()) {
+            PacketHeader hdr;
+            bool ok = false;
+            if (msg->remaining()>=sizeof(hdr)) {
+                msg->read(sizeof(hdr),&hdr);
+                ok = (hdr.size>=sizeof(hdr))&&(hdr.size-sizeof(hdr)<=msg->remaining());
+            }
+            if (!ok) {
+                unsigned ms = msTick();
+                if ((ms-lastErrMs) > 1000) { // avoid logging too much
+                    StringBuffer errorMsg;
+                    msg->getDetails(errorMsg);
+                    LOG(MCerror, "BatchPacketHandler: protocol error %s", errorMsg.str());
+                }
+                lastErrMs = ms;
+                break;
+            }
+            size32_t bodysize = hdr.size-sizeof(hdr);
+            CMessageBuffer *part = new CMessageBuffer(bodysize);
+            hdr.setMessageFields(*part);
+            msg->read(bodysize,part->reserveTruncate(bodysize));
+            server->userpackethandler->handle(part); // takes ownership
+        }
+        delete msg;
+        return NULL;
+    }
+    bool send(CMPChannel *channel,const std::vector<CoalescedSend *> &batch,CTimeMon &tm)
+    {
+        PacketHeader outhdr;
+        outhdr = batch[0]->hdr;
+        outhdr.tag = TAG_SYS_BATCH;
+        outhdr.replytag = TAG_NULL;
+        outhdr.size = sizeof(outhdr);
+        for (CoalescedSend *entry: batch)
+            outhdr.size += entry->hdr.size;
+        outhdr.initseq();
+        unsigned n = 0;
+        const void **bufs = (const void **)alloca(sizeof(void *)*(batch.size()*2+1));
+        size32_t *sizes = (size32_t *)alloca(sizeof(size32_t)*(batch.size()*2+1));
+        bufs[n] = &outhdr;
+        sizes[n++] = sizeof(outhdr);
+        for (CoalescedSend *entry: batch) {
+            bufs[n] = &entry->hdr;
+            sizes[n++] = sizeof(entry->hdr);
+            if (entry->mb.length()) {
+                bufs[n] = entry->mb.toByteArray();
+                sizes[n++] = entry->mb.length();
+            }
+        }
+#ifdef _FULLTRACE
+        StringBuffer ep1;
+        LOG(MCdebugInfo, "MP: batch-send(target=%s,messages=%u,size=%u)",outhdr.target.getEndpointHostText(ep1).str(),(unsigned)batch.size(),outhdr.size);
+#endif
+        return channel->writepackets(n,bufs,sizes,tm);
+    }
+};
+
 
 // --------------------------------------------------------
 
@@ -1830,6 +2202,22 @@ public:
                         case TAG_SYS_FORWARD:
                              activemsg = parent->queryServer().forwardpackethandler->handle(activemsg); 
                              break;
+                        case TAG_SYS_BATCH:
+                             activemsg = parent->queryServer().batchpackethandler->handle(activemsg);
+                             break;
+                        case TAG_SYS_SHM:
+                             activemsg = parent->readSharedMemoryPacket(activemsg);
+                             break;
+                        case TAG_SYS_SHM_OFFER:
+                             parent->openSharedMemory(*activemsg);
+                             delete activemsg;
+                             activemsg = NULL;
+                             break;
+                        case TAG_SYS_SHM_ACCEPT:
+                             parent->acceptSharedMemory(*activemsg);
+                             delete activemsg;
+                             activemsg = NULL;
+                             break;
                         default:
                              parent->queryServer().userpackethandler->handle(activemsg); // takes ownership
                              activemsg = NULL;
@@ -1864,6 +2252,9 @@ CMPChannel::CMPChannel(CMPServer *_parent,SocketEndpoint &_remoteep) : parent(_p
 {
     localep.set(parent->getPort());
     reader = new CMPPacketReader(this);
+#ifndef _WIN32
+    shmcandidate = remoteep.isLocal();
+#endif
     attachep.set(nullptr);
     attachchk = 0;
     lastxfer = msTick();
@@ -2018,6 +2409,8 @@ bool CMPChannel::send(MemoryBuffer &mb, mptag_t tag, mptag_t replytag, CTimeMon
     }
 
     bool ismulti = (msgsize>MAXDATAPERPACKET);
+    if (!ismulti&&parent->coalesceSends&&(msgsize<=parent->coalesceMaxMsgSize))
+        return sendCoalesced(hdr,mb,tm);
     // pre-condition - ensure no clashes
     for (;;)
     {
@@ -2074,6 +2467,222 @@ bool CMPChannel::send(MemoryBuffer &mb, mptag_t tag, mptag_t replytag, CTimeMon
     return parent->userpackethandler->send(this,hdr,mb,tm);
 }
 
+bool CMPChannel::sendCoalesced(PacketHeader &hdr, MemoryBuffer &mb, CTimeMon &tm)
+{
+    /* Small messages are queued on the channel. The first sender becomes the leader and writes everything queued
+     * (including messages that arrive while it waits for the coalesce window or for sendmutex) with a single vectored
+     * send. Every sender blocks until its own message has been written, so mb is never copied.
+     */
+    CoalescedSend entry(hdr, mb);
+    bool waitwindow = false;
+    {
+        CriticalBlock block(batchsect);
+        pendingbatch.push_back(&entry);
+        pendingbatchsize += hdr.size;
+        if (!batchleader)
+        {
+            batchleader = true;
+            entry.state = CoalescedSend::cs_leader;
+            waitwindow = (parent->coalesceWindowMs != 0);
+            batchwindowwaiting = waitwindow;
+        }
+        else if (batchwindowwaiting&&((pendingbatchsize>=MAXDATAPERPACKET)||(pendingbatch.size()>=MAXBATCHMESSAGES)))
+        {
+            batchwindowwaiting = false;
+            batchfullsig.signal();
+        }
+    }
+    if (entry.state==CoalescedSend::cs_leader)
+    {
+        if (waitwindow&&!batchfullsig.wait(parent->coalesceWindowMs))
+        {
+            CriticalBlock block(batchsect);
+            if (batchwindowwaiting)
+                batchwindowwaiting = false;
+            else
+                batchfullsig.wait(); // signalled as the window expired
+        }
+        return writeCoalesced(entry, tm);
+    }
+
+    if ((tm.timeout==MP_WAIT_FOREVER)||(tm.timeout==MP_ASYNC_SEND))
+        entry.done.wait();
+    else
+    {
+        unsigned remaining;
+        if (tm.timedout(&remaining)||!entry.done.wait(remaining))
+        {
+            {
+                CriticalBlock block(batchsect);
+                if (entry.state==CoalescedSend::cs_queued)
+                {
+                    pendingbatch.erase(std::find(pendingbatch.begin(), pendingbatch.end(), &entry));
+                    pendingbatchsize -= hdr.size;
+                    return false;
+                }
+            }
+            entry.done.wait(); // already promoted or being written, mb is still referenced
+        }
+    }
+    switch (entry.state)
+    {
+    case CoalescedSend::cs_leader: // promoted to write the backlog, no point waiting for the window
+        return writeCoalesced(entry, tm);
+    case CoalescedSend::cs_sent:
+        return true;
+    case CoalescedSend::cs_failed:
+        throw new CMPException(MPERR_link_closed,remoteep);
+    default:
+        return false;
+    }
+}
+
+bool CMPChannel::writeCoalesced(CoalescedSend &entry, CTimeMon &tm)
+{
+    // called by the batch leader, entry is at the head of pendingbatch
+    for (;;)
+    {
+        sendmutex.lock();
+        if (multitag!=entry.hdr.tag)    // don't want to interleave with multi send of same tag
+            break;
+        sendwaiting++;
+        sendmutex.unlock();
+        sendwaitingsig.wait();
+    }
+    std::vector<CoalescedSend *> batch;
+    {
+        CriticalBlock block(batchsect);
+        size32_t batchsize = 0;
+        auto it = pendingbatch.begin();
+        while ((it!=pendingbatch.end())&&(batch.size()<MAXBATCHMESSAGES))
+        {
+            CoalescedSend *cur = *it;
+            if (cur!=&entry)
+            {
+                if (batchsize+cur->hdr.size>MAXDATAPERPACKET)
+                    break;
+                if (cur->hdr.tag==multitag)
+                {
+                    ++it;
+                    continue;
+                }
+            }
+            batchsize += cur->hdr.size;
+            pendingbatchsize -= cur->hdr.size;
+            cur->state = CoalescedSend::cs_inflight;
+            batch.push_back(cur);
+            it = pendingbatch.erase(it);
+        }
+    }
+
+    CoalescedSend::State result = CoalescedSend::cs_failed;
+    auto complete = [&]()
+    {
+        {
+            CriticalBlock block(batchsect);
+            if (pendingbatch.empty())
+                batchleader = false;
+            else
+            {
+                CoalescedSend *next = pendingbatch.front();
+                next->state = CoalescedSend::cs_leader;
+                next->done.signal();
+            }
+        }
+        if (sendwaiting)
+        {
+            sendwaitingsig.signal(sendwaiting);
+            sendwaiting = 0;
+        }
+        sendmutex.unlock();
+        for (CoalescedSend *cur: batch)
+        {
+            if (cur!=&entry)
+            {
+                cur->state = result;
+                cur->done.signal();
+            }
+        }
+    };
+    bool ret;
+    try
+    {
+        if (batch.size()==1)
+            ret = parent->userpackethandler->send(this,entry.hdr,entry.mb,tm);
+        else
+            ret = parent->batchpackethandler->send(this,batch,tm);
+    }
+    catch (IException *)
+    {
+        complete();
+        throw;
+    }
+    result = ret ? CoalescedSend::cs_sent : CoalescedSend::cs_unsent;
+    complete();
+    return ret;
+}
+
+void CMPChannel::openSharedMemory(CMessageBuffer &msg)
+{
+    // peer is offering a ring for the packets it sends, map it and confirm
+    // Called on the select thread, so the accept is not written here (that would need the sendmutex) - it is sent
+    // ahead of the next packet written to the peer.  Until then the peer continues to use the socket.
+    StringAttr name;
+    size32_t size;
+    msg.read(name).read(size);
+    Owned<CMPSharedRing> ring = CMPSharedRing::open(name, size);
+    if (!ring)
+        return;     // peer continues to use the socket
+    CriticalBlock block(connectsect);
+    if (!channelsock)
+        return;
+    shmreceiver.set(ring);
+    shmacceptpending.set(name);
+}
+
+void CMPChannel::acceptSharedMemory(CMessageBuffer &msg)
+{
+    StringAttr name;
+    msg.read(name);
+    CriticalBlock block(connectsect);
+    if (shmsender&&streq(shmsender->queryName(), name))
+    {
+        shmsender->unlink();
+        shmsenderactive = true;
+        if (parent->mpTraceLevel >= MPVerboseMsgThreshold)
+        {
+            StringBuffer ep;
+            LOG(MCdebugInfo, "MP: using shared memory %s for packets to %s", name.get(), remoteep.getEndpointHostText(ep).str());
+        }
+    }
+}
+
+CMessageBuffer *CMPChannel::readSharedMemoryPacket(CMessageBuffer *msg)
+{
+    ShmPacketRef ref;
+    msg->read(sizeof(ref),&ref);
+    delete msg;
+    Linked<CMPSharedRing> ring;
+    {
+        CriticalBlock block(connectsect);
+        ring.set(shmreceiver);
+    }
+    const byte *packet = ring ? ring->queryPacket(ref) : nullptr;
+    PacketHeader hdr;
+    if (packet&&(ref.size>=sizeof(hdr)))
+        memcpy(&hdr,packet,sizeof(hdr));
+    if (!packet||(ref.size<sizeof(hdr))||(hdr.size!=ref.size)) {
+        StringBuffer ep;
+        throw makeStringExceptionV(0, "MP: invalid shared memory packet from %s", remoteep.getEndpointHostText(ep).str());
+    }
+    size32_t bodysize = ref.size-sizeof(hdr);
+    CMessageBuffer *ret = new CMessageBuffer(bodysize);
+    hdr.setMessageFields(*ret);
+    memcpy(ret->reserveTruncate(bodysize),packet+sizeof(hdr),bodysize);
+    ring->release(ref);
+    return ret;
+}
+
 bool CMPChannel::sendPing(CTimeMon &tm)
 {
     unsigned remaining;
@@ -2144,6 +2753,12 @@ CMPConnectThread::CMPConnectThread(CMPServer *_parent, unsigned port, bool _list
                 mpSoMaxConn = env->getPropInt("EnvSettings/ports/mpSoMaxConn", 0);
             acceptThreadPoolSize = env->getPropInt("EnvSettings/acceptThreadPoolSize", defaultAcceptThreadPoolSize);
         }
+        parent->coalesceSends = env->getPropBool("EnvSettings/mpCoalesce", false);
+        parent->coalesceWindowMs = env->getPropInt("EnvSettings/mpCoalesceWindow", 0);
+        parent->coalesceMaxMsgSize = env->getPropInt("EnvSettings/mpCoalesceMaxSize", DEFAULT_COALESCE_MAXMSGSIZE);
+        parent->useSharedMemory = env->getPropBool("EnvSettings/mpSharedMemory", false);
+        parent->shmRingSize = env->getPropInt("EnvSettings/mpSharedMemoryRingSize", DEFAULT_SHM_RINGSIZE);
+        parent->shmMinPacketSize = env->getPropInt("EnvSettings/mpSharedMemoryMinSize", DEFAULT_SHM_MINPACKETSIZE);
         unsigned mpTraceLevel = env->getPropInt("EnvSettings/mpTraceLevel", 0);
         switch (mpTraceLevel)
         {
@@ -2170,7 +2785,25 @@ CMPConnectThread::CMPConnectThread(CMPServer *_parent, unsigned port, bool _list
         else
             acceptThreadPoolSize = getGlobalConfigSP()->getPropInt("expert/@acceptThreadPoolSize", defaultAcceptThreadPoolSize);
     }
+    parent->coalesceSends = getComponentConfigSP()->getPropBool("expert/@mpCoalesce", getGlobalConfigSP()->getPropBool("expert/@mpCoalesce", false));
+    parent->coalesceWindowMs = getComponentConfigSP()->getPropInt("expert/@mpCoalesceWindow", getGlobalConfigSP()->getPropInt("expert/@mpCoalesceWindow", 0));
+    parent->coalesceMaxMsgSize = getComponentConfigSP()->getPropInt("expert/@mpCoalesceMaxSize", getGlobalConfigSP()->getPropInt("expert/@mpCoalesceMaxSize", DEFAULT_COALESCE_MAXMSGSIZE));
 #endif
+    if (parent->coalesceMaxMsgSize > MAXDATAPERPACKET)
+        parent->coalesceMaxMsgSize = MAXDATAPERPACKET;
+    if (parent->coalesceSends)
+        PROGLOG("MP: coalescing sends of up to %u bytes (window %ums)", parent->coalesceMaxMsgSize, parent->coalesceWindowMs);
+    if (parent->useSharedMemory)
+    {
+        if (parent->useTLS)
+            parent->useSharedMemory = false;    // keep all traffic on the secure socket
+        else
+        {
+            if (parent->shmRingSize < 4*MAXDATAPERPACKET)
+                parent->shmRingSize = 4*MAXDATAPERPACKET;
+            PROGLOG("MP: using %u byte shared memory rings for processes on this host", parent->shmRingSize);
+        }
+    }
 
     if (mpSoMaxConn)
     {
@@ -2664,6 +3297,7 @@ CMPServer::CMPServer(unsigned __int64 _role, unsigned _port, bool _listen)
     forwardpackethandler = new ForwardPacketHandler;        // TAG_SYS_FORWARD
     multipackethandler = new MultiPacketHandler;            // TAG_SYS_MULTI
     broadcastpackethandler = new BroadcastPacketHandler;    // TAG_SYS_BCAST
+    batchpackethandler = new BatchPacketHandler(this);      // TAG_SYS_BATCH
     userpackethandler = new UserPacketHandler(this);        // default
     notifyclosedthread = new CMPNotifyClosedThread(this);
     notifyclosedthread->start(false);
@@ -2694,6 +3328,7 @@ CMPServer::~CMPServer()
     delete forwardpackethandler;
     delete multipackethandler;
     delete broadcastpackethandler;
+    delete batchpackethandler;
     delete userpackethandler;
     ::Release(myNode);
 }
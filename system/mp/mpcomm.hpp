@@ -93,7 +93,7 @@ extern mp_decl ICommunicator *createCommunicator(IGroup *group,bool outer=false)
 extern mp_decl IInterCommunicator &queryWorldCommunicator();
 extern mp_decl bool hasMPServerStarted();
 
-enum MPServerOpts { mpsopt_null, mpsopt_channelreopen };
+enum MPServerOpts { mpsopt_null, mpsopt_channelreopen, mpsopt_coalesce, mpsopt_coalescewindow, mpsopt_coalescemaxsize };
 interface IMPServer : extends IInterface
 {
     virtual mptag_t createReplyTag() = 0;
@@ -72,6 +72,10 @@ TAGENUM
     DEFSTDTAG ( TAG_SYS_BCAST, (unsigned) -7 )
     DEFSTDTAG ( TAG_SYS_FORWARD, (unsigned) -8 )
     DEFSTDTAG ( TAG_SYS_PING_REPLY_ID, (unsigned) -9 )
+    DEFSTDTAG ( TAG_SYS_BATCH, (unsigned) -10 )
+    DEFSTDTAG ( TAG_SYS_SHM, (unsigned) -11 )
+    DEFSTDTAG ( TAG_SYS_SHM_OFFER, (unsigned) -12 )
+    DEFSTDTAG ( TAG_SYS_SHM_ACCEPT, (unsigned) -13 )
     DEFSTDTAG ( TAG_REPLY_BASE,(unsigned) -1000)                // internal use
 
 TAGENUMEND
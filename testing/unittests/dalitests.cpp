@@ -32,6 +32,7 @@
 #include "danqs.hpp"
 #include "dautils.hpp"
 
+#include <algorithm>
 #include <vector>
 #include <future>
 #include <math.h>
@@ -52,6 +53,14 @@ static unsigned initCounter = 0; // counter for initialiser
 
 // Declared in dadfs.cpp *only* when CPPUNIT is active
 extern void removeLogical(const char *fname, IUserDescriptor *user);
+extern void setDfsMetaCacheLimits(unsigned maxEntries, memsize_t maxSize);
+extern void getDfsMetaCacheCounts(__uint64 &hits, __uint64 &misses, __uint64 &stale);
+extern __uint64 getDfsMetaCachePermissionChecks();
+
+// Declared in dasds.cpp *only* when CPPUNIT is active
+extern void setTestAttributeIndex(IPropertyTree *store, const char *branchXPath, const char *attributes);
+extern IPropertyTree *getTestAttributeIndexXPaths(const char *xpath, bool &indexed);
+extern void applyTestAttributeIndexDelta(const char *deltaXml);
 
 void daliClientInit()
 {
@@ -1858,6 +1867,7 @@ class CDaliDFSStressTests : public CppUnit::TestFixture
         CPPUNIT_TEST(testDFSRename2);
         CPPUNIT_TEST(testDFSRenameThenDelete);
         CPPUNIT_TEST(testDFSRemoveSuperSub);
+        CPPUNIT_TEST(testDFSMetaCache);
 // This test requires access to an external IP with dafilesrv running
 //        CPPUNIT_TEST(testDFSRename3);
     CPPUNIT_TEST_SUITE_END();
@@ -2574,6 +2584,73 @@ public:
         ASSERT(!dir.exists("regress::removesupersub::sub1", user, true, false) && "regress::removesupersub::sub1 should NOT exist");
         ASSERT(!dir.exists("regress::removesupersub::sub4", user, true, false) && "regress::removesupersub::sub4 should NOT exist");
     }
+
+    void testDFSMetaCache()
+    {
+        setupDFS(logctx, "metacache", 0, 3);
+        setDfsMetaCacheLimits(2, 0x100000);
+
+        __uint64 hits, misses, stale;
+        __uint64 lastHits, lastMisses, lastStale;
+        getDfsMetaCacheCounts(lastHits, lastMisses, lastStale);
+        auto check = [&](unsigned expectedHits, unsigned expectedMisses)
+        {
+            getDfsMetaCacheCounts(hits, misses, stale);
+            bool ok = (hits-lastHits == expectedHits) && (misses-lastMisses == expectedMisses);
+            lastHits = hits;
+            lastMisses = misses;
+            return ok;
+        };
+
+        logctx.CTXLOG("Meta cache hit");
+        Owned<IPropertyTree> tree = dir.getFileTree("regress::metacache::sub1", user);
+        ASSERT(tree && check(0, 1) && "first getFileTree should miss the cache");
+        tree.setown(dir.getFileTree("regress::metacache::sub1", user));
+        ASSERT(tree && check(1, 0) && "second getFileTree should hit the cache");
+        ASSERT(!tree->hasProp("Attr/@metaCacheTest"));
+
+        logctx.CTXLOG("Meta cache permission reuse");
+        __uint64 permissionChecks = getDfsMetaCachePermissionChecks();
+        tree.setown(dir.getFileTree("regress::metacache::sub1", user));
+        tree.setown(dir.getFileTree("regress::metacache::sub2", user));
+        tree.setown(dir.getFileTree("regress::metacache::sub2", user));
+        ASSERT(check(2, 1) && "sub1 and the second sub2 lookup should hit");
+        ASSERT((getDfsMetaCachePermissionChecks() == permissionChecks) && "the scope permission checked for the first hit should be reused");
+
+        logctx.CTXLOG("Meta cache invalidation");
+        {
+            Owned<IDistributedFile> file = dir.lookup("regress::metacache::sub1", user, AccessMode::tbdWrite, false, false, nullptr, defaultPrivilegedUser);
+            ASSERT(file);
+            DistributedFilePropertyLock lock(file);
+            lock.queryAttributes().setProp("@metaCacheTest", "changed");
+        }
+        bool changed = false;
+        for (unsigned i=0; i<100 && !changed; i++) // the change is notified asynchronously
+        {
+            tree.setown(dir.getFileTree("regress::metacache::sub1", user));
+            changed = tree->hasProp("Attr/@metaCacheTest");
+            if (!changed)
+                MilliSleep(100);
+        }
+        getDfsMetaCacheCounts(hits, misses, stale);
+        ASSERT(changed && "cached tree was not invalidated by the change");
+        ASSERT(stale > lastStale && "invalidation was not counted");
+
+        logctx.CTXLOG("Meta cache eviction");
+        setDfsMetaCacheLimits(2, 0x100000); // start with an empty cache
+        check(0, 0); // reset
+        tree.setown(dir.getFileTree("regress::metacache::sub1", user));
+        tree.setown(dir.getFileTree("regress::metacache::sub1", user));
+        tree.setown(dir.getFileTree("regress::metacache::sub2", user));
+        tree.setown(dir.getFileTree("regress::metacache::sub3", user)); // evicts sub1, the least recently used
+        ASSERT(check(1, 3) && "only the second sub1 lookup should hit");
+        tree.setown(dir.getFileTree("regress::metacache::sub3", user));
+        ASSERT(check(1, 0) && "sub3 should still be cached");
+        tree.setown(dir.getFileTree("regress::metacache::sub1", user));
+        ASSERT(check(0, 1) && "sub1 should have been evicted");
+
+        setDfsMetaCacheLimits(0, 0);
+    }
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION( CDaliDFSStressTests );
@@ -2933,6 +3010,170 @@ public:
 CPPUNIT_TEST_SUITE_REGISTRATION( CDaliUtils );
 CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( CDaliUtils, "DaliUtils" );
 
+// Server side attribute indexes of a store branch, tested on a local tree with the deltas the server would see
+class CDaliSDSAttributeIndexTests : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE(CDaliSDSAttributeIndexTests);
+      CPPUNIT_TEST(testLookup);
+      CPPUNIT_TEST(testAdd);
+      CPPUNIT_TEST(testDelete);
+      CPPUNIT_TEST(testAttributeChange);
+    CPPUNIT_TEST_SUITE_END();
+
+    Owned<IPropertyTree> store;
+
+    // The names of the matching children, in the order they are returned, and checks that they are the same set as an unindexed query
+    std::vector<std::string> getMatches(const char *xpath, bool expectIndexed=true)
+    {
+        bool indexed = false;
+        Owned<IPropertyTree> matchTree = getTestAttributeIndexXPaths(xpath, indexed);
+        CPPUNIT_ASSERT_EQUAL(expectIndexed, indexed);
+        std::vector<std::string> matches;
+        IPropertyTree *branch = store->queryPropTree("WorkUnits");
+        if (matchTree)
+        {
+            Owned<IPropertyTreeIterator> iter = matchTree->getElements("*");
+            ForEach(*iter)
+            {
+                IPropertyTree &match = iter->query();
+                VStringBuffer childXPath("%s[%d]", match.queryName(), match.getPropInt("@pos"));
+                CPPUNIT_ASSERT(branch->hasProp(childXPath)); // the position refers to the child
+                matches.push_back(match.queryName());
+            }
+        }
+        std::vector<std::string> expected;
+        Owned<IPropertyTreeIterator> iter = branch->getElements(xpath);
+        ForEach(*iter)
+            expected.push_back(iter->query().queryName());
+        std::vector<std::string> sorted(matches);
+        std::sort(sorted.begin(), sorted.end());
+        std::sort(expected.begin(), expected.end());
+        CPPUNIT_ASSERT(expected == sorted);
+        return matches;
+    }
+    static std::vector<std::string> sorted(std::vector<std::string> values)
+    {
+        std::sort(values.begin(), values.end());
+        return values;
+    }
+public:
+    virtual void setUp() override
+    {
+        store.setown(createPTreeFromXMLString(
+            "<Root><WorkUnits>"
+            "<W1 state='completed' jobName='alpha'/>"
+            "<W2 state='completed' jobName='beta'/>"
+            "<W3 state='running' jobName='alpha'/>"
+            "<W4 state='Failed' jobName='gamma'/>"
+            "<W5 state='completed' jobName='Alpha'/>"
+            "<W6 jobName='delta'/>"
+            "</WorkUnits></Root>"));
+        setTestAttributeIndex(store, "/WorkUnits", "@state,jobName");
+    }
+    virtual void tearDown() override
+    {
+        setTestAttributeIndex(nullptr, nullptr, nullptr);
+        store.clear();
+    }
+
+    void testLookup()
+    {
+        //Multiple matches are returned in the order the children were indexed, which was the branch order
+        std::vector<std::string> unindexed;
+        Owned<IPropertyTreeIterator> iter = store->getElements("WorkUnits/*[@state=\"completed\"]");
+        ForEach(*iter)
+            unindexed.push_back(iter->query().queryName());
+        CPPUNIT_ASSERT(getMatches("*[@state=\"completed\"]") == unindexed);
+        CPPUNIT_ASSERT(sorted(getMatches("*[@state=\"completed\"]")) == (std::vector<std::string>{ "W1", "W2", "W5" }));
+
+        CPPUNIT_ASSERT(getMatches("*[@state=\"failed\"]").empty());
+        CPPUNIT_ASSERT(getMatches("*[@state=?\"failed\"]") == (std::vector<std::string>{ "W4" }));
+        CPPUNIT_ASSERT(getMatches("*[@state=\"unknown\"]").empty());
+        CPPUNIT_ASSERT(sorted(getMatches("*[@jobName=?\"alpha\"]")) == (std::vector<std::string>{ "W1", "W3", "W5" }));
+        CPPUNIT_ASSERT(sorted(getMatches("*[@state=\"completed\"][@jobName=\"alpha\"]")) == (std::vector<std::string>{ "W1" }));
+        CPPUNIT_ASSERT(getMatches("W2[@state=\"completed\"]") == (std::vector<std::string>{ "W2" }));
+
+        //Qualifiers that the index cannot answer are evaluated against the branch
+        getMatches("*[@state!=\"completed\"]", false);
+        CPPUNIT_ASSERT(getMatches("*[@owner=\"fred\"]", false).empty());
+        CPPUNIT_ASSERT(getMatches("*[@state=\"comp*\"]", false).size() == 3);
+        CPPUNIT_ASSERT(getMatches("*[@state=~\"comp*\"]", false).size() == 3);
+    }
+
+    void testAdd()
+    {
+        getMatches("*[@state=\"completed\"]");
+        applyTestAttributeIndexDelta("<Header path='/WorkUnits'><Delta><T>"
+                                     "<T name='W7' new='1'><AC state='completed' jobName='beta'/></T>"
+                                     "<T name='W8' new='1'><AC state='running'/></T>"
+                                     "</T></Delta></Header>");
+        //A child added since the index was built is returned after the children that were already indexed
+        std::vector<std::string> matches = getMatches("*[@state=\"completed\"]");
+        CPPUNIT_ASSERT(sorted(matches) == (std::vector<std::string>{ "W1", "W2", "W5", "W7" }));
+        CPPUNIT_ASSERT_EQUAL(std::string("W7"), matches.back());
+        CPPUNIT_ASSERT(sorted(getMatches("*[@jobName=\"beta\"]")) == (std::vector<std::string>{ "W2", "W7" }));
+        CPPUNIT_ASSERT(sorted(getMatches("*[@state=\"running\"]")) == (std::vector<std::string>{ "W3", "W8" }));
+    }
+
+    void testDelete()
+    {
+        getMatches("*[@state=\"completed\"]");
+        applyTestAttributeIndexDelta("<Header path='/WorkUnits'><Delta><T>"
+                                     "<D name='W2' pos='1'/>"
+                                     "</T></Delta></Header>");
+        CPPUNIT_ASSERT(sorted(getMatches("*[@state=\"completed\"]")) == (std::vector<std::string>{ "W1", "W5" }));
+        CPPUNIT_ASSERT(getMatches("*[@jobName=\"beta\"]").empty());
+
+        //A child deleted and added again with the same name is indexed under its new values
+        applyTestAttributeIndexDelta("<Header path='/WorkUnits'><Delta><T>"
+                                     "<T name='W2' new='1'><AC state='failed' jobName='beta'/></T>"
+                                     "</T></Delta></Header>");
+        CPPUNIT_ASSERT(sorted(getMatches("*[@state=\"completed\"]")) == (std::vector<std::string>{ "W1", "W5" }));
+        CPPUNIT_ASSERT(getMatches("*[@jobName=\"beta\"]") == (std::vector<std::string>{ "W2" }));
+    }
+
+    void testAttributeChange()
+    {
+        std::vector<std::string> before = getMatches("*[@state=\"completed\"]");
+        //A change to the branch that names the child
+        applyTestAttributeIndexDelta("<Header path='/WorkUnits'><Delta><T>"
+                                     "<T name='W3' pos='1'><AC state='completed'/></T>"
+                                     "</T></Delta></Header>");
+        //A change to the child itself
+        applyTestAttributeIndexDelta("<Header path='/WorkUnits/W2'><Delta><T>"
+                                     "<AC state='failed'/>"
+                                     "</T></Delta></Header>");
+        //A change that adds the indexed attribute to a child that did not have it
+        applyTestAttributeIndexDelta("<Header path='/WorkUnits/W6'><Delta><T>"
+                                     "<AC state='completed'/>"
+                                     "</T></Delta></Header>");
+        std::vector<std::string> after = getMatches("*[@state=\"completed\"]");
+        CPPUNIT_ASSERT(sorted(after) == (std::vector<std::string>{ "W1", "W3", "W5", "W6" }));
+        CPPUNIT_ASSERT(getMatches("*[@state=?\"failed\"]").size() == 2);
+        CPPUNIT_ASSERT(sorted(getMatches("*[@state=\"running\"]")).empty());
+
+        //Re-indexed children keep their place in the order
+        std::vector<std::string> unindexed;
+        Owned<IPropertyTreeIterator> iter = store->getElements("WorkUnits/*");
+        ForEach(*iter)
+        {
+            const char *name = iter->query().queryName();
+            if (std::find(after.begin(), after.end(), name) != after.end())
+                unindexed.push_back(name);
+        }
+        CPPUNIT_ASSERT(after == unindexed);
+
+        //Removing the attribute removes the child from the index
+        applyTestAttributeIndexDelta("<Header path='/WorkUnits/W1'><Delta><T>"
+                                     "<AD state=''/>"
+                                     "</T></Delta></Header>");
+        CPPUNIT_ASSERT(sorted(getMatches("*[@state=\"completed\"]")) == (std::vector<std::string>{ "W3", "W5", "W6" }));
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( CDaliSDSAttributeIndexTests );
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( CDaliSDSAttributeIndexTests, "CDaliSDSAttributeIndexTests" );
+
 class CFileNameNormalizeUnitTest : public CppUnit::TestFixture, CDfsLogicalFileName
 {
     CPPUNIT_TEST_SUITE(CFileNameNormalizeUnitTest);
@@ -24,6 +24,7 @@
 #include <memory>
 #include <chrono>
 #include <algorithm>
+#include <functional>
 #include "jsem.hpp"
 #include "jfile.hpp"
 #include "jdebug.hpp"
@@ -2117,6 +2118,9 @@ class JlibIPTTest : public CppUnit::TestFixture
         CPPUNIT_TEST(testMergeConfig);
         CPPUNIT_TEST(testRemoveReuse);
         CPPUNIT_TEST(testSpecialTags);
+        CPPUNIT_TEST(testCompactChildren);
+        CPPUNIT_TEST(testReaderRuns);
+        CPPUNIT_TEST(testParallelParse);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -2839,6 +2843,141 @@ subX:
         CPPUNIT_ASSERT(na1->isArray(nullptr));
         CPPUNIT_ASSERT(na2->isArray(nullptr));
     }
+    void testCompactChildren()
+    {
+        for (byte flags : { (byte)ipt_lowmem, (byte)(ipt_lowmem|ipt_caseInsensitive) })
+        {
+            bool nocase = (0 != (flags & ipt_caseInsensitive));
+            Owned<IPropertyTree> t = createPTree("root", flags);
+            // grow through the dense sizes and beyond, so the child table is rehashed with live children
+            for (unsigned i=0; i<20; i++)
+            {
+                VStringBuffer name("c%u", i);
+                t->setPropInt(name, i);
+                t->addPropInt("multi", i);
+                for (unsigned j=0; j<=i; j++)
+                {
+                    VStringBuffer name2(nocase ? "C%u" : "c%u", j);
+                    CPPUNIT_ASSERT_EQUAL((int)j, t->getPropInt(name2, -1));
+                }
+            }
+            CPPUNIT_ASSERT_EQUAL(20U, t->getCount("multi"));
+            CPPUNIT_ASSERT_EQUAL(40U, t->numChildren());
+            CPPUNIT_ASSERT(t->removeProp("c3"));
+            CPPUNIT_ASSERT(!t->hasProp("c3"));
+            CPPUNIT_ASSERT_EQUAL(4, t->getPropInt("c4"));
+
+            // a small node, removing and replacing children while dense
+            IPropertyTree *small = t->addPropTree("small", createPTree(flags));
+            small->setProp("a", "1");
+            small->setProp("b", "2");
+            small->setProp("c", "3");
+            CPPUNIT_ASSERT(small->removeProp("a"));
+            small->setProp("b", "x");
+            CPPUNIT_ASSERT(!small->hasProp("a"));
+            CPPUNIT_ASSERT(streq("x", small->queryProp("b")));
+            CPPUNIT_ASSERT(streq("3", small->queryProp("c")));
+            unsigned count = 0;
+            Owned<IPropertyTreeIterator> iter = small->getElements("*");
+            ForEach(*iter)
+                count++;
+            CPPUNIT_ASSERT_EQUAL(2U, count);
+            CPPUNIT_ASSERT(small->removeTree(small->queryPropTree("c")));
+            CPPUNIT_ASSERT_EQUAL(1U, small->numChildren());
+
+            Owned<IPropertyTree> copy = createPTreeFromIPT(t);
+            CPPUNIT_ASSERT(areMatchingPTrees(t, copy));
+        }
+    }
+    void testReaderRuns()
+    {
+        // runs of text and attribute values longer than a scanning block, with embedded newlines, quotes and entities
+        StringBuffer longText, xml, json;
+        for (unsigned i=0; i<10; i++)
+            longText.append("line ").append(i).append(" of some text\n");
+        xml.append("<a x=\"").append(longText).append("&amp;'end\" y='").append(longText).append("\"end'>");
+        xml.append(longText).append("&lt;tail&gt;</a>");
+        for (unsigned pass=0; pass<2; pass++)
+        {
+            Owned<IPropertyTree> t = pass ? createPTreeFromXMLString(xml.length(), xml.str()) : createPTreeFromXMLString(xml.str());
+            VStringBuffer expected("%s&'end", longText.str());
+            CPPUNIT_ASSERT(streq(expected, t->queryProp("@x")));
+            expected.set(longText).append("\"end");
+            CPPUNIT_ASSERT(streq(expected, t->queryProp("@y")));
+            expected.set(longText).append("<tail>");
+            CPPUNIT_ASSERT(streq(expected, t->queryProp(nullptr)));
+        }
+
+        json.append("{\"a\": {\"s\": \"").append(longText.length(), longText.str());
+        json.replaceString("\n", "\\n");
+        json.append("\\\"quoted\\\" caf\xc3\xa9\"}}");
+        Owned<IPropertyTree> j = createPTreeFromJSONString(json.str());
+        VStringBuffer expected("%s\"quoted\" caf\xc3\xa9", longText.str());
+        CPPUNIT_ASSERT(streq(expected, j->queryProp("a/s")));
+
+        // line numbers in errors must account for newlines consumed in bulk
+        StringBuffer bad("<a>\n");
+        bad.append(longText).append("<b x=\"1\n2\">\n  \n</a>");
+        try
+        {
+            Owned<IPropertyTree> b = createPTreeFromXMLString(bad.str());
+            CPPUNIT_FAIL("expected a parse error");
+        }
+        catch (IPTreeReadException *e)
+        {
+            CPPUNIT_ASSERT_EQUAL(15U, e->queryLine());
+            e->Release();
+        }
+    }
+    void testParallelParse()
+    {
+        // top level elements large enough to be split, with markup that must not confuse the boundary scan
+        StringBuffer xml("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<!-- store -->\n<SDS a=\"1\">\n");
+        for (unsigned top=0; top<3; top++)
+        {
+            xml.appendf(" <Top%u name=\"t>%u\">\n", top % 2, top);
+            for (unsigned i=0; i<2000; i++)
+            {
+                xml.appendf("  <Item id='%u' note=\"a/>b\"><Value>v%u &amp; &lt;x&gt;</Value>", i, i);
+                if (i % 100 == 0)
+                    xml.append("<!-- </Item> --><Data><![CDATA[</Data><Item>]]></Data><Empty/>");
+                xml.append("</Item>\n");
+            }
+            xml.appendf(" </Top%u>\n", top % 2);
+        }
+        xml.append(" <Text>some text<b/></Text>\n <Empty x='1'/>\n <!-- trailing --><Small><c/></Small>\n</SDS>\n");
+
+        Owned<IPropertyTree> serial = createPTreeFromXMLString(xml.length(), xml.str());
+        Owned<IPropertyTree> parallel = createPTreeFromXMLBufferParallel(xml.length(), xml.str());
+        CPPUNIT_ASSERT(parallel);
+        StringBuffer serialXml, parallelXml;
+        toXML(serial, serialXml);
+        toXML(parallel, parallelXml);
+        CPPUNIT_ASSERT(streq(serialXml, parallelXml));
+        CPPUNIT_ASSERT_EQUAL(2000U, (unsigned)parallel->getCount("Top0[2]/Item"));
+        CPPUNIT_ASSERT(streq("</Data><Item>", parallel->queryProp("Top1/Item[@id='100']/Data")));
+
+        // documents that cannot be split
+        const char *text = "<a>text<b/></a>";
+        CPPUNIT_ASSERT(!createPTreeFromXMLBufferParallel(strlen(text), text));
+        const char *doctype = "<!DOCTYPE a [<!ENTITY e \"x\">]><a><b>&e;</b></a>";
+        CPPUNIT_ASSERT(!createPTreeFromXMLBufferParallel(strlen(doctype), doctype));
+        const char *noRoot = "<a/><b/>";
+        CPPUNIT_ASSERT(!createPTreeFromXMLBufferParallel(strlen(noRoot), noRoot, ipt_none, ptr_noRoot));
+
+        // errors within a piece are reported
+        StringBuffer bad(xml);
+        bad.replaceString("<Item id='1500'", "<Item id='1500' <");
+        try
+        {
+            Owned<IPropertyTree> b = createPTreeFromXMLBufferParallel(bad.length(), bad.str());
+            CPPUNIT_FAIL("expected a parse error");
+        }
+        catch (IException *e)
+        {
+            e->Release();
+        }
+    }
     void testPtreeEncode(const char *input, const char *expected=nullptr)
     {
         static unsigned id = 0;
@@ -3006,6 +3145,101 @@ Nothing_toEncodeHere:
 CPPUNIT_TEST_SUITE_REGISTRATION(JlibIPTTest);
 CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(JlibIPTTest, "JlibIPTTest");
 
+// Generates a store shaped like a Dali workunit/file branch: many sibling nodes, each with attributes and a few children
+static void generateStore(StringBuffer &xml, unsigned numItems)
+{
+    static const char *states[] = { "completed", "failed", "running", "compiled" };
+    xml.append("<SDS><WorkUnits>");
+    for (unsigned i=0; i<numItems; i++)
+    {
+        xml.appendf("<W2024%07u state=\"%s\" submitID=\"user%u\" clusterName=\"thor%u\" jobName=\"job %u\" totalThorTime=\"%u\">",
+                    i, states[i % 4], i % 50, i % 4, i, i * 7);
+        xml.appendf("<Debug><targetclustertype>thor</targetclustertype><maxcompilethreads>%u</maxcompilethreads></Debug>", i % 8);
+        xml.appendf("<Query fetchEntire=\"1\"><Associated><File desc=\"a%u.cpp\" filename=\"/var/lib/a%u.so\" type=\"dll\"/></Associated></Query>", i, i);
+        xml.append("<Results>");
+        for (unsigned r=0; r<3; r++)
+            xml.appendf("<Result name=\"Result %u\" sequence=\"%u\" status=\"calculated\"><rowCount>%u</rowCount></Result>", r+1, r, i+r);
+        xml.appendf("</Results></W2024%07u>", i);
+    }
+    xml.append("</WorkUnits></SDS>");
+}
+
+class JlibIPTMemoryTiming : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE(JlibIPTMemoryTiming);
+        CPPUNIT_TEST(testStoreMemory);
+    CPPUNIT_TEST_SUITE_END();
+
+    IPropertyTree *measure(const char *title, const StringBuffer &xml, byte flags)
+    {
+        ProcessInfo before(ReadMemoryInfo);
+        CCycleTimer timer;
+        Owned<IPropertyTree> tree = createPTreeFromXMLString(xml.str(), flags);
+        unsigned elapsedMs = timer.elapsedMs();
+        ProcessInfo after(ReadMemoryInfo);
+        __int64 used = (__int64)after.getActiveResidentMemory() - (__int64)before.getActiveResidentMemory();
+        DBGLOG("%s: xml=%u bytes, resident delta=%" I64F "d bytes (%.2fx xml), load=%u ms", title, xml.length(), used, (double)used/xml.length(), elapsedMs);
+        CPPUNIT_ASSERT(tree->hasProp("WorkUnits"));
+        return tree.getClear();
+    }
+
+public:
+    void testStoreMemory()
+    {
+        StringBuffer xml;
+        generateStore(xml, 200000);
+        // NB: trees are kept alive so that the second load cannot reuse memory freed by the first
+        Owned<IPropertyTree> lowmem = measure("lowmem ptree (atom names, compact children)", xml, ipt_lowmem);
+        Owned<IPropertyTree> fast = measure("default ptree", xml, ipt_none);
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(JlibIPTMemoryTiming);
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(JlibIPTMemoryTiming, "JlibIPTMemoryTiming");
+
+class JlibIPTParseTiming : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE(JlibIPTParseTiming);
+        CPPUNIT_TEST(testParseXML);
+        CPPUNIT_TEST(testParseJSON);
+    CPPUNIT_TEST_SUITE_END();
+
+    void timeParse(const char *title, unsigned len, std::function<IPropertyTree *()> parse)
+    {
+        CCycleTimer timer;
+        Owned<IPropertyTree> tree = parse();
+        unsigned elapsedMs = timer.elapsedMs();
+        DBGLOG("%s: %u bytes in %u ms (%.1f MB/s)", title, len, elapsedMs, elapsedMs ? (double)len / 1000.0 / elapsedMs : 0.0);
+        CPPUNIT_ASSERT(tree);
+    }
+
+public:
+    void testParseXML()
+    {
+        StringBuffer xml;
+        generateStore(xml, 100000);
+        timeParse("xml string reader", xml.length(), [&]() { return createPTreeFromXMLString(xml.str()); });
+        timeParse("xml buffer reader", xml.length(), [&]() { return createPTreeFromXMLString(xml.length(), xml.str()); });
+        Owned<IPropertyTree> tree = createPTreeFromXMLString(xml.length(), xml.str());
+        StringBuffer pretty;
+        toXML(tree, pretty); // indented, so also exercises whitespace skipping
+        timeParse("xml buffer reader (formatted)", pretty.length(), [&]() { return createPTreeFromXMLString(pretty.length(), pretty.str()); });
+    }
+    void testParseJSON()
+    {
+        StringBuffer xml;
+        generateStore(xml, 100000);
+        Owned<IPropertyTree> tree = createPTreeFromXMLString(xml.length(), xml.str());
+        StringBuffer json;
+        toJSON(tree, json);
+        timeParse("json string reader", json.length(), [&]() { return createPTreeFromJSONString(json.str()); });
+        timeParse("json buffer reader", json.length(), [&]() { return createPTreeFromJSONString(json.length(), json.str()); });
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(JlibIPTParseTiming);
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(JlibIPTParseTiming, "JlibIPTParseTiming");
+
 
 
 #include "jdebug.hpp"
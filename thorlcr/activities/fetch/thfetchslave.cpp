@@ -40,6 +40,7 @@
 #include "thfetchslave.ipp"
 
 #define NUMSLAVEPORTS       2
+#define PARALLEL_FETCHES_PER_STRAND 16
 
 struct FPosTableEntryIFileIO : public FPosTableEntry
 {
@@ -83,6 +84,10 @@ protected:
     CActivityBase &owner;
     Linked<IThorRowInterfaces> keyRowIf, fetchRowIf;
     StringAttr logicalFilename;
+    // If more than one strand is requested, blocks of keys are fetched in parallel and the results returned in order
+    unsigned parallelFetches;
+    std::vector<OwnedConstThorRow> fetchedRows;
+    unsigned curFetched = 0;
 
     class CFPosHandler : implements IHash, public CSimpleInterface
     {
@@ -124,9 +129,9 @@ protected:
 public:
     IMPLEMENT_IINTERFACE_USING(CSimpleInterface);
 
-    CFetchStream(CActivityBase &_owner, IThorRowInterfaces *_keyRowIf, IThorRowInterfaces *_fetchRowIf, bool &_abortSoon, const char *_logicalFilename, CPartDescriptorArray &_parts, unsigned _offsetCount, size32_t offsetMapSz, const void *offsetMap, IFetchHandler *_iFetchHandler, mptag_t _tag, IExpander *_eexp)
+    CFetchStream(CActivityBase &_owner, IThorRowInterfaces *_keyRowIf, IThorRowInterfaces *_fetchRowIf, bool &_abortSoon, const char *_logicalFilename, CPartDescriptorArray &_parts, unsigned _offsetCount, size32_t offsetMapSz, const void *offsetMap, IFetchHandler *_iFetchHandler, mptag_t _tag, IExpander *_eexp, unsigned _parallelFetches)
         : owner(_owner), keyRowIf(_keyRowIf), fetchRowIf(_fetchRowIf), abortSoon(_abortSoon), logicalFilename(_logicalFilename),
-          iFetchHandler(_iFetchHandler), offsetCount(_offsetCount), tag(_tag), eexp(_eexp)
+          iFetchHandler(_iFetchHandler), offsetCount(_offsetCount), tag(_tag), eexp(_eexp), parallelFetches(_parallelFetches)
     {
         distributor = NULL;
         fposHash = NULL;
@@ -201,6 +206,8 @@ public:
     }
     virtual void stop()
     {
+        fetchedRows.clear();
+        curFetched = 0;
         if (keyOutStream)
         {
             keyOutStream->stop();
@@ -213,52 +220,91 @@ public:
         }
         stopInput();
     }
+    const void *fetchRow(const void *keyRec)
+    {
+        offset_t fpos = iFetchHandler->extractFpos(keyRec);
+        switch (files)
+        {
+            case 0:
+                assertex(false);
+            case 1:
+            {
+                unsigned __int64 localFpos;
+                if (isLocalFpos(fpos))
+                    localFpos = getLocalFposOffset(fpos);
+                else
+                    localFpos = fpos-fPosMultiPartTable[0].base;
+                RtlDynamicRowBuilder row(fetchRowIf->queryRowAllocator());
+                size32_t sz = iFetchHandler->fetch(row, keyRec, 0, localFpos, fpos);
+                if (sz)
+                    return row.finalizeRowClear(sz);
+                break;
+            }
+            default:
+            {
+                // which of multiple parts this slave is dealing with.
+                FPosTableEntryIFileIO *result = (FPosTableEntryIFileIO *)bsearch(&fpos, fPosMultiPartTable, files, sizeof(FPosTableEntryIFileIO), partLookup);
+                unsigned __int64 localFpos;
+                if (isLocalFpos(fpos))
+                    localFpos = getLocalFposOffset(fpos);
+                else
+                    localFpos = fpos-result->base;
+                RtlDynamicRowBuilder row(fetchRowIf->queryRowAllocator());
+                size32_t sz = iFetchHandler->fetch(row, keyRec, result->index, localFpos, fpos);
+                if (sz)
+                    return row.finalizeRowClear(sz);
+                break;
+            }
+        }
+        return NULL;
+    }
+    const void *nextParallelRow()
+    {
+        for (;;)
+        {
+            while (curFetched < fetchedRows.size())
+            {
+                const void *row = fetchedRows[curFetched++].getClear();
+                if (row)
+                    return row;
+            }
+            if (abortSoon)
+                return NULL;
+            std::vector<OwnedConstThorRow> keys;
+            unsigned maxKeys = parallelFetches * PARALLEL_FETCHES_PER_STRAND;
+            while (keys.size() < maxKeys)
+            {
+                OwnedConstThorRow keyRec = keyOutStream->nextRow();
+                if (!keyRec)
+                    break;
+                keys.emplace_back(keyRec.getClear());
+            }
+            if (keys.empty())
+                return NULL;
+            fetchedRows.clear();
+            fetchedRows.resize(keys.size());
+            curFetched = 0;
+            asyncFor(keys.size(), parallelFetches, true, [&](unsigned i)
+            {
+                fetchedRows[i].setown(fetchRow(keys[i]));
+            });
+        }
+    }
     const void *nextRow()
     {
         if (abortSoon)
             return NULL;
 
+        if (parallelFetches > 1)
+            return nextParallelRow();
         for (;;)
         {
             OwnedConstThorRow keyRec = keyOutStream->nextRow(); // is this right?
             if (!keyRec)
                 break;
-
-            offset_t fpos = iFetchHandler->extractFpos(keyRec);
-            switch (files)
-            {
-                case 0:
-                    assertex(false);
-                case 1:
-                {
-                    unsigned __int64 localFpos;
-                    if (isLocalFpos(fpos))
-                        localFpos = getLocalFposOffset(fpos);
-                    else
-                        localFpos = fpos-fPosMultiPartTable[0].base;
-                    RtlDynamicRowBuilder row(fetchRowIf->queryRowAllocator());
-                    size32_t sz = iFetchHandler->fetch(row, keyRec, 0, localFpos, fpos);
-                    if (sz)
-                        return row.finalizeRowClear(sz);
-                    break;
-                }
-                default:
-                {
-                    // which of multiple parts this slave is dealing with.
-                    FPosTableEntryIFileIO *result = (FPosTableEntryIFileIO *)bsearch(&fpos, fPosMultiPartTable, files, sizeof(FPosTableEntryIFileIO), partLookup);
-                    unsigned __int64 localFpos;
-                    if (isLocalFpos(fpos))
-                        localFpos = getLocalFposOffset(fpos);
-                    else
-                        localFpos = fpos-result->base;
-                    RtlDynamicRowBuilder row(fetchRowIf->queryRowAllocator());
-                    size32_t sz = iFetchHandler->fetch(row, keyRec, result->index, localFpos, fpos);
-                    if (sz)
-                        return row.finalizeRowClear(sz);
-                    break;
-                }
-            }
-
+            const void *row = fetchRow(keyRec);
+            if (row)
+                return row;
         }
         return NULL;
     }
@@ -290,9 +336,9 @@ public:
 };
 
 
-IFetchStream *createFetchStream(CSlaveActivity &owner, IThorRowInterfaces *keyRowIf, IThorRowInterfaces *fetchRowIf, bool &abortSoon, const char *logicalFilename, CPartDescriptorArray &parts, unsigned offsetCount, size32_t offsetMapSz, const void *offsetMap, IFetchHandler *iFetchHandler, mptag_t tag, IExpander *eexp)
+IFetchStream *createFetchStream(CSlaveActivity &owner, IThorRowInterfaces *keyRowIf, IThorRowInterfaces *fetchRowIf, bool &abortSoon, const char *logicalFilename, CPartDescriptorArray &parts, unsigned offsetCount, size32_t offsetMapSz, const void *offsetMap, IFetchHandler *iFetchHandler, mptag_t tag, IExpander *eexp, unsigned parallelFetches)
 {
-    return new CFetchStream(owner, keyRowIf, fetchRowIf, abortSoon, logicalFilename, parts, offsetCount, offsetMapSz, offsetMap, iFetchHandler, tag, eexp);
+    return new CFetchStream(owner, keyRowIf, fetchRowIf, abortSoon, logicalFilename, parts, offsetCount, offsetMapSz, offsetMap, iFetchHandler, tag, eexp, parallelFetches);
 }
 
 class CFetchSlaveBase : public CSlaveActivity, implements IFetchHandler
@@ -318,6 +364,7 @@ protected:
     Owned<IRowStream> keyIn;
     bool indexRowExtractNeeded = false;
     mptag_t mptag = TAG_NULL;
+    unsigned parallelFetches = 1; // only set by activities whose fetch() can be called concurrently
 
     IPointerArrayOf<ISourceRowPrefetcher> prefetchers;
     IConstPointerArrayOf<ITranslator> translators;
@@ -515,7 +562,7 @@ public:
         OwnedRoxieString fileName = fetchBaseHelper->getFileName();
         {
             CriticalBlock b(fetchStreamCS);
-            fetchStream.setown(createFetchStream(*this, keyInIf, rowIf, abortSoon, fileName, parts, offsetCount, offsetMapSz, offsetMapBytes.toByteArray(), this, mptag, eexp));
+            fetchStream.setown(createFetchStream(*this, keyInIf, rowIf, abortSoon, fileName, parts, offsetCount, offsetMapSz, offsetMapBytes.toByteArray(), this, mptag, eexp, parallelFetches));
         }
         fetchStreamOut = fetchStream->queryOutput();
         fetchStream->start(keyIn);
@@ -594,7 +641,13 @@ public:
 class CFetchSlaveActivity : public CFetchSlaveBase
 {
 public:
-    CFetchSlaveActivity(CGraphElementBase *container) : CFetchSlaveBase(container) { }
+    CFetchSlaveActivity(CGraphElementBase *container) : CFetchSlaveBase(container)
+    {
+        // Each fetch reads through its own stream, so the fetches can be spread over the strands requested by the graph
+        CThorStrandOptions strandOptions(*container);
+        if (strandOptions.numStrands > 1)
+            parallelFetches = strandOptions.numStrands;
+    }
     virtual size32_t fetch(ARowBuilder & rowBuilder, const void *keyRow, unsigned filePartIndex, unsigned __int64 localFpos, unsigned __int64 fpos)
     {
         Owned<IFileIO> partIO = fetchStream->getPartIO(filePartIndex);
@@ -49,23 +49,65 @@ public:
 };
 
 
+static constexpr unsigned filterBlockSize = 64;
+
 class CFilterSlaveActivity : public CFilterSlaveActivityBase, public CThorSteppable
 {
     typedef CFilterSlaveActivityBase PARENT;
 
     IHThorFilterArg *helper;
     unsigned matched;
+    // Unless the input is being stepped, rows are read and filtered a block at a time
+    std::unique_ptr<RtlFilterBlock> block;
+    bool endOfGroup = false;
+
+    void clearBlock()
+    {
+        block->reset();
+        endOfGroup = false;
+    }
+    const void *nextBlockRow()
+    {
+        while (!abortSoon)
+        {
+            const void *row = block->nextResult();
+            if (row)
+            {
+                matched++;
+                anyThisGroup = true;
+                dataLinkIncrement();
+                return row;
+            }
+            const void *firstRow = nullptr;
+            if (endOfGroup)
+            {
+                endOfGroup = false;
+                if (anyThisGroup)
+                {
+                    anyThisGroup = false;
+                    break;
+                }
+                firstRow = inputStream->nextRow();
+                if (!firstRow)
+                    break;
+            }
+            endOfGroup = block->fill(*inputStream, firstRow);
+        }
+        return nullptr;
+    }
 
 public:
     CFilterSlaveActivity(CGraphElementBase *container)
         : CFilterSlaveActivityBase(container), CThorSteppable(this)
     {
         helper = static_cast <IHThorFilterArg *> (queryHelper());
+        block.reset(new RtlFilterBlock(*helper, filterBlockSize));
     }
     virtual void start() override
     {   
         ActivityTimer s(slaveTimerStats, timeActivities);
         matched = 0;
+        clearBlock();
         if (helper->canMatchAny())
             PARENT::start();
         else
@@ -75,9 +117,16 @@ public:
             stopInput(0);
         }
     }
+    virtual void stop() override
+    {
+        clearBlock();
+        PARENT::stop();
+    }
     CATCH_NEXTROW()
     {
         ActivityTimer t(slaveTimerStats, timeActivities);
+        if (!inputStepping)
+            return nextBlockRow();
         while (!abortSoon)
         {
             OwnedConstThorRow row = inputStream->nextRow();
@@ -148,6 +197,7 @@ public:
     { 
         abortSoon = !helper->canMatchAny();
         anyThisGroup = false;
+        clearBlock();
         inputStream->resetEOF();
     }
 // steppable
@@ -159,6 +209,100 @@ public:
     virtual IInputSteppingMeta *querySteppingMeta() { return CThorSteppable::inputStepping; }
 };
 
+class CFilterStrandProcessor : public CThorStrandProcessor
+{
+    IHThorFilterArg *helper;
+    std::unique_ptr<RtlFilterBlock> block;
+    bool endOfGroup = false;
+    bool eof = false;
+
+public:
+    explicit CFilterStrandProcessor(CThorStrandedActivity &parent, IEngineRowStream *inputStream, unsigned outputId)
+        : CThorStrandProcessor(parent, inputStream, outputId)
+    {
+        helper = static_cast <IHThorFilterArg *> (queryHelper());
+        block.reset(new RtlFilterBlock(*helper, filterBlockSize));
+    }
+    virtual void start() override
+    {
+        CThorStrandProcessor::start();
+        block->reset();
+        endOfGroup = false;
+        eof = !helper->canMatchAny();
+    }
+    virtual void stop() override
+    {
+        block->reset();
+        CThorStrandProcessor::stop();
+    }
+    virtual void resetEOF() override
+    {
+        block->reset();
+        endOfGroup = false;
+        eof = !helper->canMatchAny();
+        CThorStrandProcessor::resetEOF();
+    }
+    STRAND_CATCH_NEXTROW()
+    {
+        ActivityTimer t(slaveTimerStats, timeActivities);
+        if (eof)
+            return nullptr;
+        for (;;)
+        {
+            const void *row = block->nextResult();
+            if (row)
+            {
+                rowsProcessed++;
+                return row;
+            }
+            if (parent.queryAbortSoon())
+                return nullptr;
+            const void *firstRow = nullptr;
+            if (endOfGroup)
+            {
+                endOfGroup = false;
+                if (numProcessedLastGroup != rowsProcessed)
+                {
+                    numProcessedLastGroup = rowsProcessed;
+                    return nullptr;
+                }
+                // Nothing was output for the last group, so do not output an empty group - and two ends of group in a row is eof
+                firstRow = inputStream->nextRow();
+                if (!firstRow)
+                    return nullptr;
+            }
+            endOfGroup = block->fill(*inputStream, firstRow);
+        }
+    }
+};
+
+
+// Used when the graph requests the filter is executed in parallel.  The strands cannot support stepping (nextRowGE),
+// so the single stranded CFilterSlaveActivity is used otherwise.
+class CStrandedFilterSlaveActivity : public CThorStrandedActivity
+{
+public:
+    explicit CStrandedFilterSlaveActivity(CGraphElementBase *_container) : CThorStrandedActivity(_container)
+    {
+        setRequireInitData(false);
+        appendOutputLinked(this);
+    }
+    virtual CThorStrandProcessor *createStrandProcessor(IEngineRowStream *instream) override
+    {
+        return new CFilterStrandProcessor(*this, instream, 0);
+    }
+    virtual CThorStrandProcessor *createStrandSourceProcessor(bool inputOrdered) override { throwUnexpected(); }
+
+// IThorDataLink
+    virtual void getMetaInfo(ThorDataLinkMetaInfo &info) const override
+    {
+        initMetaInfo(info);
+        info.canReduceNumRows = true;
+        calcMetaInfoSize(info, queryInput(0));
+    }
+    virtual bool isGrouped() const override { return queryInput(0)->isGrouped(); }
+};
+
 class CFilterProjectSlaveActivity : public CFilterSlaveActivityBase
 {
     typedef CFilterSlaveActivityBase PARENT;
@@ -412,6 +556,9 @@ public:
 
 CActivityBase *createFilterSlave(CGraphElementBase *container)
 {
+    CThorStrandOptions strandOptions(*container);
+    if (strandOptions.numStrands > 1)
+        return new CStrandedFilterSlaveActivity(container);
     return new CFilterSlaveActivity(container);
 }
 
@@ -25,65 +25,89 @@
 #include "thexception.hpp"
 
 
-class NormalizeSlaveActivity : public CSlaveActivity
+class CNormalizeStrandProcessor : public CThorStrandProcessor
 {
-    typedef CSlaveActivity PARENT;
-
-    IHThorNormalizeArg * helper;
-    OwnedConstThorRow row;
-    unsigned curRow;
-    unsigned numThisRow;
-    bool anyThisGroup;
+    IHThorNormalizeArg *helper;
     Owned<IEngineRowAllocator> allocator;
-
+    OwnedConstThorRow row;
+    unsigned curRow = 0;
+    unsigned numThisRow = 0;
 
 public:
-    NormalizeSlaveActivity(CGraphElementBase *_container) 
-        : CSlaveActivity(_container)
+    explicit CNormalizeStrandProcessor(CThorStrandedActivity &parent, IEngineRowStream *inputStream, unsigned outputId)
+        : CThorStrandProcessor(parent, inputStream, outputId)
     {
         helper = static_cast <IHThorNormalizeArg *> (queryHelper());
-        allocator.set(queryRowAllocator());
-        setRequireInitData(false);
-        appendOutputLinked(this);
+        Owned<IRowInterfaces> rowIf = parent.getRowInterfaces();
+        allocator.setown(parent.getRowAllocator(rowIf->queryRowMetaData(), (parent.queryHeapFlags()|roxiemem::RHFpacked|roxiemem::RHFunique)));
     }
     virtual void start() override
-    { 
-        ActivityTimer s(slaveTimerStats, timeActivities);
-        PARENT::start();
+    {
+        CThorStrandProcessor::start();
+        row.clear();
+        curRow = 0;
         numThisRow = 0;
+    }
+    virtual void stop() override
+    {
+        row.clear();
+        CThorStrandProcessor::stop();
+    }
+    virtual void resetEOF() override
+    {
+        row.clear();
         curRow = 0;
-        anyThisGroup = false;
+        numThisRow = 0;
+        CThorStrandProcessor::resetEOF();
     }
-    CATCH_NEXTROW()
+    STRAND_CATCH_NEXTROW()
     {
         ActivityTimer t(slaveTimerStats, timeActivities);
         for (;;)
         {
             while (curRow == numThisRow)
             {
-                if (abortSoon) 
-                    return NULL;
+                if (parent.queryAbortSoon())
+                    return nullptr;
                 row.setown(inputStream->nextRow());
-                if (!row&&!anyThisGroup)
-                    row.setown(inputStream->nextRow());
-                if(!row) {
-                    anyThisGroup = false;
-                    return NULL;
+                if (!row)
+                {
+                    if (numProcessedLastGroup == rowsProcessed)
+                        row.setown(inputStream->nextRow());
+                    if (!row)
+                    {
+                        numProcessedLastGroup = rowsProcessed;
+                        return nullptr;
+                    }
                 }
                 curRow = 0;
                 numThisRow = helper->numExpandedRows(row);
             }
-            if (abortSoon) 
-                return NULL;
             RtlDynamicRowBuilder ret(allocator);
             size32_t sz = helper->transform(ret, row, ++curRow);
-            if (sz!=0) {
-                anyThisGroup = true;
-                dataLinkIncrement();
+            if (sz != 0)
+            {
+                rowsProcessed++;
                 return ret.finalizeRowClear(sz);
             }
         }
     }
+};
+
+
+class CNormalizeSlaveActivity : public CThorStrandedActivity
+{
+public:
+    explicit CNormalizeSlaveActivity(CGraphElementBase *_container) : CThorStrandedActivity(_container)
+    {
+        setRequireInitData(false);
+        appendOutputLinked(this);
+    }
+    virtual CThorStrandProcessor *createStrandProcessor(IEngineRowStream *instream) override
+    {
+        return new CNormalizeStrandProcessor(*this, instream, 0);
+    }
+    virtual CThorStrandProcessor *createStrandSourceProcessor(bool inputOrdered) override { throwUnexpected(); }
     virtual bool isGrouped() const override { return queryInput(0)->isGrouped(); }
     virtual void getMetaInfo(ThorDataLinkMetaInfo &info) const override
     {
@@ -245,21 +269,204 @@ public:
 };
 
 
+// The child iterators hold their state in the helper, so each strand creates its own instance of the helper
+class CNormalizeChildStrandProcessor : public CThorStrandProcessor
+{
+    Owned<IHThorNormalizeChildArg> helper;
+    INormalizeChildIterator *cursor = nullptr;
+    Owned<IEngineRowAllocator> allocator;
+    OwnedConstThorRow childBuf;
+    void *curChildRow = nullptr;
+    unsigned curRow = 0;
+
+public:
+    explicit CNormalizeChildStrandProcessor(CThorStrandedActivity &parent, IEngineRowStream *inputStream, unsigned outputId)
+        : CThorStrandProcessor(parent, inputStream, outputId)
+    {
+        Owned<IRowInterfaces> rowIf = parent.getRowInterfaces();
+        allocator.setown(parent.getRowAllocator(rowIf->queryRowMetaData(), (parent.queryHeapFlags()|roxiemem::RHFpacked|roxiemem::RHFunique)));
+    }
+    virtual void start() override
+    {
+        CThorStrandProcessor::start();
+        if (!helper)
+        {
+            helper.setown(static_cast <IHThorNormalizeChildArg *> (parent.queryContainer().createStrandHelper()));
+            cursor = helper->queryIterator();
+        }
+        parent.queryContainer().startStrandHelper(*helper);
+        childBuf.clear();
+        curChildRow = nullptr;
+    }
+    virtual void stop() override
+    {
+        childBuf.clear();
+        curChildRow = nullptr;
+        CThorStrandProcessor::stop();
+    }
+    virtual void resetEOF() override
+    {
+        childBuf.clear();
+        curChildRow = nullptr;
+        CThorStrandProcessor::resetEOF();
+    }
+    STRAND_CATCH_NEXTROW()
+    {
+        ActivityTimer t(slaveTimerStats, timeActivities);
+        for (;;)
+        {
+            while (!curChildRow)
+            {
+                if (parent.queryAbortSoon())
+                    return nullptr;
+                curRow = 0;
+                childBuf.setown(inputStream->nextRow());
+                if (!childBuf)
+                {
+                    if (numProcessedLastGroup == rowsProcessed)
+                        childBuf.setown(inputStream->nextRow());
+                    if (!childBuf)
+                    {
+                        numProcessedLastGroup = rowsProcessed;
+                        return nullptr;
+                    }
+                }
+                curChildRow = cursor->first(childBuf);
+            }
+            RtlDynamicRowBuilder ret(allocator);
+            size32_t sz = helper->transform(ret, childBuf, curChildRow, ++curRow);
+            curChildRow = cursor->next();
+            if (sz)
+            {
+                rowsProcessed++;
+                return ret.finalizeRowClear(sz);
+            }
+        }
+    }
+};
+
+class CNormalizeLinkedChildStrandProcessor : public CThorStrandProcessor
+{
+    Owned<IHThorNormalizeLinkedChildArg> helper;
+    OwnedConstThorRow curParent;
+    OwnedConstThorRow curChild;
+
+    bool advanceInput()
+    {
+        for (;;)
+        {
+            if (parent.queryAbortSoon())
+                return false;
+            curParent.setown(inputStream->nextRow());
+            if (!curParent)
+            {
+                if (numProcessedLastGroup != rowsProcessed)
+                {
+                    numProcessedLastGroup = rowsProcessed;
+                    return false;
+                }
+                curParent.setown(inputStream->nextRow());
+                if (!curParent)
+                    return false;
+            }
+            curChild.set(helper->first(curParent));
+            if (curChild)
+                return true;
+        }
+    }
+
+public:
+    explicit CNormalizeLinkedChildStrandProcessor(CThorStrandedActivity &parent, IEngineRowStream *inputStream, unsigned outputId)
+        : CThorStrandProcessor(parent, inputStream, outputId)
+    {
+    }
+    virtual void start() override
+    {
+        CThorStrandProcessor::start();
+        if (!helper)
+            helper.setown(static_cast <IHThorNormalizeLinkedChildArg *> (parent.queryContainer().createStrandHelper()));
+        parent.queryContainer().startStrandHelper(*helper);
+        curParent.clear();
+        curChild.clear();
+    }
+    virtual void stop() override
+    {
+        curParent.clear();
+        curChild.clear();
+        CThorStrandProcessor::stop();
+    }
+    virtual void resetEOF() override
+    {
+        curParent.clear();
+        curChild.clear();
+        CThorStrandProcessor::resetEOF();
+    }
+    STRAND_CATCH_NEXTROW()
+    {
+        ActivityTimer t(slaveTimerStats, timeActivities);
+        for (;;)
+        {
+            if (!curParent)
+            {
+                if (!advanceInput())
+                    return nullptr;
+            }
+            OwnedConstThorRow ret = curChild.getClear();
+            curChild.set(helper->next());
+            if (!curChild)
+                curParent.clear();
+            if (ret)
+            {
+                rowsProcessed++;
+                return ret.getClear();
+            }
+        }
+    }
+};
+
+// Used when the graph requests the child normalize is executed in parallel
+template <class STRANDPROCESSOR>
+class CStrandedNormalizeChildSlaveActivity : public CThorStrandedActivity
+{
+public:
+    explicit CStrandedNormalizeChildSlaveActivity(CGraphElementBase *_container) : CThorStrandedActivity(_container)
+    {
+        setRequireInitData(false);
+        appendOutputLinked(this);
+    }
+    virtual CThorStrandProcessor *createStrandProcessor(IEngineRowStream *instream) override
+    {
+        return new STRANDPROCESSOR(*this, instream, 0);
+    }
+    virtual CThorStrandProcessor *createStrandSourceProcessor(bool inputOrdered) override { throwUnexpected(); }
+    virtual bool isGrouped() const override { return queryInput(0)->isGrouped(); }
+    virtual void getMetaInfo(ThorDataLinkMetaInfo &info) const override
+    {
+        initMetaInfo(info);
+        info.unknownRowsOutput = true;
+        info.canIncreaseNumRows = true;
+    }
+};
+
+
 CActivityBase *createNormalizeChildSlave(CGraphElementBase *container)
 {
+    CThorStrandOptions strandOptions(*container);
+    if (strandOptions.numStrands > 1)
+        return new CStrandedNormalizeChildSlaveActivity<CNormalizeChildStrandProcessor>(container);
     return new CNormalizeChildSlaveActivity(container);
 }
 
 CActivityBase *createNormalizeLinkedChildSlave(CGraphElementBase *container)
 {
+    CThorStrandOptions strandOptions(*container);
+    if (strandOptions.numStrands > 1)
+        return new CStrandedNormalizeChildSlaveActivity<CNormalizeLinkedChildStrandProcessor>(container);
     return new CNormalizeLinkedChildSlaveActivity(container);
 }
 
 
 CActivityBase *createNormalizeSlave(CGraphElementBase *container)
 {
-    return new NormalizeSlaveActivity(container);
+    return new CNormalizeSlaveActivity(container);
 }
-
-
-
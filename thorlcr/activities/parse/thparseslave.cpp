@@ -28,90 +28,114 @@
 
 #include "thparseslave.ipp"
 
-class CParseSlaveActivity : public CSlaveActivity, implements IMatchedAction
+class CParseStrandProcessor : public CThorStrandProcessor, implements IMatchedAction
 {
-    typedef CSlaveActivity PARENT;
-
     IHThorParseArg *helper;
     OwnedConstThorRow curRow;
-    Owned<INlpParseAlgorithm> algorithm;
     Owned<INlpParser> parser;
-    bool anyThisGroup;
-    char * curSearchText;
-    size32_t curSearchTextLen;
     INlpResultIterator * rowIter;
-    Owned<IEngineRowAllocator> allocator;
+    char * curSearchText = nullptr;
+    size32_t curSearchTextLen = 0;
 
-public:
-    CParseSlaveActivity(CGraphElementBase *_container) : CSlaveActivity(_container)
+    void freeSearchText()
     {
-        helper = (IHThorParseArg *)queryHelper();
-        anyThisGroup = false;
+        if (helper->searchTextNeedsFree())
+            rtlFree(curSearchText);
         curSearchTextLen = 0;
-        curSearchText = NULL;
-        algorithm.setown(createThorParser(queryCodeContext(), *helper));
-        parser.setown(algorithm->createParser(queryCodeContext(), (unsigned)container.queryId(), helper->queryHelper(), helper));
+        curSearchText = nullptr;
+    }
+    void processRecord(const void * in)
+    {
+        freeSearchText();
+        helper->getSearchText(curSearchTextLen, curSearchText, in);
+        parser->performMatch(*this, in, curSearchTextLen, curSearchText);
+    }
+
+public:
+    // Each strand needs its own parser, since the parser holds the matching state and results of the current row
+    explicit CParseStrandProcessor(CThorStrandedActivity &parent, IEngineRowStream *inputStream, unsigned outputId, INlpParseAlgorithm &algorithm)
+        : CThorStrandProcessor(parent, inputStream, outputId)
+    {
+        helper = static_cast <IHThorParseArg *> (queryHelper());
+        parser.setown(algorithm.createParser(parent.queryCodeContext(), (unsigned)parent.queryContainer().queryId(), helper->queryHelper(), helper));
         rowIter = parser->queryResultIter();
-        allocator.set(queryRowAllocator());
-        setRequireInitData(false);
-        appendOutputLinked(this);
     }
-    ~CParseSlaveActivity()
+    ~CParseStrandProcessor()
     {
-        if (helper->searchTextNeedsFree())
-            rtlFree(curSearchText);
+        freeSearchText();
     }
     virtual void start() override
     {
-        ActivityTimer s(slaveTimerStats, timeActivities);
-        PARENT::start();
+        CThorStrandProcessor::start();
+        parser->reset();
     }
     virtual void stop() override
     {
         parser->reset();
-        PARENT::stop();
+        curRow.clear();
+        CThorStrandProcessor::stop();
     }
-    void processRecord(const void * in)
+    virtual void resetEOF() override
     {
-        if (helper->searchTextNeedsFree())
-            rtlFree(curSearchText);
-
-        curSearchTextLen = 0;
-        curSearchText = NULL;
-        helper->getSearchText(curSearchTextLen, curSearchText, in);
-
-        parser->performMatch(*this, in, curSearchTextLen, curSearchText);
+        parser->reset();
+        curRow.clear();
+        CThorStrandProcessor::resetEOF();
     }
-
-    CATCH_NEXTROW()
+    STRAND_CATCH_NEXTROW()
     {
         ActivityTimer t(slaveTimerStats, timeActivities);
-        while (!abortSoon) {
-            if (rowIter->isValid()) {
-                anyThisGroup = true;
+        for (;;)
+        {
+            if (rowIter->isValid())
+            {
                 OwnedConstThorRow r = rowIter->getRow();
-                dataLinkIncrement();
                 rowIter->next();
+                rowsProcessed++;
                 return r.getClear();
             }
+            if (parent.queryAbortSoon())
+                return nullptr;
             curRow.setown(inputStream->nextRow());
-
-            if (!curRow) {
-                if (anyThisGroup) {
-                    anyThisGroup = false;
-                    break;
-                }
-                curRow.setown(inputStream->nextRow());
+            if (!curRow)
+            {
+                if (numProcessedLastGroup == rowsProcessed)
+                    curRow.setown(inputStream->nextRow());
                 if (!curRow)
-                    break;
+                {
+                    numProcessedLastGroup = rowsProcessed;
+                    return nullptr;
+                }
             }
-
             processRecord(curRow.get());
             rowIter->first();
         }
-        
-        return NULL;
     }
+// IMatchedAction impl.
+    virtual size32_t onMatch(ARowBuilder & rowBuilder, const void * row, IMatchedResults *results, IMatchWalker * walker) override
+    {
+        return helper->transform(rowBuilder, row, results, walker);
+    }
+};
+
+
+class CParseSlaveActivity : public CThorStrandedActivity
+{
+    IHThorParseArg *helper;
+    Owned<INlpParseAlgorithm> algorithm;
+
+public:
+    CParseSlaveActivity(CGraphElementBase *_container) : CThorStrandedActivity(_container)
+    {
+        helper = (IHThorParseArg *)queryHelper();
+        algorithm.setown(createThorParser(queryCodeContext(), *helper));
+        setRequireInitData(false);
+        appendOutputLinked(this);
+    }
+    virtual CThorStrandProcessor *createStrandProcessor(IEngineRowStream *instream) override
+    {
+        return new CParseStrandProcessor(*this, instream, 0, *algorithm);
+    }
+    virtual CThorStrandProcessor *createStrandSourceProcessor(bool inputOrdered) override { throwUnexpected(); }
     virtual bool isGrouped() const override
     { 
         return queryInput(0)->isGrouped();
@@ -121,11 +145,6 @@ public:
         initMetaInfo(info);
         info.unknownRowsOutput = true;
     }
-// IMatchedAction impl.
-    size32_t onMatch(ARowBuilder & rowBuilder, const void * row, IMatchedResults *results, IMatchWalker * walker)
-    {
-        return helper->transform(rowBuilder, row, results, walker);
-    }
 };
 
 CActivityBase *createParseSlave(CGraphElementBase *container)
@@ -22,8 +22,12 @@
 
 class CProjecStrandProcessor : public CThorStrandProcessor
 {
+    static constexpr unsigned projectBlockSize = 64;
+
     IHThorProjectArg *helper;
     Owned<IEngineRowAllocator> allocator;
+    std::unique_ptr<RtlProjectBlock> block;
+    bool endOfGroup = false;
 
 public:
     explicit CProjecStrandProcessor(CThorStrandedActivity &parent, IEngineRowStream *inputStream, unsigned outputId)
@@ -32,42 +36,63 @@ public:
         helper = static_cast <IHThorProjectArg *> (queryHelper());
         Owned<IRowInterfaces> rowIf = parent.getRowInterfaces();
         allocator.setown(parent.getRowAllocator(rowIf->queryRowMetaData(), (parent.queryHeapFlags()|roxiemem::RHFpacked|roxiemem::RHFunique)));
+        block.reset(new RtlProjectBlock(*helper, allocator, projectBlockSize));
+    }
+    virtual void start() override
+    {
+        CThorStrandProcessor::start();
+        block->reset();
+        endOfGroup = false;
+    }
+    virtual void stop() override
+    {
+        block->reset();
+        CThorStrandProcessor::stop();
+    }
+    virtual void resetEOF() override
+    {
+        block->reset();
+        endOfGroup = false;
+        CThorStrandProcessor::resetEOF();
     }
     STRAND_CATCH_NEXTROW()
     {
         ActivityTimer t(slaveTimerStats, timeActivities);
         for (;;)
         {
+            const void *ret = block->nextResult();
+            if (ret)
+            {
+                rowsProcessed++;
+                return ret;
+            }
             if (parent.queryAbortSoon())
                 return nullptr;
-            OwnedConstThorRow in = inputStream->nextRow();
-            if (!in)
+
+            // Read a block of rows (up to the end of the group), and transform them with a single call to the helper
+            const void *firstRow = nullptr;
+            if (endOfGroup)
             {
-                if (numProcessedLastGroup == rowsProcessed)
-                    in.setown(inputStream->nextRow());
-                if (!in)
+                endOfGroup = false;
+                if (numProcessedLastGroup != rowsProcessed)
                 {
                     numProcessedLastGroup = rowsProcessed;
                     return nullptr;
                 }
+                // Nothing was output for the last group, so do not output an empty group - and two ends of group in a row is eof
+                firstRow = inputStream->nextRow();
+                if (!firstRow)
+                    return nullptr;
             }
-
-            RtlDynamicRowBuilder rowBuilder(allocator);
-            size32_t outSize;
             try
             {
-                outSize = helper->transform(rowBuilder, in);
+                endOfGroup = block->fill(*inputStream, firstRow);
             }
             catch (IException *e)
             {
                 parent.ActPrintLog(e, "In helper->transform()");
                 throw;
             }
-            if (outSize)
-            {
-                rowsProcessed++;
-                return rowBuilder.finalizeRowClear(outSize);
-            }
         }
     }
 };
@@ -22,66 +22,64 @@
 #include "thactivityutil.ipp"
 #include "eclrtl.hpp"
 
-class CXmlParseSlaveActivity : public CSlaveActivity, implements IXMLSelect
+class CXmlParseStrandProcessor : public CThorStrandProcessor, implements IXMLSelect
 {
-    typedef CSlaveActivity PARENT;
-
     IHThorXmlParseArg *helper;
-    bool eogNext;
-    bool anyThisGroup;
     Linked<IColumnProvider> lastMatch;
-    char *searchStr;
+    char *searchStr = nullptr;
     Owned<IXMLParse> xmlParser;
     OwnedConstThorRow nxt;
     Owned<IEngineRowAllocator> allocator;
 
+    void clearParse()
+    {
+        xmlParser.clear();
+        lastMatch.clear();
+        nxt.clear();
+        if (searchStr && helper->searchTextNeedsFree())
+            rtlFree(searchStr);
+        searchStr = nullptr;
+    }
+
 public:
-    IMPLEMENT_IINTERFACE_USING(CSlaveActivity);
+    IMPLEMENT_IINTERFACE_USING(CThorStrandProcessor);
 
-    CXmlParseSlaveActivity(CGraphElementBase *_container) : CSlaveActivity(_container)
+    explicit CXmlParseStrandProcessor(CThorStrandedActivity &parent, IEngineRowStream *inputStream, unsigned outputId)
+        : CThorStrandProcessor(parent, inputStream, outputId)
     {
         helper = static_cast <IHThorXmlParseArg *> (queryHelper());
-        searchStr = NULL;
-        appendOutputLinked(this);
+        Owned<IRowInterfaces> rowIf = parent.getRowInterfaces();
+        allocator.setown(parent.getRowAllocator(rowIf->queryRowMetaData(), (parent.queryHeapFlags()|roxiemem::RHFpacked|roxiemem::RHFunique)));
+    }
+    ~CXmlParseStrandProcessor()
+    {
+        clearParse();
     }
 
 // IXMLSelect
-    virtual void match(IColumnProvider &entry, offset_t startOffset, offset_t endOffset)
+    virtual void match(IColumnProvider &entry, offset_t startOffset, offset_t endOffset) override
     {
         lastMatch.set(&entry);
     }
 
-// IThorSlaveActivity overloaded methods
-    virtual void init(MemoryBuffer &data, MemoryBuffer &slaveData)
+    virtual void start() override
     {
-        allocator.set(queryRowAllocator());
+        CThorStrandProcessor::start();
+        clearParse();
     }
-    virtual void kill()
+    virtual void stop() override
     {
-        CSlaveActivity::kill();
-        xmlParser.clear();
-        if (searchStr && helper->searchTextNeedsFree())
-            rtlFree(searchStr);
+        clearParse();
+        CThorStrandProcessor::stop();
     }
-// IThorDataLink methods
-    virtual void start() override
+    virtual void resetEOF() override
     {
-        ActivityTimer s(slaveTimerStats, timeActivities);
-        PARENT::start();
-        anyThisGroup = false;
-        eogNext = false;
+        clearParse();
+        CThorStrandProcessor::resetEOF();
     }
-    CATCH_NEXTROW()
+    STRAND_CATCH_NEXTROW()
     {
         ActivityTimer t(slaveTimerStats, timeActivities);
-        if (abortSoon)
-            return NULL;
-        if (eogNext)
-        {
-            eogNext = false;
-            anyThisGroup = false;
-            return NULL;
-        }
         try
         {
             for (;;)
@@ -95,7 +93,7 @@ public:
                             if (helper->searchTextNeedsFree())
                             {
                                 rtlFree(searchStr);
-                                searchStr = NULL;
+                                searchStr = nullptr;
                             }
                             xmlParser.clear();
                             break;
@@ -107,24 +105,30 @@ public:
                             try { sizeGot = helper->transform(row, nxt, lastMatch); }
                             catch (IException *e) 
                             { 
-                                ActPrintLog(e, "In helper->transform()");
+                                parent.ActPrintLog(e, "In helper->transform()");
                                 throw;
                             }
                             lastMatch.clear();
                             if (sizeGot == 0)
                                 continue; // not sure if this will ever be possible in this context.
-                            dataLinkIncrement();
-                            anyThisGroup = true;
-                            OwnedConstThorRow ret = row.finalizeRowClear(sizeGot);
-                            return ret.getClear();
+                            rowsProcessed++;
+                            return row.finalizeRowClear(sizeGot);
                         }
                     }
                 }
+                if (parent.queryAbortSoon())
+                    return nullptr;
                 nxt.setown(inputStream->nextRow());
-                if (!nxt && !anyThisGroup)
-                    nxt.setown(inputStream->nextRow());
                 if (!nxt)
-                    break;
+                {
+                    if (numProcessedLastGroup == rowsProcessed)
+                        nxt.setown(inputStream->nextRow());
+                    if (!nxt)
+                    {
+                        numProcessedLastGroup = rowsProcessed;
+                        return nullptr;
+                    }
+                }
                 unsigned len;
                 helper->getSearchText(len, searchStr, nxt);
                 OwnedRoxieString xmlIteratorPath(helper->getXmlIteratorPath());
@@ -134,25 +138,37 @@ public:
         catch (IOutOfMemException *e)
         {
             StringBuffer s("XMLParse actId(");
-            s.append(container.queryId()).append(") out of memory.").newline();
+            s.append(parent.queryContainer().queryId()).append(") out of memory.").newline();
             s.append("INTERNAL ERROR ").append(e->errorCode()).append(": ");
             e->errorMessage(s);
             e->Release();
-            throw MakeActivityException(this, 0, "%s", s.str());
+            throw MakeActivityException(&parent, 0, "%s", s.str());
         }
         catch (IException *e)
         {
             StringBuffer s("XMLParse actId(");
-            s.append(container.queryId());
+            s.append(parent.queryContainer().queryId());
             s.append(") INTERNAL ERROR ").append(e->errorCode()).append(": ");
             e->errorMessage(s);
             e->Release();
-            throw MakeActivityException(this, 0, "%s", s.str());
+            throw MakeActivityException(&parent, 0, "%s", s.str());
         }
-        eogNext = false;
-        anyThisGroup = false;
-        return NULL;
     }
+};
+
+
+class CXmlParseSlaveActivity : public CThorStrandedActivity
+{
+public:
+    CXmlParseSlaveActivity(CGraphElementBase *_container) : CThorStrandedActivity(_container)
+    {
+        appendOutputLinked(this);
+    }
+    virtual CThorStrandProcessor *createStrandProcessor(IEngineRowStream *instream) override
+    {
+        return new CXmlParseStrandProcessor(*this, instream, 0);
+    }
+    virtual CThorStrandProcessor *createStrandSourceProcessor(bool inputOrdered) override { throwUnexpected(); }
     virtual bool isGrouped() const override { return queryInput(0)->isGrouped(); }
     virtual void getMetaInfo(ThorDataLinkMetaInfo &info) const override
     {
@@ -619,6 +619,25 @@ void CGraphElementBase::onStart(size32_t parentExtractSz, const byte *parentExtr
         return;
     CriticalBlock b(crit);
     baseHelper->onStart(parentExtract, startCtx);
+    startParentExtract = parentExtract;
+}
+
+IHThorArg *CGraphElementBase::createStrandHelper()
+{
+    Owned<IHThorArg> helper = helperFactory();
+    CriticalBlock b(crit);
+    MemoryBuffer createCtx; // the base helper has already read createCtxMb
+    if (haveCreateCtx)
+        createCtx.append(createCtxMb.length(), createCtxMb.toByteArray());
+    CGraphElementBase *ownerActivity = owner->queryOwner() ? owner->queryOwner()->queryElement(ownerId) : NULL;
+    helper->onCreate(queryCodeContext(), ownerActivity ? ownerActivity->queryHelper() : NULL, haveCreateCtx?&createCtx:NULL);
+    return helper.getClear();
+}
+
+void CGraphElementBase::startStrandHelper(IHThorArg &helper)
+{
+    CriticalBlock b(crit);
+    helper.onStart(startParentExtract, nullptr);
 }
 
 bool CGraphElementBase::executeDependencies(size32_t parentExtractSz, const byte *parentExtract, int controlId, bool async)
@@ -430,6 +430,7 @@ protected:
     Owned<IThorBoundLoopGraph> loopGraph; // really only here as master and slave derivatives set/use
     MemoryBuffer createCtxMb, startCtxMb;
     bool haveCreateCtx;
+    const byte *startParentExtract = nullptr;
     unsigned maxCores;
     bool isCodeSigned = false;
     CActivityCodeContext activityCodeContext;
@@ -478,6 +479,8 @@ public:
     virtual void reset();
     void onStart(size32_t parentExtractSz, const byte *parentExtract, MemoryBuffer *startCtx=nullptr);
     void onCreate();
+    IHThorArg *createStrandHelper(); // another instance of the helper, for strands that cannot share the helper's state
+    void startStrandHelper(IHThorArg &helper); // starts it with the parent extract the base helper was last started with
     void abort(IException *e);
     virtual void preStart(size32_t parentExtractSz, const byte *parentExtract);
     bool isOnCreated() const { return onCreateCalled; }
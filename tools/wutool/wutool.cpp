@@ -819,11 +819,14 @@ class WuTool : public CppUnit::TestFixture
         CPPUNIT_TEST(testSet);
         CPPUNIT_TEST(testResults);
         CPPUNIT_TEST(testWorkUnitServices);
+        CPPUNIT_TEST(testLoad);
         CPPUNIT_TEST(testDelete);
         CPPUNIT_TEST(testCopy);
         CPPUNIT_TEST(testQuery);
+        CPPUNIT_TEST(testCachedSections);
         CPPUNIT_TEST(testGraph);
         CPPUNIT_TEST(testGraphProgress);
+        CPPUNIT_TEST(testIncrementalGraphProgress);
     CPPUNIT_TEST_SUITE_END();
 protected:
     static StringArray wuids;
@@ -1214,6 +1217,71 @@ protected:
         factory->deleteWorkUnit(wuid);
     }
 
+    // The query and graphs of a finished workunit may be served from a cache (e.g. by the cassandra factory) - check
+    // that a section that has been changed since it was cached is not returned stale
+    void testCachedSections()
+    {
+        Owned<IWorkUnitFactory> factory = getWorkUnitFactory();
+        Owned<IWorkUnit> createWu = factory->createWorkUnit("WuTest", NULL, NULL, NULL);
+        StringBuffer wuid(createWu->queryWuid());
+        {
+            Owned<IWUQuery> query = createWu->updateQuery();
+            query->setQueryText("Original");
+        }
+        createWu->createGraph("Graph1", "graphLabel", GraphTypeActivities, createPTreeFromXMLString("<graph/>"), 0);
+        createWu->setState(WUStateCompleted);
+        createWu->commit();
+        createWu.clear();
+
+        // Read both sections twice, so the second read may come from the cache
+        SCMStringBuffer s;
+        for (unsigned pass = 0; pass < 2; pass++)
+        {
+            Owned<IConstWorkUnit> wu = factory->openWorkUnit(wuid);
+            Owned<IConstWUQuery> query = wu->getQuery();
+            ASSERT(query);
+            ASSERT(streq(query->getQueryText(s).str(), "Original"));
+            Owned<IConstWUGraph> graph = wu->getGraph("Graph1");
+            ASSERT(graph != NULL);
+            Owned<IConstWUGraph> missing = wu->getGraph("Graph2");
+            ASSERT(!missing);
+        }
+
+        {
+            Owned<IWorkUnit> lockedWu = factory->updateWorkUnit(wuid);
+            Owned<IWUQuery> query = lockedWu->updateQuery();
+            query->setQueryText("Changed");
+            query.clear();
+            lockedWu->createGraph("Graph2", "graphLabel", GraphTypeActivities, createPTreeFromXMLString("<graph/>"), 1);
+            lockedWu->commit();
+        }
+
+        {
+            Owned<IConstWorkUnit> wu = factory->openWorkUnit(wuid);
+            Owned<IConstWUQuery> query = wu->getQuery();
+            ASSERT(query);
+            ASSERT(streq(query->getQueryText(s).str(), "Changed"));
+            Owned<IConstWUGraph> graph = wu->getGraph("Graph2");
+            ASSERT(graph != NULL);
+        }
+
+        // Changes to the rest of the workunit are seen, and the sections are still correct
+        {
+            Owned<IWorkUnit> lockedWu = factory->updateWorkUnit(wuid);
+            lockedWu->setJobName("renamed");
+            lockedWu->commit();
+        }
+        {
+            Owned<IConstWorkUnit> wu = factory->openWorkUnit(wuid);
+            Owned<IConstWUQuery> query = wu->getQuery();
+            ASSERT(query);
+            ASSERT(streq(query->getQueryText(s).str(), "Changed"));
+            ASSERT(streq(wu->queryJobName(), "renamed"));
+        }
+
+        factory->deleteWorkUnit(wuid);
+    }
+
     void testGraph()
     {
         Owned<IWorkUnitFactory> factory = getWorkUnitFactory();
@@ -1387,6 +1455,68 @@ protected:
         factory->deleteWorkUnit(wuid);
     }
 
+    void testIncrementalGraphProgress()
+    {
+        Owned<IWorkUnitFactory> factory = getWorkUnitFactory();
+        Owned<IWorkUnit> createWu = factory->createWorkUnit("WuTest", NULL, NULL, NULL);
+        StringBuffer wuid(createWu->queryWuid());
+        createWu->createGraph("graph1", "graphLabel", GraphTypeActivities, createPTreeFromXMLString("<graph><node id='1'/></graph>"), 1);
+        createWu->commit();
+        createWu.clear();
+        Owned<IConstWorkUnit> wu = factory->openWorkUnit(wuid);
+
+        // Repeated updates of the same subgraph - the later ones may only publish the values that changed
+        for (unsigned pass=1; pass <= 5; pass++)
+        {
+            Owned<IWUGraphStats> progress = wu->updateStats("graph1", SCThthor, queryStatisticsComponentName(), 1, 1, false);
+            IStatisticGatherer & stats = progress->queryStatsBuilder();
+            StatsSubgraphScope subgraph(stats, 1);
+            stats.addStatistic(StTimeElapsed, 5000);
+            {
+                StatsActivityScope activity(stats, 2);
+                stats.addStatistic(StNumRowsProcessed, pass*100);
+            }
+            if (pass >= 3)
+            {
+                StatsActivityScope activity(stats, 3);
+                stats.addStatistic(StNumRowsProcessed, pass);
+            }
+            // Enough unchanging statistics that a delta is much smaller than the complete stats
+            for (unsigned id=10; id < 200; id++)
+            {
+                StatsActivityScope activity(stats, id);
+                stats.addStatistic(StNumRowsProcessed, id*1000);
+                stats.addStatistic(StTimeLocalExecute, id*id*7919);
+            }
+        }
+
+        bool isDali = streq(factory->queryStoreType(), "Dali");
+        if (isDali)
+        {
+            // The updates after the first must have been appended as deltas, rather than rewriting the stats
+            VStringBuffer path("/GraphProgress/%s/graph1/sg1", wuid.str());
+            Owned<IRemoteConnection> conn = querySDS().connect(path, myProcessSession(), RTM_LOCK_READ, 5*60*1000);
+            ASSERT(conn);
+            ASSERT(conn->queryRoot()->hasProp("Stats"));
+            ASSERT(conn->queryRoot()->getCount("Delta") == 4);
+        }
+
+        Owned<IConstWUGraphProgress> graphProgress = wu->getGraphProgress("graph1");
+        Owned<IPropertyTree> tree = graphProgress->getProgressTree(false);
+        VStringBuffer xpath("node[@id=\"1\"]/%s", queryTreeTag(StTimeElapsed));
+        ASSERT(tree->getPropInt64(xpath) == 5000);
+        xpath.clear().appendf("node[@id=\"1\"]/node[@id=\"2\"]/%s", queryTreeTag(StNumRowsProcessed));
+        ASSERT(tree->getPropInt64(xpath) == 500);
+        xpath.clear().appendf("node[@id=\"1\"]/node[@id=\"3\"]/%s", queryTreeTag(StNumRowsProcessed));
+        ASSERT(tree->getPropInt64(xpath) == 5);
+        xpath.clear().appendf("node[@id=\"1\"]/node[@id=\"59\"]/%s", queryTreeTag(StNumRowsProcessed));
+        ASSERT(tree->getPropInt64(xpath) == 59000);
+
+        wu->clearGraphProgress();
+        wu.clear();
+        factory->deleteWorkUnit(wuid);
+    }
+
     void sortStatistics(StringBuffer &xml)
     {
         Owned<IPropertyTree> p = createPTreeFromXMLString(xml);
@@ -1418,6 +1548,43 @@ protected:
         ASSERT(streq(s1, s2));
     }
 
+    void testLoad()
+    {
+        // Time full loads and listing of the workunits created by testCreate - run against any store with -selftest testSize=n
+        Owned<IWorkUnitFactory> factory = getWorkUnitFactory();
+        unsigned start = msTick();
+        for (unsigned pass = 0; pass < 2; pass++)
+        {
+            // The second pass may be satisfied (in part) from any cache the store keeps of unchanging sections
+            ForEachItemIn(i, wuids)
+            {
+                Owned<IConstWorkUnit> wu = factory->openWorkUnit(wuids.item(i));
+                ASSERT(wu);
+                Owned<IPropertyTree> tree = queryExtendedWU(wu)->getUnpackedTree(false);
+                ASSERT(tree);
+            }
+            unsigned end = msTick();
+            DBGLOG("%u workunits fully loaded (pass %u) in %d ms", wuids.ordinality(), pass+1, end-start);
+            start = end;
+        }
+
+        unsigned numIterated = 0;
+        Owned<IConstWorkUnitIterator> wus = factory->getWorkUnitsByOwner(NULL, NULL, NULL);
+        ForEach(*wus)
+            numIterated++;
+        unsigned end = msTick();
+        DBGLOG("%u workunits listed in %d ms", numIterated, end-start);
+        start = end;
+
+        WUSortField sortByOwner[] = { WUSFuser, WUSFterm };
+        numIterated = 0;
+        wus.setown(factory->getWorkUnitsSorted((WUSortField) (WUSFwuid | WUSFreverse), sortByOwner, "WuTestUser00|WuTestUser01|WuTestUser02|WuTestUser03", 0, 10000, NULL, NULL));
+        ForEach(*wus)
+            numIterated++;
+        DBGLOG("%u workunits for 4 owners listed in %d ms", numIterated, msTick()-start);
+        ASSERT(numIterated == (testSize+49)/50 + (testSize+48)/50 + (testSize+47)/50 + (testSize+46)/50);
+    }
+
     void testDelete()
     {
         ASSERT(wuids.length() == testSize);